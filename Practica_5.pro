@@ -1,5 +1,7 @@
 QT       += core gui\
-            multimedia
+            multimedia\
+            concurrent\
+            network
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -10,18 +12,31 @@ CONFIG += c++17
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
+    capaestructura.cpp \
+    capaterreno.cpp \
     escenajuego.cpp \
     main.cpp \
+    motorefectos.cpp \
+    partidared.cpp \
     ventanaprincipal.cpp
 
 HEADERS += \
-    bloqueestructura.h \
+    cachesprites.h \
+    capaescombros.h \
+    capaestructura.h \
+    capaparticulas.h \
+    capaproyectiles.h \
+    capaterreno.h \
     escenajuego.h \
-    vector2d.h \
+    motorefectos.h \
+    partidared.h \
     ventanaprincipal.h
 
 FORMS +=
 
+# Nucleo de simulacion (fisica sin Qt), compartido con herramientas sin ventana
+include(simulacion/simulacion.pri)
+
 # Default rules for deployment.
 qnx: target.path = /tmp/$${TARGET}/bin
 else: unix:!android: target.path = /opt/$${TARGET}/bin
@@ -29,3 +44,15 @@ else: unix:!android: target.path = /opt/$${TARGET}/bin
 
 RESOURCES += \
     rec.qrc
+
+# Sprites a tamaño de pantalla generados desde arte/ (ver
+# herramientas/preparar_sprites.py). Los generados estan en el repositorio;
+# si hay Python se regeneran antes de compilar cuando cambia el arte.
+win32: PYTHON_SPRITES = python
+else:  PYTHON_SPRITES = python3
+PYTHON_OK = $$system($$PYTHON_SPRITES -c \"print(1)\")
+equals(PYTHON_OK, 1) {
+    sprites.commands = $$PYTHON_SPRITES $$shell_quote($$PWD/herramientas/preparar_sprites.py) $$shell_quote($$PWD)
+    QMAKE_EXTRA_TARGETS += sprites
+    PRE_TARGETDEPS += sprites
+}
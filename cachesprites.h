@@ -0,0 +1,40 @@
+#ifndef CACHESPRITES_H
+#define CACHESPRITES_H
+
+#include <QPixmap>
+#include <QHash>
+#include <QString>
+#include <QSize>
+
+// CacheSprites:
+//  - Los sprites ya vienen a tamaño de pantalla (herramientas/preparar_sprites.py),
+//    incluida la version espejada del cañon.
+//  - Cada uno se decodifica como mucho una vez por proceso; reiniciar la
+//    partida reutiliza el mismo QPixmap (datos compartidos, sin copia).
+class CacheSprites
+{
+public:
+    // 'caja' es el tamaño maximo con el que se dibuja. Si el recurso es
+    // mas grande (p. ej. sprites sin regenerar) se escala una sola vez.
+    static QPixmap obtener(const QString &nombre, const QSize &caja){
+        QHash<QString, QPixmap> &cache = instancia();
+        auto it = cache.constFind(nombre);
+        if (it != cache.constEnd())
+            return it.value();
+
+        QPixmap pix(QStringLiteral(":/new/images/") + nombre);
+        if (pix.width() > caja.width() || pix.height() > caja.height())
+            pix = pix.scaled(caja, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+
+        cache.insert(nombre, pix);
+        return pix;
+    }
+
+private:
+    static QHash<QString, QPixmap> &instancia(){
+        static QHash<QString, QPixmap> cache;
+        return cache;
+    }
+};
+
+#endif // CACHESPRITES_H
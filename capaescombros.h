@@ -0,0 +1,60 @@
+#ifndef CAPAESCOMBROS_H
+#define CAPAESCOMBROS_H
+
+#include <QGraphicsItem>
+#include <QPainter>
+#include <QPolygonF>
+#include <QBrush>
+#include <QPen>
+#include "escombros.h"
+
+// CapaEscombros:
+//  - Un solo item que dibuja todos los pedazos de bloques destruidos,
+//    leyendo directamente los Escombros del mundo (como CapaProyectiles).
+//  - Cada pedazo es un cuadrilatero girado; la escena solo pide repintar
+//    mientras alguno esta despierto.
+class CapaEscombros : public QGraphicsItem
+{
+public:
+    CapaEscombros(const Escombros &escombros, const QRectF &limites,
+                  QGraphicsItem *parent = nullptr)
+        : QGraphicsItem(parent),
+        m_escombros(escombros),
+        m_limites(limites)
+    {
+        setZValue(0.5);  // delante de los bloques, detras de los sprites
+    }
+
+    // Zona donde puede haber escombros (escena mas un margen).
+    void fijarLimites(const QRectF &limites){
+        prepareGeometryChange();
+        m_limites = limites;
+    }
+
+    QRectF boundingRect() const override { return m_limites; }
+
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *,
+               QWidget *) override {
+        const Escombros &e = m_escombros;
+        const int n = e.tamano();
+        if (n == 0) return;
+
+        painter->setPen(QPen(Qt::black));
+        painter->setBrush(QBrush(Qt::darkGray));
+
+        QPolygonF pedazo(4);
+        for (int i = 0; i < n; ++i) {
+            for (int k = 0; k < 4; ++k) {
+                const Vector2D p = e.esquina(i, k);
+                pedazo[k] = QPointF(p.x, p.y);
+            }
+            painter->drawPolygon(pedazo);
+        }
+    }
+
+private:
+    const Escombros &m_escombros;
+    QRectF m_limites;
+};
+
+#endif // CAPAESCOMBROS_H
@@ -0,0 +1,172 @@
+#include "capaestructura.h"
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+#include <QFontMetricsF>
+#include <QGuiApplication>
+#include <QtMath>
+#include <algorithm>
+
+CapaEstructura::CapaEstructura(QGraphicsItem *parent)
+    : QGraphicsItem(parent)
+{
+    // Para recibir exposedRect y pintar solo los bloques invalidados.
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
+}
+
+void CapaEstructura::limpiar()
+{
+    prepareGeometryChange();
+    m_rects.clear();
+    m_resistencia.clear();
+    m_destruido.clear();
+    m_color.clear();
+    m_limites = QRectF();
+}
+
+void CapaEstructura::reservar(int n)
+{
+    m_rects.reserve(n);
+    m_resistencia.reserve(n);
+    m_destruido.reserve(n);
+    m_color.reserve(n);
+}
+
+int CapaEstructura::agregarBloque(const QRectF &rect, double resistencia)
+{
+    prepareGeometryChange();
+    m_rects.append(rect);
+    m_resistencia.append(resistencia);
+    m_destruido.append(0);
+    m_color.append(kColorIntacto);
+
+    // Margen de medio pixel por el borde de 1 px.
+    m_limites = m_limites.united(rect.adjusted(-1, -1, 1, 1));
+    return m_rects.size() - 1;
+}
+
+void CapaEstructura::fijarResistencia(int i, double resistencia, bool destruido)
+{
+    if (m_destruido[i]) return;
+
+    m_resistencia[i] = resistencia;
+
+    if (destruido){
+        m_resistencia[i] = 0.0;
+        m_destruido[i] = 1;   // no se dibuja: quedan sus escombros
+    } else {
+        // Color segun porcentaje de vida (indice de la paleta = tono - 30)
+        double ratio = std::max(0.0, std::min(1.0, m_resistencia[i] / 200.0));
+        m_color[i] = int(120 * ratio);
+    }
+
+    invalidar(i);
+}
+
+void CapaEstructura::moverBloque(int i, const QRectF &rect)
+{
+    if (m_rects[i] == rect) return;
+
+    invalidar(i);
+    const QRectF conBorde = rect.adjusted(-1, -1, 1, 1);
+    if (!m_limites.contains(conBorde)) {
+        prepareGeometryChange();
+        m_limites = m_limites.united(conBorde);
+    }
+    m_rects[i] = rect;
+    invalidar(i);
+}
+
+void CapaEstructura::restaurar(int i, const QRectF &rect, double resistencia)
+{
+    moverBloque(i, rect);
+    m_resistencia[i] = resistencia;
+    m_destruido[i] = 0;
+    m_color[i] = kColorIntacto;
+    invalidar(i);
+}
+
+void CapaEstructura::invalidar(int i)
+{
+    update(m_rects[i].adjusted(-1, -1, 1, 1));
+}
+
+void CapaEstructura::paint(QPainter *painter,
+                           const QStyleOptionGraphicsItem *opcion, QWidget *)
+{
+    const QRectF expuesto = opcion->exposedRect;
+    const QVector<QBrush> &tonos = paleta();
+    static const QBrush intacto(Qt::lightGray);
+
+    painter->setPen(QPen(Qt::black));
+    for (int i = 0; i < m_rects.size(); ++i) {
+        const QRectF &r = m_rects[i];
+        if (m_destruido[i] || !expuesto.intersects(r.adjusted(-1, -1, 1, 1)))
+            continue;
+
+        const int color = m_color[i];
+        painter->setBrush(color == kColorIntacto ? intacto : tonos[color]);
+        painter->drawRect(r);
+        dibujarNumero(painter, r, int(m_resistencia[i]));
+    }
+}
+
+// Compone el numero con los digitos cacheados, centrado en el bloque.
+void CapaEstructura::dibujarNumero(QPainter *painter, const QRectF &rect,
+                                   int valor) const
+{
+    const Digitos &d = digitos();
+
+    char texto[12];
+    int n = 0;
+    do {
+        texto[n++] = char(valor % 10);
+        valor /= 10;
+    } while (valor > 0 && n < 11);
+
+    qreal x = rect.left() + (rect.width()  - n * d.avance) / 2.0;
+    qreal y = rect.top()  + (rect.height() - d.alto) / 2.0;
+    for (int k = n - 1; k >= 0; --k) {
+        painter->drawPixmap(QPointF(x, y), d.glifo[int(texto[k])]);
+        x += d.avance;
+    }
+}
+
+// Digitos 0-9 con la fuente por defecto, rasterizados una sola vez.
+const CapaEstructura::Digitos &CapaEstructura::digitos()
+{
+    static const Digitos cache = [] {
+        Digitos d;
+        QFont fuente = QGuiApplication::font();
+        QFontMetricsF fm(fuente);
+        for (int k = 0; k < 10; ++k)
+            d.avance = std::max(d.avance, fm.horizontalAdvance(QChar('0' + k)));
+        d.alto = fm.height();
+
+        for (int k = 0; k < 10; ++k) {
+            QPixmap glifo(qCeil(d.avance), qCeil(d.alto));
+            glifo.fill(Qt::transparent);
+            QPainter p(&glifo);
+            p.setRenderHint(QPainter::TextAntialiasing);
+            p.setFont(fuente);
+            p.setPen(Qt::black);
+            p.drawText(QRectF(0, 0, d.avance, d.alto), Qt::AlignCenter,
+                       QString(QChar('0' + k)));
+            d.glifo[k] = glifo;
+        }
+        return d;
+    }();
+    return cache;
+}
+
+// Tonos 30 (poca vida) a 150 (vida completa), como QColor::fromHsv(tono, 255, 220).
+const QVector<QBrush> &CapaEstructura::paleta()
+{
+    static const QVector<QBrush> tonos = [] {
+        QVector<QBrush> v;
+        v.reserve(121);
+        for (int k = 0; k <= 120; ++k)
+            v.append(QBrush(QColor::fromHsv(30 + k, 255, 220)));
+        return v;
+    }();
+    return tonos;
+}
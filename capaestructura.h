@@ -0,0 +1,70 @@
+#ifndef CAPAESTRUCTURA_H
+#define CAPAESTRUCTURA_H
+
+#include <QGraphicsItem>
+#include <QVector>
+#include <QRectF>
+#include <QBrush>
+#include <QPixmap>
+#include <array>
+
+// CapaEstructura:
+//  - Un solo item que dibuja todos los bloques "100" o "200" de los
+//    edificios, en lugar de un QGraphicsRectItem con un texto hijo cada uno.
+//  - Rectangulos, resistencia y color de cada bloque en arreglos contiguos.
+//  - El color sale de una paleta precalculada (vida → tono) y el numero
+//    de vida se compone con pixmaps de digitos cacheados.
+//  - No calcula daño: copia la resistencia que le da MundoSimulacion
+//    para los bloques golpeados en el frame. Solo se invalida el
+//    rectangulo de esos bloques (y de uno que cae, el de antes y el de
+//    ahora).
+class CapaEstructura : public QGraphicsItem
+{
+public:
+    explicit CapaEstructura(QGraphicsItem *parent = nullptr);
+
+    // Quita todos los bloques (al cambiar de nivel).
+    void limpiar();
+    void reservar(int n);
+    int  agregarBloque(const QRectF &rect, double resistencia);
+    int  numBloques() const { return m_rects.size(); }
+    bool destruido(int i) const { return m_destruido[i] != 0; }
+    double resistencia(int i) const { return m_resistencia[i]; }
+
+    // Nueva resistencia del bloque (destruido: deja de dibujarse).
+    void fijarResistencia(int i, double resistencia, bool destruido);
+
+    // El bloque cayo: invalida donde estaba y donde queda.
+    void moverBloque(int i, const QRectF &rect);
+
+    // Vuelve al estado recien creado (revancha sin recrear nada).
+    void restaurar(int i, const QRectF &rect, double resistencia);
+
+    QRectF boundingRect() const override { return m_limites; }
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *opcion,
+               QWidget *widget) override;
+
+private:
+    // Indice especial de la paleta: bloque sin daño (el resto de los
+    // indices son tonos de vida).
+    static constexpr int kColorIntacto = -1;
+
+    void invalidar(int i);
+    void dibujarNumero(QPainter *painter, const QRectF &rect, int valor) const;
+
+    struct Digitos {
+        std::array<QPixmap, 10> glifo;
+        qreal avance{0};
+        qreal alto{0};
+    };
+    static const Digitos &digitos();
+    static const QVector<QBrush> &paleta();
+
+    QVector<QRectF> m_rects;
+    QVector<double> m_resistencia;
+    QVector<quint8> m_destruido;
+    QVector<int>    m_color;      // indice en paleta() o kColorIntacto
+    QRectF          m_limites;
+};
+
+#endif // CAPAESTRUCTURA_H
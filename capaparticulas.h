@@ -0,0 +1,101 @@
+#ifndef CAPAPARTICULAS_H
+#define CAPAPARTICULAS_H
+
+#include <QGraphicsItem>
+#include <QPainter>
+#include <QPen>
+#include <QVector>
+#include <algorithm>
+#include "particulas.h"
+
+// CapaParticulas:
+//  - Un solo item que dibuja todas las Particulas de la escena (polvo,
+//    chispas y pedazos), en vez de un item por particula.
+//  - Las vivas se agrupan por tipo y por nivel de desvanecido; cada grupo
+//    sale con una sola llamada (drawPoints o drawRects) y un solo pincel.
+//  - Los grupos son miembros que se vacian sin soltar memoria, asi que
+//    pintar no pide memoria una vez que crecieron.
+class CapaParticulas : public QGraphicsItem
+{
+public:
+    CapaParticulas(const Particulas &particulas, const QRectF &limites,
+                   QGraphicsItem *parent = nullptr)
+        : QGraphicsItem(parent),
+        m_particulas(particulas),
+        m_limites(limites)
+    {
+        setZValue(1.5);  // delante de los sprites, detras de los proyectiles
+    }
+
+    // Zona donde puede haber particulas (escena mas un margen).
+    void fijarLimites(const QRectF &limites){
+        prepareGeometryChange();
+        m_limites = limites;
+    }
+
+    QRectF boundingRect() const override { return m_limites; }
+
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *,
+               QWidget *) override {
+        const Particulas &p = m_particulas;
+        if (p.vacio()) return;
+
+        for (auto &grupos : m_puntos)
+            for (QVector<QPointF> &g : grupos) g.clear();
+        for (QVector<QRectF> &g : m_pedazos) g.clear();
+
+        const int n = p.ocupadas();
+        for (int i = 0; i < n; ++i) {
+            if (p.vida[i] <= 0.0f) continue;
+            const int nivel = std::min(kNiveles - 1,
+                                       int(kNiveles * p.vida[i] / p.duracion[i]));
+            if (p.tipo[i] == Particulas::Pedazo)
+                m_pedazos[nivel].append(QRectF(p.x[i] - 1.5, p.y[i] - 1.5, 3.0, 3.0));
+            else
+                m_puntos[p.tipo[i]][nivel].append(QPointF(p.x[i], p.y[i]));
+        }
+
+        painter->setBrush(Qt::NoBrush);
+        for (int t = Particulas::Polvo; t <= Particulas::Chispa; ++t) {
+            for (int nivel = 0; nivel < kNiveles; ++nivel) {
+                const QVector<QPointF> &g = m_puntos[t][nivel];
+                if (g.isEmpty()) continue;
+                QPen pen(color(t, nivel), t == Particulas::Polvo ? 3.0 : 2.0);
+                pen.setCapStyle(t == Particulas::Polvo ? Qt::RoundCap : Qt::SquareCap);
+                painter->setPen(pen);
+                painter->drawPoints(g.constData(), int(g.size()));
+            }
+        }
+
+        painter->setPen(Qt::NoPen);
+        for (int nivel = 0; nivel < kNiveles; ++nivel) {
+            const QVector<QRectF> &g = m_pedazos[nivel];
+            if (g.isEmpty()) continue;
+            painter->setBrush(color(Particulas::Pedazo, nivel));
+            painter->drawRects(g.constData(), int(g.size()));
+        }
+    }
+
+private:
+    // Escalones de transparencia: mas grupos son mas llamadas de dibujo.
+    static constexpr int kNiveles = 4;
+
+    static QColor color(int tipo, int nivel){
+        static const QColor kBase[Particulas::NumTipos] = {
+            QColor(150, 140, 120),   // Polvo
+            QColor(255, 200,  60),   // Chispa
+            QColor( 90,  90,  90),   // Pedazo
+        };
+        QColor c = kBase[tipo];
+        c.setAlphaF(float(nivel + 1) / kNiveles);
+        return c;
+    }
+
+    const Particulas &m_particulas;
+    QRectF m_limites;
+    // Polvo y chispas (puntos) y pedazos (rectangulos), por nivel.
+    QVector<QPointF> m_puntos[Particulas::Chispa + 1][kNiveles];
+    QVector<QRectF>  m_pedazos[kNiveles];
+};
+
+#endif // CAPAPARTICULAS_H
@@ -0,0 +1,63 @@
+#ifndef CAPAPROYECTILES_H
+#define CAPAPROYECTILES_H
+
+#include <QGraphicsItem>
+#include <QPainter>
+#include <QBrush>
+#include <QPen>
+#include "almacenproyectiles.h"
+
+// CapaProyectiles:
+//  - Un solo item que dibuja todos los proyectiles en vuelo.
+//  - Lee directamente el AlmacenProyectiles del mundo, asi no hay un
+//    QGraphicsItem por proyectil aunque haya miles (metralla).
+//  - Interpola entre la posicion anterior y la actual (paso fijo).
+class CapaProyectiles : public QGraphicsItem
+{
+public:
+    CapaProyectiles(const AlmacenProyectiles &almacen, const QRectF &limites,
+                    QGraphicsItem *parent = nullptr)
+        : QGraphicsItem(parent),
+        m_almacen(almacen),
+        m_limites(limites)
+    {
+        setZValue(2);  // delante de bloques y sprites
+    }
+
+    // alfa = 0 → estado anterior, alfa = 1 → estado actual.
+    void fijarInterpolacion(double alfa){
+        m_alfa = alfa;
+        update();
+    }
+
+    // Zona donde puede haber proyectiles (escena mas un margen).
+    void fijarLimites(const QRectF &limites){
+        prepareGeometryChange();
+        m_limites = limites;
+    }
+
+    QRectF boundingRect() const override { return m_limites; }
+
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *,
+               QWidget *) override {
+        const AlmacenProyectiles &p = m_almacen;
+        const int n = p.tamano();
+        if (n == 0) return;
+
+        painter->setPen(QPen(Qt::black));
+        painter->setBrush(QBrush(Qt::red));
+
+        for (int i = 0; i < n; ++i) {
+            double x = p.xAnt[i] + (p.x[i] - p.xAnt[i]) * m_alfa;
+            double y = p.yAnt[i] + (p.y[i] - p.yAnt[i]) * m_alfa;
+            painter->drawEllipse(QPointF(x, y), p.radio[i], p.radio[i]);
+        }
+    }
+
+private:
+    const AlmacenProyectiles &m_almacen;
+    QRectF m_limites;
+    double m_alfa{1.0};
+};
+
+#endif // CAPAPROYECTILES_H
@@ -0,0 +1,66 @@
+#include "capaterreno.h"
+#include <QColor>
+#include <QImage>
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+
+CapaTerreno::CapaTerreno(const Terreno &terreno, QGraphicsItem *parent)
+    : QGraphicsItem(parent),
+    m_terreno(terreno)
+{
+    setZValue(-1);   // detras de bloques y sprites, como el suelo plano
+    // Para recibir exposedRect y copiar solo esa parte del pixmap.
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
+}
+
+void CapaTerreno::rehacer()
+{
+    const QRectF limites(0, 0, m_terreno.ancho(), m_terreno.alto());
+    if (limites != m_limites) {
+        prepareGeometryChange();
+        m_limites = limites;
+    }
+
+    if (!m_terreno.activo()) {
+        m_imagen = QPixmap();
+        return;
+    }
+    if (m_imagen.size() != QSize(m_terreno.ancho(), m_terreno.alto()))
+        m_imagen = QPixmap(m_terreno.ancho(), m_terreno.alto());
+    pintarZona(QRect(0, 0, m_terreno.ancho(), m_terreno.alto()));
+    update();
+}
+
+void CapaTerreno::actualizar()
+{
+    const Terreno::Zona &z = m_terreno.cambios();
+    if (z.vacia() || m_imagen.isNull())
+        return;
+    const QRect zona(z.x0, z.y0, z.x1 - z.x0, z.y1 - z.y0);
+    pintarZona(zona);
+    update(QRectF(zona));
+}
+
+// Las filas del Terreno son palabras de 64 bits con la columna 0 en el
+// bit menos significativo: en little-endian es justo Format_MonoLSB con
+// 8 bytes por palabra. Se copia a color solo la zona pedida.
+void CapaTerreno::pintarZona(const QRect &zona)
+{
+    QImage mascara(reinterpret_cast<const uchar *>(m_terreno.fila(0)),
+                   m_terreno.ancho(), m_terreno.alto(),
+                   qsizetype(m_terreno.palabrasPorFila()) * 8, QImage::Format_MonoLSB);
+    mascara.setColorTable({qRgba(0, 0, 0, 0), QColor(Qt::darkGreen).rgba()});
+
+    QPainter p(&m_imagen);
+    p.setCompositionMode(QPainter::CompositionMode_Source);
+    p.drawImage(zona.topLeft(), mascara.copy(zona));
+}
+
+void CapaTerreno::paint(QPainter *painter, const QStyleOptionGraphicsItem *opcion,
+                        QWidget *)
+{
+    if (m_imagen.isNull())
+        return;
+    const QRect expuesto = opcion->exposedRect.toAlignedRect() & m_imagen.rect();
+    painter->drawPixmap(expuesto.topLeft(), m_imagen, expuesto);
+}
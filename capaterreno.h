@@ -0,0 +1,38 @@
+#ifndef CAPATERRENO_H
+#define CAPATERRENO_H
+
+#include <QGraphicsItem>
+#include <QPixmap>
+#include <QRectF>
+#include "terreno.h"
+
+// CapaTerreno:
+//  - Dibuja el Terreno destructible del mundo desde un pixmap del tamaño
+//    del mundo, detras de todo lo demas.
+//  - La mascara de bits se lee tal cual como una imagen de 1 bit por
+//    pixel (sin copiarla) y solo se vuelve a pintar en el pixmap la zona
+//    que cambio desde que se tomaron los sucesos del mundo por ultima vez
+//    (Terreno::cambios()).
+class CapaTerreno : public QGraphicsItem
+{
+public:
+    explicit CapaTerreno(const Terreno &terreno, QGraphicsItem *parent = nullptr);
+
+    // Vuelve a pintar todo (nivel nuevo o revancha).
+    void rehacer();
+    // Pinta los crateres nuevos, si hubo.
+    void actualizar();
+
+    QRectF boundingRect() const override { return m_limites; }
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *opcion,
+               QWidget *widget) override;
+
+private:
+    void pintarZona(const QRect &zona);
+
+    const Terreno &m_terreno;
+    QPixmap m_imagen;
+    QRectF  m_limites;
+};
+
+#endif // CAPATERRENO_H
@@ -3,46 +3,28 @@
 #include <QGraphicsEllipseItem>
 #include <QGraphicsRectItem>
 #include <QGraphicsPixmapItem>
-#include <QTransform>
-#include <algorithm>    // std::min, std::max
-#include <cmath>        // std::
-#include <QSoundEffect>
+#include <QGuiApplication>
+#include <QScreen>
+#include <QPainter>
+#include <QFontMetricsF>
+#include <QRandomGenerator>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QResource>
+#include "nivel.h"
+
+const QString EscenaJuego::kNivelBase = QStringLiteral(":/niveles/base.p5n");
 
 EscenaJuego::EscenaJuego(QObject *parent)
-    : QGraphicsScene(parent),
-    m_turno(Izquierda)
+    : QGraphicsScene(parent)
 {
-    setSceneRect(0, 0, m_ancho, m_alto);
     configurarMundo();
 
     // ------------------ SONIDOS ---------------------
-    // DISPARO
-    sonidoDisparo = new QMediaPlayer(this);
-    audioDisparo  = new QAudioOutput(this);
-    sonidoDisparo->setAudioOutput(audioDisparo);
-    audioDisparo->setVolume(0.8);
-    sonidoDisparo->setSource(QUrl("qrc:/new/sonidos/disparo_canon.mp3"));
-
-    // REBOTE
-    sonidoRebote = new QMediaPlayer(this);
-    audioRebote  = new QAudioOutput(this);
-    sonidoRebote->setAudioOutput(audioRebote);
-    audioRebote->setVolume(0.7);
-    sonidoRebote->setSource(QUrl("qrc:/new/sonidos/rebote.mp3"));
-
-    // DESTRUCCIÓN
-    sonidoDestruccion = new QMediaPlayer(this);
-    audioDestruccion  = new QAudioOutput(this);
-    sonidoDestruccion->setAudioOutput(audioDestruccion);
-    audioDestruccion->setVolume(0.8);
-    sonidoDestruccion->setSource(QUrl("qrc:/new/sonidos/destruccion.mp3"));
-
-    // SONIDO DE VICTORIA
-    sonidoVictoria = new QMediaPlayer(this);
-    audioVictoria  = new QAudioOutput(this);
-    sonidoVictoria->setAudioOutput(audioVictoria);
-    audioVictoria->setVolume(0.8);
-    sonidoVictoria->setSource(QUrl("qrc:/new/sonidos/winning.mp3"));
+    // Disparo, rebote, destrucción y victoria se decodifican una vez y
+    // se mezclan en MotorEfectos (varias voces a la vez, sin cortes).
+    m_efectos = new MotorEfectos(this);
 
     // ------------------ MÚSICA DE FONDO ---------------------
     musicaFondo1 = new QMediaPlayer(this);
@@ -75,429 +57,419 @@ EscenaJuego::EscenaJuego(QObject *parent)
     musicaFondo1->play();
 
 
-    m_temporizador.setInterval(16);
+    // El temporizador solo marca frames; su precision ya no afecta a la
+    // fisica. Se ajusta al refresco de la pantalla (120/144 Hz incluidos).
+    int intervaloMs = 16;
+    if (QScreen *pantalla = QGuiApplication::primaryScreen()) {
+        if (pantalla->refreshRate() > 0.0)
+            intervaloMs = qMax(1, int(1000.0 / pantalla->refreshRate()));
+    }
+    m_temporizador.setTimerType(Qt::PreciseTimer);
+    m_temporizador.setInterval(intervaloMs);
     connect(&m_temporizador, &QTimer::timeout,
             this, &EscenaJuego::actualizarSimulacion);
+
+    m_temporizadorParticulas.setTimerType(Qt::PreciseTimer);
+    m_temporizadorParticulas.setInterval(intervaloMs);
+    connect(&m_temporizadorParticulas, &QTimer::timeout,
+            this, &EscenaJuego::actualizarParticulas);
+
+    // La guia se recalcula como mucho una vez por frame aunque los
+    // controles cambien muchas veces seguidas (arrastrar un spin box).
+    m_temporizadorTrayectoria.setSingleShot(true);
+    m_temporizadorTrayectoria.setInterval(intervaloMs);
+    connect(&m_temporizadorTrayectoria, &QTimer::timeout,
+            this, &EscenaJuego::actualizarTrayectoria);
 }
 
 // Crea todos los elementos de la escena (bloques, rivales, cañones, etc.)
+// La geometria la decide el nivel cargado en m_mundo; aqui solo se crean
+// los items que la dibujan (mostrarNivel los ajusta a cada nivel).
 void EscenaJuego::configurarMundo()
 {
     // Fondo (cielo) y suelo verde
     setBackgroundBrush(QBrush(QColor(220, 230, 255)));
-    addRect(0, m_alto-20, m_ancho, 20,
-            QPen(Qt::NoPen), QBrush(Qt::darkGreen));
-
-    // Geometría común de las estructuras
-    double yBase = m_alto - 20;
-    double anchoColumna = 60;
-    double altoColumna = 200;
-    double separacion = 110;
-    double altoTecho = 60;
-
-    // Un poco más adentro de la pared izquierda
-    double xBaseIzq = 110;
-
-    // ----------- LADO IZQUIERDO (bloques) -----------
-    BloqueEstructura *izqCol1 = new BloqueEstructura(
-        QRectF(xBaseIzq, yBase - altoColumna,
-               anchoColumna, altoColumna), 200);
-    BloqueEstructura *izqCol2 = new BloqueEstructura(
-        QRectF(xBaseIzq + anchoColumna + separacion, yBase - altoColumna,
-               anchoColumna, altoColumna), 200);
-    addItem(izqCol1); addItem(izqCol2);
-    m_bloquesIzquierda << izqCol1 << izqCol2;
-
-    double yTecho = yBase - altoColumna - altoTecho;
-    BloqueEstructura *izqTecho = new BloqueEstructura(
-        QRectF(xBaseIzq, yTecho,
-               2*anchoColumna + separacion, altoTecho), 150);
-    addItem(izqTecho);
-    m_bloquesIzquierda << izqTecho;
-
-    // ----------- LADO DERECHO (bloques) -----------
-    double xBaseDer = m_ancho - xBaseIzq - 2*anchoColumna - separacion;
-
-    BloqueEstructura *derCol1 = new BloqueEstructura(
-        QRectF(xBaseDer, yBase - altoColumna,
-               anchoColumna, altoColumna), 200);
-    BloqueEstructura *derCol2 = new BloqueEstructura(
-        QRectF(xBaseDer + anchoColumna + separacion, yBase - altoColumna,
-               anchoColumna, altoColumna), 200);
-    addItem(derCol1); addItem(derCol2);
-    m_bloquesDerecha << derCol1 << derCol2;
-
-    BloqueEstructura *derTecho = new BloqueEstructura(
-        QRectF(xBaseDer, yTecho,
-               2*anchoColumna + separacion, altoTecho), 150);
-    addItem(derTecho);
-    m_bloquesDerecha << derTecho;
-
-    // ----------- SPRITES DE PERSONAJES -----------
-
-    // Cargamos sprites y se les ajusta el tamaño
-    QPixmap spritePersonaje1(":/new/images/personaje1.png");
-    spritePersonaje1 = spritePersonaje1.scaled(
-        100, 100, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-
-    QPixmap spritePersonaje2(":/new/images/personaje2.png");
-    spritePersonaje2 = spritePersonaje2.scaled(
-        100, 100, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-
-    // Personaje izquierdo = personaje1.png
-    m_rivalIzquierda = addPixmap(spritePersonaje1);
-    m_rivalIzquierda->setZValue(1);  // delante de bloques
+    m_suelo = addRect(QRectF(), QPen(Qt::NoPen), QBrush(Qt::darkGreen));
+    m_capaTerreno = new CapaTerreno(m_mundo.terreno());
+    addItem(m_capaTerreno);
+
+    // ----------- SPRITES -----------
+
+    // Sprites ya escalados (y espejado) en tiempo de compilación; la
+    // caché evita volver a decodificarlos en cada reinicio.
+    QPixmap spritePersonaje1 = CacheSprites::obtener("personaje1.png", QSize(100, 100));
+    QPixmap spritePersonaje2 = CacheSprites::obtener("personaje2.png", QSize(100, 100));
+
+    // Cañon derecho: sprite original (mira hacia la izquierda);
+    // el izquierdo usa la versión espejada.
+    QPixmap spriteCanon    = CacheSprites::obtener("canon.png", QSize(80, 70));
+    QPixmap spriteCanonIzq = CacheSprites::obtener("canon_izq.png", QSize(80, 70));
+
+    // Nivel inicial: el original de la práctica, compilado en los recursos.
+    // Si faltara, el mundo lo arma por código con el tamaño de los sprites.
+    if (!leerNivel(kNivelBase)) {
+        qWarning("Nivel: %s (%s); se usa el nivel por defecto",
+                 qPrintable(kNivelBase), qPrintable(m_errorNivel));
+        m_mundo.construirNivelBase(spritePersonaje1.width(), spritePersonaje1.height(),
+                                   spriteCanon.width(), spriteCanon.height());
+    }
 
-    // Se coloca centrado ENTRE las dos columnas
-    double anchoEstructura = 2*anchoColumna + separacion;
-    double xCentroEstrIzq = xBaseIzq + anchoEstructura / 2.0;
-    double yPersonaje = yBase - spritePersonaje1.height() - 10;
+    // ----------- BLOQUES (ambos lados) -----------
+    // Un solo item para todos los bloques en vez de un rectángulo con
+    // texto hijo por bloque.
+    m_capaEstructura = new CapaEstructura;
+    addItem(m_capaEstructura);
 
-    m_rivalIzquierda->setPos(xCentroEstrIzq - spritePersonaje1.width()/2.0,
-                             yPersonaje);
+    // Los bloques destruidos desaparecen y dejan sus pedazos.
+    m_capaEscombros = new CapaEscombros(m_mundo.escombros(), QRectF());
+    addItem(m_capaEscombros);
 
-    // Personaje derecho = personaje2.png, también centrado en su estructura
+    // Polvo, chispas y pedazos de los golpes, todos en un item.
+    m_capaParticulas = new CapaParticulas(m_particulas, QRectF());
+    addItem(m_capaParticulas);
+
+    // ----------- PERSONAJES -----------
+    // Personaje izquierdo = personaje1.png, personaje derecho = personaje2.png
+    m_rivalIzquierda = addPixmap(spritePersonaje1);
+    m_rivalIzquierda->setZValue(1);  // delante de bloques
     m_rivalDerecha = addPixmap(spritePersonaje2);
     m_rivalDerecha->setZValue(1);
 
-    double xCentroEstrDer = xBaseDer + anchoEstructura / 2.0;
-
-    m_rivalDerecha->setPos(xCentroEstrDer - spritePersonaje2.width()/2.0,
-                           yPersonaje);
-
-    // ----------- CAÑONES CENTRADOS EN LOS LATERALES (sprites) -----------
+    // ----------- CAÑONES CENTRADOS EN LOS LATERALES -----------
 
-    // Sprite base del cañon, escalado
-    QPixmap spriteCanon(":/new/images/canon.png");
-    spriteCanon = spriteCanon.scaled(
-        80, 70, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-
-    // Versión espejada para el cañon izquierdo
-    QPixmap spriteCanonIzq = spriteCanon.transformed(
-        QTransform().scale(-1, 1));
-
-    double yCentro = m_alto / 2.0;
-
-    double anchoPlataforma = 80;
-    double altoPlataforma  = 10;
-    double xPlataformaMargen = 10;   // separación de la pared
-
-    // Plataforma izquierda (no recibe daño)
-    m_plataformaIzquierda = addRect(
-        xPlataformaMargen,
-        yCentro + 10,
-        anchoPlataforma,
-        altoPlataforma,
-        QPen(Qt::black), QBrush(Qt::darkGray));
+    // Plataformas (no reciben daño)
+    m_plataformaIzquierda = addRect(QRectF(), QPen(Qt::black), QBrush(Qt::darkGray));
+    m_plataformaDerecha   = addRect(QRectF(), QPen(Qt::black), QBrush(Qt::darkGray));
 
     // Cañon izquierdo: usa sprite espejado (mira a la derecha)
     m_canionIzquierda = addPixmap(spriteCanonIzq);
     m_canionIzquierda->setZValue(1);
 
-    double xCanonIzq = xPlataformaMargen + anchoPlataforma/2.0;
-    double yCanon    = yCentro - spriteCanonIzq.height()/2.0;
-
-    m_canionIzquierda->setPos(xCanonIzq - spriteCanonIzq.width()/2.0,
-                              yCanon);
-
-    // Plataforma derecha
-    m_plataformaDerecha = addRect(
-        m_ancho - xPlataformaMargen - anchoPlataforma,
-        yCentro + 10,
-        anchoPlataforma,
-        altoPlataforma,
-        QPen(Qt::black), QBrush(Qt::darkGray));
-
     // Cañon derecho: sprite original (mira hacia la izquierda)
     m_canionDerecha = addPixmap(spriteCanon);
     m_canionDerecha->setZValue(1);
 
-    double xCanonDer = m_ancho - xPlataformaMargen - anchoPlataforma/2.0;
-    m_canionDerecha->setPos(xCanonDer - spriteCanon.width()/2.0,
-                            yCanon);
-}
+    // ----------- GUIA DEL DISPARO -----------
+    QPen punteado(QColor(40, 40, 40, 180), 2, Qt::DotLine);
+    m_trayectoria = addPath(QPainterPath(), punteado);
+    m_trayectoria->setZValue(1.5);   // sobre bloques y sprites
+    m_trayectoria->hide();
 
-// Logica para iniciar un disparo desde el bando que tenga el turno.
-void EscenaJuego::dispararProyectil(double anguloGrados, double velocidad)
-{
-    if (m_proyectil.activo) return; // aún hay un proyectil en vuelo
-
-    reiniciarProyectil(m_turno, anguloGrados, velocidad);
+    // ----------- PROYECTILES -----------
+    m_capaProyectiles = new CapaProyectiles(m_mundo.proyectiles(), QRectF());
+    addItem(m_capaProyectiles);
 
-    // Sonido de disparo de cañon
-    sonidoDisparo->stop();
-    sonidoDisparo->play();
-
-    m_temporizador.start();
+    mostrarNivel();
+    iniciarRegistro(QRandomGenerator::global()->generate());
 }
 
-// Posiciona y configura el proyectil según el bando (izquierda/derecha).
+// ------------------------- Niveles -------------------------
 
-void EscenaJuego::reiniciarProyectil(Bando bando,
-                                     double anguloGrados,
-                                     double velocidad)
+// Los recursos de nivel van sin comprimir (rec.qrc) y se leen en su sitio;
+// los archivos se mapean en memoria. En ambos casos los bloques pasan al
+// mundo copiando arreglos enteros (ver Nivel).
+bool EscenaJuego::leerNivel(const QString &ruta)
 {
-    m_proyectil.activo = true;
-    m_proyectil.tiempoVida = 0.0;
-    m_proyectil.masa = 10.0;
-    m_proyectil.radio = 8.0;
-
-    double rad = qDegreesToRadians(anguloGrados);
-
-    if (bando == Izquierda) {
-        // Centro del cañon izquierdo
-        QRectF r = m_canionIzquierda->boundingRect();
-        QPointF centro = m_canionIzquierda->mapToScene(r.center());
-        m_proyectil.posicion = Vector2D(centro.x(), centro.y());
-
-        // Disparo hacia la derecha
-        m_proyectil.velocidad.x =  velocidad * qCos(rad);
-        m_proyectil.velocidad.y = -velocidad * qSin(rad);
+    Nivel nivel;
+    QByteArray copia;
+    bool leido;
+
+    if (ruta.startsWith(QLatin1Char(':'))) {
+        QResource recurso(ruta);
+        if (recurso.isValid() && recurso.compressionAlgorithm() == QResource::NoCompression) {
+            leido = nivel.desdeMemoria(reinterpret_cast<const std::uint8_t *>(recurso.data()),
+                                       std::size_t(recurso.size()));
+        } else {
+            QFile archivo(ruta);
+            leido = archivo.open(QIODevice::ReadOnly);
+            if (leido) {
+                copia = archivo.readAll();
+                leido = nivel.desdeMemoria(reinterpret_cast<const std::uint8_t *>(copia.constData()),
+                                           std::size_t(copia.size()));
+            }
+        }
     } else {
-        // Centro del cañon derecho
-        QRectF r = m_canionDerecha->boundingRect();
-        QPointF centro = m_canionDerecha->mapToScene(r.center());
-        m_proyectil.posicion = Vector2D(centro.x(), centro.y());
-
-        // Disparo hacia la izquierda
-        m_proyectil.velocidad.x = -velocidad * qCos(rad);
-        m_proyectil.velocidad.y = -velocidad * qSin(rad);
+        leido = nivel.abrir(ruta.toStdString());
     }
 
-    if (!m_itemProyectil) {
-        m_itemProyectil = addEllipse(
-            0, 0,
-            2*m_proyectil.radio, 2*m_proyectil.radio,
-            QPen(Qt::black), QBrush(Qt::red));
+    if (!leido) {
+        m_errorNivel = nivel.error().empty() ? tr("no se pudo abrir")
+                                             : QString::fromStdString(nivel.error());
+        return false;
     }
-    m_itemProyectil->setVisible(true);
-    m_itemProyectil->setPos(m_proyectil.posicion.x - m_proyectil.radio,
-                            m_proyectil.posicion.y - m_proyectil.radio);
+
+    m_temporizador.stop();
+    nivel.aplicar(m_mundo);
+    m_errorNivel.clear();
+    return true;
 }
 
-// Avanza la simulación un paso de tiempo.
-void EscenaJuego::actualizarSimulacion()
+bool EscenaJuego::cargarNivel(const QString &ruta)
 {
-    if (!m_proyectil.activo){
-        m_temporizador.stop();
-        return;
-    }
-
-    double dt = 0.016;
-    integrar(dt);
-    resolverChoquesParedes();
-    resolverChoquesBloques();
-    comprobarGolpeRival();
+    if (!leerNivel(ruta))
+        return false;
 
-    m_proyectil.tiempoVida += dt;
-    double vel = magnitud(m_proyectil.velocidad);
-
-    // Condiciones para eliminar el proyectil y pasar turno.
-    if (m_proyectil.posicion.y - m_proyectil.radio > m_alto + 50 ||
-        m_proyectil.posicion.x + m_proyectil.radio < -50 ||
-        m_proyectil.posicion.x - m_proyectil.radio > m_ancho + 50 ||
-        m_proyectil.tiempoVida > 8.0 || vel < 10.0)
-    {
-        finalizarTurno();
-    }
+    mostrarNivel();
+    reiniciarJuego();
+    return true;
 }
 
-// Integración explicita muy simple (Euler).
-void EscenaJuego::integrar(double dt)
+// Ajusta la escena al nivel de m_mundo: tamaño, suelo (o terreno) y bloques.
+void EscenaJuego::mostrarNivel()
 {
-    // Aceleración: solo gravedad hacia abajo.
-    m_proyectil.velocidad.y += m_gravedad * dt;
-    m_proyectil.posicion += m_proyectil.velocidad * dt;
+    const double ancho = m_mundo.ancho();
+    const double alto  = m_mundo.alto();
+
+    setSceneRect(0, 0, ancho, alto);
+    m_suelo->setRect(0, alto - m_mundo.altoSuelo(), ancho, m_mundo.altoSuelo());
+    m_suelo->setVisible(!m_mundo.hayTerreno());
+    m_capaTerreno->rehacer();
+    m_capaProyectiles->fijarLimites(sceneRect().adjusted(-50, -50, 50, 50));
+    m_capaEscombros->fijarLimites(sceneRect().adjusted(-50, -50, 50, 50));
+    m_capaEscombros->update();
+    m_capaParticulas->fijarLimites(sceneRect().adjusted(-50, -50, 50, 50));
+
+    m_capaEstructura->limpiar();
+    m_capaEstructura->reservar(m_mundo.numBloques());
+    for (int i = 0; i < m_mundo.numBloques(); ++i) {
+        const RectMundo &r = m_mundo.rectBloque(i);
+        m_capaEstructura->agregarBloque(QRectF(r.x, r.y, r.ancho, r.alto),
+                                        m_mundo.resistenciaBloque(i));
+    }
 
-    if (m_itemProyectil)
-        m_itemProyectil->setPos(m_proyectil.posicion.x - m_proyectil.radio,
-                                m_proyectil.posicion.y - m_proyectil.radio);
+    colocarItems();
 }
 
-// Colisiones elasticas con las paredes de la escena (caja).
-void EscenaJuego::resolverChoquesParedes()
+// Recoge los sucesos de todos los pasos del frame y los lleva a las
+// capas una sola vez: crateres, resistencia de los bloques golpeados y
+// posicion de los que cayeron.
+void EscenaJuego::aplicarSucesos()
 {
-    bool rebote = false;
-
-    if (m_proyectil.posicion.x - m_proyectil.radio < 0.0){
-        m_proyectil.posicion.x = m_proyectil.radio;
-        m_proyectil.velocidad.x *= -1.0;
-        rebote = true;
-    }
-    if (m_proyectil.posicion.x + m_proyectil.radio > m_ancho){
-        m_proyectil.posicion.x = m_ancho - m_proyectil.radio;
-        m_proyectil.velocidad.x *= -1.0;
-        rebote = true;
+    m_capaTerreno->actualizar();   // antes: tomarSucesos olvida los cambios
+    m_mundo.tomarSucesos(m_sucesos);
+    for (int i : m_sucesos.bloquesDaniados)
+        m_capaEstructura->fijarResistencia(i, m_mundo.resistenciaBloque(i),
+                                           m_mundo.bloqueDestruido(i));
+    for (int i : m_sucesos.bloquesMovidos) {
+        const RectMundo &r = m_mundo.rectBloque(i);
+        m_capaEstructura->moverBloque(i, QRectF(r.x, r.y, r.ancho, r.alto));
     }
-    if (m_proyectil.posicion.y - m_proyectil.radio < 0.0){
-        m_proyectil.posicion.y = m_proyectil.radio;
-        m_proyectil.velocidad.y *= -1.0;
-        rebote = true;
+    emitirParticulas();
+}
+
+// Polvo y chispas en cada golpe (mas polvo cuanto mas daño), pedazos y
+// polvo al romperse un bloque y polvo de tierra en cada crater.
+void EscenaJuego::emitirParticulas()
+{
+    for (const Suceso &s : m_sucesos.lista()) {
+        switch (s.tipo) {
+        case Suceso::Golpe:
+            m_particulas.emitir(Particulas::Polvo, s.punto, qBound(2, int(s.valor / 5.0), 12), 40.0);
+            m_particulas.emitir(Particulas::Chispa, s.punto, 3, 220.0);
+            break;
+        case Suceso::Destruccion:
+            m_particulas.emitir(Particulas::Pedazo, s.punto, 16, 180.0);
+            m_particulas.emitir(Particulas::Polvo, s.punto, 24, 60.0);
+            break;
+        case Suceso::Crater:
+            m_particulas.emitir(Particulas::Polvo, s.punto, int(s.valor), 80.0);
+            break;
+        default:
+            break;
+        }
     }
-    if (m_proyectil.posicion.y + m_proyectil.radio > m_alto - 20){
-        m_proyectil.posicion.y = m_alto - 20 - m_proyectil.radio;
-        m_proyectil.velocidad.y *= -1.0;
-        rebote = true;
+
+    if (!m_particulas.vacio() && !m_temporizadorParticulas.isActive()) {
+        m_relojParticulas.start();
+        m_temporizadorParticulas.start();
     }
+}
 
-    if (rebote && m_itemProyectil)
-        m_itemProyectil->setPos(m_proyectil.posicion.x - m_proyectil.radio,
-                                m_proyectil.posicion.y - m_proyectil.radio);
+// Las particulas solo se ven: avanzan con el tiempo real del frame, sin
+// paso fijo, y se dejan de mover cuando se apaga la ultima.
+void EscenaJuego::actualizarParticulas()
+{
+    const double dt = qMin(m_relojParticulas.nsecsElapsed() * 1e-9, 0.1);
+    m_relojParticulas.restart();
+    m_particulas.avanzar(dt);
+    m_capaParticulas->update();
+    if (m_particulas.vacio())
+        m_temporizadorParticulas.stop();
+}
 
-    // Si hubo rebote contra alguna pared, reproducimos sonido de rebote
-    if (rebote) {
-        sonidoRebote->stop();
-        sonidoRebote->play();
-    }
+// Solo un sonido por tipo y por frame: destrucción (o crater) y rebote
+// (o golpe que no rompe), aunque hubiera cientos de choques.
+void EscenaJuego::reproducirSucesos()
+{
+    if (m_sucesos.hay(Suceso::Destruccion) || m_sucesos.hay(Suceso::Crater))
+        m_efectos->reproducir(MotorEfectos::Destruccion);
+    if (m_sucesos.hay(Suceso::Rebote) ||
+        m_sucesos.cuantos(Suceso::Golpe) > m_sucesos.cuantos(Suceso::Destruccion))
+        m_efectos->reproducir(MotorEfectos::Rebote);
 }
 
-// Chequeo geometrico: ¿un circulo intersecta un rectangulo?
-bool EscenaJuego::circuloIntersecaRect(const Vector2D &c, double r,
-                                       const QRectF &rect) const
+// Repinta los escombros si alguno se movio en el ultimo paso (tambien en
+// el que se quedaron quietos).
+void EscenaJuego::moverEscombros()
 {
-    double qx = std::max(rect.left(),  std::min(rect.right(),  c.x));
-    double qy = std::max(rect.top(),   std::min(rect.bottom(), c.y));
-    Vector2D d(c.x - qx, c.y - qy);
-    return magnitud2(d) <= r*r;
+    const bool despiertos = m_mundo.escombros().hayDespiertos();
+    if (despiertos || m_escombrosEnMovimiento)
+        m_capaEscombros->update();
+    m_escombrosEnMovimiento = despiertos;
 }
 
-// Colisiones inelasticas contra los bloques de la infraestructura.
-void EscenaJuego::resolverChoquesBloques()
+// Coloca personajes, plataformas y cañones donde los tiene m_mundo.
+void EscenaJuego::colocarItems()
 {
-    auto procesarLista = [&](QVector<BloqueEstructura*> &lista){
-        for (BloqueEstructura *b : lista){
-            if (!b || b->destruido()) continue;
-
-            QRectF r = b->sceneBoundingRect();
-            if (!circuloIntersecaRect(m_proyectil.posicion,
-                                      m_proyectil.radio, r))
-                continue;
-
-            // Aproximamos la normal de choque eligiendo la cara mas cercana.
-            double distIzq  = std::abs((m_proyectil.posicion.x + m_proyectil.radio) - r.left());
-            double distDer  = std::abs((m_proyectil.posicion.x - m_proyectil.radio) - r.right());
-            double distSup  = std::abs((m_proyectil.posicion.y + m_proyectil.radio) - r.top());
-            double distInf  = std::abs((m_proyectil.posicion.y - m_proyectil.radio) - r.bottom());
-
-            Vector2D n(0,0);
-            double minDist = std::min(std::min(distIzq, distDer),
-                                      std::min(distSup, distInf));
-
-            if (minDist == distIzq)       n = Vector2D(-1,0);
-            else if (minDist == distDer)  n = Vector2D(1,0);
-            else if (minDist == distSup)  n = Vector2D(0,-1);
-            else                          n = Vector2D(0,1);
-
-            // Separación mínima para evitar que se "clave" en el bloque.
-            m_proyectil.posicion += n * 1.0;
-
-            // Descomposición de la velocidad en normal y tangencial.
-            double vN = productoPunto(m_proyectil.velocidad, n);
-            Vector2D vPerp = n * vN;
-            Vector2D vPar  = m_proyectil.velocidad - vPerp;
-
-            // Rebote inelastico (se pierde energia en la normal).
-            Vector2D vPerpNueva = n * (-m_coefRestEstructura * vN);
-            m_proyectil.velocidad = vPar + vPerpNueva;
-
-            if (m_itemProyectil)
-                m_itemProyectil->setPos(m_proyectil.posicion.x - m_proyectil.radio,
-                                        m_proyectil.posicion.y - m_proyectil.radio);
-
-            // Daño proporcional al momento (masa * |velocidad|)
-            double vel = magnitud(m_proyectil.velocidad);
-            double danio = m_factorDanio * m_proyectil.masa * vel;
-
-            // aplicarDanio devuelve true si el bloque se destruye con este golpe
-            bool seDestruyo = b->aplicarDanio(danio);
-
-            // Solo un sonido: si se destruye el bloque, usamos destrucción;
-            // en caso contrario, solo el rebote.
-            if (seDestruyo) {
-                sonidoDestruccion->stop();
-                sonidoDestruccion->play();
-            } else {
-                sonidoRebote->stop();
-                sonidoRebote->play();
-            }
-        }
+    auto aQRectF = [](const RectMundo &r){
+        return QRectF(r.x, r.y, r.ancho, r.alto);
     };
 
-    procesarLista(m_bloquesIzquierda);
-    procesarLista(m_bloquesDerecha);
+    const RectMundo &rivalIzq = m_mundo.rectRival(MundoSimulacion::Izquierda);
+    const RectMundo &rivalDer = m_mundo.rectRival(MundoSimulacion::Derecha);
+    m_rivalIzquierda->setPos(rivalIzq.x, rivalIzq.y);
+    m_rivalDerecha->setPos(rivalDer.x, rivalDer.y);
+
+    m_plataformaIzquierda->setRect(aQRectF(m_mundo.rectPlataforma(MundoSimulacion::Izquierda)));
+    m_plataformaDerecha->setRect(aQRectF(m_mundo.rectPlataforma(MundoSimulacion::Derecha)));
+
+    const RectMundo &canonIzq = m_mundo.rectCanion(MundoSimulacion::Izquierda);
+    const RectMundo &canonDer = m_mundo.rectCanion(MundoSimulacion::Derecha);
+    m_canionIzquierda->setPos(canonIzq.x, canonIzq.y);
+    m_canionDerecha->setPos(canonDer.x, canonDer.y);
 }
 
-// Comprueba si el proyectil golpea al rival y decide la victoria.
-void EscenaJuego::comprobarGolpeRival()
+// Logica para iniciar un disparo desde el bando que tenga el turno.
+void EscenaJuego::dispararProyectil(double anguloGrados, double velocidad,
+                                    MundoSimulacion::ModoDisparo modo)
 {
-    // Si ya hubo ganador, ignoramos nuevos impactos
-    if (m_hayGanador)
-        return;
+    const MundoSimulacion::Bando turno = m_mundo.turno();
+    if (!m_mundo.disparar(anguloGrados, velocidad, modo))
+        return; // aún hay proyectiles en vuelo
 
-    if (!m_proyectil.activo)
-        return;
+    m_registro.agregarDisparo(turno, modo, anguloGrados, velocidad);
+    m_trayectoria->hide();
+    emit disparoHecho(Bando(turno), modo, anguloGrados, velocidad);
 
-    // Rectángulos de los dos jugadores
-    QRectF rectIzquierda = m_rivalIzquierda->sceneBoundingRect();
-    QRectF rectDerecha   = m_rivalDerecha->sceneBoundingRect();
+    m_capaProyectiles->fijarInterpolacion(1.0);
+    m_perfilador.olvidarUltimoFrame();
 
-    bool impactoIzquierda = circuloIntersecaRect(
-        m_proyectil.posicion,
-        m_proyectil.radio,
-        rectIzquierda);
+    // Sonido de disparo de cañon
+    m_efectos->reproducir(MotorEfectos::Disparo);
 
-    bool impactoDerecha = circuloIntersecaRect(
-        m_proyectil.posicion,
-        m_proyectil.radio,
-        rectDerecha);
+    m_acumulador = 0.0;
+    m_pasosDisparo = 0;
+    m_reloj.start();
+    m_temporizador.start();
+}
 
-    if (!impactoIzquierda && !impactoDerecha)
+// El registro guarda en que paso se salto para que la reproduccion
+// haga exactamente lo mismo.
+void EscenaJuego::resolverAlInstante()
+{
+    if (!m_mundo.hayMovimiento())
         return;
 
-    // Sonido de destrucción (opcional, además del winning)
-    if (sonidoDestruccion) {
-        sonidoDestruccion->stop();
-        sonidoDestruccion->play();
+    m_temporizador.stop();
+    m_registro.marcarSalto(m_pasosDisparo);
+
+    MundoSimulacion::ResultadoPaso res = m_mundo.resolverAlInstante();
+    aplicarSucesos();
+    m_capaEscombros->update();   // ya asentados
+    m_escombrosEnMovimiento = false;
+    reproducirSucesos();
+
+    if (res.golpeRival)
+        anunciarGanador(Bando(m_mundo.ganador()));
+    else
+        finalizarTurno();
+}
+
+// Avanza la simulación con paso fijo según el tiempo real transcurrido
+// y refleja el resultado en la escena.
+void EscenaJuego::actualizarSimulacion()
+{
+    if (!m_mundo.hayMovimiento()){
+        m_temporizador.stop();
+        return;
     }
 
-    // Determinar ganador según a quién golpeó y de quién era el turno
-    Bando ganador;
+    // Las mediciones de fase del mundo van a m_perfilador (si se mide).
+    const bool medir = midiendo();
+    Perfilador::Activo perfilActivo(medir ? &m_perfilador : nullptr);
+    const qint64 inicioFrame = medir ? Perfilador::ahoraNs() : 0;
+    if (medir)
+        m_perfilador.iniciarFrame(qint64(m_temporizador.interval()) * 1000000);
+
+    // Tiempo real desde el último frame, limitado para que un bloqueo
+    // largo del hilo de la GUI no dispare una ráfaga de pasos.
+    double transcurrido = m_reloj.nsecsElapsed() * 1e-9;
+    m_reloj.restart();
+    m_acumulador += qMin(transcurrido, m_pasoFisica * kMaxPasosPorFrame);
+
+    bool golpeRival = false;
+    bool turnoTerminado = false;
+
+    while (m_acumulador >= m_pasoFisica) {
+        MundoSimulacion::ResultadoPaso res = m_mundo.paso(m_pasoFisica);
+        m_acumulador -= m_pasoFisica;
+        ++m_pasosDisparo;
+
+        golpeRival     = res.golpeRival;
+        turnoTerminado = res.turnoTerminado;
+        if (golpeRival || turnoTerminado)
+            break;
+    }
 
-    if (impactoIzquierda && impactoDerecha) {
-        // Caso muy raro: le pega a los dos, damos la victoria al rival del turno
-        ganador = (m_turno == Izquierda) ? Derecha : Izquierda;
+    // Los pasos solo llenan los sucesos del mundo; la escena los consume
+    // una vez por frame: los bloques golpeados actualizan su color y su
+    // texto de vida, los que caen su posicion y el terreno sus crateres.
+    {
+        MedicionFase medirDanio(Perfilador::Danio);
+        aplicarSucesos();
+        moverEscombros();
     }
-    else if (impactoIzquierda) {
-        // Golpea al jugador de la izquierda
-        // Si el turno era Izquierda, se auto-disparó → gana Derecha
-        // Si el turno era Derecha, le dio al enemigo → gana Derecha
-        ganador = Derecha;
+    {
+        MedicionFase medirSonido(Perfilador::Sonido);
+        reproducirSucesos();
     }
-    else { // impactoDerecha
-        // Golpea al jugador de la derecha
-        // Si el turno era Derecha, se auto-disparó → gana Izquierda
-        // Si el turno era Izquierda, le dio al enemigo → gana Izquierda
-        ganador = Izquierda;
+
+    if (golpeRival)
+        anunciarGanador(Bando(m_mundo.ganador()));
+    else if (turnoTerminado)
+        finalizarTurno();
+    else
+        m_capaProyectiles->fijarInterpolacion(m_acumulador / m_pasoFisica);
+
+    if (medir) {
+        m_perfilador.sumar(Perfilador::Actualizar, inicioFrame,
+                           Perfilador::ahoraNs() - inicioFrame);
+        m_perfilador.terminarFrame();
+        if (m_perfilVisible)
+            actualizarTextoPerfil();
     }
+}
+
+// Muestra el ganador cuando el proyectil alcanza a un rival.
+void EscenaJuego::anunciarGanador(Bando ganador)
+{
+    // Sonido de destrucción (opcional, además del winning)
+    m_efectos->reproducir(MotorEfectos::Destruccion);
 
-    // Desactivar proyectil y parar la simulación
-    m_proyectil.activo = false;
-    if (m_itemProyectil)
-        m_itemProyectil->setVisible(false);
+    // El mundo ya retiró los proyectiles; parar la simulación
+    m_capaProyectiles->update();
     m_temporizador.stop();
 
-    // Marcar que ya hay ganador
-    m_hayGanador = true;
+    m_registro.cerrar(m_mundo);
+    guardarRegistro();
+    m_trayectoria->hide();
 
     // --- Parar música de fondo ---
     if (musicaFondo1) musicaFondo1->stop();
     if (musicaFondo2) musicaFondo2->stop();
 
     // --- Reproducir sonido de victoria ---
-    if (sonidoVictoria) {
-        sonidoVictoria->stop();
-        sonidoVictoria->play();
-    }
+    m_efectos->reproducir(MotorEfectos::Victoria);
 
     // --- Mostrar texto en el centro de la escena ---
     QString texto;
@@ -518,6 +490,7 @@ void EscenaJuego::comprobarGolpeRival()
         m_textoFin = addText(texto, fuente);
     } else {
         m_textoFin->setPlainText(texto);
+        m_textoFin->setVisible(true);
     }
 
     m_textoFin->setDefaultTextColor(Qt::black);
@@ -532,34 +505,43 @@ void EscenaJuego::comprobarGolpeRival()
     emit partidaTerminada(ganador);
 }
 
+// Revancha con una semilla al azar.
 void EscenaJuego::reiniciarJuego()
+{
+    reiniciarJuego(QRandomGenerator::global()->generate());
+}
+
+// Revancha: se reutilizan todos los items de la escena; solo se
+// restauran los bloques y se recolocan los items a partir de m_mundo.
+void EscenaJuego::reiniciarJuego(quint32 semilla)
 {
     // Detener cualquier cosa que siga sonando
     if (musicaFondo1) musicaFondo1->stop();
     if (musicaFondo2) musicaFondo2->stop();
-    if (sonidoVictoria) sonidoVictoria->stop();
+    m_efectos->detenerTodo();
 
     m_temporizador.stop();
-    m_proyectil.activo = false;
-
-    // Limpiar todos los items gráficos
-    clear();
-
-    // Resetear listas y punteros relacionados con la escena
-    m_bloquesIzquierda.clear();
-    m_bloquesDerecha.clear();
-    m_itemProyectil = nullptr;
-    m_rivalIzquierda = nullptr;
-    m_rivalDerecha   = nullptr;
-
-    m_textoFin = nullptr;
-    m_hayGanador = false;
-
-    // Volver al turno inicial
-    m_turno = Izquierda;
+    m_temporizadorParticulas.stop();
+    m_particulas.limpiar();
+    m_capaParticulas->update();
+
+    // Bloques y partida como al principio (también vuelve al turno inicial)
+    m_mundo.restaurarNivel();
+    for (int i = 0; i < m_capaEstructura->numBloques(); ++i) {
+        const RectMundo &r = m_mundo.rectBloque(i);
+        m_capaEstructura->restaurar(i, QRectF(r.x, r.y, r.ancho, r.alto),
+                                    m_mundo.resistenciaBloque(i));
+    }
+    m_capaTerreno->rehacer();   // sin crateres
+    colocarItems();
+    iniciarRegistro(semilla);
+    actualizarTrayectoria();
 
-    // Volver a montar el mundo
-    configurarMundo();
+    if (m_textoFin)
+        m_textoFin->setVisible(false);
+    m_capaProyectiles->update();
+    m_capaEscombros->update();
+    m_escombrosEnMovimiento = false;
 
     // Volver a arrancar la música de fondo desde la canción 1
     if (musicaFondo1 && musicaFondo2) {
@@ -569,18 +551,178 @@ void EscenaJuego::reiniciarJuego()
     }
 
     // Notificar a la ventana que el turno actual cambió
-    emit turnoCambiado(m_turno);
+    emit turnoCambiado(turnoActual());
 }
 
-// Destruye el proyectil actual y alterna el turno
+// El mundo ya retiró los proyectiles y alternó el turno
 void EscenaJuego::finalizarTurno()
 {
-    m_proyectil.activo = false;
-    if (m_itemProyectil) m_itemProyectil->setVisible(false);
+    m_capaProyectiles->update();
     m_temporizador.stop();
+    actualizarTrayectoria();   // ahora desde el otro cañon
+
+    emit turnoCambiado(turnoActual());
+}
+
+// ------------------------- Guia del disparo -------------------------
+
+void EscenaJuego::preverDisparo(double anguloGrados, double velocidad,
+                                MundoSimulacion::ModoDisparo modo)
+{
+    m_prevision.angulo = anguloGrados;
+    m_prevision.velocidad = velocidad;
+    m_prevision.modo = modo;
+    m_prevision.pedida = true;
+
+    if (!m_temporizadorTrayectoria.isActive())
+        m_temporizadorTrayectoria.start();
+}
+
+// Parabola exacta hasta el primer contacto; reutiliza el item, el
+// vector de puntos y el QPainterPath.
+void EscenaJuego::actualizarTrayectoria()
+{
+    if (!m_prevision.pedida || m_mundo.hayMovimiento() || m_mundo.hayGanador()) {
+        m_trayectoria->hide();
+        return;
+    }
+
+    m_mundo.preverTrayectoria(m_prevision.angulo, m_prevision.velocidad,
+                              m_prevision.modo, m_puntosTrayectoria);
+
+    m_caminoTrayectoria.clear();
+    if (!m_puntosTrayectoria.empty()) {
+        m_caminoTrayectoria.moveTo(m_puntosTrayectoria[0].x, m_puntosTrayectoria[0].y);
+        for (std::size_t i = 1; i < m_puntosTrayectoria.size(); ++i)
+            m_caminoTrayectoria.lineTo(m_puntosTrayectoria[i].x, m_puntosTrayectoria[i].y);
+    }
+    m_trayectoria->setPath(m_caminoTrayectoria);
+    m_trayectoria->show();
+}
+
+// ------------------------- Grabacion -------------------------
 
-    m_turno = (m_turno == Izquierda) ? Derecha : Izquierda;
-    emit turnoCambiado(m_turno);
+// Semilla nueva por partida; el registro guarda el nivel y la fisica
+// tal como empiezan.
+void EscenaJuego::iniciarRegistro(quint32 semilla)
+{
+    m_mundo.fijarSemilla(semilla);
+    aplicarFisica(semilla);
+    m_registro.iniciar(m_mundo, m_pasoFisica);
+}
+
+// El viento es un entero de px/s entre -60 y 60 sacado de la semilla.
+void EscenaJuego::aplicarFisica(quint32 semilla)
+{
+    constexpr double kArrastre = 2e-4;   // un disparo simple no pasa de ~400 px/s
+    constexpr int    kVientoMaximo = 60;
+
+    const double viento = (m_aire == ConViento)
+        ? double(int((semilla >> 16) % (2*kVientoMaximo + 1)) - kVientoMaximo)
+        : 0.0;
+    m_mundo.fijarIntegrador(m_integrador);
+    m_mundo.fijarAire(m_aire == SinAire ? 0.0 : kArrastre, Vector2D(viento, 0.0));
+    m_pasoFisica = m_mundo.pasoRecomendado(kPasoFisica, kPasoMaximo);
+}
+
+void EscenaJuego::guardarRegistro()
+{
+    if (m_carpetaRegistros.isEmpty() || m_registro.vacio())
+        return;
+
+    QDir carpeta(m_carpetaRegistros);
+    if (!carpeta.mkpath(QStringLiteral(".")))
+        return;
+
+    const QString nombre = QStringLiteral("partida_%1.p5r").arg(
+        QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss_zzz"));
+    if (!m_registro.guardar(carpeta.filePath(nombre).toStdString()))
+        qWarning("No se pudo guardar el registro %s", qPrintable(nombre));
+}
+
+// ------------------------- Perfilado -------------------------
+
+void EscenaJuego::mostrarPerfil(bool visible)
+{
+    m_perfilVisible = visible;
+    if (visible) {
+        m_relojHud.invalidate();
+        actualizarTextoPerfil();
+    } else {
+        update(m_rectPerfil);
+    }
+}
+
+void EscenaJuego::grabarTraza(bool grabar)
+{
+    m_perfilador.grabarTraza(grabar);
+}
+
+bool EscenaJuego::exportarTraza(const QString &ruta) const
+{
+    return m_perfilador.exportarTraza(ruta.toStdString());
+}
+
+// El texto del HUD se recalcula como mucho 4 veces por segundo.
+void EscenaJuego::actualizarTextoPerfil()
+{
+    if (m_relojHud.isValid() && m_relojHud.elapsed() < 250)
+        return;
+    m_relojHud.start();
+
+    QString texto = tr("%1 frames          p50     p99 (ms)")
+                        .arg(m_perfilador.framesMedidos());
+    for (int f = 0; f < Perfilador::NumFases; ++f) {
+        Perfilador::Fase fase = Perfilador::Fase(f);
+        Perfilador::Resumen r = m_perfilador.resumen(fase);
+        texto += QString("\n%1 %2 %3")
+                     .arg(QString::fromLatin1(Perfilador::nombreFase(fase)), -12)
+                     .arg(r.p50Ms, 7, 'f', 3)
+                     .arg(r.p99Ms, 7, 'f', 3);
+    }
+    if (m_perfilador.grabandoTraza())
+        texto += tr("\n[grabando traza: %1 eventos]").arg(m_perfilador.eventosTraza());
+
+    m_textoPerfil = texto;
+    update(m_rectPerfil.isEmpty() ? sceneRect() : m_rectPerfil);
 }
 
+void EscenaJuego::drawBackground(QPainter *painter, const QRectF &rect)
+{
+    if (midiendo())
+        m_inicioPintado = Perfilador::ahoraNs();
+    QGraphicsScene::drawBackground(painter, rect);
+}
 
+void EscenaJuego::drawForeground(QPainter *painter, const QRectF &rect)
+{
+    QGraphicsScene::drawForeground(painter, rect);
+
+    if (m_perfilVisible && !m_textoPerfil.isEmpty()) {
+        QFont fuente(QStringLiteral("monospace"));
+        fuente.setStyleHint(QFont::Monospace);
+        fuente.setPointSize(8);
+        QFontMetricsF fm(fuente);
+
+        QRectF texto = fm.boundingRect(QRectF(0, 0, 1000, 1000),
+                                       Qt::AlignLeft | Qt::AlignTop, m_textoPerfil);
+        m_rectPerfil = texto.translated(sceneRect().topLeft() + QPointF(10, 10))
+                           .adjusted(-4, -4, 4, 4);
+
+        painter->save();
+        painter->setPen(Qt::NoPen);
+        painter->setBrush(QColor(0, 0, 0, 160));
+        painter->drawRect(m_rectPerfil);
+        painter->setPen(Qt::white);
+        painter->setFont(fuente);
+        painter->drawText(m_rectPerfil.adjusted(4, 4, -4, -4),
+                          Qt::AlignLeft | Qt::AlignTop, m_textoPerfil);
+        painter->restore();
+    }
+
+    if (m_inicioPintado >= 0) {
+        m_perfilador.sumar(Perfilador::Pintado, m_inicioPintado,
+                           Perfilador::ahoraNs() - m_inicioPintado);
+        m_inicioPintado = -1;
+    }
+}
@@ -3,12 +3,23 @@
 
 #include <QGraphicsScene>
 #include <QTimer>
+#include <QElapsedTimer>
 #include <QVector>
 #include <QGraphicsPixmapItem>
+#include <QGraphicsPathItem>
+#include <QPainterPath>
 #include <QMediaPlayer>
 #include <QAudioOutput>
-#include "vector2d.h"
-#include "bloqueestructura.h"
+#include "mundosimulacion.h"
+#include "perfilador.h"
+#include "registropartida.h"
+#include "capaestructura.h"
+#include "capaproyectiles.h"
+#include "capaescombros.h"
+#include "capaterreno.h"
+#include "capaparticulas.h"
+#include "motorefectos.h"
+#include "cachesprites.h"
 #include <QGraphicsTextItem>
 
 class EscenaJuego : public QGraphicsScene
@@ -20,45 +31,145 @@ public:
 
     explicit EscenaJuego(QObject *parent = nullptr);
 
-    Bando turnoActual() const { return m_turno; }
-    void dispararProyectil(double anguloGrados, double velocidad);
+    Bando turnoActual() const { return Bando(m_mundo.turno()); }
+    const MundoSimulacion &mundo() const { return m_mundo; }
+    void dispararProyectil(double anguloGrados, double velocidad,
+                           MundoSimulacion::ModoDisparo modo = MundoSimulacion::DisparoSimple);
+
+    // Salta al final del turno en curso: el mundo resuelve los
+    // proyectiles en vuelo por eventos (sin animacion) y la escena
+    // refleja el daño y el resultado de una vez.
+    void resolverAlInstante();
+
+    // Guia punteada del disparo con los valores actuales de la ventana.
+    // Se puede llamar en cada cambio: se recalcula como mucho una vez por
+    // frame y solo mientras no haya proyectiles en vuelo.
+    void preverDisparo(double anguloGrados, double velocidad,
+                       MundoSimulacion::ModoDisparo modo);
+
+    // --- niveles ---
+    // Nivel de texto o binario (ver Nivel), de un archivo o de los
+    // recursos (":/niveles/..."). Si no se puede leer devuelve false,
+    // deja errorNivel() con el motivo y la partida actual sigue igual;
+    // si se lee, empieza una partida nueva en ese nivel.
+    static const QString kNivelBase;
+    bool cargarNivel(const QString &ruta);
+    QString errorNivel() const { return m_errorNivel; }
+
+    // --- fisica de la partida ---
+    // Aire: nada, arrastre, o arrastre y viento. El viento sale de la
+    // semilla, asi que cambia en cada partida y la partida en red lo tiene
+    // igual en los dos procesos.
+    enum Aire { SinAire, ConArrastre, ConViento };
+    Q_ENUM(Aire)
+    // Vale desde la proxima partida (reiniciarJuego o cargarNivel).
+    void fijarFisica(Integrador metodo, Aire aire)
+    {
+        m_integrador = metodo;
+        m_aire = aire;
+    }
+    // Paso fijo de la partida en curso (ver m_pasoFisica).
+    double pasoFisica() const { return m_pasoFisica; }
 
     // --- reiniciar el juego ---
     Q_INVOKABLE void reiniciarJuego();
+    // Con una semilla dada para la metralla (la partida en red la
+    // acuerda entre los dos procesos).
+    void reiniciarJuego(quint32 semilla);
+
+    // --- grabacion de partidas ---
+    // Con carpeta, cada partida terminada se guarda como .p5r.
+    void fijarCarpetaRegistros(const QString &carpeta) { m_carpetaRegistros = carpeta; }
+    const RegistroPartida &registro() const { return m_registro; }
+
+    // --- perfilado por fases ---
+    void mostrarPerfil(bool visible);
+    bool perfilVisible() const { return m_perfilVisible; }
+    void grabarTraza(bool grabar);
+    bool grabandoTraza() const { return m_perfilador.grabandoTraza(); }
+    bool exportarTraza(const QString &ruta) const;
 
 signals:
     void turnoCambiado(EscenaJuego::Bando nuevoTurno);
+    // Salio un disparo (de quien tenia el turno), con sus entradas.
+    void disparoHecho(EscenaJuego::Bando turno, MundoSimulacion::ModoDisparo modo,
+                      double anguloGrados, double velocidad);
     void partidaTerminada(EscenaJuego::Bando ganador);
 
 private slots:
     void actualizarSimulacion();
+    void actualizarParticulas();
 
-private:
-    struct EstadoProyectil {
-        bool     activo{false};
-        double   masa{10.0};
-        double   radio{8.0};
-        Vector2D posicion;
-        Vector2D velocidad;
-        double   tiempoVida{0.0};
-    };
+protected:
+    // Marcan el principio y el fin del pintado de la vista (fase Pintado);
+    // drawForeground dibuja ademas el HUD del perfilador.
+    void drawBackground(QPainter *painter, const QRectF &rect) override;
+    void drawForeground(QPainter *painter, const QRectF &rect) override;
 
+private:
     void configurarMundo();
-    void reiniciarProyectil(Bando bando, double anguloGrados, double velocidad);
-    void integrar(double dt);
-    void resolverChoquesParedes();
-    void resolverChoquesBloques();
-    void comprobarGolpeRival();
+    bool leerNivel(const QString &ruta);
+    void mostrarNivel();
+    void colocarItems();
+    void aplicarSucesos();
+    void reproducirSucesos();
+    void emitirParticulas();
+    void moverEscombros();
+    void anunciarGanador(Bando ganador);
     void finalizarTurno();
-    bool circuloIntersecaRect(const Vector2D &c, double r, const QRectF &rect) const;
-
-    Bando m_turno;
-    EstadoProyectil m_proyectil;
-    QGraphicsEllipseItem *m_itemProyectil{nullptr};
+    void actualizarTrayectoria();
+    void iniciarRegistro(quint32 semilla);
+    void aplicarFisica(quint32 semilla);
+    void guardarRegistro();
+    bool midiendo() const { return m_perfilVisible || m_perfilador.grabandoTraza(); }
+    void actualizarTextoPerfil();
+
+    // Fisica y reglas de la partida; la escena solo dibuja a partir de aqui.
+    MundoSimulacion m_mundo;
+    // Lo que paso en el ultimo frame (se intercambia con el del mundo).
+    SucesosFisica m_sucesos;
+
+    // Dibuja todos los proyectiles en vuelo de m_mundo.
+    CapaProyectiles *m_capaProyectiles{nullptr};
     QTimer m_temporizador;
 
-    QVector<BloqueEstructura*> m_bloquesIzquierda;
-    QVector<BloqueEstructura*> m_bloquesDerecha;
+    // --- paso fijo ---
+    // La fisica avanza siempre en pasos de m_pasoFisica; cada frame ejecuta
+    // los pasos que quepan en el tiempo real transcurrido (como mucho
+    // kMaxPasosPorFrame) y dibuja interpolando entre los dos ultimos.
+    // Con Euler el paso es kPasoFisica; con Verlet o RK4, el mas largo que
+    // se aleja del vuelo exacto lo mismo que Euler con kPasoFisica (medido
+    // al empezar cada partida), hasta kPasoMaximo, lo que aguantan el
+    // derrumbe y los escombros (y lo que acepta un registro al cargarse).
+    static constexpr double kPasoFisica = 0.016;
+    static constexpr double kPasoMaximo = RegistroPartida::kPasoMaximo;
+    static constexpr int    kMaxPasosPorFrame = 5;
+    double m_pasoFisica{kPasoFisica};
+    Integrador m_integrador{Integrador::EulerSemiImplicito};
+    Aire m_aire{SinAire};
+    QElapsedTimer m_reloj;
+    double m_acumulador{0.0};
+    quint32 m_pasosDisparo{0};   // pasos del disparo en curso (para el registro)
+
+    QGraphicsRectItem *m_suelo{nullptr};
+    // Suelo destructible (en lugar de m_suelo si el nivel lo tiene).
+    CapaTerreno *m_capaTerreno{nullptr};
+    QString m_errorNivel;
+
+    // Dibuja todos los bloques; mismo indice que los bloques de m_mundo.
+    CapaEstructura *m_capaEstructura{nullptr};
+
+    // Pedazos de los bloques destruidos; se repinta mientras se mueven.
+    CapaEscombros *m_capaEscombros{nullptr};
+    bool m_escombrosEnMovimiento{false};
+
+    // Polvo, chispas y pedazos de los golpes. Avanzan con su propio
+    // temporizador, en tiempo real, mientras quede alguna (tambien
+    // despues de acabar el turno).
+    Particulas m_particulas;
+    CapaParticulas *m_capaParticulas{nullptr};
+    QTimer m_temporizadorParticulas;
+    QElapsedTimer m_relojParticulas;
 
     QGraphicsPixmapItem *m_rivalIzquierda{nullptr};
     QGraphicsPixmapItem *m_rivalDerecha{nullptr};
@@ -68,22 +179,21 @@ private:
     QGraphicsRectItem   *m_plataformaIzquierda{nullptr};
     QGraphicsRectItem   *m_plataformaDerecha{nullptr};
 
-    double m_ancho{1200.0};
-    double m_alto{600.0};
-
-    double m_gravedad{200.0};
-    double m_coefRestEstructura{0.5};
-    double m_factorDanio{0.02};
-
-    // --- Sonidos ---
-    QMediaPlayer *sonidoDisparo{nullptr};
-    QAudioOutput *audioDisparo{nullptr};
-
-    QMediaPlayer *sonidoRebote{nullptr};
-    QAudioOutput *audioRebote{nullptr};
+    // --- guia del disparo (un solo item, se reutiliza) ---
+    struct Prevision {
+        double angulo{45.0};
+        double velocidad{150.0};
+        MundoSimulacion::ModoDisparo modo{MundoSimulacion::DisparoSimple};
+        bool pedida{false};
+    };
+    Prevision m_prevision;
+    QGraphicsPathItem *m_trayectoria{nullptr};
+    QTimer m_temporizadorTrayectoria;
+    std::vector<Vector2D> m_puntosTrayectoria;
+    QPainterPath m_caminoTrayectoria;
 
-    QMediaPlayer *sonidoDestruccion{nullptr};
-    QAudioOutput *audioDestruccion{nullptr};
+    // --- Efectos de sonido (PCM precargado, mezcla propia) ---
+    MotorEfectos *m_efectos{nullptr};
 
     // --- Música de fondo ---
     QMediaPlayer *musicaFondo1{nullptr};
@@ -92,13 +202,22 @@ private:
     QMediaPlayer *musicaFondo2{nullptr};
     QAudioOutput *audioMusica2{nullptr};
 
-    // --- sonido de victoria ---
-    QMediaPlayer *sonidoVictoria{nullptr};
-    QAudioOutput *audioVictoria{nullptr};
-
     // --- texto de fin de partida ---
     QGraphicsTextItem *m_textoFin{nullptr};
-    bool m_hayGanador{false};
+
+    // --- grabacion de partidas ---
+    RegistroPartida m_registro;
+    QString m_carpetaRegistros;
+
+    // --- perfilado ---
+    // Solo se mide con el HUD visible o grabando traza; si no, cada
+    // MedicionFase se queda en una comprobacion de puntero.
+    Perfilador m_perfilador;
+    bool m_perfilVisible{false};
+    qint64 m_inicioPintado{-1};
+    QElapsedTimer m_relojHud;
+    QString m_textoPerfil;
+    QRectF  m_rectPerfil;
 };
 
 #endif // ESCENAJUEGO_H
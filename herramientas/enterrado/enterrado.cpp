@@ -0,0 +1,99 @@
+// Rival enterrado bajo escombros (ver Escombros::Entorno::numQuitan).
+//
+// Uso: enterrado [-v]
+// Sobre el nivel base sin estructuras apila bloques sin resistencia encima
+// del rival derecho y los rompe con disparos de la izquierda que no le
+// dan. Despues prueba, cada uno sobre una copia del mundo, todos los
+// disparos que alcanzan al rival con el nivel vacio (Torneo::repertorio).
+// Sale con 0 si no queda ningun pedazo sobre el rival y todos esos
+// disparos lo siguen alcanzando, y con 1 si no.
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "torneo.h"
+
+namespace {
+
+constexpr int kPisos = 6;
+
+int bloquesRotos(const MundoSimulacion &mundo)
+{
+    int rotos = 0;
+    for (int i = 0; i < mundo.numBloques(); ++i)
+        rotos += mundo.bloqueDestruido(i) ? 1 : 0;
+    return rotos;
+}
+
+// Pedazos apoyados en la cara de arriba del rival (o metidos en ella).
+int pedazosEncima(const MundoSimulacion &mundo, const RectMundo &rival)
+{
+    const Escombros &e = mundo.escombros();
+    int encima = 0;
+    for (int i = 0; i < e.tamano(); ++i) {
+        const RectMundo c = e.caja(i);
+        if (c.derecha() > rival.izquierda() && c.izquierda() < rival.derecha() &&
+            c.abajo() >= rival.arriba() - 1.0 && c.arriba() < rival.arriba())
+            ++encima;
+    }
+    return encima;
+}
+
+// Disparo de la izquierda sobre una copia de 'mundo', resuelto al instante.
+MundoSimulacion disparo(const MundoSimulacion &mundo, const Torneo::Disparo &d)
+{
+    MundoSimulacion copia = mundo;
+    copia.fijarTurno(MundoSimulacion::Izquierda);
+    copia.disparar(d.angulo, d.velocidad);
+    copia.resolverAlInstante();
+    return copia;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    const bool detallado = argc == 2 && std::strcmp(argv[1], "-v") == 0;
+    if (argc > 2 || (argc == 2 && !detallado)) {
+        std::fprintf(stderr, "uso: %s [-v]\n", argv[0]);
+        return 1;
+    }
+
+    MundoSimulacion mundo;
+    // Mismas medidas que los sprites (herramientas/preparar_sprites.py).
+    mundo.construirNivelBase(66, 100, 70, 70);
+    mundo.cargarBloques(0, nullptr, nullptr, nullptr);
+    const RectMundo rival = mundo.rectRival(MundoSimulacion::Derecha);
+    for (int k = 0; k < kPisos; ++k)
+        mundo.agregarBloque(RectMundo(rival.x - 7.0, rival.y - 30.0 * (k + 1), rival.ancho + 14.0, 30.0),
+                            1e-9, MundoSimulacion::Derecha);
+
+    const std::vector<Torneo::Disparo> tiros =
+        Torneo::repertorio(mundo, MundoSimulacion::Izquierda, Torneo::Opciones());
+
+    // Romper la pila con los tiros que no llegan al rival.
+    for (const Torneo::Disparo &d : tiros) {
+        if (bloquesRotos(mundo) == kPisos) break;
+        MundoSimulacion despues = disparo(mundo, d);
+        if (!despues.hayGanador())
+            mundo = std::move(despues);
+    }
+
+    int aciertos = 0;
+    for (const Torneo::Disparo &d : tiros) {
+        const bool alcanza = disparo(mundo, d).hayGanador();
+        aciertos += alcanza ? 1 : 0;
+        if (detallado && !alcanza)
+            std::printf("no alcanza: %.1f grados, %.1f px/s\n", d.angulo, d.velocidad);
+    }
+
+    const int rotos = bloquesRotos(mundo);
+    const int encima = pedazosEncima(mundo, rival);
+    std::printf("%d/%d bloques rotos, %d escombros, %d sobre el rival; "
+                "%d/%zu disparos lo alcanzan\n",
+                rotos, kPisos, mundo.escombros().tamano(), encima, aciertos, tiros.size());
+    const bool bien = rotos == kPisos && encima == 0 && !tiros.empty() &&
+                      aciertos == int(tiros.size());
+    std::printf("%s\n", bien ? "OK" : "FALLA");
+    return bien ? 0 : 1;
+}
@@ -0,0 +1,14 @@
+# Comprobacion de que los escombros no tapan a un rival (sin Qt, sin ventana).
+# Rompe una pila de bloques apoyada sobre el rival derecho y dispara todos
+# los tiros que lo alcanzan con el nivel vacio: tienen que seguir
+# alcanzandolo con los pedazos caidos encima.
+#   enterrado [-v]
+
+TEMPLATE = app
+CONFIG  += c++17 console
+CONFIG  -= qt app_bundle
+TARGET   = enterrado
+
+SOURCES += enterrado.cpp
+
+include(../../simulacion/simulacion.pri)
@@ -0,0 +1,177 @@
+// Precision contra coste de los integradores del vuelo (ver integradores.pro).
+//
+// Uso: integradores [--tolerancia px] [--json archivo]
+// Por defecto la tolerancia es el error de Euler con el paso de la partida
+// (16 ms), el mismo criterio que MundoSimulacion::pasoRecomendado: con
+// cada metodo se busca el paso mas largo que no se aleja mas que eso.
+// Los tiempos son los de AlmacenProyectiles::integrar, lo que paga la
+// partida. Sin aire Verlet y RK4 no integran: con gravedad constante los
+// dos dan la parabola exacta y el almacen la calcula directamente. Esas
+// filas se marcan "parabola" en la columna camino (el error sigue siendo
+// el del metodo paso a paso, que ahi es solo redondeo).
+// Sale con 0 si todo fue bien y con 2 si el uso es incorrecto o no se pudo
+// escribir el JSON.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "almacenproyectiles.h"
+#include "integrador.h"
+
+namespace {
+
+constexpr double kPasoPartida = 0.016;
+constexpr double kSuelo = 580.0;
+const double kPasos[] = {0.004, 0.008, 0.016, 0.024, 0.032, 0.048, 0.064, 0.1};
+const Integrador kMetodos[] = {Integrador::EulerSemiImplicito, Integrador::Verlet,
+                               Integrador::RK4};
+
+struct Aire {
+    const char *nombre;
+    double arrastre;
+    double viento;
+};
+// Los mismos valores que usa EscenaJuego (viento en su maximo).
+const Aire kAires[] = {
+    {"sin_aire",        0.0,  0.0},
+    {"arrastre",        2e-4, 0.0},
+    {"arrastre_viento", 2e-4, -60.0},
+};
+
+struct Medida {
+    const char *aire;
+    Integrador metodo;
+    const char *camino;      // lo que se cronometro (ver caminoIntegrar)
+    double dt;
+    double errorPx;
+    double nsPorPaso;        // por proyectil
+    double nsPorSegundo;     // por proyectil y segundo simulado
+    double tolerancia;
+};
+
+volatile double g_sumidero = 0.0;
+
+// Que hace AlmacenProyectiles::integrar con ese metodo y esas fuerzas.
+const char *caminoIntegrar(Integrador metodo, const ModeloFuerzas &f)
+{
+    return f.soloGravedad() && metodo != Integrador::EulerSemiImplicito ? "parabola"
+                                                                        : "metodo";
+}
+
+// Tiempo por proyectil y paso integrando 1000 proyectiles de metralla.
+double medirPaso(Integrador metodo, const ModeloFuerzas &f, double dt)
+{
+    constexpr int kProyectiles = 1000;
+    constexpr int kPasosMedidos = 200;
+    double mejor = 1e300;
+    for (int muestra = 0; muestra < 5; ++muestra) {
+        AlmacenProyectiles p;
+        p.reservar(kProyectiles);
+        for (int i = 0; i < kProyectiles; ++i)
+            p.agregar({100.0 + i % 50, 300.0 + i / 50},
+                      {150.0 + i % 7 * 10.0, -200.0 + i % 11 * 10.0}, 2.0, 0.25);
+
+        const auto inicio = std::chrono::steady_clock::now();
+        for (int k = 0; k < kPasosMedidos; ++k)
+            p.integrar(dt, f, metodo);
+        const double ns = std::chrono::duration<double, std::nano>(
+                              std::chrono::steady_clock::now() - inicio).count();
+        g_sumidero = g_sumidero + double(p.y[0]);
+        if (ns < mejor)
+            mejor = ns;
+    }
+    return mejor / (double(kProyectiles) * kPasosMedidos);
+}
+
+bool escribirJson(const std::string &ruta, const std::vector<Medida> &medidas,
+                  const std::vector<Medida> &elegidos)
+{
+    std::FILE *f = std::fopen(ruta.c_str(), "w");
+    if (!f) return false;
+    auto escribir = [f](const Medida &m, bool ultima) {
+        std::fprintf(f, "    {\"aire\": \"%s\", \"integrador\": \"%s\", \"camino\": \"%s\", "
+                        "\"dt\": %.3f, \"error_px\": %.6g, \"tolerancia_px\": %.6g, "
+                        "\"ns_paso\": %.3f, \"ns_segundo\": %.1f}%s\n",
+                     m.aire, nombreIntegrador(m.metodo), m.camino, m.dt, m.errorPx, m.tolerancia,
+                     m.nsPorPaso, m.nsPorSegundo, ultima ? "" : ",");
+    };
+    std::fprintf(f, "{\n  \"medidas\": [\n");
+    for (std::size_t i = 0; i < medidas.size(); ++i)
+        escribir(medidas[i], i + 1 == medidas.size());
+    std::fprintf(f, "  ],\n  \"elegidos\": [\n");
+    for (std::size_t i = 0; i < elegidos.size(); ++i)
+        escribir(elegidos[i], i + 1 == elegidos.size());
+    std::fprintf(f, "  ]\n}\n");
+    return std::fclose(f) == 0;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    double toleranciaFija = 0.0;   // 0: la de Euler a kPasoPartida
+    std::string rutaJson;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--tolerancia") == 0 && i + 1 < argc) {
+            toleranciaFija = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            rutaJson = argv[++i];
+        } else {
+            std::fprintf(stderr, "uso: %s [--tolerancia px] [--json archivo]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    std::vector<Medida> medidas;
+    std::vector<Medida> elegidos;
+
+    for (const Aire &aire : kAires) {
+        ModeloFuerzas f;
+        f.arrastre = aire.arrastre;
+        f.viento = Vector2D(aire.viento, 0.0);
+        f.suelo = kSuelo;
+        const double coef = f.coefArrastre(2.0, 0.25);
+        const double tolerancia = toleranciaFija > 0.0
+            ? toleranciaFija
+            : errorTrayectoria(Integrador::EulerSemiImplicito, f, coef, kPasoPartida);
+
+        std::printf("\n%s (tolerancia %.4g px)\n", aire.nombre, tolerancia);
+        std::printf("  %-7s %-8s %7s %12s %10s %12s\n",
+                    "metodo", "camino", "dt", "error px", "ns/paso", "ns/segundo");
+
+        for (Integrador metodo : kMetodos) {
+            const char *camino = caminoIntegrar(metodo, f);
+            Medida mejor{aire.nombre, metodo, camino, 0.0, 0.0, 0.0, 0.0, tolerancia};
+            for (double dt : kPasos) {
+                Medida m{aire.nombre, metodo, camino, dt,
+                         errorTrayectoria(metodo, f, coef, dt),
+                         medirPaso(metodo, f, dt), 0.0, tolerancia};
+                m.nsPorSegundo = m.nsPorPaso / dt;
+                medidas.push_back(m);
+                std::printf("  %-7s %-8s %7.3f %12.6g %10.2f %12.1f%s\n",
+                            nombreIntegrador(metodo), camino, dt, m.errorPx, m.nsPorPaso,
+                            m.nsPorSegundo, m.errorPx <= tolerancia ? "" : "  > tolerancia");
+                if (m.errorPx <= tolerancia && dt > mejor.dt)
+                    mejor = m;
+            }
+            if (mejor.dt > 0.0)
+                elegidos.push_back(mejor);
+        }
+
+        std::printf("  paso mas largo dentro de la tolerancia:\n");
+        for (const Medida &m : elegidos)
+            if (m.aire == aire.nombre)
+                std::printf("    %-7s dt %.3f  %.1f ns por segundo simulado%s\n",
+                            nombreIntegrador(m.metodo), m.dt, m.nsPorSegundo,
+                            std::strcmp(m.camino, "parabola") == 0 ? " (parabola exacta)" : "");
+    }
+
+    if (!rutaJson.empty() && !escribirJson(rutaJson, medidas, elegidos)) {
+        std::fprintf(stderr, "no se pudo escribir %s\n", rutaJson.c_str());
+        return 2;
+    }
+    return 0;
+}
@@ -0,0 +1,16 @@
+# Precision contra coste de los integradores del vuelo (sin Qt, sin ventana).
+# Para cada aire y cada metodo (Euler, Verlet, RK4) mide el error de un tiro
+# de prueba y el tiempo por paso con varios pasos dt, y dice que paso
+# elegiria la partida (sin aire, Verlet y RK4 salen como "parabola": el
+# almacen calcula la exacta en vez de integrar):
+#   integradores [--tolerancia px] [--json resultados.json]
+# Compilar en release: los tiempos de una compilacion debug no sirven.
+
+TEMPLATE = app
+CONFIG  += c++17 console
+CONFIG  -= qt app_bundle
+TARGET   = integradores
+
+SOURCES += integradores.cpp
+
+include(../../simulacion/simulacion.pri)
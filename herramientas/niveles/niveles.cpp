@@ -0,0 +1,146 @@
+// Herramienta de niveles (ver Nivel).
+//
+// Uso:
+//   niveles convertir <entrada> <salida>   texto o binario -> segun extension
+//   niveles base <salida>                  nivel original de la practica
+//   niveles generar <bloques> <salida>     nivel base + malla de bloques
+//   niveles medir <archivo> [repeticiones] tiempo de abrir + aplicar
+// La salida es binaria si termina en .p5n y de texto en otro caso.
+// Sale con 0 si todo fue bien, 1 si hubo un error y 2 si el uso es incorrecto.
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include "nivel.h"
+
+namespace {
+
+bool terminaEn(const std::string &s, const std::string &sufijo)
+{
+    return s.size() >= sufijo.size() &&
+           s.compare(s.size() - sufijo.size(), sufijo.size(), sufijo) == 0;
+}
+
+bool guardar(const MundoSimulacion &mundo, const std::string &ruta)
+{
+    std::FILE *f = std::fopen(ruta.c_str(), "wb");
+    if (!f) return false;
+
+    bool escrito;
+    if (terminaEn(ruta, ".p5n")) {
+        const std::vector<std::uint8_t> datos = Nivel::serializar(mundo);
+        escrito = std::fwrite(datos.data(), 1, datos.size(), f) == datos.size();
+    } else {
+        const std::string texto = Nivel::aTexto(mundo);
+        escrito = std::fwrite(texto.data(), 1, texto.size(), f) == texto.size();
+    }
+    return (std::fclose(f) == 0) && escrito;
+}
+
+// Mismas medidas que los sprites (herramientas/preparar_sprites.py).
+MundoSimulacion nivelBase()
+{
+    MundoSimulacion mundo;
+    mundo.construirNivelBase(66, 100, 70, 70);
+    return mundo;
+}
+
+// Malla de bloques chicos entre las dos estructuras, repartidos entre
+// ambos lados (la misma que usa herramientas/rendimiento).
+MundoSimulacion nivelGenerado(int bloques)
+{
+    MundoSimulacion mundo = nivelBase();
+    const int extra = bloques - mundo.numBloques();
+    if (extra > 0) {
+        const double x0 = 400, y0 = 100, ancho = 400, alto = 460;
+        const int columnas = int(std::ceil(std::sqrt(extra * ancho / alto)));
+        const int filas = (extra + columnas - 1) / columnas;
+        const double celdaX = ancho / columnas, celdaY = alto / filas;
+        for (int k = 0; k < extra; ++k) {
+            const int c = k % columnas, f = k / columnas;
+            RectMundo r(x0 + c*celdaX + 0.5, y0 + f*celdaY + 0.5,
+                        celdaX - 1.0, celdaY - 1.0);
+            mundo.agregarBloque(r, 100, c < columnas/2 ? MundoSimulacion::Izquierda
+                                                       : MundoSimulacion::Derecha);
+        }
+    }
+    return mundo;
+}
+
+int uso(const char *programa)
+{
+    std::fprintf(stderr,
+                 "uso: %s convertir <entrada> <salida>\n"
+                 "     %s base <salida>\n"
+                 "     %s generar <bloques> <salida>\n"
+                 "     %s medir <archivo> [repeticiones]\n",
+                 programa, programa, programa, programa);
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    if (argc < 3) return uso(argv[0]);
+    const std::string orden = argv[1];
+
+    if (orden == "convertir" && argc == 4) {
+        Nivel nivel;
+        if (!nivel.abrir(argv[2])) {
+            std::fprintf(stderr, "%s: %s\n", argv[2], nivel.error().c_str());
+            return 1;
+        }
+        MundoSimulacion mundo;
+        nivel.aplicar(mundo);
+        if (!guardar(mundo, argv[3])) {
+            std::fprintf(stderr, "no se pudo escribir %s\n", argv[3]);
+            return 1;
+        }
+        std::printf("%s: %d bloques\n", argv[3], mundo.numBloques());
+        return 0;
+    }
+
+    if (orden == "base" && argc == 3) {
+        if (!guardar(nivelBase(), argv[2])) {
+            std::fprintf(stderr, "no se pudo escribir %s\n", argv[2]);
+            return 1;
+        }
+        return 0;
+    }
+
+    if (orden == "generar" && argc == 4) {
+        const int bloques = std::atoi(argv[2]);
+        if (bloques <= 0) return uso(argv[0]);
+        if (!guardar(nivelGenerado(bloques), argv[3])) {
+            std::fprintf(stderr, "no se pudo escribir %s\n", argv[3]);
+            return 1;
+        }
+        return 0;
+    }
+
+    if (orden == "medir" && (argc == 3 || argc == 4)) {
+        const int repeticiones = argc == 4 ? std::max(1, std::atoi(argv[3])) : 20;
+        MundoSimulacion mundo;
+        double mejorMs = 1e300;
+        for (int r = 0; r < repeticiones; ++r) {
+            const auto inicio = std::chrono::steady_clock::now();
+            Nivel nivel;
+            if (!nivel.abrir(argv[2])) {
+                std::fprintf(stderr, "%s: %s\n", argv[2], nivel.error().c_str());
+                return 1;
+            }
+            nivel.aplicar(mundo);
+            const std::chrono::duration<double, std::milli> ms =
+                std::chrono::steady_clock::now() - inicio;
+            mejorMs = std::min(mejorMs, ms.count());
+        }
+        std::printf("%s: %d bloques, carga %.3f ms (mejor de %d)\n",
+                    argv[2], mundo.numBloques(), mejorMs, repeticiones);
+        return 0;
+    }
+
+    return uso(argv[0]);
+}
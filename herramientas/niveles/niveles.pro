@@ -0,0 +1,14 @@
+# Conversion y generacion de niveles (sin Qt, sin ventana).
+#   niveles convertir nivel.txt nivel.p5n    texto -> binario (o al reves)
+#   niveles base niveles/base.txt            nivel original de la practica
+#   niveles generar 100000 grande.p5n        nivel de prueba con muchos bloques
+#   niveles medir grande.p5n                 tiempo de carga
+
+TEMPLATE = app
+CONFIG  += c++17 console
+CONFIG  -= qt app_bundle
+TARGET   = niveles
+
+SOURCES += niveles.cpp
+
+include(../../simulacion/simulacion.pri)
@@ -0,0 +1,229 @@
+#!/usr/bin/env python3
+"""Genera los sprites del juego al tamaño con el que se dibujan.
+
+Lee los PNG originales de arte/ y escribe en sprites/ las versiones ya
+escaladas (y la variante espejada del cañón). rec.qrc solo incluye las
+de sprites/, asi el ejecutable no carga megabytes de imagenes a
+resolucion completa ni escala nada al arrancar o al reiniciar.
+
+Solo usa la biblioteca estandar de Python (zlib), para no depender de
+nada mas en la maquina de compilacion.
+
+Uso:  python3 herramientas/preparar_sprites.py [raiz_del_proyecto]
+"""
+
+import os
+import struct
+import sys
+import zlib
+
+# (origen en arte/, destino en sprites/, caja ancho x alto, espejo horizontal)
+# Las cajas son las de EscenaJuego::configurarMundo (Qt::KeepAspectRatio).
+SPRITES = [
+    ("personaje1.png", "personaje1.png", 100, 100, False),
+    ("personaje2.png", "personaje2.png", 100, 100, False),
+    ("canon.png",      "canon.png",       80,  70, False),
+    ("canon.png",      "canon_izq.png",   80,  70, True),
+]
+
+
+# ----------------------------- PNG -----------------------------
+
+def leer_png(ruta):
+    with open(ruta, "rb") as f:
+        datos = f.read()
+    if datos[:8] != b"\x89PNG\r\n\x1a\n":
+        raise ValueError(ruta + ": no es un PNG")
+
+    pos = 8
+    idat = []
+    ancho = alto = tipo = None
+    while pos < len(datos):
+        largo, = struct.unpack(">I", datos[pos:pos + 4])
+        nombre = datos[pos + 4:pos + 8]
+        cuerpo = datos[pos + 8:pos + 8 + largo]
+        pos += 12 + largo
+        if nombre == b"IHDR":
+            ancho, alto, bits, tipo, _, _, entrelazado = struct.unpack(">IIBBBBB", cuerpo)
+            if bits != 8 or tipo not in (2, 6) or entrelazado:
+                raise ValueError(ruta + ": solo RGB/RGBA de 8 bits sin entrelazar")
+        elif nombre == b"IDAT":
+            idat.append(cuerpo)
+        elif nombre == b"IEND":
+            break
+
+    canales = 4 if tipo == 6 else 3
+    crudo = zlib.decompress(b"".join(idat))
+    fila = ancho * canales
+    pixeles = bytearray(alto * fila)
+    anterior = bytearray(fila)
+
+    for y in range(alto):
+        filtro = crudo[y * (fila + 1)]
+        linea = bytearray(crudo[y * (fila + 1) + 1:(y + 1) * (fila + 1)])
+        if filtro == 1:
+            for i in range(canales, fila):
+                linea[i] = (linea[i] + linea[i - canales]) & 0xFF
+        elif filtro == 2:
+            for i in range(fila):
+                linea[i] = (linea[i] + anterior[i]) & 0xFF
+        elif filtro == 3:
+            for i in range(fila):
+                izq = linea[i - canales] if i >= canales else 0
+                linea[i] = (linea[i] + ((izq + anterior[i]) >> 1)) & 0xFF
+        elif filtro == 4:
+            for i in range(fila):
+                a = linea[i - canales] if i >= canales else 0
+                b = anterior[i]
+                c = anterior[i - canales] if i >= canales else 0
+                p = a + b - c
+                pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+                pred = a if (pa <= pb and pa <= pc) else (b if pb <= pc else c)
+                linea[i] = (linea[i] + pred) & 0xFF
+        pixeles[y * fila:(y + 1) * fila] = linea
+        anterior = linea
+
+    if canales == 3:
+        rgba = bytearray(ancho * alto * 4)
+        rgba[0::4] = pixeles[0::3]
+        rgba[1::4] = pixeles[1::3]
+        rgba[2::4] = pixeles[2::3]
+        rgba[3::4] = b"\xff" * (ancho * alto)
+        pixeles = rgba
+    return ancho, alto, pixeles
+
+
+def escribir_png(ruta, ancho, alto, rgba):
+    def chunk(nombre, cuerpo):
+        return (struct.pack(">I", len(cuerpo)) + nombre + cuerpo +
+                struct.pack(">I", zlib.crc32(nombre + cuerpo) & 0xFFFFFFFF))
+
+    fila = ancho * 4
+    crudo = b"".join(b"\x00" + bytes(rgba[y * fila:(y + 1) * fila]) for y in range(alto))
+    with open(ruta, "wb") as f:
+        f.write(b"\x89PNG\r\n\x1a\n")
+        f.write(chunk(b"IHDR", struct.pack(">IIBBBBB", ancho, alto, 8, 6, 0, 0, 0)))
+        f.write(chunk(b"IDAT", zlib.compress(crudo, 9)))
+        f.write(chunk(b"IEND", b""))
+
+
+# --------------------------- escalado ---------------------------
+
+def tam_ajustado(ancho, alto, caja_ancho, caja_alto):
+    """Igual que QSize::scaled(..., Qt::KeepAspectRatio)."""
+    w = caja_alto * ancho // alto
+    if w <= caja_ancho:
+        return max(1, w), caja_alto
+    return caja_ancho, max(1, caja_ancho * alto // ancho)
+
+
+def pesos(n_origen, n_destino):
+    """Para cada pixel destino, los pixeles origen que cubre y su peso."""
+    escala = n_origen / n_destino
+    tabla = []
+    for d in range(n_destino):
+        ini, fin = d * escala, (d + 1) * escala
+        lista = []
+        s = int(ini)
+        while s < fin and s < n_origen:
+            w = min(fin, s + 1) - max(ini, s)
+            if w > 0:
+                lista.append((s, w / escala))
+            s += 1
+        tabla.append(lista)
+    return tabla
+
+
+def escalar(ancho, alto, rgba, nuevo_ancho, nuevo_alto):
+    """Promedio por area con alfa premultiplicado (como SmoothTransformation)."""
+    # Premultiplicar
+    pre = [0.0] * (ancho * alto * 4)
+    for i in range(ancho * alto):
+        a = rgba[4 * i + 3] / 255.0
+        pre[4 * i] = rgba[4 * i] * a
+        pre[4 * i + 1] = rgba[4 * i + 1] * a
+        pre[4 * i + 2] = rgba[4 * i + 2] * a
+        pre[4 * i + 3] = float(rgba[4 * i + 3])
+
+    # Horizontal
+    ph = pesos(ancho, nuevo_ancho)
+    tmp = [0.0] * (nuevo_ancho * alto * 4)
+    for y in range(alto):
+        base = y * ancho * 4
+        for x, lista in enumerate(ph):
+            r = g = b = a = 0.0
+            for s, w in lista:
+                k = base + 4 * s
+                r += pre[k] * w
+                g += pre[k + 1] * w
+                b += pre[k + 2] * w
+                a += pre[k + 3] * w
+            k = (y * nuevo_ancho + x) * 4
+            tmp[k], tmp[k + 1], tmp[k + 2], tmp[k + 3] = r, g, b, a
+
+    # Vertical y des-premultiplicar
+    pv = pesos(alto, nuevo_alto)
+    salida = bytearray(nuevo_ancho * nuevo_alto * 4)
+    for y, lista in enumerate(pv):
+        for x in range(nuevo_ancho):
+            r = g = b = a = 0.0
+            for s, w in lista:
+                k = (s * nuevo_ancho + x) * 4
+                r += tmp[k] * w
+                g += tmp[k + 1] * w
+                b += tmp[k + 2] * w
+                a += tmp[k + 3] * w
+            k = (y * nuevo_ancho + x) * 4
+            if a > 0.0:
+                f = 1.0 / (a / 255.0)
+                salida[k] = min(255, int(r * f + 0.5))
+                salida[k + 1] = min(255, int(g * f + 0.5))
+                salida[k + 2] = min(255, int(b * f + 0.5))
+            salida[k + 3] = min(255, int(a + 0.5))
+    return salida
+
+
+def espejar(ancho, alto, rgba):
+    salida = bytearray(len(rgba))
+    for y in range(alto):
+        for x in range(ancho):
+            o = (y * ancho + x) * 4
+            d = (y * ancho + (ancho - 1 - x)) * 4
+            salida[d:d + 4] = rgba[o:o + 4]
+    return salida
+
+
+# ----------------------------- main -----------------------------
+
+def main():
+    raiz = sys.argv[1] if len(sys.argv) > 1 else os.path.join(os.path.dirname(__file__), "..")
+    dir_arte = os.path.join(raiz, "arte")
+    dir_sprites = os.path.join(raiz, "sprites")
+    os.makedirs(dir_sprites, exist_ok=True)
+
+    cache = {}
+    for origen, destino, caja_w, caja_h, espejo in SPRITES:
+        ruta_origen = os.path.join(dir_arte, origen)
+        ruta_destino = os.path.join(dir_sprites, destino)
+
+        # Nada que hacer si el sprite es mas nuevo que el original.
+        if (os.path.exists(ruta_destino) and
+                os.path.getmtime(ruta_destino) >= os.path.getmtime(ruta_origen) and
+                os.path.getmtime(ruta_destino) >= os.path.getmtime(__file__)):
+            continue
+
+        clave = (origen, caja_w, caja_h)
+        if clave not in cache:
+            ancho, alto, rgba = leer_png(ruta_origen)
+            nw, nh = tam_ajustado(ancho, alto, caja_w, caja_h)
+            cache[clave] = (nw, nh, escalar(ancho, alto, rgba, nw, nh))
+        nw, nh, pix = cache[clave]
+        if espejo:
+            pix = espejar(nw, nh, pix)
+
+        escribir_png(ruta_destino, nw, nh, pix)
+        print("%s -> %s (%dx%d)" % (origen, destino, nw, nh))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,335 @@
+// Partida en red por localhost, sin ventana (ver MensajeRed y PartidaRed).
+//
+// Uso: redlocal [--partidas N] [--turnos T] [--nivel archivo] [--semilla S]
+//               [--separar | --invalido] [-v]
+// Dos hilos juegan cada partida por TCP en 127.0.0.1 con el protocolo de
+// PartidaRed: quien sirve (izquierda) elige la semilla y manda el Saludo
+// con la huella del nivel; cada uno manda su disparo cuando le toca (al
+// azar dentro de los rangos de MensajeRed), los dos lo simulan y al final
+// de cada turno intercambian y comparan la huella del estado.
+// --separar cambia un 1% la gravedad de quien se une: su saludo tiene que
+// rechazarse. --invalido hace que quien sirve abra con un modo que no
+// existe: quien se une tiene que cortar.
+// Sale con 0 si cada partida acaba como se espera (sin desincronizarse o,
+// con --separar o --invalido, con el rechazo), con 1 si no y con 2 si el
+// uso es incorrecto, no se pudo leer el nivel o falla un socket.
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include "mensajered.h"
+#include "mundosimulacion.h"
+#include "nivel.h"
+#include "registropartida.h"
+
+namespace {
+
+// Como EscenaJuego::kPasoFisica.
+constexpr double kPasoFisica = 0.016;
+
+struct Opciones {
+    int partidas{10};
+    int turnos{40};               // sin ganador antes: se da por terminada
+    std::uint32_t semilla{1};
+    bool separar{false};
+    bool invalido{false};
+    bool detallado{false};
+};
+
+enum Fin {
+    Terminada,          // ganador o tope de turnos, con las huellas iguales
+    Desincronizada,     // una huella de turno distinta
+    SaludoRechazado,    // la huella del nivel no coincide
+    DisparoRechazado,   // MensajeRed::disparoValido() dio false
+    Cortada,            // el otro cerro la conexion
+    ErrorProtocolo      // mensaje inesperado o disparo que no termina
+};
+
+const char *const kNombresFin[] = {
+    "terminada", "desincronizada", "saludo rechazado", "disparo rechazado",
+    "cortada", "error de protocolo"
+};
+
+// Un extremo de la conexion: escribe y lee mensajes enteros, bloqueando.
+class Conexion
+{
+public:
+    explicit Conexion(int fd) : m_fd(fd)
+    {
+        const int uno = 1;
+        ::setsockopt(m_fd, IPPROTO_TCP, TCP_NODELAY, &uno, sizeof uno);
+    }
+    ~Conexion() { ::close(m_fd); }
+    Conexion(const Conexion &) = delete;
+    Conexion &operator=(const Conexion &) = delete;
+
+    bool enviar(const MensajeRed &m)
+    {
+        m_salida.clear();
+        m.codificar(m_salida);
+        std::size_t hecho = 0;
+        while (hecho < m_salida.size()) {
+            const ssize_t n = ::send(m_fd, m_salida.data() + hecho, m_salida.size() - hecho,
+                                     MSG_NOSIGNAL);
+            if (n <= 0) return false;
+            hecho += std::size_t(n);
+        }
+        m_bytesEnviados += static_cast<long long>(m_salida.size());
+        return true;
+    }
+
+    // False si el otro cerro o el flujo trae un tipo desconocido.
+    bool recibir(MensajeRed &m)
+    {
+        for (;;) {
+            const int usados = MensajeRed::decodificar(m_entrada.data(), m_entrada.size(), m);
+            if (usados < 0) return false;
+            if (usados > 0) {
+                m_entrada.erase(m_entrada.begin(), m_entrada.begin() + usados);
+                return true;
+            }
+            std::uint8_t bloque[256];
+            const ssize_t n = ::recv(m_fd, bloque, sizeof bloque, 0);
+            if (n <= 0) return false;
+            m_entrada.insert(m_entrada.end(), bloque, bloque + n);
+        }
+    }
+
+    long long bytesEnviados() const { return m_bytesEnviados; }
+
+private:
+    int m_fd;
+    std::vector<std::uint8_t> m_salida;
+    std::vector<std::uint8_t> m_entrada;
+    long long m_bytesEnviados{0};
+};
+
+struct Lado {
+    MundoSimulacion::Bando bando{MundoSimulacion::Izquierda};
+    Fin fin{Terminada};
+    int turnos{0};
+    int ganador{-1};
+    long long bytes{0};
+};
+
+// Generador de los disparos de un lado (xorshift32, como el del mundo).
+struct Azar {
+    std::uint32_t estado;
+    double operator()()
+    {
+        estado ^= estado << 13;
+        estado ^= estado >> 17;
+        estado ^= estado << 5;
+        return (estado >> 8) * (1.0 / 16777216.0);
+    }
+};
+
+// Una partida desde un lado de la conexion; 'nivel' es el mundo recien
+// cargado (cada lado trabaja sobre su copia).
+void jugar(Conexion &conexion, const MundoSimulacion &nivel, std::uint32_t semilla,
+           const Opciones &op, Lado &lado)
+{
+    MundoSimulacion mundo = nivel;
+    const bool sirve = lado.bando == MundoSimulacion::Izquierda;
+    const auto terminar = [&](Fin fin) {
+        lado.fin = fin;
+        lado.bytes = conexion.bytesEnviados();
+    };
+
+    if (sirve) {
+        mundo.fijarSemilla(semilla);
+        if (!conexion.enviar(MensajeRed::saludo(semilla, mundo.hashEstado())))
+            return terminar(Cortada);
+    } else {
+        if (op.separar)
+            mundo.fijarGravedad(mundo.gravedad() * 1.01);
+        MensajeRed saludo;
+        if (!conexion.recibir(saludo))
+            return terminar(Cortada);
+        if (saludo.tipo != MensajeRed::Saludo || saludo.version != MensajeRed::kVersion)
+            return terminar(ErrorProtocolo);
+        mundo.fijarSemilla(saludo.semilla);
+        if (mundo.hashEstado() != saludo.huella)
+            return terminar(SaludoRechazado);
+    }
+
+    const double dt = mundo.pasoRecomendado(kPasoFisica, RegistroPartida::kPasoMaximo);
+    Azar azar{mundo.semilla() ^ (sirve ? 0x5bd1e995u : 0x27d4eb2du)};
+
+    for (std::uint32_t turno = 0; !mundo.hayGanador() && int(turno) < op.turnos; ++turno) {
+        MensajeRed d;
+        if (mundo.turno() == lado.bando) {
+            d = MensajeRed::disparo(turno, std::uint8_t(4 * azar()),
+                MensajeRed::kAnguloMin + (MensajeRed::kAnguloMax - MensajeRed::kAnguloMin) * azar(),
+                MensajeRed::kVelocidadMin + (MensajeRed::kVelocidadMax - MensajeRed::kVelocidadMin) * azar());
+            if (op.invalido && turno == 0) {
+                // El otro tiene que cortar antes de mandar nada.
+                d.modo = MensajeRed::kModos;
+                conexion.enviar(d);
+                MensajeRed respuesta;
+                return terminar(conexion.recibir(respuesta) ? ErrorProtocolo : Cortada);
+            }
+            if (!conexion.enviar(d))
+                return terminar(Cortada);
+        } else {
+            if (!conexion.recibir(d))
+                return terminar(Cortada);
+            if (d.tipo != MensajeRed::Disparo || d.turno != turno)
+                return terminar(ErrorProtocolo);
+            if (!d.disparoValido())
+                return terminar(DisparoRechazado);
+        }
+
+        mundo.disparar(d.angulo, d.velocidad, MundoSimulacion::ModoDisparo(d.modo));
+        for (std::uint32_t n = 0; mundo.hayMovimiento() && n < RegistroPartida::kMaxPasosDisparo; ++n)
+            mundo.paso(dt);
+        if (mundo.hayMovimiento())
+            return terminar(ErrorProtocolo);
+        lado.turnos = int(turno) + 1;
+
+        const std::uint64_t huella = mundo.hashEstado();
+        if (!conexion.enviar(MensajeRed::huellaTurno(turno + 1, huella)))
+            return terminar(Cortada);
+        MensajeRed otra;
+        if (!conexion.recibir(otra))
+            return terminar(Cortada);
+        if (otra.tipo != MensajeRed::Huella || otra.turno != turno + 1)
+            return terminar(ErrorProtocolo);
+        if (otra.huella != huella)
+            return terminar(Desincronizada);
+    }
+    lado.ganador = mundo.hayGanador() ? int(mundo.ganador()) : -1;
+    terminar(Terminada);
+}
+
+int uso(const char *programa)
+{
+    std::fprintf(stderr, "uso: %s [--partidas N] [--turnos T] [--nivel archivo] [--semilla S]\n"
+                         "       [--separar | --invalido] [-v]\n", programa);
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    Opciones op;
+    std::string rutaNivel;
+    for (int i = 1; i < argc; ++i) {
+        const bool hayValor = i + 1 < argc;
+        if (std::strcmp(argv[i], "--partidas") == 0 && hayValor) {
+            op.partidas = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--turnos") == 0 && hayValor) {
+            op.turnos = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--semilla") == 0 && hayValor) {
+            op.semilla = std::uint32_t(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--nivel") == 0 && hayValor) {
+            rutaNivel = argv[++i];
+        } else if (std::strcmp(argv[i], "--separar") == 0) {
+            op.separar = true;
+        } else if (std::strcmp(argv[i], "--invalido") == 0) {
+            op.invalido = true;
+        } else if (std::strcmp(argv[i], "-v") == 0) {
+            op.detallado = true;
+        } else {
+            return uso(argv[0]);
+        }
+    }
+    if (op.partidas < 1 || op.turnos < 1 || (op.separar && op.invalido))
+        return uso(argv[0]);
+
+    MundoSimulacion nivel;
+    if (rutaNivel.empty()) {
+        // Mismas medidas que los sprites (herramientas/preparar_sprites.py).
+        nivel.construirNivelBase(66, 100, 70, 70);
+    } else {
+        Nivel archivo;
+        if (!archivo.abrir(rutaNivel)) {
+            std::fprintf(stderr, "%s: %s\n", rutaNivel.c_str(), archivo.error().c_str());
+            return 2;
+        }
+        archivo.aplicar(nivel);
+    }
+
+    const int servidor = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in direccion{};
+    direccion.sin_family = AF_INET;
+    direccion.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    direccion.sin_port = 0;   // el que de el sistema
+    socklen_t largo = sizeof direccion;
+    if (servidor < 0 ||
+        ::bind(servidor, reinterpret_cast<sockaddr *>(&direccion), sizeof direccion) != 0 ||
+        ::listen(servidor, 1) != 0 ||
+        ::getsockname(servidor, reinterpret_cast<sockaddr *>(&direccion), &largo) != 0) {
+        std::perror("redlocal: no se pudo escuchar en 127.0.0.1");
+        return 2;
+    }
+
+    const Fin esperado = op.separar ? SaludoRechazado : op.invalido ? DisparoRechazado : Terminada;
+    int comoSeEspera = 0, turnos = 0;
+    long long bytes = 0;
+    const auto inicio = std::chrono::steady_clock::now();
+
+    for (int p = 0; p < op.partidas; ++p) {
+        const std::uint32_t semilla = op.semilla + std::uint32_t(p) * 0x9E3779B9u;
+        Lado izquierda, derecha;
+        derecha.bando = MundoSimulacion::Derecha;
+
+        bool conectado = false;
+        std::thread seUne([&] {
+            const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+            if (fd < 0) return;
+            if (::connect(fd, reinterpret_cast<sockaddr *>(&direccion), sizeof direccion) != 0) {
+                ::close(fd);
+                return;
+            }
+            conectado = true;
+            Conexion conexion(fd);
+            jugar(conexion, nivel, 0, op, derecha);
+        });
+        const int fd = ::accept(servidor, nullptr, nullptr);
+        if (fd >= 0) {
+            Conexion conexion(fd);
+            jugar(conexion, nivel, semilla, op, izquierda);
+        }
+        seUne.join();
+        if (fd < 0 || !conectado) {
+            std::perror("redlocal: no se pudo conectar por 127.0.0.1");
+            ::close(servidor);
+            return 2;
+        }
+
+        // Quien recibe decide: la derecha rechaza el saludo o el disparo;
+        // sin rechazo los dos lados tienen que terminar igual.
+        const bool bien = derecha.fin == esperado &&
+            (esperado != Terminada || (izquierda.fin == Terminada &&
+                                       izquierda.ganador == derecha.ganador &&
+                                       izquierda.turnos == derecha.turnos));
+        comoSeEspera += bien ? 1 : 0;
+        turnos += derecha.turnos;
+        bytes += izquierda.bytes + derecha.bytes;
+        if (op.detallado || !bien)
+            std::printf("%s partida %d (semilla %u): izquierda %s, derecha %s, %d turnos, gana %s\n",
+                        bien ? "OK      " : "DISTINTA", p, semilla,
+                        kNombresFin[izquierda.fin], kNombresFin[derecha.fin], derecha.turnos,
+                        derecha.ganador == 0 ? "izquierda" : derecha.ganador == 1 ? "derecha" : "nadie");
+    }
+    ::close(servidor);
+
+    const double segundos = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - inicio).count();
+    std::printf("%d/%d partidas como se espera (%s), %d turnos, %.1f bytes por turno, %.2f s\n",
+                comoSeEspera, op.partidas, kNombresFin[esperado], turnos,
+                turnos > 0 ? double(bytes) / turnos : 0.0, segundos);
+    return comoSeEspera == op.partidas ? 0 : 1;
+}
@@ -0,0 +1,15 @@
+# Partida en red por localhost (sin Qt, sin ventana, sockets POSIX).
+# Dos hilos juegan por TCP en 127.0.0.1 con MensajeRed como PartidaRed y
+# comparan la huella del estado (hashEstado) al final de cada turno:
+#   redlocal --partidas 50 --nivel ../../niveles/colinas.p5n
+#   redlocal --separar     (el saludo con otra fisica se rechaza)
+#   redlocal --invalido    (un disparo con un modo que no existe se rechaza)
+
+TEMPLATE = app
+CONFIG  += c++17 console
+CONFIG  -= qt app_bundle
+TARGET   = redlocal
+
+SOURCES += redlocal.cpp
+
+include(../../simulacion/simulacion.pri)
@@ -0,0 +1,626 @@
+// Banco de pruebas de rendimiento del juego (ver rendimiento.pro).
+//
+// Cada prueba repite una operacion real del juego, calibra cuantas
+// repeticiones caben en ~20 ms y toma varias muestras; se informa la
+// mediana en nanosegundos por operacion. La salida es JSON:
+//   { "contexto": {...}, "resultados": [ { "nombre": ..., "ns_por_op": ... } ] }
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QDateTime>
+#include <QFile>
+#include <QGraphicsScene>
+#include <QImage>
+#include <QPainter>
+#include <QSysInfo>
+#include <QTemporaryDir>
+#include <QThread>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "mundosimulacion.h"
+#include "almacenproyectiles.h"
+#include "fijo.h"
+#include "capaestructura.h"
+#include "capaparticulas.h"
+#include "escenajuego.h"
+#include "nivel.h"
+#include "escombros.h"
+#include "grafoapoyos.h"
+#include "rejillabloques.h"
+#include "terreno.h"
+
+namespace {
+
+using Reloj = std::chrono::steady_clock;
+
+// Para que el compilador no elimine el trabajo medido.
+volatile double g_sumidero = 0.0;
+
+// Tiempo medido dentro de una prueba; la preparacion de cada repeticion
+// se puede dejar fuera con pausar()/reanudar().
+class Cronometro
+{
+public:
+    void reanudar() { m_inicio = Reloj::now(); }
+    void pausar()   { m_acumulado += Reloj::now() - m_inicio; }
+    double ns() const { return std::chrono::duration<double, std::nano>(m_acumulado).count(); }
+
+private:
+    Reloj::time_point m_inicio;
+    Reloj::duration   m_acumulado{0};
+};
+
+// Hace una tanda de trabajo y devuelve cuantas operaciones fueron.
+using Cuerpo = std::function<qint64(Cronometro &)>;
+
+struct Medicion {
+    QString nombre;
+    double  nsMediana{0.0};
+    double  nsMin{0.0};
+    double  nsMax{0.0};
+    qint64  operaciones{0};
+    int     muestras{0};
+};
+
+// Generador fijo para que todas las versiones midan los mismos datos.
+class Aleatorio
+{
+public:
+    double entre(double a, double b)
+    {
+        m_estado ^= m_estado << 13;
+        m_estado ^= m_estado >> 17;
+        m_estado ^= m_estado << 5;
+        return a + (b - a) * (m_estado / 4294967296.0);
+    }
+
+private:
+    quint32 m_estado{0x12345678u};
+};
+
+Medicion medir(const QString &nombre, const Cuerpo &cuerpo, int muestras)
+{
+    auto tanda = [&](int repeticiones, double &ns) {
+        Cronometro c;
+        qint64 ops = 0;
+        for (int i = 0; i < repeticiones; ++i) {
+            c.reanudar();
+            ops += cuerpo(c);
+            c.pausar();
+        }
+        ns = c.ns();
+        return ops;
+    };
+
+    // Calentamiento y calibracion: al menos ~20 ms por muestra.
+    int repeticiones = 1;
+    for (;;) {
+        double ns = 0.0;
+        tanda(repeticiones, ns);
+        if (ns >= 2e7 || repeticiones >= (1 << 24)) break;
+        repeticiones *= 2;
+    }
+
+    Medicion m;
+    m.nombre = nombre;
+    m.muestras = muestras;
+    std::vector<double> nsPorOp;
+    for (int s = 0; s < muestras; ++s) {
+        double ns = 0.0;
+        const qint64 ops = tanda(repeticiones, ns);
+        m.operaciones += ops;
+        nsPorOp.push_back(ops > 0 ? ns / ops : 0.0);
+    }
+    std::sort(nsPorOp.begin(), nsPorOp.end());
+    m.nsMediana = nsPorOp[nsPorOp.size() / 2];
+    m.nsMin = nsPorOp.front();
+    m.nsMax = nsPorOp.back();
+    return m;
+}
+
+// Nivel base (6 bloques) y, si hacen falta mas, una malla de bloques
+// chicos entre las dos estructuras, repartidos entre ambos lados.
+MundoSimulacion crearMundo(int bloques)
+{
+    MundoSimulacion mundo;
+    mundo.construirNivelBase(66, 100, 70, 70);
+
+    const int extra = bloques - mundo.numBloques();
+    if (extra > 0) {
+        const double x0 = 400, y0 = 100, ancho = 400, alto = 460;
+        const int columnas = int(std::ceil(std::sqrt(extra * ancho / alto)));
+        const int filas = (extra + columnas - 1) / columnas;
+        const double celdaX = ancho / columnas, celdaY = alto / filas;
+        for (int k = 0; k < extra; ++k) {
+            const int c = k % columnas, f = k / columnas;
+            RectMundo r(x0 + c*celdaX + 0.5, y0 + f*celdaY + 0.5,
+                        celdaX - 1.0, celdaY - 1.0);
+            mundo.agregarBloque(r, 100, c < columnas/2 ? MundoSimulacion::Izquierda
+                                                       : MundoSimulacion::Derecha);
+        }
+    }
+    return mundo;
+}
+
+// Torres de 20 pisos (dos columnas y un techo por piso) una al lado de
+// la otra hasta llegar a unos 'bloques'. El mundo se ensancha lo justo.
+MundoSimulacion crearTorres(int bloques)
+{
+    const int pisos = 20, porTorre = 3*pisos;
+    const int torres = std::max(1, bloques / porTorre);
+    const double ancho = 40.0, altoPiso = 25.0, grosor = 5.0;
+
+    MundoSimulacion mundo;
+    mundo.fijarTamano(std::max(1200.0, 200.0 + torres*ancho), 600);
+    const double suelo = mundo.alto() - mundo.altoSuelo();
+    for (int t = 0; t < torres; ++t) {
+        const double x = 100.0 + t*ancho;
+        for (int p = 0; p < pisos; ++p) {
+            const double base = suelo - p*altoPiso;
+            const double alto = altoPiso - grosor;
+            mundo.agregarBloque(RectMundo(x, base - alto, grosor, alto), 100, MundoSimulacion::Izquierda);
+            mundo.agregarBloque(RectMundo(x + ancho - 10 - grosor, base - alto, grosor, alto), 100,
+                                MundoSimulacion::Izquierda);
+            mundo.agregarBloque(RectMundo(x, base - altoPiso, ancho - 10, grosor), 100,
+                                MundoSimulacion::Izquierda);
+        }
+    }
+    return mundo;
+}
+
+// --- pruebas ---
+
+// Un paso por lotes de AlmacenProyectilesT: integrar + paredes, con el
+// escalar T (double, float o Fijo).
+template <typename T>
+Cuerpo pruebaIntegrarParedes(int n)
+{
+    auto p = std::make_shared<AlmacenProyectilesT<T>>();
+    Aleatorio azar;
+    p->reservar(n);
+    for (int i = 0; i < n; ++i)
+        p->agregar({azar.entre(10, 1190), azar.entre(10, 570)},
+                   {azar.entre(-150, 150), azar.entre(-150, 150)}, 4.0, 1.0);
+
+    return [p](Cronometro &) -> qint64 {
+        p->integrar(0.016, 200.0);
+        g_sumidero = g_sumidero + p->resolverChoquesParedes(1200.0, 580.0);
+        return 1;
+    };
+}
+
+Cuerpo pruebaCirculoRect()
+{
+    constexpr int kCasos = 1024;
+    struct Caso { Vector2D c; double r; RectMundo rect; };
+    auto casos = std::make_shared<std::vector<Caso>>();
+    Aleatorio azar;
+    for (int i = 0; i < kCasos; ++i)
+        casos->push_back({{azar.entre(0, 200), azar.entre(0, 200)}, azar.entre(2, 10),
+                          RectMundo(azar.entre(0, 150), azar.entre(0, 150),
+                                    azar.entre(5, 60), azar.entre(5, 60))});
+
+    return [casos](Cronometro &) -> qint64 {
+        int choques = 0;
+        for (const Caso &k : *casos)
+            choques += circuloIntersecaRect(k.c, k.r, k.rect);
+        g_sumidero = g_sumidero + choques;
+        return kCasos;
+    };
+}
+
+// Un disparo completo desde el nivel restaurado; se informa por paso.
+// Los choques contra bloques (fase amplia + barrido) van dentro de paso().
+Cuerpo pruebaPasoMundo(int bloques, MundoSimulacion::ModoDisparo modo)
+{
+    auto mundo = std::make_shared<MundoSimulacion>(crearMundo(bloques));
+
+    return [mundo, modo](Cronometro &c) -> qint64 {
+        c.pausar();
+        mundo->restaurarNivel();
+        mundo->disparar(45.0, 150.0, modo);
+        c.reanudar();
+
+        qint64 pasos = 0;
+        while (mundo->hayMovimiento() && pasos < 2000) {
+            mundo->paso(0.016);
+            ++pasos;
+        }
+        return pasos;
+    };
+}
+
+// El mismo disparo resuelto por eventos; se informa por disparo.
+Cuerpo pruebaSaltoMundo(int bloques, MundoSimulacion::ModoDisparo modo)
+{
+    auto mundo = std::make_shared<MundoSimulacion>(crearMundo(bloques));
+
+    return [mundo, modo](Cronometro &c) -> qint64 {
+        c.pausar();
+        mundo->restaurarNivel();
+        mundo->disparar(45.0, 150.0, modo);
+        c.reanudar();
+
+        mundo->resolverAlInstante();
+        return 1;
+    };
+}
+
+// Un disparo sobre terreno destructible con una colina en el centro (el
+// nivel base con la colina de colinas.txt); los proyectiles abren
+// crateres. Se informa por paso.
+Cuerpo pruebaPasoTerreno(MundoSimulacion::ModoDisparo modo)
+{
+    auto mundo = std::make_shared<MundoSimulacion>(crearMundo(6));
+    mundo->activarTerreno(true);
+    mundo->agregarColina({600.0, 360.0, 130.0});
+
+    return [mundo, modo](Cronometro &c) -> qint64 {
+        c.pausar();
+        mundo->restaurarNivel();
+        mundo->disparar(45.0, 150.0, modo);
+        c.reanudar();
+
+        qint64 pasos = 0;
+        while (mundo->hayMovimiento() && pasos < 2000) {
+            mundo->paso(0.016);
+            ++pasos;
+        }
+        return pasos;
+    };
+}
+
+// Crateres de radio 'radio' en un terreno de ancho x 600 lleno desde la
+// mitad para abajo, en puntos al azar de la superficie. Copiar el terreno
+// intacto queda fuera de la medicion. Se informa por crater.
+Cuerpo pruebaCrater(int ancho, double radio)
+{
+    struct Estado {
+        Terreno inicial, trabajo;
+        std::vector<Vector2D> puntos;
+    };
+    auto e = std::make_shared<Estado>();
+    e->inicial.crear(ancho, 600);
+    e->inicial.rellenarBajo(std::vector<int>(std::size_t(ancho), 300));
+    Aleatorio azar;
+    for (int k = 0; k < 64; ++k)
+        e->puntos.push_back({azar.entre(0.0, ancho), azar.entre(300.0, 600.0)});
+
+    return [e, radio](Cronometro &c) -> qint64 {
+        c.pausar();
+        e->trabajo = e->inicial;
+        c.reanudar();
+
+        for (const Vector2D &p : e->puntos)
+            e->trabajo.excavar(p, radio);
+        g_sumidero = g_sumidero + e->trabajo.cambios().x1;
+        return qint64(e->puntos.size());
+    };
+}
+
+// Grafo de apoyos: armarlo entero (lo que costaria revisar toda la
+// estructura tras cada golpe) frente a quitar un bloque y revisar solo lo
+// que tenia encima. 'piso' es el piso de la columna que se quita.
+Cuerpo pruebaApoyos(int bloques, int piso, bool completo)
+{
+    struct Estado {
+        MundoSimulacion mundo;
+        RejillaBloques rejilla;
+        GrafoApoyos grafo;
+        std::vector<RectMundo> rects;
+        std::vector<std::uint8_t> destruido;
+        std::vector<int> caen;
+    };
+    auto e = std::make_shared<Estado>();
+    e->mundo = crearTorres(bloques);
+    for (int i = 0; i < e->mundo.numBloques(); ++i)
+        e->rects.push_back(e->mundo.rectBloque(i));
+    e->destruido.assign(e->rects.size(), 0);
+    e->rejilla.construir(e->rects, e->destruido, e->mundo.ancho(), e->mundo.alto());
+    const double suelo = e->mundo.alto() - e->mundo.altoSuelo();
+
+    // Columna izquierda de la torre del medio.
+    const int torres = int(e->rects.size()) / 60;
+    const int bloque = (torres / 2) * 60 + 3*piso;
+
+    return [e, suelo, bloque, completo](Cronometro &c) -> qint64 {
+        if (!completo) c.pausar();
+        e->grafo.construir(e->rects, e->destruido, nullptr, 0, suelo,
+                           e->mundo.ancho(), e->rejilla);
+        if (completo) return 1;
+
+        c.reanudar();
+        e->caen.clear();
+        e->grafo.quitar(bloque, e->rects, e->caen);
+        g_sumidero = g_sumidero + double(e->caen.size());
+        return 1;
+    };
+}
+
+// Escombros apilados en columnas sobre el suelo de un mundo de 1200 x 600
+// (mas chicos cuantos mas haya, para que quepan).
+// Con 'dormidos' se dejan asentar (todas las islas duermen) y solo cae un
+// pedazo suelto lejos de las pilas: mide lo que cuestan las islas
+// dormidas. Sin 'dormidos' se mide con las pilas aun en movimiento.
+// Se informa por paso.
+Cuerpo pruebaEscombros(int cuerpos, bool dormidos)
+{
+    struct Estado {
+        std::vector<RectMundo> bloques;
+        std::vector<std::uint8_t> destruido;
+        RejillaBloques rejilla;
+        Escombros::Entorno entorno;
+        Escombros inicial, trabajo;
+    };
+    auto e = std::make_shared<Estado>();
+    e->rejilla.construir(e->bloques, e->destruido, 1200.0, 600.0);
+    e->entorno.ancho = 1200.0;
+    e->entorno.suelo = 580.0;
+    e->entorno.bloques = &e->bloques;
+    e->entorno.rejilla = &e->rejilla;
+
+    Aleatorio azar;
+    const double lado = std::min(29.0, 0.7 * std::sqrt(1100.0 * 450.0 / cuerpos));
+    const int columnas = int(1100.0 / (lado + 8.0));
+    e->inicial.fijarLimites(1200.0, 600.0);
+    for (int k = 0; k < cuerpos; ++k) {
+        const int c = k % columnas, f = k / columnas;
+        e->inicial.agregar({60.0 + c*(lado + 8.0) + azar.entre(-2, 2),
+                            580.0 - lado/2.0 - f*(lado + 2.0)},
+                           lado/2.0, lado/2.0, {azar.entre(-20, 20), 0.0},
+                           azar.entre(-0.5, 0.5), MundoSimulacion::kDensidadBloque);
+    }
+    for (int n = 0; n < 3000 && e->inicial.hayDespiertos(); ++n) {
+        e->inicial.paso(0.016, 200.0, e->entorno);
+        if (!dormidos && n == 30) break;
+    }
+    if (dormidos)
+        e->inicial.agregar({1180.0, 40.0}, 8.0, 8.0, {0.0, 0.0}, 0.0,
+                           MundoSimulacion::kDensidadBloque);
+
+    return [e](Cronometro &c) -> qint64 {
+        c.pausar();
+        e->trabajo = e->inicial;
+        c.reanudar();
+
+        const int kPasos = 10;
+        for (int n = 0; n < kPasos; ++n)
+            e->trabajo.paso(0.016, 200.0, e->entorno);
+        g_sumidero = g_sumidero + e->trabajo.y[0];
+        return kPasos;
+    };
+}
+
+// Abrir un nivel guardado y pasarlo al mundo (binario mapeado o texto).
+Cuerpo pruebaCargarNivel(const QTemporaryDir *carpeta, int bloques, bool binario)
+{
+    const MundoSimulacion origen = crearMundo(bloques);
+    const QString ruta = carpeta->filePath(QStringLiteral("nivel_%1.%2")
+                                           .arg(bloques).arg(binario ? "p5n" : "txt"));
+    QFile archivo(ruta);
+    if (archivo.open(QIODevice::WriteOnly)) {
+        if (binario) {
+            const std::vector<std::uint8_t> datos = Nivel::serializar(origen);
+            archivo.write(reinterpret_cast<const char *>(datos.data()), qint64(datos.size()));
+        } else {
+            archivo.write(QByteArray::fromStdString(Nivel::aTexto(origen)));
+        }
+    }
+    archivo.close();
+
+    auto mundo = std::make_shared<MundoSimulacion>();
+    const std::string rutaNivel = ruta.toStdString();
+    return [mundo, rutaNivel](Cronometro &) -> qint64 {
+        Nivel nivel;
+        if (nivel.abrir(rutaNivel))
+            nivel.aplicar(*mundo);
+        g_sumidero = g_sumidero + mundo->numBloques();
+        return 1;
+    };
+}
+
+// Resistencia nueva en la capa de estructura (color + numero de vida).
+Cuerpo pruebaFijarResistencia(QGraphicsScene *escena)
+{
+    const MundoSimulacion mundo = crearMundo(6);
+    auto *capa = new CapaEstructura;
+    for (int i = 0; i < mundo.numBloques(); ++i) {
+        const RectMundo &r = mundo.rectBloque(i);
+        capa->agregarBloque(QRectF(r.x, r.y, r.ancho, r.alto), mundo.resistenciaBloque(i));
+    }
+    escena->addItem(capa);
+
+    return [capa, mundo](Cronometro &c) -> qint64 {
+        for (int i = 0; i < capa->numBloques(); ++i) {
+            const double queda = capa->resistencia(i) - 1.0;
+            capa->fijarResistencia(i, queda, queda <= 0.0);
+            if (capa->destruido(i)) {
+                c.pausar();
+                const RectMundo &r = mundo.rectBloque(i);
+                capa->restaurar(i, QRectF(r.x, r.y, r.ancho, r.alto),
+                                mundo.resistenciaBloque(i));
+                c.reanudar();
+            }
+        }
+        return capa->numBloques();
+    };
+}
+
+// Un frame de particulas con unas 'n' vivas: avanzar y, con 'pintar',
+// dibujar la capa sobre una imagen del tamaño del mundo. Cuando se apaga
+// la mitad se vuelve a llenar el anillo fuera de la medicion.
+Cuerpo pruebaParticulas(int n, bool pintar)
+{
+    auto p = std::make_shared<Particulas>(n);
+    auto llenar = [p, n] {
+        Aleatorio azar;
+        for (int k = 0; k < n / 16; ++k)
+            p->emitir(Particulas::Tipo(k % Particulas::NumTipos),
+                      {azar.entre(100, 1100), azar.entre(100, 500)}, 16, 150.0);
+    };
+    llenar();
+    auto capa = std::make_shared<CapaParticulas>(*p, QRectF(0, 0, 1200, 600));
+    auto imagen = std::make_shared<QImage>(1200, 600, QImage::Format_ARGB32_Premultiplied);
+
+    return [p, llenar, capa, imagen, pintar](Cronometro &c) -> qint64 {
+        if (p->vivas() < p->capacidad() / 2) {
+            c.pausar();
+            llenar();
+            c.reanudar();
+        }
+        p->avanzar(0.016);
+        if (pintar) {
+            QPainter painter(imagen.get());
+            capa->paint(&painter, nullptr, nullptr);
+        }
+        return 1;
+    };
+}
+
+// Crear la escena completa (configurarMundo, sonidos y musica incluidos).
+Cuerpo pruebaConstruirEscena()
+{
+    return [](Cronometro &) -> qint64 {
+        auto *escena = new EscenaJuego;
+        delete escena;
+        return 1;
+    };
+}
+
+Cuerpo pruebaReiniciarJuego(EscenaJuego *escena)
+{
+    return [escena](Cronometro &) -> qint64 {
+        escena->reiniciarJuego();
+        return 1;
+    };
+}
+
+QJsonObject aJson(const Medicion &m)
+{
+    QJsonObject o;
+    o["nombre"]      = m.nombre;
+    o["ns_por_op"]   = m.nsMediana;
+    o["ns_min"]      = m.nsMin;
+    o["ns_max"]      = m.nsMax;
+    o["operaciones"] = m.operaciones;
+    o["muestras"]    = m.muestras;
+    return o;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    // Sin pantalla por defecto (integracion continua, kioscos).
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption opcionSalida("salida", "Archivo JSON de resultados (por defecto, stdout).", "archivo");
+    QCommandLineOption opcionFiltro("filtro", "Solo las pruebas cuyo nombre contiene el texto.", "texto");
+    QCommandLineOption opcionMuestras("muestras", "Muestras por prueba.", "n", "9");
+    parser.addOption(opcionSalida);
+    parser.addOption(opcionFiltro);
+    parser.addOption(opcionMuestras);
+    parser.process(app);
+
+    const QString filtro = parser.value(opcionFiltro);
+    const int muestras = std::max(1, parser.value(opcionMuestras).toInt());
+
+    QGraphicsScene escenaDanio;
+    QTemporaryDir carpetaNiveles;
+    EscenaJuego escenaReinicio;
+
+    struct Prueba { QString nombre; std::function<Cuerpo()> crear; };
+    const std::vector<Prueba> pruebas = {
+        {"almacen/integrar_paredes/proyectiles=1000",  [] { return pruebaIntegrarParedes<double>(1000); }},
+        {"almacen/integrar_paredes/proyectiles=20000", [] { return pruebaIntegrarParedes<double>(20000); }},
+        {"almacen/integrar_paredes_float/proyectiles=20000", [] { return pruebaIntegrarParedes<float>(20000); }},
+        {"almacen/integrar_paredes_fijo/proyectiles=20000",  [] { return pruebaIntegrarParedes<Fijo>(20000); }},
+        {"colision/circuloIntersecaRect",              [] { return pruebaCirculoRect(); }},
+        {"mundo/paso_simple/bloques=6",       [] { return pruebaPasoMundo(6,     MundoSimulacion::DisparoSimple); }},
+        {"mundo/paso_simple/bloques=100",     [] { return pruebaPasoMundo(100,   MundoSimulacion::DisparoSimple); }},
+        {"mundo/paso_simple/bloques=10000",   [] { return pruebaPasoMundo(10000, MundoSimulacion::DisparoSimple); }},
+        {"mundo/paso_metralla/bloques=6",     [] { return pruebaPasoMundo(6,     MundoSimulacion::DisparoMetralla); }},
+        {"mundo/paso_metralla/bloques=100",   [] { return pruebaPasoMundo(100,   MundoSimulacion::DisparoMetralla); }},
+        {"mundo/paso_metralla/bloques=10000", [] { return pruebaPasoMundo(10000, MundoSimulacion::DisparoMetralla); }},
+        {"mundo/salto_simple/bloques=6",      [] { return pruebaSaltoMundo(6,     MundoSimulacion::DisparoSimple); }},
+        {"mundo/salto_simple/bloques=10000",  [] { return pruebaSaltoMundo(10000, MundoSimulacion::DisparoSimple); }},
+        {"mundo/salto_metralla/bloques=6",    [] { return pruebaSaltoMundo(6,     MundoSimulacion::DisparoMetralla); }},
+        {"mundo/salto_metralla/bloques=10000",[] { return pruebaSaltoMundo(10000, MundoSimulacion::DisparoMetralla); }},
+        {"terreno/paso_simple",               [] { return pruebaPasoTerreno(MundoSimulacion::DisparoSimple); }},
+        {"terreno/paso_metralla",             [] { return pruebaPasoTerreno(MundoSimulacion::DisparoMetralla); }},
+        {"terreno/crater/ancho=1200/radio=10",[] { return pruebaCrater(1200, 10.0); }},
+        {"terreno/crater/ancho=1200/radio=40",[] { return pruebaCrater(1200, 40.0); }},
+        {"terreno/crater/ancho=4800/radio=40",[] { return pruebaCrater(4800, 40.0); }},
+        {"apoyos/construir/bloques=600",      [] { return pruebaApoyos(600,   0, true); }},
+        {"apoyos/construir/bloques=12000",    [] { return pruebaApoyos(12000, 0, true); }},
+        {"apoyos/quitar_piso19/bloques=600",  [] { return pruebaApoyos(600,   19, false); }},
+        {"apoyos/quitar_piso19/bloques=12000",[] { return pruebaApoyos(12000, 19, false); }},
+        {"apoyos/quitar_piso0/bloques=600",   [] { return pruebaApoyos(600,   0, false); }},
+        {"apoyos/quitar_piso0/bloques=12000", [] { return pruebaApoyos(12000, 0, false); }},
+        {"escombros/paso_despiertos/cuerpos=300",  [] { return pruebaEscombros(300,  false); }},
+        {"escombros/paso_despiertos/cuerpos=1000", [] { return pruebaEscombros(1000, false); }},
+        {"escombros/paso_dormidos/cuerpos=1000",   [] { return pruebaEscombros(1000, true); }},
+        {"escombros/paso_dormidos/cuerpos=2000",   [] { return pruebaEscombros(2000, true); }},
+        {"nivel/cargar_binario/bloques=6",      [&] { return pruebaCargarNivel(&carpetaNiveles, 6,      true); }},
+        {"nivel/cargar_binario/bloques=100000", [&] { return pruebaCargarNivel(&carpetaNiveles, 100000, true); }},
+        {"nivel/cargar_texto/bloques=6",        [&] { return pruebaCargarNivel(&carpetaNiveles, 6,      false); }},
+        {"nivel/cargar_texto/bloques=100000",   [&] { return pruebaCargarNivel(&carpetaNiveles, 100000, false); }},
+        {"capa/fijarResistencia",             [&] { return pruebaFijarResistencia(&escenaDanio); }},
+        {"particulas/avanzar/particulas=32768",       [] { return pruebaParticulas(32768, false); }},
+        {"particulas/avanzar_pintar/particulas=32768",[] { return pruebaParticulas(32768, true); }},
+        {"escena/construir",                  [] { return pruebaConstruirEscena(); }},
+        {"escena/reiniciarJuego",             [&] { return pruebaReiniciarJuego(&escenaReinicio); }},
+    };
+
+    QJsonArray resultados;
+    for (const Prueba &p : pruebas) {
+        if (!filtro.isEmpty() && !p.nombre.contains(filtro)) continue;
+
+        std::fprintf(stderr, "%-40s ", qPrintable(p.nombre));
+        Medicion m = medir(p.nombre, p.crear(), muestras);
+        std::fprintf(stderr, "%12.1f ns/op\n", m.nsMediana);
+        resultados.append(aJson(m));
+    }
+
+    QJsonObject contexto;
+    contexto["fecha"]      = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    contexto["qt"]         = QString::fromLatin1(qVersion());
+    contexto["cpu"]        = QSysInfo::currentCpuArchitecture();
+    contexto["so"]         = QSysInfo::prettyProductName();
+    contexto["hilos"]      = QThread::idealThreadCount();
+#ifdef QT_DEBUG
+    contexto["compilacion"] = "debug";
+#else
+    contexto["compilacion"] = "release";
+#endif
+
+    QJsonObject raiz;
+    raiz["contexto"]   = contexto;
+    raiz["resultados"] = resultados;
+    const QByteArray json = QJsonDocument(raiz).toJson();
+
+    if (parser.isSet(opcionSalida)) {
+        QFile archivo(parser.value(opcionSalida));
+        if (!archivo.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            std::fprintf(stderr, "No se pudo escribir %s\n", qPrintable(archivo.fileName()));
+            return 1;
+        }
+        archivo.write(json);
+    } else {
+        std::fwrite(json.constData(), 1, size_t(json.size()), stdout);
+    }
+    return 0;
+}
@@ -0,0 +1,35 @@
+# Banco de pruebas de rendimiento (sin ventana).
+# Mide la fisica, los choques, el daño, las particulas y la reconstruccion de la escena
+# que usa el juego y escribe los resultados en JSON para comparar versiones:
+#   rendimiento --salida resultados.json [--filtro mundo/] [--muestras 9]
+# Compilar en release: los numeros de una compilacion debug no sirven.
+
+QT      += core gui widgets multimedia concurrent
+CONFIG  += c++17 console
+CONFIG  -= app_bundle
+TARGET   = rendimiento
+
+RAIZ = $$PWD/../..
+INCLUDEPATH += $$RAIZ
+
+SOURCES += \
+    rendimiento.cpp \
+    $$RAIZ/capaestructura.cpp \
+    $$RAIZ/capaterreno.cpp \
+    $$RAIZ/escenajuego.cpp \
+    $$RAIZ/motorefectos.cpp
+
+HEADERS += \
+    $$RAIZ/cachesprites.h \
+    $$RAIZ/capaescombros.h \
+    $$RAIZ/capaestructura.h \
+    $$RAIZ/capaparticulas.h \
+    $$RAIZ/capaproyectiles.h \
+    $$RAIZ/capaterreno.h \
+    $$RAIZ/escenajuego.h \
+    $$RAIZ/motorefectos.h
+
+include($$RAIZ/simulacion/simulacion.pri)
+
+RESOURCES += \
+    $$RAIZ/rec.qrc
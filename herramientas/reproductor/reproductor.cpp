@@ -0,0 +1,81 @@
+// Reproductor de partidas grabadas (ver RegistroPartida).
+//
+// Uso: reproductor [-v] archivo.p5r [archivo.p5r ...]
+// Sale con 0 si todas las partidas se reproducen igual que al grabarlas,
+// con 1 si alguna diverge y con 2 si algun archivo no se pudo leer.
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "registropartida.h"
+
+namespace {
+
+const char *nombreGanador(std::uint8_t g)
+{
+    return g == 0 ? "izquierda" : g == 1 ? "derecha" : "ninguno";
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    bool detallado = false;
+    std::vector<std::string> archivos;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "-v") == 0) detallado = true;
+        else archivos.push_back(argv[i]);
+    }
+    if (archivos.empty()) {
+        std::fprintf(stderr, "uso: %s [-v] archivo.p5r [archivo.p5r ...]\n", argv[0]);
+        return 2;
+    }
+
+    int iguales = 0, distintas = 0, ilegibles = 0;
+    long long disparos = 0, pasos = 0;
+    const auto inicio = std::chrono::steady_clock::now();
+
+    for (const std::string &ruta : archivos) {
+        RegistroPartida registro;
+        if (!registro.cargar(ruta)) {
+            std::fprintf(stderr, "ILEGIBLE %s\n", ruta.c_str());
+            ++ilegibles;
+            continue;
+        }
+
+        const RegistroPartida::Verificacion v = registro.reproducir();
+        disparos += v.disparosSimulados;
+        pasos += v.pasosSimulados;
+
+        if (v.coincide) {
+            ++iguales;
+            if (detallado)
+                std::printf("OK       %s (%d disparos, gana %s)\n", ruta.c_str(),
+                            v.disparosSimulados, nombreGanador(v.ganador));
+        } else {
+            ++distintas;
+            std::printf("DISTINTA %s: ", ruta.c_str());
+            if (v.disparoFueraDeTurno >= 0)
+                std::printf("el disparo %d no corresponde al turno o la partida ya termino",
+                            v.disparoFueraDeTurno);
+            else if (v.disparoSinTerminar >= 0)
+                std::printf("el disparo %d no termina", v.disparoSinTerminar);
+            else if (v.primerBloqueDistinto >= 0)
+                std::printf("la vida del bloque %d no coincide", v.primerBloqueDistinto);
+            else
+                std::printf("gana %s", nombreGanador(v.ganador));
+            std::printf("\n");
+        }
+    }
+
+    const double segundos = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - inicio).count();
+    std::printf("%d iguales, %d distintas, %d ilegibles; %lld disparos, "
+                "%lld pasos en %.3f s\n",
+                iguales, distintas, ilegibles, disparos, pasos, segundos);
+
+    if (ilegibles > 0) return 2;
+    return distintas > 0 ? 1 : 0;
+}
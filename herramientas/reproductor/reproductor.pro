@@ -0,0 +1,13 @@
+# Reproductor de partidas grabadas (sin Qt, sin ventana).
+# Vuelve a simular cada registro .p5r tan rapido como da la CPU y
+# comprueba que el daño de los bloques y el ganador coinciden:
+#   reproductor partidas/*.p5r
+
+TEMPLATE = app
+CONFIG  += c++17 console
+CONFIG  -= qt app_bundle
+TARGET   = reproductor
+
+SOURCES += reproductor.cpp
+
+include(../../simulacion/simulacion.pri)
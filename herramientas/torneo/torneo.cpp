@@ -0,0 +1,276 @@
+// Torneo de partidas CPU contra CPU (ver torneo.pro y Torneo).
+//
+// Uso: torneo [--partidas N] [--hilos H] [--nivel archivo]
+//             [--columna R[,R...]] [--techo R[,R...]] [--factor-danio F[,F...]]
+//             [--modo simple|salva|racimo|metralla] [--max-turnos T]
+//             [--error-angulo grados] [--error-velocidad px/s]
+//             [--semilla S] [--alternar] [--csv archivo] [--json archivo]
+// Con varias resistencias o factores separados por comas juega todas las
+// combinaciones, cada una con las mismas N semillas. --columna y --techo
+// cambian las resistencias del nivel base (200 y 150); con --nivel valen
+// las del archivo. --alternar hace que abra la derecha en las partidas
+// impares (por defecto abre siempre la izquierda, como en el juego).
+// Sale con 0 si todo fue bien, con 1 si no se pudo leer el nivel o
+// escribir un resultado y con 2 si el uso es incorrecto.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "nivel.h"
+#include "torneo.h"
+
+namespace {
+
+struct Configuracion {
+    double columna{200.0};
+    double techo{150.0};
+    double factorDanio{0.02};
+};
+
+struct Resultado {
+    Configuracion config;
+    Torneo::Estadisticas e;
+};
+
+const char *const kModos[] = {"simple", "salva", "racimo", "metralla"};
+
+// "150,200,250" -> {150, 200, 250}. False si algo no es un numero.
+bool leerLista(const char *texto, std::vector<double> &valores)
+{
+    valores.clear();
+    const char *p = texto;
+    for (;;) {
+        char *fin;
+        const double v = std::strtod(p, &fin);
+        if (fin == p) return false;
+        valores.push_back(v);
+        if (*fin == '\0') return true;
+        if (*fin != ',') return false;
+        p = fin + 1;
+    }
+}
+
+bool escribirCsv(const std::string &ruta, const std::vector<Resultado> &resultados,
+                 bool nivelBase)
+{
+    std::FILE *f = std::fopen(ruta.c_str(), "w");
+    if (!f) return false;
+    const int bloques = int(resultados.front().e.bloqueEnPie.size());
+    std::fprintf(f, "columna,techo,factor_danio,partidas,victorias_izquierda,"
+                    "victorias_derecha,empates,tasa_izquierda,tasa_derecha,"
+                    "turnos_medios,turnos_p50,turnos_p90,supervivencia_media,"
+                    "golpes_por_partida,danio_medio_golpe");
+    for (int b = 0; b < bloques; ++b)
+        std::fprintf(f, ",en_pie_b%d", b);
+    std::fprintf(f, ",segundos,partidas_por_minuto\n");
+
+    for (const Resultado &r : resultados) {
+        const Torneo::Estadisticas &e = r.e;
+        if (nivelBase)
+            std::fprintf(f, "%g,%g,", r.config.columna, r.config.techo);
+        else
+            std::fprintf(f, ",,");
+        std::fprintf(f, "%g,%d,%d,%d,%d,%.4f,%.4f,%.2f,%d,%d,%.4f,%.2f,%.3f",
+                     r.config.factorDanio, e.partidas, e.victorias[0], e.victorias[1],
+                     e.empates, e.tasaVictoria(MundoSimulacion::Izquierda),
+                     e.tasaVictoria(MundoSimulacion::Derecha), e.turnosMedios(),
+                     e.percentilTurnos(0.5), e.percentilTurnos(0.9),
+                     e.supervivenciaMedia(), e.golpesPorPartida(), e.danioMedioGolpe());
+        for (int b = 0; b < bloques; ++b)
+            std::fprintf(f, ",%.4f", e.supervivencia(b));
+        std::fprintf(f, ",%.3f,%.0f\n", e.segundos, e.partidasPorMinuto());
+    }
+    return std::fclose(f) == 0;
+}
+
+// Texto entre comillas de JSON (las rutas de Windows llevan '\').
+std::string cadenaJson(const std::string &texto)
+{
+    std::string s = "\"";
+    for (char c : texto) {
+        if (c == '"' || c == '\\') s += '\\';
+        s += c;
+    }
+    return s + '"';
+}
+
+// Sin resistencias de columna y techo si el nivel viene de un archivo.
+bool escribirJson(const std::string &ruta, const std::vector<Resultado> &resultados,
+                  const std::string &nivel, bool nivelBase, const Torneo::Opciones &op)
+{
+    std::FILE *f = std::fopen(ruta.c_str(), "w");
+    if (!f) return false;
+    std::fprintf(f, "{\n  \"nivel\": %s, \"partidas\": %d, \"semilla\": %u, "
+                    "\"modo\": \"%s\", \"max_turnos\": %d, \"alternar\": %s,\n"
+                    "  \"error_angulo\": %g, \"error_velocidad\": %g,\n"
+                    "  \"configuraciones\": [\n",
+                 cadenaJson(nivel).c_str(), op.partidas, op.semilla, kModos[op.modo],
+                 op.maxTurnos, op.alternarInicio ? "true" : "false",
+                 op.errorAngulo, op.errorVelocidad);
+    for (std::size_t i = 0; i < resultados.size(); ++i) {
+        const Resultado &r = resultados[i];
+        const Torneo::Estadisticas &e = r.e;
+        if (nivelBase)
+            std::fprintf(f, "    {\"columna\": %g, \"techo\": %g,",
+                         r.config.columna, r.config.techo);
+        else
+            std::fprintf(f, "    {\"columna\": null, \"techo\": null,");
+        std::fprintf(f, " \"factor_danio\": %g,\n"
+                        "     \"victorias_izquierda\": %d, \"victorias_derecha\": %d, "
+                        "\"empates\": %d,\n"
+                        "     \"tasa_izquierda\": %.4f, \"tasa_derecha\": %.4f,\n"
+                        "     \"turnos_medios\": %.2f, \"turnos_p50\": %d, \"turnos_p90\": %d,\n"
+                        "     \"supervivencia_media\": %.4f,\n"
+                        "     \"golpes_por_partida\": %.2f, \"danio_medio_golpe\": %.3f,\n"
+                        "     \"bloques\": [",
+                     r.config.factorDanio, e.victorias[0], e.victorias[1], e.empates,
+                     e.tasaVictoria(MundoSimulacion::Izquierda),
+                     e.tasaVictoria(MundoSimulacion::Derecha),
+                     e.turnosMedios(), e.percentilTurnos(0.5), e.percentilTurnos(0.9),
+                     e.supervivenciaMedia(), e.golpesPorPartida(), e.danioMedioGolpe());
+        for (std::size_t b = 0; b < e.bloqueEnPie.size(); ++b)
+            std::fprintf(f, "%s{\"en_pie\": %.4f, \"resistencia_final\": %.2f}",
+                         b ? ", " : "", e.supervivencia(int(b)),
+                         e.partidas ? e.resistenciaFinal[b] / e.partidas : 0.0);
+        std::fprintf(f, "],\n     \"segundos\": %.3f, \"partidas_por_minuto\": %.0f, "
+                        "\"robos\": %lld}%s\n",
+                     e.segundos, e.partidasPorMinuto(), e.robos,
+                     i + 1 == resultados.size() ? "" : ",");
+    }
+    std::fprintf(f, "  ]\n}\n");
+    return std::fclose(f) == 0;
+}
+
+int uso(const char *programa)
+{
+    std::fprintf(stderr,
+                 "uso: %s [--partidas N] [--hilos H] [--nivel archivo]\n"
+                 "       [--columna R[,R...]] [--techo R[,R...]] [--factor-danio F[,F...]]\n"
+                 "       [--modo simple|salva|racimo|metralla] [--max-turnos T]\n"
+                 "       [--error-angulo grados] [--error-velocidad px/s]\n"
+                 "       [--semilla S] [--alternar] [--csv archivo] [--json archivo]\n",
+                 programa);
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    Torneo::Opciones op;
+    op.partidas = 10000;
+    std::string rutaNivel, rutaCsv, rutaJson;
+    std::vector<double> columnas{200.0}, techos{150.0}, factores{0.02};
+    bool resistenciasDadas = false;
+
+    for (int i = 1; i < argc; ++i) {
+        const bool hayValor = i + 1 < argc;
+        if (std::strcmp(argv[i], "--partidas") == 0 && hayValor) {
+            op.partidas = std::atoi(argv[++i]);
+            if (op.partidas <= 0) return uso(argv[0]);
+        } else if (std::strcmp(argv[i], "--hilos") == 0 && hayValor) {
+            op.hilos = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--nivel") == 0 && hayValor) {
+            rutaNivel = argv[++i];
+        } else if (std::strcmp(argv[i], "--columna") == 0 && hayValor) {
+            if (!leerLista(argv[++i], columnas)) return uso(argv[0]);
+            resistenciasDadas = true;
+        } else if (std::strcmp(argv[i], "--techo") == 0 && hayValor) {
+            if (!leerLista(argv[++i], techos)) return uso(argv[0]);
+            resistenciasDadas = true;
+        } else if (std::strcmp(argv[i], "--factor-danio") == 0 && hayValor) {
+            if (!leerLista(argv[++i], factores)) return uso(argv[0]);
+        } else if (std::strcmp(argv[i], "--modo") == 0 && hayValor) {
+            const char *nombre = argv[++i];
+            int m = 0;
+            while (m < 4 && std::strcmp(nombre, kModos[m]) != 0) ++m;
+            if (m == 4) return uso(argv[0]);
+            op.modo = MundoSimulacion::ModoDisparo(m);
+        } else if (std::strcmp(argv[i], "--max-turnos") == 0 && hayValor) {
+            op.maxTurnos = std::atoi(argv[++i]);
+            if (op.maxTurnos <= 0) return uso(argv[0]);
+        } else if (std::strcmp(argv[i], "--error-angulo") == 0 && hayValor) {
+            op.errorAngulo = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--error-velocidad") == 0 && hayValor) {
+            op.errorVelocidad = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--semilla") == 0 && hayValor) {
+            op.semilla = std::uint32_t(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--alternar") == 0) {
+            op.alternarInicio = true;
+        } else if (std::strcmp(argv[i], "--csv") == 0 && hayValor) {
+            rutaCsv = argv[++i];
+        } else if (std::strcmp(argv[i], "--json") == 0 && hayValor) {
+            rutaJson = argv[++i];
+        } else {
+            return uso(argv[0]);
+        }
+    }
+    if (!rutaNivel.empty() && resistenciasDadas) {
+        std::fprintf(stderr, "--columna y --techo solo valen con el nivel base\n");
+        return 2;
+    }
+
+    // Con --nivel: el archivo, una sola vez (las resistencias no cambian).
+    MundoSimulacion delArchivo;
+    if (!rutaNivel.empty()) {
+        Nivel nivel;
+        if (!nivel.abrir(rutaNivel)) {
+            std::fprintf(stderr, "%s: %s\n", rutaNivel.c_str(), nivel.error().c_str());
+            return 1;
+        }
+        nivel.aplicar(delArchivo);
+        columnas.assign(1, 0.0);
+        techos.assign(1, 0.0);
+    }
+
+    std::printf("%s, %d partidas por combinacion, modo %s\n",
+                rutaNivel.empty() ? "nivel base" : rutaNivel.c_str(),
+                op.partidas, kModos[op.modo]);
+    std::printf("%8s %6s %7s %7s %7s %7s %8s %5s %5s %8s %10s\n",
+                "columna", "techo", "factor", "izq", "der", "empate",
+                "turnos", "p50", "p90", "en pie", "partidas/min");
+
+    std::vector<Resultado> resultados;
+    for (double columna : columnas) {
+        for (double techo : techos) {
+            for (double factor : factores) {
+                MundoSimulacion mundo;
+                if (rutaNivel.empty())
+                    // Mismas medidas que los sprites (herramientas/preparar_sprites.py).
+                    mundo.construirNivelBase(66, 100, 70, 70, columna, techo);
+                else
+                    mundo = delArchivo;
+                mundo.fijarFactorDanio(factor);
+
+                Resultado r{{columna, techo, factor}, Torneo::jugar(mundo, op)};
+                const Torneo::Estadisticas &e = r.e;
+                if (rutaNivel.empty())
+                    std::printf("%8g %6g ", columna, techo);
+                else
+                    std::printf("%8s %6s ", "-", "-");
+                std::printf("%7g %6.1f%% %6.1f%% %6.1f%% %8.2f %5d %5d %7.1f%% %10.0f\n",
+                            factor,
+                            100.0 * e.tasaVictoria(MundoSimulacion::Izquierda),
+                            100.0 * e.tasaVictoria(MundoSimulacion::Derecha),
+                            100.0 * e.empates / e.partidas, e.turnosMedios(),
+                            e.percentilTurnos(0.5), e.percentilTurnos(0.9),
+                            100.0 * e.supervivenciaMedia(), e.partidasPorMinuto());
+                std::fflush(stdout);
+                resultados.push_back(std::move(r));
+            }
+        }
+    }
+
+    const std::string nombreNivel = rutaNivel.empty() ? "base" : rutaNivel;
+    if (!rutaCsv.empty() && !escribirCsv(rutaCsv, resultados, rutaNivel.empty())) {
+        std::fprintf(stderr, "no se pudo escribir %s\n", rutaCsv.c_str());
+        return 1;
+    }
+    if (!rutaJson.empty() && !escribirJson(rutaJson, resultados, nombreNivel, rutaNivel.empty(), op)) {
+        std::fprintf(stderr, "no se pudo escribir %s\n", rutaJson.c_str());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,15 @@
+# Torneo de partidas CPU contra CPU (sin Qt, sin ventana).
+# Juega miles de partidas completas repartidas entre todos los nucleos y
+# resume victorias por bando, turnos hasta ganar y que bloques quedan en
+# pie, para equilibrar resistencias y factor de daño:
+#   torneo --partidas 100000 --columna 150,200,250 --techo 150 --csv equilibrio.csv
+# Compilar en release: los tiempos de una compilacion debug no sirven.
+
+TEMPLATE = app
+CONFIG  += c++17 console
+CONFIG  -= qt app_bundle
+TARGET   = torneo
+
+SOURCES += torneo.cpp
+
+include(../../simulacion/simulacion.pri)
@@ -1,10 +1,64 @@
 #include <QApplication>
+#include <QCommandLineParser>
 #include "ventanaprincipal.h"
 
 int main(int argc, char *argv[])
 {
     QApplication app(argc, argv);
+
+    // Perfilado sin depurador (p. ej. en los kioscos):
+    //   --perfil          muestra el HUD con p50/p99 por fase (tambien F3)
+    //   --traza <json>    graba desde el arranque y guarda al salir (F4)
+    // Archivo de partidas (se verifican con herramientas/reproductor):
+    //   --registros <dir> guarda cada partida terminada como .p5r
+    // Niveles propios (ver herramientas/niveles):
+    //   --nivel <archivo|carpeta>  agrega niveles al selector (un archivo
+    //                              suelto se carga al empezar)
+    // Partida en red (los dos con el mismo --nivel):
+    //   --servir <puerto>          espera al otro jugador (juega a la izquierda)
+    //   --conectar <host:puerto>   se une a una partida (juega a la derecha)
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption opcionPerfil("perfil",
+        QCoreApplication::translate("main", "Muestra los tiempos por fase del frame."));
+    QCommandLineOption opcionTraza("traza",
+        QCoreApplication::translate("main", "Guarda una traza trace_event de Chrome."),
+        QCoreApplication::translate("main", "archivo"));
+    QCommandLineOption opcionRegistros("registros",
+        QCoreApplication::translate("main", "Carpeta donde guardar las partidas jugadas."),
+        QCoreApplication::translate("main", "carpeta"));
+    QCommandLineOption opcionNivel("nivel",
+        QCoreApplication::translate("main", "Nivel (.p5n o de texto) o carpeta de niveles."),
+        QCoreApplication::translate("main", "ruta"));
+    QCommandLineOption opcionServir("servir",
+        QCoreApplication::translate("main", "Sirve una partida en red en ese puerto."),
+        QCoreApplication::translate("main", "puerto"));
+    QCommandLineOption opcionConectar("conectar",
+        QCoreApplication::translate("main", "Se une a una partida en red."),
+        QCoreApplication::translate("main", "host:puerto"));
+    parser.addOption(opcionPerfil);
+    parser.addOption(opcionTraza);
+    parser.addOption(opcionRegistros);
+    parser.addOption(opcionNivel);
+    parser.addOption(opcionServir);
+    parser.addOption(opcionConectar);
+    parser.process(app);
+
     VentanaPrincipal ventana;
+    ventana.configurarPerfil(parser.isSet(opcionPerfil), parser.value(opcionTraza));
+    ventana.fijarCarpetaRegistros(parser.value(opcionRegistros));
+    for (const QString &ruta : parser.values(opcionNivel))
+        ventana.agregarNiveles(ruta);
+    if (parser.isSet(opcionServir)) {
+        ventana.servirPartida(quint16(parser.value(opcionServir).toUInt()));
+    } else if (parser.isSet(opcionConectar)) {
+        const QString destino = parser.value(opcionConectar);
+        const int dosPuntos = destino.lastIndexOf(':');
+        if (dosPuntos <= 0)
+            parser.showHelp(2);
+        ventana.unirsePartida(destino.left(dosPuntos),
+                              quint16(destino.mid(dosPuntos + 1).toUInt()));
+    }
     ventana.show();
     return app.exec();
 }
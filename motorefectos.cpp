@@ -0,0 +1,258 @@
+#include "motorefectos.h"
+#include <QAudioSink>
+#include <QAudioDecoder>
+#include <QAudioBuffer>
+#include <QMediaDevices>
+#include <QAudioDevice>
+#include <QUrl>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+namespace {
+
+// Convierte un QAudioBuffer cualquiera a float intercalado con 'canales'.
+void agregarBuffer(const QAudioBuffer &buffer, int canales, QVector<float> &salida)
+{
+    const QAudioFormat f = buffer.format();
+    const int canalesOrigen = f.channelCount();
+    const qsizetype frames = buffer.frameCount();
+    if (canalesOrigen <= 0 || frames <= 0) return;
+
+    auto muestra = [&](qsizetype i) -> float {
+        switch (f.sampleFormat()) {
+        case QAudioFormat::UInt8: return (buffer.constData<quint8>()[i] - 128) / 128.0f;
+        case QAudioFormat::Int16: return buffer.constData<qint16>()[i] / 32768.0f;
+        case QAudioFormat::Int32: return buffer.constData<qint32>()[i] / 2147483648.0f;
+        case QAudioFormat::Float: return buffer.constData<float>()[i];
+        default:                  return 0.0f;
+        }
+    };
+
+    const qsizetype base = salida.size();
+    salida.resize(base + frames * canales);
+    float *dst = salida.data() + base;
+    for (qsizetype fr = 0; fr < frames; ++fr) {
+        for (int c = 0; c < canales; ++c) {
+            // Mono → se duplica; mas canales → se toman los primeros.
+            int co = std::min(c, canalesOrigen - 1);
+            dst[fr*canales + c] = muestra(fr*canalesOrigen + co);
+        }
+    }
+}
+
+// Remuestreo lineal (solo si el decodificador no entrego la frecuencia pedida).
+QVector<float> remuestrear(const QVector<float> &in, int canales,
+                           int frecOrigen, int frecDestino)
+{
+    if (frecOrigen == frecDestino || frecOrigen <= 0) return in;
+
+    const qsizetype framesIn = in.size() / canales;
+    const qsizetype framesOut = framesIn * frecDestino / frecOrigen;
+    QVector<float> out(framesOut * canales);
+    const double paso = double(frecOrigen) / frecDestino;
+
+    for (qsizetype fr = 0; fr < framesOut; ++fr) {
+        double pos = fr * paso;
+        qsizetype i0 = qsizetype(pos);
+        qsizetype i1 = std::min(i0 + 1, framesIn - 1);
+        float t = float(pos - i0);
+        for (int c = 0; c < canales; ++c)
+            out[fr*canales + c] = in[i0*canales + c] * (1.0f - t) + in[i1*canales + c] * t;
+    }
+    return out;
+}
+
+} // namespace
+
+// ------------------------- MotorEfectos -------------------------
+
+MotorEfectos::MotorEfectos(QObject *parent)
+    : QObject(parent)
+{
+    // Formato de salida: estereo 44.1 kHz, 16 bits si el dispositivo lo
+    // acepta; si no, el preferido del dispositivo.
+    QAudioDevice dispositivo = QMediaDevices::defaultAudioOutput();
+    m_formato.setSampleRate(44100);
+    m_formato.setChannelCount(2);
+    m_formato.setSampleFormat(QAudioFormat::Int16);
+    if (!dispositivo.isFormatSupported(m_formato))
+        m_formato = dispositivo.preferredFormat();
+
+    m_mezclador = new Mezclador(m_formato, this);
+    m_mezclador->open(QIODevice::ReadOnly);
+
+    m_salida = new QAudioSink(dispositivo, m_formato, this);
+    // Buffer corto: ~20 ms de latencia
+    m_salida->setBufferSize(m_formato.bytesForDuration(20000));
+    m_salida->start(m_mezclador);
+
+    cargar(Disparo,     "qrc:/new/sonidos/disparo_canon.mp3", 0.8f);
+    cargar(Rebote,      "qrc:/new/sonidos/rebote.mp3",        0.7f);
+    cargar(Destruccion, "qrc:/new/sonidos/destruccion.mp3",   0.8f);
+    cargar(Victoria,    "qrc:/new/sonidos/winning.mp3",       0.8f);
+}
+
+MotorEfectos::~MotorEfectos()
+{
+    if (m_salida) m_salida->stop();
+}
+
+void MotorEfectos::reproducir(Efecto efecto)
+{
+    m_mezclador->encolar(std::int8_t(efecto));
+}
+
+void MotorEfectos::detenerTodo()
+{
+    m_mezclador->encolar(-1);
+}
+
+// Decodifica el mp3 completo a PCM una sola vez (asincrono, al arrancar).
+void MotorEfectos::cargar(Efecto efecto, const QString &url, float volumen)
+{
+    auto *decodificador = new QAudioDecoder(this);
+    decodificador->setAudioFormat(m_formato);
+    decodificador->setSource(QUrl(url));
+
+    auto pcm = std::make_shared<QVector<float>>();
+    auto frecuencia = std::make_shared<int>(0);
+    const int canales = m_formato.channelCount();
+
+    connect(decodificador, &QAudioDecoder::bufferReady, this,
+            [decodificador, pcm, frecuencia, canales]() {
+                QAudioBuffer b = decodificador->read();
+                *frecuencia = b.format().sampleRate();
+                agregarBuffer(b, canales, *pcm);
+            });
+    connect(decodificador, &QAudioDecoder::finished, this,
+            [this, decodificador, pcm, frecuencia, canales, efecto, volumen]() {
+                QVector<float> muestras = remuestrear(*pcm, canales, *frecuencia,
+                                                      m_formato.sampleRate());
+                for (float &m : muestras) m *= volumen;
+                m_mezclador->fijarMuestras(efecto, std::move(muestras));
+                decodificador->deleteLater();
+            });
+    connect(decodificador, qOverload<QAudioDecoder::Error>(&QAudioDecoder::error),
+            this, [decodificador](QAudioDecoder::Error) {
+                qWarning("MotorEfectos: %s", qPrintable(decodificador->errorString()));
+                decodificador->deleteLater();
+            });
+
+    decodificador->start();
+}
+
+// ------------------------- Mezclador -------------------------
+
+MotorEfectos::Mezclador::Mezclador(const QAudioFormat &formato, QObject *parent)
+    : QIODevice(parent),
+    m_formato(formato)
+{
+    const int bytesMuestra = m_formato.bytesPerSample();
+    if (bytesMuestra > 0)
+        m_mezcla.resize(m_formato.bytesForDuration(kMaxLecturaUs) / bytesMuestra);
+}
+
+void MotorEfectos::Mezclador::fijarMuestras(Efecto efecto, QVector<float> muestras)
+{
+    m_muestras[efecto] = std::move(muestras);
+    m_cargado[efecto].store(true, std::memory_order_release);
+}
+
+// Productor (hilo de la GUI). Si la cola esta llena se descarta el pedido.
+bool MotorEfectos::Mezclador::encolar(std::int8_t orden)
+{
+    const std::uint32_t cabeza = m_cabeza.load(std::memory_order_relaxed);
+    const std::uint32_t fin = m_fin.load(std::memory_order_acquire);
+    if (cabeza - fin >= std::uint32_t(kTamCola))
+        return false;
+
+    m_cola[cabeza & (kTamCola - 1)] = orden;
+    m_cabeza.store(cabeza + 1, std::memory_order_release);
+    return true;
+}
+
+// Consumidor (hilo de audio): arranca o detiene voces.
+void MotorEfectos::Mezclador::atenderCola()
+{
+    std::uint32_t fin = m_fin.load(std::memory_order_relaxed);
+    const std::uint32_t cabeza = m_cabeza.load(std::memory_order_acquire);
+
+    for (; fin != cabeza; ++fin) {
+        std::int8_t orden = m_cola[fin & (kTamCola - 1)];
+        if (orden == kDetener) {
+            for (Voz &v : m_voces) v.efecto = -1;
+        } else {
+            iniciarVoz(orden);
+        }
+    }
+    m_fin.store(fin, std::memory_order_release);
+}
+
+// Usa una voz libre; si no hay, reemplaza a la que lleva mas tiempo sonando.
+void MotorEfectos::Mezclador::iniciarVoz(int efecto)
+{
+    if (efecto < 0 || efecto >= NumEfectos) return;
+    if (!m_cargado[efecto].load(std::memory_order_acquire)) return;
+
+    Voz *elegida = &m_voces[0];
+    for (Voz &v : m_voces) {
+        if (v.efecto < 0) { elegida = &v; break; }
+        if (v.posicion > elegida->posicion) elegida = &v;
+    }
+    elegida->efecto = efecto;
+    elegida->posicion = 0;
+}
+
+qint64 MotorEfectos::Mezclador::bytesAvailable() const
+{
+    // Fuente continua: siempre hay datos (silencio si no suena nada).
+    return m_formato.bytesForDuration(20000) + QIODevice::bytesAvailable();
+}
+
+qint64 MotorEfectos::Mezclador::readData(char *data, qint64 maxlen)
+{
+    atenderCola();
+
+    const int bytesMuestra = m_formato.bytesPerSample();
+    if (bytesMuestra <= 0) return 0;
+    const qint64 nMuestras = std::min<qint64>(maxlen / bytesMuestra, m_mezcla.size());
+
+    std::fill(m_mezcla.begin(), m_mezcla.begin() + nMuestras, 0.0f);
+
+    for (Voz &v : m_voces) {
+        if (v.efecto < 0) continue;
+        const QVector<float> &pcm = m_muestras[v.efecto];
+        const qint64 quedan = pcm.size() - v.posicion;
+        const qint64 n = std::min(nMuestras, quedan);
+        const float *src = pcm.constData() + v.posicion;
+        for (qint64 i = 0; i < n; ++i)
+            m_mezcla[i] += src[i];
+        v.posicion += n;
+        if (v.posicion >= pcm.size()) v.efecto = -1;
+    }
+
+    // Salida en el formato del dispositivo, con saturacion.
+    for (qint64 i = 0; i < nMuestras; ++i) {
+        float m = std::clamp(m_mezcla[i], -1.0f, 1.0f);
+        switch (m_formato.sampleFormat()) {
+        case QAudioFormat::UInt8:
+            reinterpret_cast<quint8 *>(data)[i] = quint8(128 + m * 127.0f);
+            break;
+        case QAudioFormat::Int16:
+            reinterpret_cast<qint16 *>(data)[i] = qint16(m * 32767.0f);
+            break;
+        case QAudioFormat::Int32:
+            // En double: 1.0f * 2147483647.0f redondea a 2^31, que no cabe.
+            reinterpret_cast<qint32 *>(data)[i] = qint32(double(m) * 2147483647.0);
+            break;
+        case QAudioFormat::Float:
+            reinterpret_cast<float *>(data)[i] = m;
+            break;
+        default:
+            std::memset(data + i*bytesMuestra, 0, bytesMuestra);
+            break;
+        }
+    }
+    return nMuestras * bytesMuestra;
+}
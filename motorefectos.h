@@ -0,0 +1,92 @@
+#ifndef MOTOREFECTOS_H
+#define MOTOREFECTOS_H
+
+#include <QObject>
+#include <QIODevice>
+#include <QAudioFormat>
+#include <QVector>
+#include <atomic>
+#include <array>
+#include <cstdint>
+
+class QAudioSink;
+class QAudioDecoder;
+
+// MotorEfectos:
+//  - Efectos de sonido cortos (disparo, rebote, destruccion, victoria).
+//  - Cada mp3 se decodifica una sola vez al arrancar a PCM en memoria.
+//  - Un mezclador propio (QIODevice en modo pull de QAudioSink) suma
+//    varias voces a la vez, asi un rebote no corta el anterior.
+//  - reproducir() solo deja el pedido en una cola sin bloqueos; ni
+//    decodificacion ni QMediaPlayer en medio del paso de simulacion.
+class MotorEfectos : public QObject
+{
+    Q_OBJECT
+public:
+    enum Efecto { Disparo, Rebote, Destruccion, Victoria, NumEfectos };
+
+    explicit MotorEfectos(QObject *parent = nullptr);
+    ~MotorEfectos() override;
+
+    void reproducir(Efecto efecto);
+    void detenerTodo();
+
+private:
+    class Mezclador;
+
+    void cargar(Efecto efecto, const QString &url, float volumen);
+
+    QAudioFormat m_formato;
+    QAudioSink  *m_salida{nullptr};
+    Mezclador   *m_mezclador{nullptr};
+};
+
+// Mezclador: lo lee QAudioSink (posiblemente desde su propio hilo).
+class MotorEfectos::Mezclador : public QIODevice
+{
+public:
+    explicit Mezclador(const QAudioFormat &formato, QObject *parent = nullptr);
+
+    // Hilo de la GUI: una vez cargado, el PCM de un efecto no cambia.
+    void fijarMuestras(Efecto efecto, QVector<float> muestras);
+    bool encolar(std::int8_t orden);
+
+    qint64 bytesAvailable() const override;
+
+protected:
+    qint64 readData(char *data, qint64 maxlen) override;
+    qint64 writeData(const char *, qint64) override { return -1; }
+
+private:
+    static constexpr int kMaxVoces = 16;
+    static constexpr int kTamCola  = 64;     // potencia de 2
+    static constexpr std::int8_t kDetener = -1;
+    // Lo mas que se mezcla por lectura; si QAudioSink pide mas, vuelve a
+    // leer. El buffer de mezcla se reserva una vez y el hilo de audio no
+    // pide memoria.
+    static constexpr qint64 kMaxLecturaUs = 100000;
+
+    struct Voz {
+        int    efecto{-1};      // -1 = libre
+        qint64 posicion{0};     // en muestras (todas las canales)
+    };
+
+    void atenderCola();
+    void iniciarVoz(int efecto);
+
+    QAudioFormat m_formato;
+
+    // PCM intercalado en float [-1, 1], ya con el volumen del efecto.
+    std::array<QVector<float>, NumEfectos> m_muestras;
+    std::array<std::atomic<bool>, NumEfectos> m_cargado{};
+
+    // Cola de un productor (GUI) y un consumidor (audio).
+    std::array<std::int8_t, kTamCola> m_cola{};
+    std::atomic<std::uint32_t> m_cabeza{0};  // lo escribe el productor
+    std::atomic<std::uint32_t> m_fin{0};     // lo escribe el consumidor
+
+    std::array<Voz, kMaxVoces> m_voces{};
+    QVector<float> m_mezcla;    // kMaxLecturaUs de muestras
+};
+
+#endif // MOTOREFECTOS_H
@@ -0,0 +1,251 @@
+#include "partidared.h"
+#include <QRandomGenerator>
+#include <vector>
+
+PartidaRed::PartidaRed(EscenaJuego *escena, QObject *parent)
+    : QObject(parent),
+    m_escena(escena)
+{
+    connect(m_escena, &EscenaJuego::disparoHecho, this, &PartidaRed::disparoLocal);
+    connect(m_escena, &EscenaJuego::turnoCambiado, this, &PartidaRed::turnoResuelto);
+    connect(m_escena, &EscenaJuego::partidaTerminada, this, &PartidaRed::turnoResuelto);
+}
+
+bool PartidaRed::servir(quint16 puerto)
+{
+    m_bandoLocal = EscenaJuego::Izquierda;
+    m_servidor = new QTcpServer(this);
+    connect(m_servidor, &QTcpServer::newConnection, this, &PartidaRed::conexionEntrante);
+    if (!m_servidor->listen(QHostAddress::Any, puerto)) {
+        fallar(tr("No se pudo escuchar en el puerto %1: %2")
+                   .arg(puerto).arg(m_servidor->errorString()));
+        return false;
+    }
+    emit estadoCambiado(tr("Esperando al otro jugador en el puerto %1...").arg(puerto));
+    return true;
+}
+
+void PartidaRed::conectar(const QString &host, quint16 puerto)
+{
+    m_bandoLocal = EscenaJuego::Derecha;
+    auto *socket = new QTcpSocket(this);
+    adoptarSocket(socket);
+    connect(socket, &QTcpSocket::connected, this, &PartidaRed::conectado);
+    connect(socket, &QAbstractSocket::errorOccurred, this, [this, socket]() {
+        if (!m_listo)
+            fallar(tr("No se pudo conectar: %1").arg(socket->errorString()));
+    });
+    emit estadoCambiado(tr("Conectando con %1:%2...").arg(host).arg(puerto));
+    socket->connectToHost(host, puerto);
+}
+
+bool PartidaRed::turnoLocal() const
+{
+    return m_listo && m_escena->turnoActual() == m_bandoLocal;
+}
+
+// Una sola partida: el servidor deja de aceptar en cuanto llega alguien.
+void PartidaRed::conexionEntrante()
+{
+    QTcpSocket *socket = m_servidor->nextPendingConnection();
+    if (!socket) return;
+    if (m_socket) {
+        socket->abort();
+        socket->deleteLater();
+        return;
+    }
+    m_servidor->close();
+    adoptarSocket(socket);
+
+    // Quien sirve elige la semilla; el saludo lleva la huella del nivel
+    // ya reiniciado con ella para que el otro compruebe que es el mismo.
+    // Listo antes de reiniciar: asi la CPU local empieza si le toca.
+    const quint32 semilla = QRandomGenerator::global()->generate();
+    m_listo = true;
+    empezar(semilla);
+    enviar(MensajeRed::saludo(semilla, m_escena->mundo().hashEstado()));
+    emit estadoCambiado(tr("Conectado: juegas a la izquierda"));
+}
+
+void PartidaRed::conectado()
+{
+    emit estadoCambiado(tr("Conectado; esperando el saludo..."));
+}
+
+void PartidaRed::adoptarSocket(QTcpSocket *socket)
+{
+    m_socket = socket;
+    // Mensajes de pocos bytes: sin esperar a juntar mas (Nagle).
+    m_socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+    connect(m_socket, &QTcpSocket::readyRead, this, &PartidaRed::datosRecibidos);
+    connect(m_socket, &QTcpSocket::disconnected, this, &PartidaRed::desconectado);
+}
+
+void PartidaRed::enviar(const MensajeRed &mensaje)
+{
+    if (!m_socket) return;
+    std::vector<std::uint8_t> datos;
+    mensaje.codificar(datos);
+    m_socket->write(reinterpret_cast<const char *>(datos.data()), qint64(datos.size()));
+}
+
+void PartidaRed::datosRecibidos()
+{
+    m_recibido.append(m_socket->readAll());
+
+    int usados = 0;
+    for (;;) {
+        MensajeRed mensaje;
+        const int n = MensajeRed::decodificar(
+            reinterpret_cast<const std::uint8_t *>(m_recibido.constData()) + usados,
+            std::size_t(m_recibido.size() - usados), mensaje);
+        if (n < 0) {
+            fallar(tr("Mensaje de red invalido"));
+            return;
+        }
+        if (n == 0) break;
+        usados += n;
+        procesar(mensaje);
+        if (!m_socket) return;   // procesar() pudo cortar la partida
+    }
+    m_recibido.remove(0, usados);
+}
+
+void PartidaRed::procesar(const MensajeRed &mensaje)
+{
+    switch (mensaje.tipo) {
+    case MensajeRed::Saludo:
+        if (m_bandoLocal != EscenaJuego::Derecha || m_listo) {
+            fallar(tr("Saludo inesperado"));
+            return;
+        }
+        if (mensaje.version != MensajeRed::kVersion) {
+            fallar(tr("El otro jugador usa otra version del protocolo"));
+            return;
+        }
+        m_listo = true;
+        empezar(mensaje.semilla);
+        if (m_escena->mundo().hashEstado() != mensaje.huella) {
+            fallar(tr("El otro jugador tiene otro nivel u otra física"));
+            return;
+        }
+        emit estadoCambiado(tr("Conectado: juegas a la derecha"));
+        break;
+
+    case MensajeRed::Disparo:
+        if (!mensaje.disparoValido()) {
+            fallar(tr("Disparo invalido del otro jugador (%1)").arg(mensaje.turno));
+            return;
+        }
+        m_pendientes.enqueue(mensaje);
+        aplicarPendientes();
+        break;
+
+    case MensajeRed::Huella:
+        m_huellasRemotas.insert(mensaje.turno, mensaje.huella);
+        compararHuellas(mensaje.turno);
+        break;
+
+    case MensajeRed::Reinicio:
+        if (m_bandoLocal != EscenaJuego::Derecha) {
+            fallar(tr("Reinicio inesperado"));
+            return;
+        }
+        empezar(mensaje.semilla);
+        emit estadoCambiado(tr("Revancha: juegas a la derecha"));
+        break;
+    }
+}
+
+// Partida nueva con la semilla acordada; lo pendiente era de la anterior.
+void PartidaRed::empezar(quint32 semilla)
+{
+    m_pendientes.clear();
+    m_huellasLocales.clear();
+    m_huellasRemotas.clear();
+    m_escena->reiniciarJuego(semilla);
+}
+
+bool PartidaRed::revancha()
+{
+    if (!m_listo || m_bandoLocal != EscenaJuego::Izquierda)
+        return false;
+    const quint32 semilla = QRandomGenerator::global()->generate();
+    empezar(semilla);
+    enviar(MensajeRed::reinicio(semilla));
+    return true;
+}
+
+// Los disparos del otro pasan tambien por aqui al aplicarse: solo se
+// manda lo que hizo el jugador local.
+void PartidaRed::disparoLocal(EscenaJuego::Bando turno, MundoSimulacion::ModoDisparo modo,
+                              double angulo, double velocidad)
+{
+    if (!m_listo || turno != m_bandoLocal)
+        return;
+    enviar(MensajeRed::disparo(disparosHechos() - 1, quint8(modo), angulo, velocidad));
+}
+
+// Fin de un turno (o de la partida): huella del estado para el otro, y
+// el disparo del otro si ya habia llegado.
+void PartidaRed::turnoResuelto()
+{
+    if (!m_listo) return;
+    const quint32 turno = disparosHechos();
+    if (turno > 0 && !m_escena->mundo().hayMovimiento()) {
+        m_huellasLocales.insert(turno, m_escena->mundo().hashEstado());
+        enviar(MensajeRed::huellaTurno(turno, m_huellasLocales.value(turno)));
+        compararHuellas(turno);
+    }
+    aplicarPendientes();
+}
+
+void PartidaRed::compararHuellas(quint32 turno)
+{
+    if (!m_huellasLocales.contains(turno) || !m_huellasRemotas.contains(turno))
+        return;
+    const bool iguales = m_huellasLocales.take(turno) == m_huellasRemotas.take(turno);
+    if (!iguales) {
+        emit estadoCambiado(tr("Partida desincronizada en el turno %1").arg(turno));
+        emit desincronizada(int(turno));
+    }
+}
+
+void PartidaRed::aplicarPendientes()
+{
+    if (m_pendientes.isEmpty()) return;
+    const MundoSimulacion &mundo = m_escena->mundo();
+    if (mundo.hayMovimiento() || mundo.hayGanador())
+        return;
+
+    const MensajeRed &d = m_pendientes.head();
+    if (d.turno != disparosHechos() || m_escena->turnoActual() == m_bandoLocal) {
+        fallar(tr("Disparo fuera de turno (%1)").arg(d.turno));
+        return;
+    }
+    const MensajeRed disparo = m_pendientes.dequeue();
+    m_escena->dispararProyectil(disparo.angulo, disparo.velocidad,
+                                MundoSimulacion::ModoDisparo(disparo.modo));
+}
+
+void PartidaRed::desconectado()
+{
+    if (!m_socket) return;
+    fallar(tr("El otro jugador se desconecto"));
+}
+
+void PartidaRed::fallar(const QString &motivo)
+{
+    m_listo = false;
+    m_pendientes.clear();
+    if (m_socket) {
+        QTcpSocket *socket = m_socket;
+        m_socket = nullptr;
+        socket->disconnect(this);
+        socket->abort();
+        socket->deleteLater();
+    }
+    qWarning("Red: %s", qPrintable(motivo));
+    emit estadoCambiado(motivo);
+    emit terminada();
+}
@@ -0,0 +1,89 @@
+#ifndef PARTIDARED_H
+#define PARTIDARED_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QHash>
+#include <QQueue>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include "escenajuego.h"
+#include "mensajered.h"
+
+// PartidaRed:
+//  - Dos procesos juegan la misma partida por TCP (pensado para la misma
+//    maquina o una red local). Quien escucha juega a la izquierda y elige
+//    la semilla; quien se conecta juega a la derecha.
+//  - Lockstep: cada proceso simula toda la partida en su EscenaJuego y
+//    por la red solo van los disparos (22 bytes cada uno, ver MensajeRed).
+//    El disparo del otro se aplica en cuanto la escena local termino el
+//    turno anterior; no hay espera por frame ni estado del mundo en vuelo.
+//  - Al final de cada turno las dos partes mandan la huella del estado y
+//    comparan: si no coinciden la partida se separo (desincronizada()).
+//  - Los dos deben haber cargado el mismo nivel con la misma fisica: el
+//    saludo lleva la huella del nivel recien empezado y se rechaza si no
+//    coincide.
+//  - La simulacion tiene que dar los mismos bits en los dos procesos: el
+//    mismo ejecutable, o compilaciones con las mismas reglas de coma
+//    flotante (ver simulacion.pri).
+class PartidaRed : public QObject
+{
+    Q_OBJECT
+public:
+    explicit PartidaRed(EscenaJuego *escena, QObject *parent = nullptr);
+
+    // Espera al otro jugador en el puerto dado (todas las interfaces).
+    bool servir(quint16 puerto);
+    // Se conecta a quien sirve la partida.
+    void conectar(const QString &host, quint16 puerto);
+
+    bool conectada() const { return m_listo; }
+    EscenaJuego::Bando bandoLocal() const { return m_bandoLocal; }
+    // El jugador de este proceso puede disparar ahora.
+    bool turnoLocal() const;
+
+    // Revancha: solo la decide quien sirve la partida (elige la semilla).
+    // Devuelve false si este proceso no puede pedirla.
+    bool revancha();
+
+signals:
+    // Texto para la barra de estado (conectando, conectado, error...).
+    void estadoCambiado(const QString &texto);
+    void desincronizada(int turno);
+    void terminada();
+
+private slots:
+    void conexionEntrante();
+    void conectado();
+    void datosRecibidos();
+    void desconectado();
+    void disparoLocal(EscenaJuego::Bando turno, MundoSimulacion::ModoDisparo modo,
+                      double angulo, double velocidad);
+    void turnoResuelto();
+
+private:
+    void adoptarSocket(QTcpSocket *socket);
+    void enviar(const MensajeRed &mensaje);
+    void procesar(const MensajeRed &mensaje);
+    void empezar(quint32 semilla);
+    void compararHuellas(quint32 turno);
+    void aplicarPendientes();
+    void fallar(const QString &motivo);
+    quint32 disparosHechos() const { return quint32(m_escena->registro().disparos().size()); }
+
+    EscenaJuego *m_escena;
+    QTcpServer  *m_servidor{nullptr};
+    QTcpSocket  *m_socket{nullptr};
+    QByteArray   m_recibido;
+    bool m_listo{false};
+    EscenaJuego::Bando m_bandoLocal{EscenaJuego::Izquierda};
+
+    // Disparos del otro que llegaron antes de que la escena local
+    // terminara el turno anterior.
+    QQueue<MensajeRed> m_pendientes;
+    // Huellas por turno resuelto, propias y del otro, hasta compararlas.
+    QHash<quint32, quint64> m_huellasLocales;
+    QHash<quint32, quint64> m_huellasRemotas;
+};
+
+#endif // PARTIDARED_H
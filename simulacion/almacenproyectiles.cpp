@@ -0,0 +1,217 @@
+#include "almacenproyectiles.h"
+#include "fijo.h"
+#include <algorithm>    // std::min, std::max
+
+template <typename T>
+void AlmacenProyectilesT<T>::limpiar()
+{
+    x.clear(); y.clear();
+    xAnt.clear(); yAnt.clear();
+    vx.clear(); vy.clear();
+    radio.clear();
+    masa.clear();
+    tiempoVida.clear();
+    tipo.clear();
+}
+
+template <typename T>
+void AlmacenProyectilesT<T>::reservar(int n)
+{
+    x.reserve(n); y.reserve(n);
+    xAnt.reserve(n); yAnt.reserve(n);
+    vx.reserve(n); vy.reserve(n);
+    radio.reserve(n);
+    masa.reserve(n);
+    tiempoVida.reserve(n);
+    tipo.reserve(n);
+}
+
+template <typename T>
+int AlmacenProyectilesT<T>::agregar(const Vector2D &pos, const Vector2D &vel,
+                                    double r, double m, Tipo t)
+{
+    x.push_back(T(pos.x));    y.push_back(T(pos.y));
+    xAnt.push_back(T(pos.x)); yAnt.push_back(T(pos.y));
+    vx.push_back(T(vel.x));   vy.push_back(T(vel.y));
+    radio.push_back(T(r));
+    masa.push_back(T(m));
+    tiempoVida.push_back(T(0));
+    tipo.push_back(t);
+    return tamano() - 1;
+}
+
+// Quita el proyectil i moviendo el ultimo a su lugar (no conserva el orden).
+template <typename T>
+void AlmacenProyectilesT<T>::eliminar(int i)
+{
+    const int ultimo = tamano() - 1;
+    if (i != ultimo) {
+        x[i] = x[ultimo];       y[i] = y[ultimo];
+        xAnt[i] = xAnt[ultimo]; yAnt[i] = yAnt[ultimo];
+        vx[i] = vx[ultimo];     vy[i] = vy[ultimo];
+        radio[i] = radio[ultimo];
+        masa[i] = masa[ultimo];
+        tiempoVida[i] = tiempoVida[ultimo];
+        tipo[i] = tipo[ultimo];
+    }
+    x.pop_back(); y.pop_back();
+    xAnt.pop_back(); yAnt.pop_back();
+    vx.pop_back(); vy.pop_back();
+    radio.pop_back();
+    masa.pop_back();
+    tiempoVida.pop_back();
+    tipo.pop_back();
+}
+
+template <typename T>
+void AlmacenProyectilesT<T>::integrar(double dtDoble, double gravedad)
+{
+    using Lote = Vector2DLote<T>;
+    constexpr int N = Lote::kCarriles;
+
+    const int n = tamano();
+    T *__restrict px  = x.data();
+    T *__restrict py  = y.data();
+    T *__restrict pxa = xAnt.data();
+    T *__restrict pya = yAnt.data();
+    T *__restrict pvx = vx.data();
+    T *__restrict pvy = vy.data();
+    const T dt(dtDoble);
+    const Vector2DT<T> dv(T(0), T(gravedad * dtDoble));
+
+    int i = 0;
+    for (; i + N <= n; i += N) {
+        Lote pos = Lote::cargar(px + i, py + i);
+        Lote vel = Lote::cargar(pvx + i, pvy + i);
+        pos.guardar(pxa + i, pya + i);
+        vel += dv;
+        pos += vel * dt;
+        pos.guardar(px + i, py + i);
+        vel.guardar(pvx + i, pvy + i);
+    }
+    for (; i < n; ++i) {
+        pxa[i] = px[i];
+        pya[i] = py[i];
+        Vector2DT<T> vel(pvx[i], pvy[i]);
+        vel += dv;
+        px[i] += vel.x * dt;
+        py[i] += vel.y * dt;
+        pvx[i] = vel.x;
+        pvy[i] = vel.y;
+    }
+}
+
+template <typename T>
+void AlmacenProyectilesT<T>::integrar(double dt, const ModeloFuerzas &fuerzas,
+                                     Integrador metodo)
+{
+    const int n = tamano();
+    if (fuerzas.soloGravedad()) {
+        if (metodo == Integrador::EulerSemiImplicito) {
+            integrar(dt, fuerzas.gravedad);
+            return;
+        }
+        // Con aceleracion constante Verlet y RK4 dan la parabola exacta:
+        // se calcula asi, por lotes.
+        T *__restrict px  = x.data();
+        T *__restrict py  = y.data();
+        T *__restrict pxa = xAnt.data();
+        T *__restrict pya = yAnt.data();
+        const T *__restrict pvx = vx.data();
+        T *__restrict pvy = vy.data();
+        const T paso(dt);
+        const T dv(fuerzas.gravedad * dt);
+        const T medioDv(0.5 * fuerzas.gravedad * dt);
+        for (int i = 0; i < n; ++i) {
+            pxa[i] = px[i];
+            pya[i] = py[i];
+            px[i] += pvx[i] * paso;
+            py[i] += (pvy[i] + medioDv) * paso;
+            pvy[i] += dv;
+        }
+        return;
+    }
+
+    for (int i = 0; i < n; ++i) {
+        const double coef = fuerzas.coefArrastre(double(radio[i]), double(masa[i]));
+        const EstadoVuelo e = avanzarVuelo(metodo, fuerzas, coef,
+                                           {posicion(i), velocidad(i)}, dt);
+        xAnt[i] = x[i];
+        yAnt[i] = y[i];
+        x[i]  = T(e.p.x);
+        y[i]  = T(e.p.y);
+        vx[i] = T(e.v.x);
+        vy[i] = T(e.v.y);
+    }
+}
+
+template <typename T>
+void AlmacenProyectilesT<T>::avanzarParabolas(double dtDoble, double gravedad)
+{
+    const int n = tamano();
+    T *__restrict px  = x.data();
+    T *__restrict py  = y.data();
+    T *__restrict pxa = xAnt.data();
+    T *__restrict pya = yAnt.data();
+    T *__restrict pvx = vx.data();
+    T *__restrict pvy = vy.data();
+    T *__restrict pv  = tiempoVida.data();
+    const T dt(dtDoble);
+    const T dv(gravedad * dtDoble);
+    const T medioDv(0.5 * gravedad * dtDoble);
+
+    for (int i = 0; i < n; ++i) {
+        px[i] += pvx[i] * dt;
+        py[i] += (pvy[i] + medioDv) * dt;
+        pvy[i] += dv;
+        pxa[i] = px[i];
+        pya[i] = py[i];
+        pv[i] += dt;
+    }
+}
+
+// Sin saltos dentro del lazo: el que cruzo una pared se refleja respecto
+// a ella (rebote elastico exacto para un tramo recto) y se invierte su
+// componente de velocidad.
+template <typename T>
+bool AlmacenProyectilesT<T>::resolverChoquesParedes(double anchoDoble, double sueloDoble)
+{
+    const int n = tamano();
+    T *__restrict px  = x.data();
+    T *__restrict py  = y.data();
+    T *__restrict pvx = vx.data();
+    T *__restrict pvy = vy.data();
+    const T *__restrict pr = radio.data();
+    const T ancho(anchoDoble);
+    const T suelo(sueloDoble);
+    int rebotes = 0;
+
+    for (int i = 0; i < n; ++i) {
+        const T r  = pr[i];
+        const T xi = px[i];
+        const T yi = py[i];
+        const T xMax = ancho - r;
+        const T yMax = suelo - r;
+
+        const bool fueraIzq = xi < r;
+        const bool fueraDer = xi > xMax;
+        const bool fueraSup = yi < r;
+        const bool fueraInf = yi > yMax;
+
+        const T xr = fueraIzq ? r + r - xi : (fueraDer ? xMax + xMax - xi : xi);
+        const T yr = fueraSup ? r + r - yi : (fueraInf ? yMax + yMax - yi : yi);
+
+        // Con pasos enormes el reflejo podria salir por el otro lado.
+        px[i]  = std::min(std::max(xr, r), xMax);
+        py[i]  = std::min(std::max(yr, r), yMax);
+        pvx[i] = (fueraIzq | fueraDer) ? -pvx[i] : pvx[i];
+        pvy[i] = (fueraSup | fueraInf) ? -pvy[i] : pvy[i];
+
+        rebotes |= int(fueraIzq | fueraDer | fueraSup | fueraInf);
+    }
+    return rebotes != 0;
+}
+
+template struct AlmacenProyectilesT<double>;
+template struct AlmacenProyectilesT<float>;
+template struct AlmacenProyectilesT<Fijo>;
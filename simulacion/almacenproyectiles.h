@@ -0,0 +1,83 @@
+#ifndef ALMACENPROYECTILES_H
+#define ALMACENPROYECTILES_H
+
+#include <vector>
+#include <cstdint>
+#include "integrador.h"
+#include "vector2d.h"
+
+// Precision de posiciones y velocidades de los proyectiles del mundo,
+// fijada al compilar (CONFIG += proyectiles_float en simulacion.pri).
+// Con float cada proyectil ocupa la mitad; el resto del mundo sigue en
+// double y lee los campos convertidos.
+#ifdef SIMULACION_PROYECTILES_FLOAT
+using EscalarProyectil = float;
+#else
+using EscalarProyectil = double;
+#endif
+
+// AlmacenProyectilesT:
+//  - Todos los proyectiles en vuelo, como estructura de arreglos (SoA):
+//    un arreglo por campo y un indice comun.
+//  - Siempre compacto: eliminar() mueve el ultimo al hueco, asi los lazos
+//    de integracion y paredes recorren solo proyectiles vivos y el
+//    compilador los puede vectorizar.
+//  - T es el escalar de todos los campos: double, float o Fijo (hay
+//    instancias de los tres en almacenproyectiles.cpp). La interfaz recibe
+//    y devuelve Vector2D y double, y convierte.
+template <typename T>
+struct AlmacenProyectilesT
+{
+    // Lo que hace un proyectil ademas de volar.
+    enum Tipo : std::uint8_t {
+        Normal,
+        CargaRacimo,    // se abre en el punto mas alto
+        CargaMetralla   // se abre al primer golpe contra un bloque
+    };
+
+    using Escalar = T;
+
+    std::vector<T> x, y;         // posicion actual
+    std::vector<T> xAnt, yAnt;   // posicion antes del ultimo paso
+    std::vector<T> vx, vy;
+    std::vector<T> radio;
+    std::vector<T> masa;
+    std::vector<T> tiempoVida;
+    std::vector<std::uint8_t> tipo;
+
+    int  tamano() const { return int(x.size()); }
+    bool vacio() const { return x.empty(); }
+
+    void limpiar();
+    void reservar(int n);
+    int  agregar(const Vector2D &pos, const Vector2D &vel,
+                 double radio, double masa, Tipo tipo = Normal);
+    void eliminar(int i);
+
+    Vector2D posicion(int i) const { return {double(x[i]), double(y[i])}; }
+    Vector2D posicionAnterior(int i) const { return {double(xAnt[i]), double(yAnt[i])}; }
+    Vector2D velocidad(int i) const { return {double(vx[i]), double(vy[i])}; }
+
+    // --- operaciones por lotes (todos los proyectiles a la vez) ---
+
+    // Euler semi-implicito con gravedad; guarda la posicion anterior. Va por
+    // lotes de Vector2DLote (4 u 8 proyectiles) y el resto de uno en uno.
+    void integrar(double dt, double gravedad);
+    // Con el metodo y las fuerzas de la partida. Con solo gravedad va por
+    // lotes (Euler es integrar(dt, gravedad); Verlet y RK4, la parabola
+    // exacta); con arrastre, de uno en uno.
+    void integrar(double dt, const ModeloFuerzas &fuerzas, Integrador metodo);
+
+    // Avance exacto sobre la parabola (sin error de integracion), sin
+    // choques; suma dt al tiempo de vida. Lo usa el salto por eventos.
+    void avanzarParabolas(double dt, double gravedad);
+
+    // Rebote elastico contra la caja [0, ancho] x [0, suelo], reflejando
+    // la posicion respecto a la pared cruzada.
+    // Devuelve true si algun proyectil reboto.
+    bool resolverChoquesParedes(double ancho, double suelo);
+};
+
+using AlmacenProyectiles = AlmacenProyectilesT<EscalarProyectil>;
+
+#endif // ALMACENPROYECTILES_H
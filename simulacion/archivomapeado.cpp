@@ -0,0 +1,123 @@
+#include "archivomapeado.h"
+
+#ifdef _WIN32
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+ArchivoMapeado &ArchivoMapeado::operator=(ArchivoMapeado &&otro) noexcept
+{
+    if (this != &otro) {
+        cerrar();
+        m_datos   = otro.m_datos;
+        m_tamano  = otro.m_tamano;
+        m_abierto = otro.m_abierto;
+#ifdef _WIN32
+        m_mapeo = otro.m_mapeo;
+        otro.m_mapeo = nullptr;
+#endif
+        otro.m_datos = nullptr;
+        otro.m_tamano = 0;
+        otro.m_abierto = false;
+    }
+    return *this;
+}
+
+#ifdef _WIN32
+
+bool ArchivoMapeado::abrir(const std::string &ruta)
+{
+    cerrar();
+
+    const int largo = MultiByteToWideChar(CP_UTF8, 0, ruta.c_str(), -1, nullptr, 0);
+    if (largo <= 0) return false;
+    std::wstring ancha(std::size_t(largo), L'\0');
+    MultiByteToWideChar(CP_UTF8, 0, ruta.c_str(), -1, &ancha[0], largo);
+
+    HANDLE archivo = CreateFileW(ancha.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                 OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (archivo == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER tamano;
+    if (!GetFileSizeEx(archivo, &tamano)) {
+        CloseHandle(archivo);
+        return false;
+    }
+    m_tamano = std::size_t(tamano.QuadPart);
+
+    if (m_tamano > 0) {
+        // El objeto de mapeo mantiene el archivo abierto por su cuenta.
+        HANDLE mapeo = CreateFileMappingW(archivo, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(archivo);
+        void *vista = mapeo ? MapViewOfFile(mapeo, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if (!vista) {
+            if (mapeo) CloseHandle(mapeo);
+            m_tamano = 0;
+            return false;
+        }
+        m_mapeo = mapeo;
+        m_datos = static_cast<const std::uint8_t *>(vista);
+    } else {
+        CloseHandle(archivo);
+    }
+    m_abierto = true;
+    return true;
+}
+
+void ArchivoMapeado::cerrar()
+{
+    if (m_datos) UnmapViewOfFile(m_datos);
+    if (m_mapeo) CloseHandle(m_mapeo);
+    m_datos = nullptr;
+    m_mapeo = nullptr;
+    m_tamano = 0;
+    m_abierto = false;
+}
+
+#else
+
+bool ArchivoMapeado::abrir(const std::string &ruta)
+{
+    cerrar();
+
+    const int fd = ::open(ruta.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        return false;
+    }
+    m_tamano = std::size_t(info.st_size);
+
+    if (m_tamano > 0) {
+        void *vista = ::mmap(nullptr, m_tamano, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (vista == MAP_FAILED) {
+            ::close(fd);
+            m_tamano = 0;
+            return false;
+        }
+        m_datos = static_cast<const std::uint8_t *>(vista);
+    }
+    ::close(fd);   // el mapeo sigue valido sin el descriptor
+    m_abierto = true;
+    return true;
+}
+
+void ArchivoMapeado::cerrar()
+{
+    if (m_datos)
+        ::munmap(const_cast<std::uint8_t *>(m_datos), m_tamano);
+    m_datos = nullptr;
+    m_tamano = 0;
+    m_abierto = false;
+}
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef ARCHIVOMAPEADO_H
+#define ARCHIVOMAPEADO_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// ArchivoMapeado:
+//  - Archivo de solo lectura proyectado en memoria (mmap en POSIX,
+//    MapViewOfFile en Windows). El sistema trae las paginas cuando se
+//    tocan: abrir no cuesta nada aunque el archivo sea enorme.
+//  - Solo se puede mover, no copiar; se desmapea al destruirse.
+class ArchivoMapeado
+{
+public:
+    ArchivoMapeado() = default;
+    ~ArchivoMapeado() { cerrar(); }
+
+    ArchivoMapeado(const ArchivoMapeado &) = delete;
+    ArchivoMapeado &operator=(const ArchivoMapeado &) = delete;
+    ArchivoMapeado(ArchivoMapeado &&otro) noexcept { *this = static_cast<ArchivoMapeado &&>(otro); }
+    ArchivoMapeado &operator=(ArchivoMapeado &&otro) noexcept;
+
+    // 'ruta' en UTF-8. Un archivo vacio se abre bien (datos() nulo).
+    bool abrir(const std::string &ruta);
+    void cerrar();
+
+    bool abierto() const { return m_abierto; }
+    const std::uint8_t *datos() const { return m_datos; }
+    std::size_t tamano() const { return m_tamano; }
+
+private:
+    const std::uint8_t *m_datos{nullptr};
+    std::size_t m_tamano{0};
+    bool m_abierto{false};
+#ifdef _WIN32
+    void *m_mapeo{nullptr};   // HANDLE del objeto de mapeo
+#endif
+};
+
+#endif // ARCHIVOMAPEADO_H
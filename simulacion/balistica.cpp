@@ -0,0 +1,226 @@
+#include "balistica.h"
+#include "mundosimulacion.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+// Primer t en [0, tMax] en que y(t) vale 'limite' moviendose en el
+// sentido 'signo' (+1 bajando, -1 subiendo).
+bool cruceHorizontalY(const Parabola &p, double limite, double signo,
+                      double tMax, double &t)
+{
+    double raices[2];
+    const int n = raicesCuadratica(0.5*p.g, p.v0.y, p.p0.y - limite, raices);
+    for (int i = 0; i < n; ++i) {
+        const double ti = raices[i];
+        if (ti < 0.0 || ti > tMax) continue;
+        if (signo * (p.v0.y + p.g*ti) > 0.0) { t = ti; return true; }
+    }
+    return false;
+}
+
+// Primer t en [0, tMax] en que x(t) vale 'limite' moviendose en el
+// sentido 'signo' (+1 hacia la derecha, -1 hacia la izquierda).
+bool cruceVerticalX(const Parabola &p, double limite, double signo,
+                    double tMax, double &t)
+{
+    if (signo * p.v0.x <= 0.0) return false;
+    const double ti = (limite - p.p0.x) / p.v0.x;
+    if (ti < 0.0 || ti > tMax) return false;
+    t = ti;
+    return true;
+}
+
+// Contacto con la esquina c (sx, sy indican hacia donde queda la region
+// de la esquina fuera del rectangulo). f(t) = |p(t) - c|² - r² es una
+// cuartica; entre las raices de su derivada (una cubica) es monotona,
+// asi que cada tramo tiene a lo sumo una raiz, que se refina por
+// biseccion.
+bool impactoEsquina(const Parabola &p, double r, const Vector2D &c,
+                    double sx, double sy, double tMax,
+                    double &t, Vector2D &normal)
+{
+    const Vector2D a = p.p0 - c;
+    auto f = [&](double ti) { return magnitud2(p.posicion(ti) - c) - r*r; };
+
+    // f'(t)/2 = (a + v0 t + G t²/2)·(v0 + G t), con G = (0, g)
+    double criticos[3];
+    const int nc = raicesCubica(0.5*p.g*p.g, 1.5*p.g*p.v0.y,
+                                p.g*a.y + magnitud2(p.v0), productoPunto(a, p.v0),
+                                criticos);
+
+    double bordes[5];
+    int nb = 0;
+    bordes[nb++] = 0.0;
+    for (int i = 0; i < nc; ++i)
+        if (criticos[i] > 0.0 && criticos[i] < tMax) bordes[nb++] = criticos[i];
+    bordes[nb++] = tMax;
+
+    for (int i = 0; i + 1 < nb; ++i) {
+        double t0 = bordes[i], t1 = bordes[i+1];
+        double raiz;
+        if (i == 0 && f(0.0) <= 0.0) {
+            // Ya solapado: solo cuenta si se esta metiendo.
+            if (productoPunto(a, p.v0) >= 0.0) continue;
+            raiz = 0.0;
+        } else {
+            if (!(f(t0) > 0.0 && f(t1) <= 0.0)) continue;
+            for (int k = 0; k < 60; ++k) {
+                const double medio = 0.5 * (t0 + t1);
+                if (f(medio) > 0.0) t0 = medio; else t1 = medio;
+            }
+            raiz = t0;
+        }
+
+        const Vector2D q = p.posicion(raiz) - c;
+        if (sx*q.x >= 0.0 && sy*q.y >= 0.0) {
+            t = raiz;
+            normal = normalizar(q);
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+int raicesCuadratica(double a, double b, double c, double raices[2])
+{
+    if (a == 0.0) {
+        if (b == 0.0) return 0;
+        raices[0] = -c / b;
+        return 1;
+    }
+
+    const double disc = b*b - 4.0*a*c;
+    if (disc < 0.0) return 0;
+
+    // Forma estable (sin restar numeros casi iguales).
+    const double q = -0.5 * (b + std::copysign(std::sqrt(disc), b));
+    if (q == 0.0) {
+        raices[0] = 0.0;
+        return 1;
+    }
+    raices[0] = q / a;
+    raices[1] = c / q;
+    if (raices[0] > raices[1]) std::swap(raices[0], raices[1]);
+    return 2;
+}
+
+int raicesCubica(double a, double b, double c, double d, double raices[3])
+{
+    if (a == 0.0) return raicesCuadratica(b, c, d, raices);
+
+    // t = x - b/3 lleva a la cubica reducida x³ + px + q = 0.
+    b /= a; c /= a; d /= a;
+    const double desplazamiento = b / 3.0;
+    const double p = c - b*b / 3.0;
+    const double q = 2.0*b*b*b / 27.0 - b*c / 3.0 + d;
+    const double disc = q*q / 4.0 + p*p*p / 27.0;
+
+    int n;
+    if (disc > 0.0) {
+        const double s = std::sqrt(disc);
+        raices[0] = std::cbrt(-q/2.0 + s) + std::cbrt(-q/2.0 - s);
+        n = 1;
+    } else if (p == 0.0) {
+        raices[0] = 0.0;
+        n = 1;
+    } else {
+        // Tres raices reales (metodo trigonometrico).
+        const double m = 2.0 * std::sqrt(-p / 3.0);
+        const double arg = std::clamp(3.0*q / (p*m), -1.0, 1.0);
+        const double phi = std::acos(arg) / 3.0;
+        for (int k = 0; k < 3; ++k)
+            raices[k] = m * std::cos(phi - 2.0*kPi*k / 3.0);
+        n = 3;
+    }
+
+    for (int k = 0; k < n; ++k) raices[k] -= desplazamiento;
+    std::sort(raices, raices + n);
+    return n;
+}
+
+bool impactoParabolaParedes(const Parabola &p, double r, double ancho,
+                            double suelo, double tMax,
+                            double &t, Vector2D &normal)
+{
+    double tMejor = std::numeric_limits<double>::infinity();
+    double ti = 0.0;
+
+    // Si ya esta del otro lado y sigue saliendo, el contacto es inmediato.
+    auto pared = [&](bool yaFuera, bool cruza, const Vector2D &n) {
+        const double tc = yaFuera ? 0.0 : ti;
+        if ((yaFuera || cruza) && tc < tMejor) { tMejor = tc; normal = n; }
+    };
+    pared(p.p0.x <= r && p.v0.x < 0.0,
+          cruceVerticalX(p, r, -1.0, tMax, ti), Vector2D(1, 0));
+    pared(p.p0.x >= ancho - r && p.v0.x > 0.0,
+          cruceVerticalX(p, ancho - r, 1.0, tMax, ti), Vector2D(-1, 0));
+    pared(p.p0.y <= r && p.v0.y < 0.0,
+          cruceHorizontalY(p, r, -1.0, tMax, ti), Vector2D(0, 1));
+    pared(p.p0.y >= suelo - r && p.v0.y > 0.0,
+          cruceHorizontalY(p, suelo - r, 1.0, tMax, ti), Vector2D(0, -1));
+
+    if (tMejor > tMax) return false;
+    t = tMejor;
+    return true;
+}
+
+bool impactoParabolaRect(const Parabola &p, double r, const RectMundo &rect,
+                         double tMax, double &t, Vector2D &normal)
+{
+    const double L = rect.izquierda(), R = rect.derecha();
+    const double T = rect.arriba(),    B = rect.abajo();
+
+    double tMejor = std::numeric_limits<double>::infinity();
+    double ti = 0.0;
+    Vector2D ni;
+
+    auto probarCara = [&](bool toca, bool dentro, const Vector2D &n) {
+        if (toca && dentro && ti < tMejor) { tMejor = ti; normal = n; }
+    };
+
+    // Caras: el centro cruza la cara desplazada r y cae dentro de su tramo.
+    {
+        bool toca = cruceHorizontalY(p, T - r, 1.0, tMax, ti);
+        const double x = p.posicion(ti).x;
+        probarCara(toca, x >= L && x <= R, Vector2D(0, -1));
+    }
+    {
+        bool toca = cruceHorizontalY(p, B + r, -1.0, tMax, ti);
+        const double x = p.posicion(ti).x;
+        probarCara(toca, x >= L && x <= R, Vector2D(0, 1));
+    }
+    {
+        bool toca = cruceVerticalX(p, L - r, 1.0, tMax, ti);
+        const double y = p.posicion(ti).y;
+        probarCara(toca, y >= T && y <= B, Vector2D(-1, 0));
+    }
+    {
+        bool toca = cruceVerticalX(p, R + r, -1.0, tMax, ti);
+        const double y = p.posicion(ti).y;
+        probarCara(toca, y >= T && y <= B, Vector2D(1, 0));
+    }
+
+    // Esquinas redondeadas (suma de Minkowski del rectangulo y el circulo).
+    const double tCaras = std::min(tMejor, tMax);
+    const struct { double x, y, sx, sy; } esquinas[4] = {
+        {L, T, -1, -1}, {R, T, 1, -1}, {L, B, -1, 1}, {R, B, 1, 1}
+    };
+    for (const auto &e : esquinas) {
+        if (impactoEsquina(p, r, Vector2D(e.x, e.y), e.sx, e.sy, tCaras, ti, ni) &&
+            ti < tMejor) {
+            tMejor = ti;
+            normal = ni;
+        }
+    }
+
+    if (tMejor > tMax) return false;
+    t = tMejor;
+    return true;
+}
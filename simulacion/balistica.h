@@ -0,0 +1,47 @@
+#ifndef BALISTICA_H
+#define BALISTICA_H
+
+#include "vector2d.h"
+
+struct RectMundo;
+
+// Balistica:
+//  - Entre dos choques un proyectil solo siente la gravedad, asi que su
+//    recorrido es una parabola exacta: p(t) = p0 + v0 t + (0, g) t²/2.
+//  - Estas funciones calculan el instante del primer contacto de un
+//    circulo que sigue esa parabola con paredes o rectangulos, sin
+//    avanzar paso a paso (ver MundoSimulacion::resolverAlInstante).
+struct Parabola {
+    Vector2D p0;
+    Vector2D v0;
+    double   g{0.0};
+
+    Vector2D posicion(double t) const
+    {
+        return {p0.x + v0.x*t, p0.y + v0.y*t + 0.5*g*t*t};
+    }
+    Vector2D velocidad(double t) const { return {v0.x, v0.y + g*t}; }
+};
+
+// Primer contacto en [0, tMax] con las paredes x = r, x = ancho - r,
+// y = r e y = suelo - r, solo si se acerca a ellas. Devuelve la normal
+// de la pared (hacia adentro).
+bool impactoParabolaParedes(const Parabola &p, double r, double ancho,
+                            double suelo, double tMax,
+                            double &t, Vector2D &normal);
+
+// Primer contacto en [0, tMax] de un circulo de radio r con un
+// rectangulo: caras (ecuaciones de grado 1 y 2) y esquinas (raiz de una
+// cuartica, aislada entre los extremos de su derivada cubica).
+bool impactoParabolaRect(const Parabola &p, double r, const RectMundo &rect,
+                         double tMax, double &t, Vector2D &normal);
+
+// Raices reales de a t² + b t + c (o de b t + c si a = 0), en orden
+// creciente. Devuelve cuantas hay (0, 1 o 2).
+int raicesCuadratica(double a, double b, double c, double raices[2]);
+
+// Raices reales de a t³ + b t² + c t + d (se degrada a cuadratica si
+// a = 0), en orden creciente. Devuelve cuantas hay (0 a 3).
+int raicesCubica(double a, double b, double c, double d, double raices[3]);
+
+#endif // BALISTICA_H
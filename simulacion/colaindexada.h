@@ -0,0 +1,125 @@
+#ifndef COLAINDEXADA_H
+#define COLAINDEXADA_H
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// ColaIndexada:
+//  - Monticulo binario de indices 0..n-1 cuyas claves viven fuera (en un
+//    arreglo paralelo del que llama). 'menor(a, b)' dice si el elemento a
+//    va antes que b; tiene que ser un orden total (desempatar por indice)
+//    para que el primero no dependa de la historia del monticulo.
+//  - Guarda la posicion de cada indice en el monticulo: cambiar la clave
+//    de uno (actualizar) cuesta O(log n) en vez de rehacer todo.
+//  - quitar() imita el borrado por intercambio de AlmacenProyectiles: el
+//    ultimo elemento pasa a ocupar el indice del quitado.
+class ColaIndexada
+{
+public:
+    int  tamano() const { return int(m_pos.size()); }
+    bool vacia() const { return m_pos.empty(); }
+    // Indice con la menor clave (la cola no debe estar vacia).
+    int  primero() const { return m_monticulo.front(); }
+
+    // Elementos 0..n-1 con sus claves ya calculadas.
+    template <typename Menor>
+    void construir(int n, Menor menor)
+    {
+        m_monticulo.resize(std::size_t(n));
+        m_pos.resize(std::size_t(n));
+        for (int i = 0; i < n; ++i) {
+            m_monticulo[std::size_t(i)] = i;
+            m_pos[std::size_t(i)] = i;
+        }
+        for (int h = n / 2 - 1; h >= 0; --h)
+            bajar(h, menor);
+    }
+
+    // Agrega el elemento tamano() (su clave ya esta en el arreglo).
+    template <typename Menor>
+    void agregar(Menor menor)
+    {
+        const int i = tamano();
+        m_monticulo.push_back(i);
+        m_pos.push_back(i);
+        subir(i, menor);
+    }
+
+    // La clave de 'i' cambio.
+    template <typename Menor>
+    void actualizar(int i, Menor menor)
+    {
+        const int h = m_pos[std::size_t(i)];
+        subir(h, menor);
+        bajar(m_pos[std::size_t(i)], menor);
+    }
+
+    // Quita 'i' y el ultimo elemento pasa a llamarse 'i'. Se llama con las
+    // claves todavia en su lugar; despues el que llama mueve la clave del
+    // ultimo a 'i' y, si 'i' sigue existiendo, llama a actualizar(i).
+    template <typename Menor>
+    void quitar(int i, Menor menor)
+    {
+        // Tapar el hueco con la ultima hoja.
+        const int hueco = m_pos[std::size_t(i)];
+        const int hoja = m_monticulo.back();
+        m_monticulo.pop_back();
+        if (hueco < int(m_monticulo.size())) {
+            m_monticulo[std::size_t(hueco)] = hoja;
+            m_pos[std::size_t(hoja)] = hueco;
+            actualizar(hoja, menor);
+        }
+
+        // Renombrar el ultimo como 'i'.
+        const int ultimo = tamano() - 1;
+        if (i != ultimo) {
+            const int h = m_pos[std::size_t(ultimo)];
+            m_monticulo[std::size_t(h)] = i;
+            m_pos[std::size_t(i)] = h;
+        }
+        m_pos.pop_back();
+    }
+
+private:
+    template <typename Menor>
+    void subir(int h, Menor &menor)
+    {
+        while (h > 0) {
+            const int padre = (h - 1) / 2;
+            if (!menor(m_monticulo[std::size_t(h)], m_monticulo[std::size_t(padre)]))
+                break;
+            intercambiar(h, padre);
+            h = padre;
+        }
+    }
+
+    template <typename Menor>
+    void bajar(int h, Menor &menor)
+    {
+        const int n = int(m_monticulo.size());
+        for (;;) {
+            int menorHijo = 2 * h + 1;
+            if (menorHijo >= n) break;
+            if (menorHijo + 1 < n &&
+                menor(m_monticulo[std::size_t(menorHijo + 1)], m_monticulo[std::size_t(menorHijo)]))
+                ++menorHijo;
+            if (!menor(m_monticulo[std::size_t(menorHijo)], m_monticulo[std::size_t(h)]))
+                break;
+            intercambiar(h, menorHijo);
+            h = menorHijo;
+        }
+    }
+
+    void intercambiar(int a, int b)
+    {
+        std::swap(m_monticulo[std::size_t(a)], m_monticulo[std::size_t(b)]);
+        m_pos[std::size_t(m_monticulo[std::size_t(a)])] = a;
+        m_pos[std::size_t(m_monticulo[std::size_t(b)])] = b;
+    }
+
+    std::vector<int> m_monticulo;   // indices; el primero es el menor
+    std::vector<int> m_pos;         // posicion de cada indice en m_monticulo
+};
+
+#endif // COLAINDEXADA_H
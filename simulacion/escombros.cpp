@@ -0,0 +1,834 @@
+#include "escombros.h"
+#include "mundosimulacion.h"
+#include "terreno.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <tuple>
+
+namespace {
+
+constexpr int    kIteraciones = 10;
+constexpr double kFriccion = 0.6;
+constexpr double kSesgo = 0.2;              // fraccion de la penetracion que se corrige por paso
+constexpr double kPenetracionPermitida = 0.5;   // px
+constexpr double kMaxSesgo = 120.0;         // px/s: un bloque que aterriza encima no los dispara
+constexpr double kVelocidadQuieto = 6.0;    // px/s
+constexpr double kGiroQuieto = 0.1;         // rad/s
+constexpr double kTiempoDormir = 0.5;       // s quieta toda la isla
+constexpr double kMaxDespierto = 10.0;      // s: se duerme aunque tiemble
+constexpr int    kContactosParalelo = 200;  // menos: no compensa despertar hilos
+constexpr double kAplastamiento = 0.5;      // penetracion / semilado menor que lo elimina
+
+// Identificadores negativos de lo estatico en Contacto::b.
+constexpr int kSuelo = -1;
+constexpr int kParedIzq = -2;
+constexpr int kParedDer = -3;
+constexpr int kTerreno = -4;
+constexpr int kPrimerFijo = -5;             // luego los fijos y despues los bloques
+
+inline double cruz(const Vector2D &a, const Vector2D &b) { return a.x*b.y - a.y*b.x; }
+inline Vector2D cruz(double w, const Vector2D &r) { return {-w*r.y, w*r.x}; }
+
+// Caja girada (centro, ejes y semilados) para el choque caja contra caja.
+struct Caja {
+    Vector2D centro;
+    Vector2D ejeX, ejeY;     // columnas de la rotacion
+    double hx, hy;
+
+    Caja(const Vector2D &c, double angulo, double hx_, double hy_)
+        : centro(c), ejeX(std::cos(angulo), std::sin(angulo)),
+          ejeY(-std::sin(angulo), std::cos(angulo)), hx(hx_), hy(hy_) {}
+
+    Vector2D local(const Vector2D &v) const { return {productoPunto(ejeX, v), productoPunto(ejeY, v)}; }
+    Vector2D mundo(const Vector2D &v) const { return ejeX * v.x + ejeY * v.y; }
+};
+
+// Arista de cada extremo del punto de contacto: identifica el contacto
+// entre pasos (arranque en caliente).
+struct Rasgo {
+    std::uint8_t entraA{0}, saleA{0}, entraB{0}, saleB{0};
+    std::uint32_t clave() const
+    {
+        return std::uint32_t(entraA) | std::uint32_t(saleA) << 8 |
+               std::uint32_t(entraB) << 16 | std::uint32_t(saleB) << 24;
+    }
+    void invertir() { std::swap(entraA, entraB); std::swap(saleA, saleB); }
+};
+
+struct PuntoRecorte {
+    Vector2D v;
+    Rasgo rasgo;
+};
+
+enum Arista : std::uint8_t { SinArista, Arista1, Arista2, Arista3, Arista4 };
+
+// Recorta el segmento con el semiplano dot(normal, p) <= desplazamiento.
+int recortar(PuntoRecorte salida[2], const PuntoRecorte entrada[2],
+             const Vector2D &normal, double desplazamiento, std::uint8_t arista)
+{
+    int n = 0;
+    const double d0 = productoPunto(normal, entrada[0].v) - desplazamiento;
+    const double d1 = productoPunto(normal, entrada[1].v) - desplazamiento;
+    if (d0 <= 0.0) salida[n++] = entrada[0];
+    if (d1 <= 0.0) salida[n++] = entrada[1];
+    if (d0 * d1 < 0.0) {
+        const double f = d0 / (d0 - d1);
+        salida[n].v = entrada[0].v + (entrada[1].v - entrada[0].v) * f;
+        if (d0 > 0.0) {
+            salida[n].rasgo = entrada[0].rasgo;
+            salida[n].rasgo.entraA = arista;
+            salida[n].rasgo.entraB = SinArista;
+        } else {
+            salida[n].rasgo = entrada[1].rasgo;
+            salida[n].rasgo.saleA = arista;
+            salida[n].rasgo.saleB = SinArista;
+        }
+        ++n;
+    }
+    return n;
+}
+
+// Arista de la caja incidente mas enfrentada a la normal de referencia.
+void aristaIncidente(PuntoRecorte c[2], const Caja &caja, const Vector2D &normal)
+{
+    const Vector2D n = caja.local(normal) * -1.0;
+    const double hx = caja.hx, hy = caja.hy;
+    if (std::abs(n.x) > std::abs(n.y)) {
+        if (n.x > 0.0) {
+            c[0].v = {hx, -hy}; c[0].rasgo.entraB = Arista3; c[0].rasgo.saleB = Arista4;
+            c[1].v = {hx,  hy}; c[1].rasgo.entraB = Arista4; c[1].rasgo.saleB = Arista1;
+        } else {
+            c[0].v = {-hx,  hy}; c[0].rasgo.entraB = Arista1; c[0].rasgo.saleB = Arista2;
+            c[1].v = {-hx, -hy}; c[1].rasgo.entraB = Arista2; c[1].rasgo.saleB = Arista3;
+        }
+    } else {
+        if (n.y > 0.0) {
+            c[0].v = { hx, hy}; c[0].rasgo.entraB = Arista4; c[0].rasgo.saleB = Arista1;
+            c[1].v = {-hx, hy}; c[1].rasgo.entraB = Arista1; c[1].rasgo.saleB = Arista2;
+        } else {
+            c[0].v = {-hx, -hy}; c[0].rasgo.entraB = Arista2; c[0].rasgo.saleB = Arista3;
+            c[1].v = { hx, -hy}; c[1].rasgo.entraB = Arista3; c[1].rasgo.saleB = Arista4;
+        }
+    }
+    c[0].v = caja.centro + caja.mundo(c[0].v);
+    c[1].v = caja.centro + caja.mundo(c[1].v);
+}
+
+struct PuntoContacto {
+    Vector2D punto;
+    Vector2D normal;       // de A hacia B
+    double separacion;
+    std::uint32_t rasgo;
+};
+
+// Choque de dos cajas giradas: eje de menor penetracion entre las cuatro
+// caras (con preferencia por las de A para que no salte de un eje a otro
+// entre pasos) y la arista incidente recortada por los lados de la cara
+// de referencia. Hasta dos puntos, solo si se solapan.
+int chocarCajas(const Caja &A, const Caja &B, PuntoContacto salida[2])
+{
+    const Vector2D dp = B.centro - A.centro;
+    const Vector2D dA = A.local(dp);
+    const Vector2D dB = B.local(dp);
+
+    // C = RA^T RB y su valor absoluto.
+    const double c00 = std::abs(productoPunto(A.ejeX, B.ejeX));
+    const double c01 = std::abs(productoPunto(A.ejeX, B.ejeY));
+    const double c10 = std::abs(productoPunto(A.ejeY, B.ejeX));
+    const double c11 = std::abs(productoPunto(A.ejeY, B.ejeY));
+
+    const double caraAx = std::abs(dA.x) - A.hx - (c00*B.hx + c01*B.hy);
+    const double caraAy = std::abs(dA.y) - A.hy - (c10*B.hx + c11*B.hy);
+    if (caraAx > 0.0 || caraAy > 0.0) return 0;
+    const double caraBx = std::abs(dB.x) - (c00*A.hx + c10*A.hy) - B.hx;
+    const double caraBy = std::abs(dB.y) - (c01*A.hx + c11*A.hy) - B.hy;
+    if (caraBx > 0.0 || caraBy > 0.0) return 0;
+
+    const double kTolRelativa = 0.95;
+    const double kTolAbsoluta = 0.01;
+
+    enum Eje { CaraAx, CaraAy, CaraBx, CaraBy };
+    Eje eje = CaraAx;
+    double separacion = caraAx;
+    Vector2D normal = dA.x > 0.0 ? A.ejeX : A.ejeX * -1.0;
+
+    if (caraAy > kTolRelativa*separacion + kTolAbsoluta*A.hy) {
+        eje = CaraAy; separacion = caraAy;
+        normal = dA.y > 0.0 ? A.ejeY : A.ejeY * -1.0;
+    }
+    if (caraBx > kTolRelativa*separacion + kTolAbsoluta*B.hx) {
+        eje = CaraBx; separacion = caraBx;
+        normal = dB.x > 0.0 ? B.ejeX : B.ejeX * -1.0;
+    }
+    if (caraBy > kTolRelativa*separacion + kTolAbsoluta*B.hy) {
+        eje = CaraBy; separacion = caraBy;
+        normal = dB.y > 0.0 ? B.ejeY : B.ejeY * -1.0;
+    }
+
+    Vector2D frente, lado;
+    double distFrente, ladoNeg, ladoPos;
+    std::uint8_t aristaNeg, aristaPos;
+    PuntoRecorte incidente[2];
+
+    auto referencia = [&](const Caja &ref, const Caja &otra, const Vector2D &n,
+                          bool ejeX) {
+        frente = n;
+        distFrente = productoPunto(ref.centro, frente) + (ejeX ? ref.hx : ref.hy);
+        lado = ejeX ? ref.ejeY : ref.ejeX;
+        const double l = productoPunto(ref.centro, lado);
+        const double semi = ejeX ? ref.hy : ref.hx;
+        ladoNeg = -l + semi;
+        ladoPos =  l + semi;
+        aristaNeg = ejeX ? Arista3 : Arista2;
+        aristaPos = ejeX ? Arista1 : Arista4;
+        aristaIncidente(incidente, otra, frente);
+    };
+    switch (eje) {
+    case CaraAx: referencia(A, B, normal, true); break;
+    case CaraAy: referencia(A, B, normal, false); break;
+    case CaraBx: referencia(B, A, normal * -1.0, true); break;
+    case CaraBy: referencia(B, A, normal * -1.0, false); break;
+    }
+
+    PuntoRecorte recorte1[2], recorte2[2];
+    if (recortar(recorte1, incidente, lado * -1.0, ladoNeg, aristaNeg) < 2) return 0;
+    if (recortar(recorte2, recorte1, lado, ladoPos, aristaPos) < 2) return 0;
+
+    int n = 0;
+    for (const PuntoRecorte &p : recorte2) {
+        const double sep = productoPunto(frente, p.v) - distFrente;
+        if (sep > 0.0) continue;
+        Rasgo rasgo = p.rasgo;
+        if (eje == CaraBx || eje == CaraBy) rasgo.invertir();
+        // El punto se lleva a la cara de referencia.
+        salida[n++] = {p.v - frente * sep, normal, sep, rasgo.clave()};
+    }
+    return n;
+}
+
+// Grupo fijo de hilos para resolver islas. Es compartido por todos los
+// mundos: si otro lo esta usando (p. ej. las copias de
+// SolucionadorPunteria, cada una en su hilo) se resuelve sin repartir.
+class GrupoHilos
+{
+public:
+    static GrupoHilos &compartido()
+    {
+        static GrupoHilos grupo;
+        return grupo;
+    }
+
+    // Ejecuta tarea(0 .. n-1) entre los hilos y el que llama. Devuelve
+    // false, sin ejecutar nada, si el grupo esta ocupado o no tiene hilos.
+    bool repartir(int n, const std::function<void(int)> &tarea)
+    {
+        std::unique_lock<std::mutex> uso(m_uso, std::try_to_lock);
+        if (!uso.owns_lock() || m_hilos.empty()) return false;
+        {
+            std::lock_guard<std::mutex> l(m_m);
+            m_tarea = &tarea;
+            m_total = n;
+            m_siguiente.store(0);
+            m_pendientes = int(m_hilos.size());
+            ++m_ronda;
+        }
+        m_hay.notify_all();
+        trabajar();
+
+        std::unique_lock<std::mutex> l(m_m);
+        m_listo.wait(l, [&]{ return m_pendientes == 0; });
+        m_tarea = nullptr;
+        return true;
+    }
+
+private:
+    GrupoHilos()
+    {
+        const int nucleos = int(std::thread::hardware_concurrency());
+        const int hilos = std::clamp(nucleos - 1, 0, 7);
+        for (int h = 0; h < hilos; ++h)
+            m_hilos.emplace_back([this]{ bucle(); });
+    }
+
+    ~GrupoHilos()
+    {
+        {
+            std::lock_guard<std::mutex> l(m_m);
+            m_salir = true;
+        }
+        m_hay.notify_all();
+        for (std::thread &t : m_hilos) t.join();
+    }
+
+    void trabajar()
+    {
+        for (;;) {
+            const int k = m_siguiente.fetch_add(1);
+            if (k >= m_total) return;
+            (*m_tarea)(k);
+        }
+    }
+
+    void bucle()
+    {
+        unsigned vista = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> l(m_m);
+                m_hay.wait(l, [&]{ return m_salir || m_ronda != vista; });
+                if (m_salir) return;
+                vista = m_ronda;
+            }
+            trabajar();
+            std::lock_guard<std::mutex> l(m_m);
+            if (--m_pendientes == 0) m_listo.notify_one();
+        }
+    }
+
+    std::vector<std::thread> m_hilos;
+    std::mutex m_uso;              // un solo mundo a la vez
+    std::mutex m_m;
+    std::condition_variable m_hay, m_listo;
+    const std::function<void(int)> *m_tarea{nullptr};
+    int m_total{0};
+    std::atomic<int> m_siguiente{0};
+    int m_pendientes{0};
+    unsigned m_ronda{0};
+    bool m_salir{false};
+};
+
+} // namespace
+
+void Escombros::limpiar()
+{
+    for (std::vector<double> *v : {&x, &y, &angulo, &vx, &vy, &w, &semiAncho, &semiAlto,
+                                   &invMasa, &invInercia, &quieto, &despierto})
+        v->clear();
+    dormido.clear();
+    m_contactos.clear();
+    m_anteriores.clear();
+    m_cajas.clear();
+    m_despiertos = 0;
+    m_rejillaSucia = true;
+}
+
+void Escombros::fijarLimites(double ancho, double alto)
+{
+    m_ancho = ancho;
+    m_alto = alto;
+    m_rejillaSucia = true;
+}
+
+int Escombros::agregar(const Vector2D &centro, double hx, double hy,
+                       const Vector2D &vel, double giro, double densidad)
+{
+    if (tamano() >= kMaxCuerpos || hx <= 0.0 || hy <= 0.0) return -1;
+
+    const double masa = densidad * 4.0 * hx * hy;
+    x.push_back(centro.x);
+    y.push_back(centro.y);
+    angulo.push_back(0.0);
+    vx.push_back(vel.x);
+    vy.push_back(vel.y);
+    w.push_back(giro);
+    semiAncho.push_back(hx);
+    semiAlto.push_back(hy);
+    invMasa.push_back(1.0 / masa);
+    invInercia.push_back(3.0 / (masa * (hx*hx + hy*hy)));   // 12 / (m (an² + al²))
+    quieto.push_back(0.0);
+    despierto.push_back(0.0);
+    dormido.push_back(0);
+    m_cajas.push_back(caja(tamano() - 1));
+    ++m_despiertos;
+    m_rejillaSucia = true;
+    return tamano() - 1;
+}
+
+RectMundo Escombros::caja(int i) const
+{
+    const double c = std::abs(std::cos(angulo[i])), s = std::abs(std::sin(angulo[i]));
+    const double ex = c*semiAncho[i] + s*semiAlto[i];
+    const double ey = s*semiAncho[i] + c*semiAlto[i];
+    return RectMundo(x[i] - ex, y[i] - ey, 2.0*ex, 2.0*ey);
+}
+
+Vector2D Escombros::esquina(int i, int k) const
+{
+    static const double signos[4][2] = {{-1, -1}, {1, -1}, {1, 1}, {-1, 1}};
+    const Caja c(Vector2D(x[i], y[i]), angulo[i], semiAncho[i], semiAlto[i]);
+    return c.centro + c.mundo(Vector2D(signos[k][0] * c.hx, signos[k][1] * c.hy));
+}
+
+void Escombros::asegurarRejilla()
+{
+    if (!m_rejillaSucia) return;
+    m_ninguno.assign(x.size(), 0);
+    m_rejilla.construir(m_cajas, m_ninguno, m_ancho, m_alto);
+    m_rejillaSucia = false;
+}
+
+void Escombros::consultar(double x0, double y0, double x1, double y1,
+                          std::vector<int> &salida)
+{
+    if (vacio()) return;
+    asegurarRejilla();
+    const std::size_t primero = salida.size();
+    m_rejilla.consultar(x0, y0, x1, y1, salida);
+    salida.erase(std::remove_if(salida.begin() + primero, salida.end(), [&](int i) {
+                     const RectMundo &q = m_cajas[i];
+                     return x1 < q.izquierda() || x0 > q.derecha() ||
+                            y1 < q.arriba()    || y0 > q.abajo();
+                 }), salida.end());
+}
+
+void Escombros::despertarEn(const RectMundo &zona)
+{
+    m_candidatos.clear();
+    consultar(zona.izquierda(), zona.arriba(), zona.derecha(), zona.abajo(), m_candidatos);
+    for (int i : m_candidatos) {
+        if (!dormido[i]) continue;
+        dormido[i] = 0;
+        quieto[i] = 0.0;
+        despierto[i] = 0.0;
+        ++m_despiertos;
+    }
+}
+
+void Escombros::dormirTodos()
+{
+    std::fill(dormido.begin(), dormido.end(), std::uint8_t(1));
+    std::fill(vx.begin(), vx.end(), 0.0);
+    std::fill(vy.begin(), vy.end(), 0.0);
+    std::fill(w.begin(), w.end(), 0.0);
+    m_contactos.clear();
+    m_anteriores.clear();
+    m_despiertos = 0;
+}
+
+// El circulo se pasa al marco de la caja, donde es un rectangulo alineado.
+bool Escombros::barrerCirculo(int i, const Vector2D &p0, const Vector2D &d, double r,
+                              double &t, Vector2D &normal) const
+{
+    const Caja c(Vector2D(x[i], y[i]), angulo[i], semiAncho[i], semiAlto[i]);
+    const RectMundo local(-c.hx, -c.hy, 2.0*c.hx, 2.0*c.hy);
+    Vector2D n;
+    if (!barridoCirculoRect(c.local(p0 - c.centro), c.local(d), r, local, t, n))
+        return false;
+    normal = c.mundo(n);
+    return true;
+}
+
+Vector2D Escombros::velocidadEn(int i, const Vector2D &punto) const
+{
+    return Vector2D(vx[i], vy[i]) + cruz(w[i], punto - Vector2D(x[i], y[i]));
+}
+
+void Escombros::golpear(int i, const Vector2D &punto, const Vector2D &impulso)
+{
+    vx[i] += invMasa[i] * impulso.x;
+    vy[i] += invMasa[i] * impulso.y;
+    w[i]  += invInercia[i] * cruz(punto - Vector2D(x[i], y[i]), impulso);
+    quieto[i] = 0.0;
+    if (dormido[i]) {
+        dormido[i] = 0;
+        despierto[i] = 0.0;
+        ++m_despiertos;
+    }
+}
+
+int Escombros::raiz(int i)
+{
+    while (m_padre[i] != i) {
+        m_padre[i] = m_padre[m_padre[i]];
+        i = m_padre[i];
+    }
+    return i;
+}
+
+void Escombros::unir(int a, int b)
+{
+    const int ra = raiz(a), rb = raiz(b);
+    if (ra != rb) m_padre[std::max(ra, rb)] = std::min(ra, rb);
+}
+
+// Quita el cuerpo i moviendo el ultimo a su hueco.
+void Escombros::eliminar(int i)
+{
+    const int ultimo = tamano() - 1;
+    for (std::vector<double> *v : {&x, &y, &angulo, &vx, &vy, &w, &semiAncho, &semiAlto,
+                                   &invMasa, &invInercia, &quieto, &despierto}) {
+        (*v)[i] = (*v)[ultimo];
+        v->pop_back();
+    }
+    dormido[i] = dormido[ultimo];
+    dormido.pop_back();
+    m_cajas[i] = m_cajas[ultimo];
+    m_cajas.pop_back();
+}
+
+// Al final del paso: los indices cambian, asi que la rejilla se rehace y
+// el siguiente paso arranca sin impulsos previos.
+void Escombros::quitarAplastados()
+{
+    for (int i = tamano() - 1; i >= 0; --i)
+        if (m_aplastado[i]) eliminar(i);
+    m_contactos.clear();
+    m_hayAplastados = false;
+    m_rejillaSucia = true;
+}
+
+// Contactos del cuerpo a con una caja (otro cuerpo o algo estatico).
+void Escombros::agregarContactos(int a, int b, const Vector2D &cb, double angB,
+                                 double hxB, double hyB)
+{
+    PuntoContacto puntos[2];
+    const int n = chocarCajas(Caja(Vector2D(x[a], y[a]), angulo[a], semiAncho[a], semiAlto[a]),
+                              Caja(cb, angB, hxB, hyB), puntos);
+    for (int k = 0; k < n; ++k) {
+        Contacto c;
+        c.a = a;
+        c.b = b;
+        c.rasgo = puntos[k].rasgo;
+        c.punto = puntos[k].punto;
+        c.normal = puntos[k].normal;
+        c.separacion = puntos[k].separacion;
+        agregarContacto(c);
+    }
+}
+
+// Esquinas y puntos medios de los lados que quedan dentro del terreno.
+// La normal sale de las celdas llenas de alrededor y la penetracion es lo
+// que hay que avanzar por ella hasta salir al aire (en cuartos de px).
+void Escombros::agregarContactosTerreno(int a, const Terreno &terreno)
+{
+    const double kRadioNormal = 3.0;
+    const double kPasoSalida = 0.25;
+    const double kMaxHundido = 8.0;
+    static const double puntos[8][2] = {{-1, -1}, {1, -1}, {1, 1}, {-1, 1},
+                                        {0, -1},  {1, 0},  {0, 1}, {-1, 0}};
+
+    const Caja caja(Vector2D(x[a], y[a]), angulo[a], semiAncho[a], semiAlto[a]);
+    for (int k = 0; k < 8; ++k) {
+        const Vector2D p = caja.centro + caja.mundo(Vector2D(puntos[k][0] * caja.hx,
+                                                             puntos[k][1] * caja.hy));
+        if (!terreno.solido(p)) continue;
+        const Vector2D afuera = terreno.normalEn(p, kRadioNormal);
+        if (magnitud2(afuera) == 0.0) continue;
+
+        double hundido = kPasoSalida;
+        while (hundido < kMaxHundido && terreno.solido(p + afuera * hundido))
+            hundido += kPasoSalida;
+
+        Contacto c;
+        c.a = a;
+        c.b = kTerreno;
+        c.rasgo = std::uint32_t(k);
+        c.punto = p;
+        c.normal = afuera * -1.0;
+        c.separacion = -hundido;
+        agregarContacto(c);
+    }
+}
+
+// Con los impulsos del paso anterior si el mismo contacto ya existia.
+void Escombros::agregarContacto(Contacto c)
+{
+    auto it = std::lower_bound(m_anteriores.begin(), m_anteriores.end(), c,
+                               [](const Contacto &p, const Contacto &q) {
+                                   return std::tie(p.a, p.b, p.rasgo) < std::tie(q.a, q.b, q.rasgo);
+                               });
+    if (it != m_anteriores.end() && it->a == c.a && it->b == c.b && it->rasgo == c.rasgo) {
+        c.pn = it->pn;
+        c.pt = it->pt;
+    }
+    m_contactos.push_back(c);
+}
+
+// Recorre los cuerpos despiertos (y los dormidos que tocan, que se
+// despiertan y se agregan a la cola). Cada par se calcula una sola vez,
+// desde el primero que se procesa. Los contactos entre cuerpos unen sus
+// islas.
+void Escombros::generarContactos(const Entorno &entorno)
+{
+    const int n = tamano();
+    m_contactos.clear();
+    m_cola.clear();
+    m_procesado.assign(n, 0);
+    m_aplastado.assign(n, 0);
+    m_hayAplastados = false;
+    m_padre.resize(n);
+    std::iota(m_padre.begin(), m_padre.end(), 0);
+
+    for (int i = 0; i < n; ++i)
+        if (!dormido[i]) m_cola.push_back(i);
+
+    // Suelo y paredes como cajas gruesas que sobrepasan el mundo (las
+    // paredes llegan muy por encima, para lo que sale volando).
+    const double kGrosor = 100.0;
+    const double altoPared = 100.0 * std::max(m_alto, entorno.suelo);
+    const int numFijos = entorno.numFijos;
+
+    for (std::size_t q = 0; q < m_cola.size(); ++q) {
+        const int i = m_cola[q];
+        m_procesado[i] = 1;
+        const RectMundo &r = m_cajas[i];
+
+        // Otros cuerpos.
+        m_candidatos.clear();
+        m_rejilla.consultar(r.izquierda(), r.arriba(), r.derecha(), r.abajo(), m_candidatos);
+        for (int j : m_candidatos) {
+            if (j == i || m_procesado[j]) continue;
+            const RectMundo &s = m_cajas[j];
+            if (r.derecha() < s.izquierda() || r.izquierda() > s.derecha() ||
+                r.abajo() < s.arriba() || r.arriba() > s.abajo())
+                continue;
+
+            const std::size_t antes = m_contactos.size();
+            const int a = std::min(i, j), b = std::max(i, j);
+            agregarContactos(a, b, Vector2D(x[b], y[b]), angulo[b], semiAncho[b], semiAlto[b]);
+            if (m_contactos.size() == antes) continue;
+
+            unir(a, b);
+            if (dormido[j]) {
+                dormido[j] = 0;
+                quieto[j] = 0.0;
+                despierto[j] = 0.0;
+                ++m_despiertos;
+                m_cola.push_back(j);
+            }
+        }
+
+        // Suelo y paredes.
+        if (r.abajo() >= entorno.suelo)
+            agregarContactos(i, kSuelo, Vector2D(entorno.ancho/2.0, entorno.suelo + kGrosor),
+                             0.0, entorno.ancho/2.0 + kGrosor, kGrosor);
+        if (r.izquierda() <= 0.0)
+            agregarContactos(i, kParedIzq, Vector2D(-kGrosor, entorno.suelo - altoPared/2.0),
+                             0.0, kGrosor, altoPared/2.0);
+        if (r.derecha() >= entorno.ancho)
+            agregarContactos(i, kParedDer, Vector2D(entorno.ancho + kGrosor, entorno.suelo - altoPared/2.0),
+                             0.0, kGrosor, altoPared/2.0);
+        if (entorno.terreno && r.abajo() >= entorno.terreno->filaSuperior())
+            agregarContactosTerreno(i, *entorno.terreno);
+
+        // Rivales, plataformas y bloques. Muy hundido en uno de ellos
+        // queda aplastado; tocando un fijo que quita, tambien.
+        const double limite = -kAplastamiento * std::min(semiAncho[i], semiAlto[i]);
+        auto probarRect = [&](const RectMundo &s, int id, bool quita) {
+            if (s.ancho <= 0.0 || s.alto <= 0.0 ||
+                r.derecha() < s.izquierda() || r.izquierda() > s.derecha() ||
+                r.abajo() < s.arriba() || r.arriba() > s.abajo())
+                return;
+            const std::size_t antes = m_contactos.size();
+            agregarContactos(i, id, s.centro(), 0.0, s.ancho/2.0, s.alto/2.0);
+            for (std::size_t k = antes; k < m_contactos.size(); ++k)
+                if (quita || m_contactos[k].separacion < limite) {
+                    m_aplastado[i] = 1;
+                    m_hayAplastados = true;
+                }
+        };
+        for (int k = 0; k < numFijos; ++k)
+            probarRect(entorno.fijos[k], kPrimerFijo - k, k >= numFijos - entorno.numQuitan);
+        if (entorno.rejilla && entorno.bloques) {
+            m_candidatos.clear();
+            entorno.rejilla->consultar(r.izquierda(), r.arriba(), r.derecha(), r.abajo(),
+                                       m_candidatos);
+            for (int j : m_candidatos)
+                probarRect((*entorno.bloques)[j], kPrimerFijo - numFijos - j, false);
+        }
+    }
+
+    // Los aplastados no empujan a nadie en su ultimo paso.
+    if (m_hayAplastados) {
+        m_contactos.erase(std::remove_if(m_contactos.begin(), m_contactos.end(),
+                                         [&](const Contacto &c) {
+                                             return m_aplastado[c.a] || (c.b >= 0 && m_aplastado[c.b]);
+                                         }), m_contactos.end());
+        std::iota(m_padre.begin(), m_padre.end(), 0);
+        for (const Contacto &c : m_contactos)
+            if (c.b >= 0) unir(c.a, c.b);
+    }
+}
+
+// Impulsos secuenciales sobre los contactos de la isla y avance de sus
+// cuerpos. Solo toca cuerpos y contactos de la isla.
+void Escombros::resolverIsla(int isla, double dt, double gravedad)
+{
+    const int *cuerpos = m_cuerposIsla.data() + m_inicioCuerpos[isla];
+    const int nCuerpos = m_inicioCuerpos[isla + 1] - m_inicioCuerpos[isla];
+    const int *contactos = m_contactosIsla.data() + m_inicioContactos[isla];
+    const int nContactos = m_inicioContactos[isla + 1] - m_inicioContactos[isla];
+    const double invDt = 1.0 / dt;
+
+    for (int k = 0; k < nCuerpos; ++k)
+        vy[cuerpos[k]] += gravedad * dt;
+
+    auto centro = [&](int b) { return Vector2D(x[b], y[b]); };
+    auto velocidad = [&](int b, const Vector2D &r) {
+        return b >= 0 ? Vector2D(vx[b], vy[b]) + cruz(w[b], r) : Vector2D(0, 0);
+    };
+    auto aplicar = [&](const Contacto &c, const Vector2D &ra, const Vector2D &rb,
+                       const Vector2D &P) {
+        vx[c.a] -= invMasa[c.a] * P.x;
+        vy[c.a] -= invMasa[c.a] * P.y;
+        w[c.a]  -= invInercia[c.a] * cruz(ra, P);
+        if (c.b >= 0) {
+            vx[c.b] += invMasa[c.b] * P.x;
+            vy[c.b] += invMasa[c.b] * P.y;
+            w[c.b]  += invInercia[c.b] * cruz(rb, P);
+        }
+    };
+
+    // Masas efectivas, sesgo de posicion y arranque en caliente.
+    for (int k = 0; k < nContactos; ++k) {
+        Contacto &c = m_contactos[contactos[k]];
+        const Vector2D ra = c.punto - centro(c.a);
+        const Vector2D rb = c.b >= 0 ? c.punto - centro(c.b) : Vector2D(0, 0);
+        const Vector2D tangente(c.normal.y, -c.normal.x);
+        const double imB = c.b >= 0 ? invMasa[c.b] : 0.0;
+        const double iiB = c.b >= 0 ? invInercia[c.b] : 0.0;
+
+        const double rnA = productoPunto(ra, c.normal), rnB = productoPunto(rb, c.normal);
+        c.masaN = 1.0 / (invMasa[c.a] + imB +
+                         invInercia[c.a] * (magnitud2(ra) - rnA*rnA) +
+                         iiB * (magnitud2(rb) - rnB*rnB));
+        const double rtA = productoPunto(ra, tangente), rtB = productoPunto(rb, tangente);
+        c.masaT = 1.0 / (invMasa[c.a] + imB +
+                         invInercia[c.a] * (magnitud2(ra) - rtA*rtA) +
+                         iiB * (magnitud2(rb) - rtB*rtB));
+        c.sesgo = std::min(kMaxSesgo, -kSesgo * invDt *
+                                      std::min(0.0, c.separacion + kPenetracionPermitida));
+
+        aplicar(c, ra, rb, c.normal * c.pn + tangente * c.pt);
+    }
+
+    for (int it = 0; it < kIteraciones; ++it) {
+        for (int k = 0; k < nContactos; ++k) {
+            Contacto &c = m_contactos[contactos[k]];
+            const Vector2D ra = c.punto - centro(c.a);
+            const Vector2D rb = c.b >= 0 ? c.punto - centro(c.b) : Vector2D(0, 0);
+
+            Vector2D dv = velocidad(c.b, rb) - velocidad(c.a, ra);
+            double dPn = c.masaN * (-productoPunto(dv, c.normal) + c.sesgo);
+            const double pn0 = c.pn;
+            c.pn = std::max(pn0 + dPn, 0.0);
+            aplicar(c, ra, rb, c.normal * (c.pn - pn0));
+
+            const Vector2D tangente(c.normal.y, -c.normal.x);
+            dv = velocidad(c.b, rb) - velocidad(c.a, ra);
+            const double dPt = c.masaT * -productoPunto(dv, tangente);
+            const double maxPt = kFriccion * c.pn;
+            const double pt0 = c.pt;
+            c.pt = limitar(pt0 + dPt, -maxPt, maxPt);
+            aplicar(c, ra, rb, tangente * (c.pt - pt0));
+        }
+    }
+
+    // Avance y reposo: la isla entera se duerme o sigue despierta.
+    double minQuieto = kTiempoDormir, minDespierto = kMaxDespierto;
+    for (int k = 0; k < nCuerpos; ++k) {
+        const int b = cuerpos[k];
+        x[b] += vx[b] * dt;
+        y[b] += vy[b] * dt;
+        angulo[b] += w[b] * dt;
+
+        despierto[b] += dt;
+        if (vx[b]*vx[b] + vy[b]*vy[b] < kVelocidadQuieto*kVelocidadQuieto &&
+            std::abs(w[b]) < kGiroQuieto)
+            quieto[b] += dt;
+        else
+            quieto[b] = 0.0;
+        minQuieto = std::min(minQuieto, quieto[b]);
+        minDespierto = std::min(minDespierto, despierto[b]);
+    }
+    if (minQuieto >= kTiempoDormir || minDespierto >= kMaxDespierto) {
+        for (int k = 0; k < nCuerpos; ++k) {
+            const int b = cuerpos[k];
+            dormido[b] = 1;
+            vx[b] = vy[b] = w[b] = 0.0;
+            quieto[b] = 0.0;
+        }
+    }
+}
+
+void Escombros::paso(double dt, double gravedad, const Entorno &entorno)
+{
+    if (m_despiertos == 0 || dt <= 0.0) return;
+    asegurarRejilla();
+    generarContactos(entorno);
+
+    // Islas: cuerpos despiertos agrupados por raiz (la raiz es el menor
+    // indice, asi el orden no depende de como se recorrieron).
+    const int n = tamano();
+    m_islaDe.assign(n, -1);
+    m_numIslas = 0;
+    m_inicioCuerpos.clear();
+    for (int i = 0; i < n; ++i) {
+        if (dormido[i]) continue;
+        const int r = raiz(i);
+        if (m_islaDe[r] < 0) {
+            m_islaDe[r] = m_numIslas++;
+            m_inicioCuerpos.push_back(0);
+        }
+        m_islaDe[i] = m_islaDe[r];
+        ++m_inicioCuerpos[m_islaDe[i]];
+    }
+    m_inicioCuerpos.push_back(0);
+    m_inicioContactos.assign(m_numIslas + 1, 0);
+    for (const Contacto &c : m_contactos)
+        ++m_inicioContactos[m_islaDe[c.a]];
+
+    // Sumas acumuladas y reparto (cuerpos y contactos en orden creciente).
+    auto repartir = [](std::vector<int> &inicio) {
+        int suma = 0;
+        for (int &v : inicio) { const int c = v; v = suma; suma += c; }
+    };
+    repartir(m_inicioCuerpos);
+    repartir(m_inicioContactos);
+    m_cuerposIsla.resize(m_inicioCuerpos.back());
+    m_contactosIsla.resize(m_contactos.size());
+    {
+        std::vector<int> &llenos = m_cola;   // ya no se usa en este paso
+        llenos.assign(m_inicioCuerpos.begin(), m_inicioCuerpos.end() - 1);
+        for (int i = 0; i < n; ++i)
+            if (!dormido[i]) m_cuerposIsla[llenos[m_islaDe[i]]++] = i;
+        llenos.assign(m_inicioContactos.begin(), m_inicioContactos.end() - 1);
+        for (int k = 0; k < int(m_contactos.size()); ++k)
+            m_contactosIsla[llenos[m_islaDe[m_contactos[k].a]]++] = k;
+    }
+
+    const std::function<void(int)> tarea = [&](int isla) {
+        resolverIsla(isla, dt, gravedad);
+    };
+    if (m_numIslas < 2 || int(m_contactos.size()) < kContactosParalelo ||
+        !GrupoHilos::compartido().repartir(m_numIslas, tarea)) {
+        for (int isla = 0; isla < m_numIslas; ++isla)
+            resolverIsla(isla, dt, gravedad);
+    }
+
+    // Cajas y rejilla de los que se movieron; contactos para el siguiente
+    // paso, ordenados para buscarlos.
+    m_despiertos = 0;
+    for (int k = 0; k < int(m_cuerposIsla.size()); ++k) {
+        const int i = m_cuerposIsla[k];
+        m_cajas[i] = caja(i);
+        if (!m_rejilla.insertar(i, m_cajas[i]))
+            m_rejillaSucia = true;
+        if (!dormido[i]) ++m_despiertos;
+    }
+    if (m_hayAplastados) {
+        for (int i = 0; i < tamano(); ++i)
+            if (m_aplastado[i] && !dormido[i]) --m_despiertos;
+        quitarAplastados();
+    }
+    m_anteriores.swap(m_contactos);
+    std::sort(m_anteriores.begin(), m_anteriores.end(), [](const Contacto &p, const Contacto &q) {
+        return std::tie(p.a, p.b, p.rasgo) < std::tie(q.a, q.b, q.rasgo);
+    });
+}
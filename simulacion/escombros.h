@@ -0,0 +1,140 @@
+#ifndef ESCOMBROS_H
+#define ESCOMBROS_H
+
+#include <cstdint>
+#include <vector>
+#include "vector2d.h"
+#include "rejillabloques.h"
+
+struct RectMundo;
+class Terreno;
+
+// Escombros:
+//  - Los pedazos de los bloques destruidos: cajas rigidas (con giro) que
+//    caen, se apilan y se quedan quietas. Estructura de arreglos con un
+//    indice comun, como AlmacenProyectiles.
+//  - Cada paso: fase amplia con una RejillaBloques sobre las cajas de los
+//    cuerpos, contactos caja contra caja (eje de separacion y recorte de
+//    la arista incidente) y contra lo que no se mueve (suelo, paredes,
+//    bloques, rivales y plataformas), e impulsos secuenciales con
+//    arranque en caliente. Contra el terreno destructible se prueban las
+//    esquinas y los puntos medios de los lados.
+//  - Islas: cuerpos unidos por contactos. Cuando todos los de una isla
+//    llevan un rato quietos se duerme entera y deja de costar; se
+//    despierta cuando algo la toca (un proyectil, un cuerpo despierto o
+//    un bloque de debajo que desaparece o se mueve).
+//  - Un pedazo que queda aplastado contra un bloque (uno que cae no
+//    empuja a los escombros) desaparece en vez de salir disparado.
+//  - Un pedazo que toca uno de los fijos que quitan (los rivales) tambien
+//    desaparece: apilados encima los taparian para siempre y ningun
+//    disparo podria alcanzarlos.
+//  - Las islas despiertas no comparten cuerpos: se resuelven en paralelo
+//    en un grupo fijo de hilos. Una isla da el mismo resultado en
+//    cualquier hilo, asi que la simulacion no depende del numero de
+//    nucleos (el registro de partidas se reproduce igual).
+class Escombros
+{
+public:
+    static constexpr int kMaxCuerpos = 3000;
+
+    // Lo que no se mueve y contra lo que chocan los escombros.
+    struct Entorno {
+        double ancho{0.0};
+        double suelo{0.0};
+        const std::vector<RectMundo> *bloques{nullptr};
+        RejillaBloques *rejilla{nullptr};     // bloques vivos
+        const RectMundo *fijos{nullptr};      // rivales y plataformas
+        int numFijos{0};
+        int numQuitan{0};                     // los ultimos de 'fijos' (rivales)
+        const Terreno *terreno{nullptr};      // o nada: solo el suelo plano
+    };
+
+    std::vector<double> x, y, angulo;       // centro y giro (radianes)
+    std::vector<double> vx, vy, w;
+    std::vector<double> semiAncho, semiAlto;
+    std::vector<double> invMasa, invInercia;
+    std::vector<double> quieto;             // segundos seguidos casi sin moverse
+    std::vector<double> despierto;          // segundos desde que desperto
+    std::vector<std::uint8_t> dormido;
+
+    int  tamano() const { return int(x.size()); }
+    bool vacio() const { return x.empty(); }
+    bool hayDespiertos() const { return m_despiertos > 0; }
+
+    void limpiar();
+    // Tamaño del mundo para la rejilla de los cuerpos.
+    void fijarLimites(double ancho, double alto);
+    // Caja de semilados (hx, hy) centrada en 'centro'. Devuelve -1 si ya
+    // hay kMaxCuerpos.
+    int agregar(const Vector2D &centro, double hx, double hy,
+                const Vector2D &vel, double giro, double densidad);
+
+    // Despierta los cuerpos cuya caja toca la zona.
+    void despertarEn(const RectMundo &zona);
+    // Detiene todo (fin de partida).
+    void dormirTodos();
+
+    void paso(double dt, double gravedad, const Entorno &entorno);
+
+    // --- para los proyectiles ---
+    RectMundo caja(int i) const;          // caja alineada que contiene al cuerpo
+    Vector2D esquina(int i, int k) const; // k = 0..3, en sentido horario
+    // Agrega a 'salida' los cuerpos cuya caja toca el rectangulo.
+    void consultar(double x0, double y0, double x1, double y1,
+                   std::vector<int> &salida);
+    // Barrido de un circulo contra el cuerpo girado (ver barridoCirculoRect).
+    bool barrerCirculo(int i, const Vector2D &p0, const Vector2D &d, double r,
+                       double &t, Vector2D &normal) const;
+    Vector2D velocidadEn(int i, const Vector2D &punto) const;
+    // Impulso en un punto del cuerpo; lo despierta.
+    void golpear(int i, const Vector2D &punto, const Vector2D &impulso);
+
+private:
+    struct Contacto {
+        int a{0};
+        int b{0};                 // cuerpo, o < 0: estatico (ver escombros.cpp)
+        std::uint32_t rasgo{0};   // aristas que lo generan (arranque en caliente)
+        Vector2D punto;
+        Vector2D normal;          // de a hacia b
+        double separacion{0.0};
+        double pn{0.0}, pt{0.0};  // impulsos acumulados
+        double masaN{0.0}, masaT{0.0}, sesgo{0.0};
+    };
+
+    void generarContactos(const Entorno &entorno);
+    void agregarContactos(int a, int b, const Vector2D &cb, double angB,
+                          double hxB, double hyB);
+    void agregarContactosTerreno(int a, const Terreno &terreno);
+    void agregarContacto(Contacto c);
+    void resolverIsla(int isla, double dt, double gravedad);
+    int  raiz(int i);
+    void unir(int a, int b);
+    void quitarAplastados();
+    void eliminar(int i);
+    void asegurarRejilla();
+
+    std::vector<Contacto> m_contactos;
+    std::vector<Contacto> m_anteriores;     // del paso anterior, ordenados
+    std::vector<int> m_cola;
+    std::vector<std::uint8_t> m_procesado;
+    std::vector<int> m_padre;               // union-find de islas
+    std::vector<std::uint8_t> m_aplastado;
+    bool m_hayAplastados{false};
+
+    // Islas del paso: cuerpos y contactos de cada una, contiguos.
+    std::vector<int> m_islaDe;
+    std::vector<int> m_cuerposIsla, m_inicioCuerpos;
+    std::vector<int> m_contactosIsla, m_inicioContactos;
+    int m_numIslas{0};
+
+    RejillaBloques m_rejilla;
+    std::vector<RectMundo> m_cajas;
+    std::vector<std::uint8_t> m_ninguno;    // "destruido" siempre 0 para la rejilla
+    bool   m_rejillaSucia{true};
+    double m_ancho{0.0};
+    double m_alto{0.0};
+    int    m_despiertos{0};
+    std::vector<int> m_candidatos;
+};
+
+#endif // ESCOMBROS_H
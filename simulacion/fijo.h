@@ -0,0 +1,98 @@
+#ifndef FIJO_H
+#define FIJO_H
+
+#include <cmath>
+#include <cstdint>
+
+// Fijo:
+//  - Numero en coma fija con signo: 64 bits, los 16 de abajo son la parte
+//    fraccionaria (paso de 1/65536, unos 0.000015 px). Cubre de sobra un
+//    mundo de miles de pixeles y velocidades de miles de px/s.
+//  - Solo usa aritmetica entera: el mismo calculo da los mismos bits en
+//    cualquier procesador y compilador, sin depender de FMA, de la libm ni
+//    de opciones de coma flotante.
+//  - Redondea hacia abajo (como >> sobre el valor exacto) al multiplicar,
+//    hacia cero al dividir y al sacar la raiz.
+//  - Sirve de escalar para Vector2DT y AlmacenProyectilesT.
+class Fijo
+{
+public:
+    static constexpr int kBitsFraccion = 16;
+    static constexpr std::int64_t kUno = std::int64_t(1) << kBitsFraccion;
+
+    constexpr Fijo() = default;
+    constexpr Fijo(int v) : m_crudo(std::int64_t(v) * kUno) {}
+    // Desde coma flotante, al valor representable mas cercano.
+    explicit Fijo(double v) : m_crudo(std::llround(v * double(kUno))) {}
+
+    static constexpr Fijo desdeCrudo(std::int64_t crudo)
+    {
+        Fijo f;
+        f.m_crudo = crudo;
+        return f;
+    }
+    constexpr std::int64_t crudo() const { return m_crudo; }
+
+    explicit operator double() const { return double(m_crudo) / double(kUno); }
+    explicit operator float() const { return float(double(*this)); }
+
+    constexpr Fijo operator-() const { return desdeCrudo(-m_crudo); }
+
+    Fijo &operator+=(Fijo o) { m_crudo += o.m_crudo; return *this; }
+    Fijo &operator-=(Fijo o) { m_crudo -= o.m_crudo; return *this; }
+    Fijo &operator*=(Fijo o) { *this = *this * o; return *this; }
+    Fijo &operator/=(Fijo o) { *this = *this / o; return *this; }
+
+    friend constexpr Fijo operator+(Fijo a, Fijo b) { return desdeCrudo(a.m_crudo + b.m_crudo); }
+    friend constexpr Fijo operator-(Fijo a, Fijo b) { return desdeCrudo(a.m_crudo - b.m_crudo); }
+
+    // a * b / 2^16 sin enteros de 128 bits: a = alto * 2^16 + bajo, con
+    // 0 <= bajo < 2^16, y cada producto parcial cabe en 64 bits.
+    friend constexpr Fijo operator*(Fijo a, Fijo b)
+    {
+        const std::int64_t alto = a.m_crudo >> kBitsFraccion;
+        const std::int64_t bajo = a.m_crudo & (kUno - 1);
+        return desdeCrudo(alto * b.m_crudo + ((bajo * b.m_crudo) >> kBitsFraccion));
+    }
+    // Dividir por cero es un error del llamador, como con los enteros.
+    friend constexpr Fijo operator/(Fijo a, Fijo b)
+    {
+        return desdeCrudo(a.m_crudo * kUno / b.m_crudo);
+    }
+
+    friend constexpr bool operator==(Fijo a, Fijo b) { return a.m_crudo == b.m_crudo; }
+    friend constexpr bool operator!=(Fijo a, Fijo b) { return a.m_crudo != b.m_crudo; }
+    friend constexpr bool operator<(Fijo a, Fijo b)  { return a.m_crudo <  b.m_crudo; }
+    friend constexpr bool operator>(Fijo a, Fijo b)  { return a.m_crudo >  b.m_crudo; }
+    friend constexpr bool operator<=(Fijo a, Fijo b) { return a.m_crudo <= b.m_crudo; }
+    friend constexpr bool operator>=(Fijo a, Fijo b) { return a.m_crudo >= b.m_crudo; }
+
+private:
+    std::int64_t m_crudo{0};
+};
+
+// Raiz cuadrada exacta por bits (la parte entera de la raiz del valor
+// crudo desplazado), para valores por debajo de 2^32; 0 para negativos.
+// Se llama sqrt para que magnitud() la encuentre igual que std::sqrt.
+inline Fijo sqrt(Fijo v)
+{
+    if (v.crudo() <= 0)
+        return Fijo();
+    std::uint64_t resto = std::uint64_t(v.crudo()) << Fijo::kBitsFraccion;
+    std::uint64_t raiz = 0;
+    std::uint64_t bit = std::uint64_t(1) << 62;
+    while (bit > resto)
+        bit >>= 2;
+    while (bit != 0) {
+        if (resto >= raiz + bit) {
+            resto -= raiz + bit;
+            raiz = (raiz >> 1) + bit;
+        } else {
+            raiz >>= 1;
+        }
+        bit >>= 2;
+    }
+    return Fijo::desdeCrudo(std::int64_t(raiz));
+}
+
+#endif // FIJO_H
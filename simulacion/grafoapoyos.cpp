@@ -0,0 +1,242 @@
+#include "grafoapoyos.h"
+#include "mundosimulacion.h"
+#include "rejillabloques.h"
+#include "terreno.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Tolerancia para considerar que dos caras se tocan (px).
+constexpr double kContacto = 0.5;
+
+void quitarDe(std::vector<int> &lista, int valor)
+{
+    auto it = std::find(lista.begin(), lista.end(), valor);
+    if (it != lista.end()) lista.erase(it);
+}
+
+} // namespace
+
+void GrafoApoyos::construir(const std::vector<RectMundo> &rects,
+                            const std::vector<std::uint8_t> &destruido,
+                            const RectMundo *fijos, int numFijos,
+                            double suelo, double ancho, RejillaBloques &rejilla,
+                            const Terreno *terreno)
+{
+    const int n = int(rects.size());
+    m_debajo.assign(n, {});
+    m_encima.assign(n, {});
+    m_cae.assign(n, 0);
+    m_tramoSuelo.assign(n, {0.0, 0.0});
+    m_costadoTerreno.assign(n, 0);
+    m_pendientes = {};
+
+    m_suelo = suelo;
+    m_ancho = ancho;
+    m_fijos.clear();
+    for (int k = 0; k < numFijos; ++k)
+        m_fijos.push_back({fijos[k].izquierda(), fijos[k].derecha(),
+                           fijos[k].arriba(), fijos[k].abajo()});
+
+    for (int i = 0; i < n; ++i)
+        if (!destruido[i])
+            buscarApoyos(i, rects, destruido, rejilla, terreno);
+}
+
+// Tramo del suelo bajo la cara inferior: el bloque entero sobre el suelo
+// plano o las celdas llenas de la fila de debajo del terreno. Tambien mira
+// si tiene terreno pegado a un costado (se recuesta en el, como en una
+// pared).
+bool GrafoApoyos::medirSuelo(int bloque, const RectMundo &r, const Terreno *terreno)
+{
+    const double kCostado = 1.5;   // px: un paso de deslizamiento frena a 1 px
+    std::uint8_t &costado = m_costadoTerreno[bloque];
+    costado = 0;
+    if (terreno) {
+        if (terreno->hayEnRect(r.izquierda() - kCostado, r.arriba(), r.izquierda(), r.abajo() - 1.0))
+            costado |= 1;
+        if (terreno->hayEnRect(r.derecha(), r.arriba(), r.derecha() + kCostado, r.abajo() - 1.0))
+            costado |= 2;
+    }
+
+    std::pair<double, double> &tramo = m_tramoSuelo[bloque];
+    if (std::abs(r.abajo() - m_suelo) <= kContacto) {
+        tramo = {r.izquierda(), r.derecha()};
+        return true;
+    }
+    return terreno && terreno->tramoEnFila(int(std::floor(r.abajo() + kContacto)),
+                                           r.izquierda(), r.derecha(),
+                                           tramo.first, tramo.second);
+}
+
+// Lo que toca la cara inferior del bloque (suelo, apoyos fijos y bloques
+// vivos que no estan cayendo) y los bloques que tiene pegados a los lados,
+// en los que se recuesta si vuelca.
+void GrafoApoyos::buscarApoyos(int bloque, const std::vector<RectMundo> &rects,
+                               const std::vector<std::uint8_t> &destruido,
+                               RejillaBloques &rejilla, const Terreno *terreno)
+{
+    const RectMundo &r = rects[bloque];
+    std::vector<int> &debajo = m_debajo[bloque];
+    debajo.clear();
+
+    auto solapa = [&](double izquierda, double derecha) {
+        return std::min(r.derecha(), derecha) - std::max(r.izquierda(), izquierda) > kContacto;
+    };
+    auto alCostado = [&](double izquierda, double derecha, double arriba, double abajo) {
+        return std::min(r.abajo(), abajo) - std::max(r.arriba(), arriba) > kContacto &&
+               (std::abs(derecha - r.izquierda()) <= kContacto ||
+                std::abs(izquierda - r.derecha()) <= kContacto);
+    };
+
+    if (medirSuelo(bloque, r, terreno))
+        debajo.push_back(kSuelo);
+
+    for (int k = 0; k < int(m_fijos.size()); ++k) {
+        const ApoyoFijo &f = m_fijos[k];
+        if ((std::abs(r.abajo() - f.arriba) <= kContacto && solapa(f.izquierda, f.derecha)) ||
+            alCostado(f.izquierda, f.derecha, f.arriba, f.abajo))
+            debajo.push_back(apoyoFijo(k));
+    }
+
+    m_candidatos.clear();
+    rejilla.consultar(r.izquierda() - kContacto, r.arriba(),
+                      r.derecha() + kContacto, r.abajo() + kContacto, m_candidatos);
+    for (int j : m_candidatos) {
+        const RectMundo &q = rects[j];
+        if (j == bloque || destruido[j] || m_cae[j]) continue;
+        if ((std::abs(r.abajo() - q.arriba()) <= kContacto && solapa(q.izquierda(), q.derecha())) ||
+            alCostado(q.izquierda(), q.derecha(), q.arriba(), q.abajo())) {
+            debajo.push_back(j);
+            m_encima[j].push_back(bloque);
+        }
+    }
+}
+
+// Desengancha el bloque de lo que tenia debajo.
+void GrafoApoyos::soltar(int bloque)
+{
+    for (int j : m_debajo[bloque])
+        if (j >= 0) quitarDe(m_encima[j], bloque);
+    m_debajo[bloque].clear();
+}
+
+// Ademas deja de sostener: lo que tenia encima queda pendiente de revisar.
+void GrafoApoyos::desenganchar(int bloque, const std::vector<RectMundo> &rects)
+{
+    soltar(bloque);
+    for (int a : m_encima[bloque]) {
+        quitarDe(m_debajo[a], bloque);
+        m_pendientes.push({rects[a].abajo(), a});
+    }
+    m_encima[bloque].clear();
+}
+
+void GrafoApoyos::quitar(int bloque, const std::vector<RectMundo> &rects,
+                         std::vector<int> &caen)
+{
+    if (bloque < 0 || bloque >= int(m_debajo.size())) return;
+
+    desenganchar(bloque, rects);
+    m_cae[bloque] = 0;
+    propagar(rects, caen);
+}
+
+void GrafoApoyos::terrenoExcavado(const std::vector<int> &bloques,
+                                  const std::vector<RectMundo> &rects,
+                                  const Terreno &terreno, std::vector<int> &caen)
+{
+    for (int b : bloques) {
+        if (b < 0 || b >= int(m_debajo.size()) || m_cae[b]) continue;
+        std::vector<int> &debajo = m_debajo[b];
+        const bool enSuelo = std::find(debajo.begin(), debajo.end(), kSuelo) != debajo.end();
+        if (!enSuelo && m_costadoTerreno[b] == 0) continue;
+        if (!medirSuelo(b, rects[b], &terreno) && enSuelo)
+            quitarDe(debajo, kSuelo);
+        m_pendientes.push({rects[b].abajo(), b});
+    }
+    propagar(rects, caen);
+}
+
+// De abajo hacia arriba: cuando se revisa un bloque, todo lo que tiene
+// debajo ya esta decidido. Lo que cae suelta a lo que sostenia.
+void GrafoApoyos::propagar(const std::vector<RectMundo> &rects, std::vector<int> &caen)
+{
+    while (!m_pendientes.empty()) {
+        const int a = m_pendientes.top().second;
+        m_pendientes.pop();
+        if (m_cae[a] || vuelco(a, rects) == 0) continue;
+
+        m_cae[a] = 1;
+        caen.push_back(a);
+        desenganchar(a, rects);
+    }
+}
+
+bool GrafoApoyos::asentar(int bloque, const std::vector<RectMundo> &rects,
+                          const std::vector<std::uint8_t> &destruido,
+                          RejillaBloques &rejilla, int &vuelco,
+                          const Terreno *terreno, bool trabado)
+{
+    m_cae[bloque] = 0;
+    buscarApoyos(bloque, rects, destruido, rejilla, terreno);
+
+    vuelco = this->vuelco(bloque, rects);
+    if (vuelco == 0 || (trabado && vuelco != kSinApoyo)) {
+        vuelco = 0;
+        return true;
+    }
+    if (vuelco == kSinApoyo)
+        vuelco = 0;
+
+    soltar(bloque);
+    m_cae[bloque] = 1;
+    return false;
+}
+
+// El tramo que cubren los apoyos de debajo (cada uno hasta donde solapa
+// con el bloque) debe contener el centro del bloque. Si no, vuelca hacia
+// el lado del centro, salvo que de ese lado tenga una pared o un bloque
+// donde recostarse.
+int GrafoApoyos::vuelco(int bloque, const std::vector<RectMundo> &rects) const
+{
+    const RectMundo &r = rects[bloque];
+    double desde = r.derecha(), hasta = r.izquierda();
+    bool hayDebajo = false;
+    bool recostadoIzq = r.izquierda() <= kContacto || (m_costadoTerreno[bloque] & 1);
+    bool recostadoDer = r.derecha() >= m_ancho - kContacto || (m_costadoTerreno[bloque] & 2);
+
+    for (int j : m_debajo[bloque]) {
+        double izquierda, derecha, arriba;
+        if (j == kSuelo) {
+            izquierda = m_tramoSuelo[bloque].first;
+            derecha   = m_tramoSuelo[bloque].second;
+            arriba    = r.abajo();
+        } else if (j >= 0) {
+            izquierda = rects[j].izquierda();
+            derecha   = rects[j].derecha();
+            arriba    = rects[j].arriba();
+        } else {
+            const ApoyoFijo &f = m_fijos[std::size_t(-2 - j)];
+            izquierda = f.izquierda;
+            derecha   = f.derecha;
+            arriba    = f.arriba;
+        }
+        if (std::abs(r.abajo() - arriba) > kContacto) {
+            // Pegado a un costado.
+            if (izquierda + derecha < r.izquierda() + r.derecha()) recostadoIzq = true;
+            else                                                   recostadoDer = true;
+            continue;
+        }
+        desde = std::min(desde, std::max(izquierda, r.izquierda()));
+        hasta = std::max(hasta, std::min(derecha, r.derecha()));
+        hayDebajo = true;
+    }
+
+    if (!hayDebajo) return kSinApoyo;
+    const double centro = r.centro().x;
+    if (centro < desde && !recostadoIzq) return -1;
+    if (centro > hasta && !recostadoDer) return 1;
+    return 0;
+}
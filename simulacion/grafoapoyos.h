@@ -0,0 +1,100 @@
+#ifndef GRAFOAPOYOS_H
+#define GRAFOAPOYOS_H
+
+#include <cstdint>
+#include <queue>
+#include <utility>
+#include <vector>
+
+struct RectMundo;
+class RejillaBloques;
+class Terreno;
+
+// GrafoApoyos:
+//  - Quien sostiene a quien: un bloque se apoya en los bloques cuya cara
+//    superior toca su cara inferior (con solape horizontal), en el suelo
+//    o en un apoyo fijo (plataformas y rivales, que no se caen). Con
+//    terreno destructible el suelo es lo que quede de el bajo el bloque,
+//    y el terreno de un costado hace de pared.
+//  - Un bloque se sostiene si el tramo horizontal que cubren sus apoyos
+//    contiene su centro; si no, vuelca hacia el lado de su centro (un
+//    techo con una sola columna en el borde se desliza fuera de ella y
+//    cae) salvo que se recueste en una pared o en un bloque pegado a ese
+//    costado.
+//  - Al destruirse un bloque solo se revisan los que se apoyaban en el,
+//    de abajo hacia arriba, y la revision se corta en cuanto un bloque sigue
+//    sostenido: el coste depende de lo que se derrumba, no del nivel.
+class GrafoApoyos
+{
+public:
+    // Apoyos que no son bloques (indices negativos en las listas).
+    static constexpr int kSuelo = -1;
+    static int apoyoFijo(int k) { return -2 - k; }
+
+    // Arma el grafo de todos los bloques vivos. 'fijos' son los apoyos
+    // que nunca caen; la rejilla debe tener los bloques vivos. Un bloque
+    // que vuelca contra una pared (x = 0 o x = ancho) queda apoyado en ella.
+    // Con 'terreno', un bloque tambien se apoya en las celdas llenas que
+    // toca su cara inferior.
+    void construir(const std::vector<RectMundo> &rects,
+                   const std::vector<std::uint8_t> &destruido,
+                   const RectMundo *fijos, int numFijos,
+                   double suelo, double ancho, RejillaBloques &rejilla,
+                   const Terreno *terreno = nullptr);
+
+    // El bloque desaparece: deja de sostener y de apoyarse. Agrega a
+    // 'caen' los bloques que se quedan sin sostén (de abajo hacia arriba).
+    void quitar(int bloque, const std::vector<RectMundo> &rects,
+                std::vector<int> &caen);
+
+    // Intenta asentar un bloque que cae sobre lo que toca debajo. Si eso
+    // no lo sostiene devuelve false, el bloque sigue cayendo y 'vuelco'
+    // dice hacia donde se va de lo que toca (-1 o +1; 0 si no toca nada).
+    // Con 'trabado' se queda aunque vuelque, con tal de que toque algo
+    // debajo (un bloque encajado que ya no sabe hacia donde deslizarse).
+    bool asentar(int bloque, const std::vector<RectMundo> &rects,
+                 const std::vector<std::uint8_t> &destruido,
+                 RejillaBloques &rejilla, int &vuelco,
+                 const Terreno *terreno = nullptr, bool trabado = false);
+
+    // Se excavo el terreno bajo estos bloques: se vuelve a medir el tramo
+    // en que se apoyan en el y se agregan a 'caen' los que (con lo que
+    // tenian encima) ya no se sostienen.
+    void terrenoExcavado(const std::vector<int> &bloques,
+                         const std::vector<RectMundo> &rects,
+                         const Terreno &terreno, std::vector<int> &caen);
+
+    bool cae(int bloque) const { return m_cae[bloque] != 0; }
+    const std::vector<int> &apoyos(int bloque) const { return m_debajo[bloque]; }
+
+private:
+    void buscarApoyos(int bloque, const std::vector<RectMundo> &rects,
+                      const std::vector<std::uint8_t> &destruido,
+                      RejillaBloques &rejilla, const Terreno *terreno);
+    bool medirSuelo(int bloque, const RectMundo &r, const Terreno *terreno);
+    void soltar(int bloque);
+    void desenganchar(int bloque, const std::vector<RectMundo> &rects);
+    void propagar(const std::vector<RectMundo> &rects, std::vector<int> &caen);
+    // 0 si se sostiene; si no, hacia donde vuelca o kSinApoyo.
+    static constexpr int kSinApoyo = 2;
+    int vuelco(int bloque, const std::vector<RectMundo> &rects) const;
+
+    std::vector<std::vector<int>> m_debajo;   // en que se apoya (debajo o al costado)
+    std::vector<std::vector<int>> m_encima;   // que bloques sostiene
+    std::vector<std::uint8_t>     m_cae;
+    // Tramo del suelo que sostiene a cada bloque apoyado en kSuelo (todo
+    // el bloque sobre el suelo plano; parte, sobre el terreno).
+    std::vector<std::pair<double, double>> m_tramoSuelo;
+    std::vector<std::uint8_t>     m_costadoTerreno;   // 1: izquierda, 2: derecha
+
+    struct ApoyoFijo { double izquierda, derecha, arriba, abajo; };
+    std::vector<ApoyoFijo> m_fijos;
+    double m_suelo{0.0};
+    double m_ancho{0.0};
+
+    // Pendientes de revisar, el mas bajo primero (mayor 'abajo').
+    std::priority_queue<std::pair<double, int>> m_pendientes;
+    std::vector<int> m_candidatos;
+};
+
+#endif // GRAFOAPOYOS_H
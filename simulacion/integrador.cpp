@@ -0,0 +1,82 @@
+#include "integrador.h"
+#include <algorithm>    // std::max
+
+EstadoVuelo avanzarVuelo(Integrador metodo, const ModeloFuerzas &f,
+                         double coef, const EstadoVuelo &e, double dt)
+{
+    switch (metodo) {
+    case Integrador::EulerSemiImplicito: {
+        const Vector2D v = e.v + f.aceleracion(e.p, e.v, coef) * dt;
+        return {e.p + v * dt, v};
+    }
+    case Integrador::Verlet: {
+        // La fuerza depende de la velocidad: la del final del paso se
+        // evalua con la velocidad predicha por Euler.
+        const Vector2D a0 = f.aceleracion(e.p, e.v, coef);
+        const Vector2D p  = e.p + e.v * dt + a0 * (0.5 * dt * dt);
+        const Vector2D a1 = f.aceleracion(p, e.v + a0 * dt, coef);
+        return {p, e.v + (a0 + a1) * (0.5 * dt)};
+    }
+    case Integrador::RK4: {
+        const double h = 0.5 * dt;
+        const Vector2D k1p = e.v;
+        const Vector2D k1v = f.aceleracion(e.p, e.v, coef);
+        const Vector2D k2p = e.v + k1v * h;
+        const Vector2D k2v = f.aceleracion(e.p + k1p * h, k2p, coef);
+        const Vector2D k3p = e.v + k2v * h;
+        const Vector2D k3v = f.aceleracion(e.p + k2p * h, k3p, coef);
+        const Vector2D k4p = e.v + k3v * dt;
+        const Vector2D k4v = f.aceleracion(e.p + k3p * dt, k4p, coef);
+        const double sexto = dt / 6.0;
+        return {e.p + (k1p + (k2p + k3p) * 2.0 + k4p) * sexto,
+                e.v + (k1v + (k2v + k3v) * 2.0 + k4v) * sexto};
+    }
+    }
+    return e;
+}
+
+double errorTrayectoria(Integrador metodo, const ModeloFuerzas &f,
+                        double coef, double dt, double duracion)
+{
+    constexpr int kSubpasos = 64;
+    const EstadoVuelo inicio{Vector2D(0.0, f.suelo - 50.0),
+                             Vector2D(1.0, -1.0) * (300.0 / std::sqrt(2.0))};
+    const double dtFino = dt / kSubpasos;
+
+    EstadoVuelo prueba = inicio;
+    EstadoVuelo exacta = inicio;
+    double error = 0.0;
+    const int pasos = int(duracion / dt + 0.5);
+    for (int i = 0; i < pasos; ++i) {
+        prueba = avanzarVuelo(metodo, f, coef, prueba, dt);
+        for (int s = 0; s < kSubpasos; ++s)
+            exacta = avanzarVuelo(Integrador::RK4, f, coef, exacta, dtFino);
+        error = std::max(error, magnitud(prueba.p - exacta.p));
+    }
+    return error;
+}
+
+double elegirPaso(Integrador metodo, const ModeloFuerzas &f, double coef,
+                  double tolerancia, const double *candidatos, int n)
+{
+    double mejor = 0.0;
+    double menor = 0.0;
+    for (int i = 0; i < n; ++i) {
+        const double dt = candidatos[i];
+        if (menor == 0.0 || dt < menor)
+            menor = dt;
+        if (dt > mejor && errorTrayectoria(metodo, f, coef, dt) <= tolerancia)
+            mejor = dt;
+    }
+    return mejor > 0.0 ? mejor : menor;
+}
+
+const char *nombreIntegrador(Integrador metodo)
+{
+    switch (metodo) {
+    case Integrador::EulerSemiImplicito: return "euler";
+    case Integrador::Verlet:             return "verlet";
+    case Integrador::RK4:                return "rk4";
+    }
+    return "?";
+}
@@ -0,0 +1,70 @@
+#ifndef INTEGRADOR_H
+#define INTEGRADOR_H
+
+#include <cstdint>
+#include "vector2d.h"
+
+// Metodo con que avanza un proyectil en vuelo (se elige por partida).
+enum class Integrador : std::uint8_t {
+    EulerSemiImplicito,   // v += a dt; p += v dt. Primer orden, el de siempre
+    Verlet,               // Verlet de velocidades, segundo orden
+    RK4                   // Runge-Kutta clasico, cuarto orden
+};
+
+// ModeloFuerzas:
+//  - Aceleracion de un proyectil en vuelo: gravedad, arrastre cuadratico
+//    contra el aire y viento.
+//  - El arrastre sobre un proyectil de radio r y masa m es
+//    -arrastre * r²/m * |v - w| (v - w), con w el viento donde esta.
+//  - El viento sopla entero en lo alto del mundo (y = 0) y se apaga
+//    linealmente hasta el suelo. Sin arrastre no empuja: el vuelo vuelve
+//    a ser la parabola exacta.
+struct ModeloFuerzas {
+    double   gravedad{200.0};
+    double   arrastre{0.0};
+    Vector2D viento;          // en y = 0 (px/s)
+    double   suelo{1.0};      // y donde el viento se anula
+
+    bool soloGravedad() const { return arrastre == 0.0; }
+    double coefArrastre(double radio, double masa) const
+    {
+        return arrastre * radio * radio / masa;
+    }
+    Vector2D vientoEn(double y) const
+    {
+        return viento * limitar(1.0 - y / suelo, 0.0, 1.0);
+    }
+    // 'coef' es coefArrastre() del proyectil.
+    Vector2D aceleracion(const Vector2D &p, const Vector2D &v, double coef) const
+    {
+        const Vector2D relativa = v - vientoEn(p.y);
+        return Vector2D(0.0, gravedad) - relativa * (coef * magnitud(relativa));
+    }
+};
+
+struct EstadoVuelo {
+    Vector2D p;
+    Vector2D v;
+};
+
+// Un paso dt del metodo dado.
+EstadoVuelo avanzarVuelo(Integrador metodo, const ModeloFuerzas &fuerzas,
+                         double coef, const EstadoVuelo &e, double dt);
+
+// --- paso elegido por el error medido ---
+
+// Error de un tiro de prueba (45°, 300 px/s, 'duracion' segundos sin
+// choques) integrado con el metodo y el paso dados: la mayor distancia,
+// en px, a la misma trayectoria integrada con RK4 a un paso 64 veces
+// menor, comparando en cada paso.
+double errorTrayectoria(Integrador metodo, const ModeloFuerzas &fuerzas,
+                        double coef, double dt, double duracion = 3.0);
+
+// El mayor de los 'n' pasos candidatos con el que el metodo no se aleja
+// mas que 'tolerancia' px en el tiro de prueba; el menor si ninguno basta.
+double elegirPaso(Integrador metodo, const ModeloFuerzas &fuerzas, double coef,
+                  double tolerancia, const double *candidatos, int n);
+
+const char *nombreIntegrador(Integrador metodo);
+
+#endif // INTEGRADOR_H
@@ -0,0 +1,153 @@
+#include "mensajered.h"
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+void escribir(std::vector<std::uint8_t> &salida, std::uint64_t v, int bytes)
+{
+    for (int i = 0; i < bytes; ++i)
+        salida.push_back(std::uint8_t(v >> (8*i)));
+}
+
+void escribirReal(std::vector<std::uint8_t> &salida, double v)
+{
+    std::uint64_t bits;
+    std::memcpy(&bits, &v, sizeof bits);
+    escribir(salida, bits, 8);
+}
+
+std::uint64_t leer(const std::uint8_t *&p, int bytes)
+{
+    std::uint64_t v = 0;
+    for (int i = 0; i < bytes; ++i)
+        v |= std::uint64_t(p[i]) << (8*i);
+    p += bytes;
+    return v;
+}
+
+double leerReal(const std::uint8_t *&p)
+{
+    const std::uint64_t bits = leer(p, 8);
+    double v;
+    std::memcpy(&v, &bits, sizeof v);
+    return v;
+}
+
+} // namespace
+
+MensajeRed MensajeRed::saludo(std::uint32_t semilla, std::uint64_t huellaNivel)
+{
+    MensajeRed m;
+    m.tipo = Saludo;
+    m.semilla = semilla;
+    m.huella = huellaNivel;
+    return m;
+}
+
+MensajeRed MensajeRed::disparo(std::uint32_t turno, std::uint8_t modo,
+                               double angulo, double velocidad)
+{
+    MensajeRed m;
+    m.tipo = Disparo;
+    m.turno = turno;
+    m.modo = modo;
+    m.angulo = angulo;
+    m.velocidad = velocidad;
+    return m;
+}
+
+MensajeRed MensajeRed::huellaTurno(std::uint32_t turno, std::uint64_t huella)
+{
+    MensajeRed m;
+    m.tipo = Huella;
+    m.turno = turno;
+    m.huella = huella;
+    return m;
+}
+
+MensajeRed MensajeRed::reinicio(std::uint32_t semilla)
+{
+    MensajeRed m;
+    m.tipo = Reinicio;
+    m.semilla = semilla;
+    return m;
+}
+
+bool MensajeRed::disparoValido() const
+{
+    return modo < kModos &&
+           std::isfinite(angulo) && angulo >= kAnguloMin && angulo <= kAnguloMax &&
+           std::isfinite(velocidad) && velocidad >= kVelocidadMin && velocidad <= kVelocidadMax;
+}
+
+std::size_t MensajeRed::tamano(std::uint8_t tipo)
+{
+    switch (tipo) {
+    case Saludo:   return 1 + 2 + 4 + 8;
+    case Disparo:  return 1 + 4 + 1 + 8 + 8;
+    case Huella:   return 1 + 4 + 8;
+    case Reinicio: return 1 + 4;
+    default:       return 0;
+    }
+}
+
+void MensajeRed::codificar(std::vector<std::uint8_t> &salida) const
+{
+    salida.push_back(tipo);
+    switch (tipo) {
+    case Saludo:
+        escribir(salida, version, 2);
+        escribir(salida, semilla, 4);
+        escribir(salida, huella, 8);
+        break;
+    case Disparo:
+        escribir(salida, turno, 4);
+        salida.push_back(modo);
+        escribirReal(salida, angulo);
+        escribirReal(salida, velocidad);
+        break;
+    case Huella:
+        escribir(salida, turno, 4);
+        escribir(salida, huella, 8);
+        break;
+    case Reinicio:
+        escribir(salida, semilla, 4);
+        break;
+    }
+}
+
+int MensajeRed::decodificar(const std::uint8_t *datos, std::size_t tamano,
+                            MensajeRed &mensaje)
+{
+    if (tamano == 0) return 0;
+    const std::size_t necesario = MensajeRed::tamano(datos[0]);
+    if (necesario == 0) return -1;
+    if (tamano < necesario) return 0;
+
+    MensajeRed m;
+    m.tipo = Tipo(datos[0]);
+    const std::uint8_t *p = datos + 1;
+    switch (m.tipo) {
+    case Saludo:
+        m.version = std::uint16_t(leer(p, 2));
+        m.semilla = std::uint32_t(leer(p, 4));
+        m.huella  = leer(p, 8);
+        break;
+    case Disparo:
+        m.turno     = std::uint32_t(leer(p, 4));
+        m.modo      = *p++;
+        m.angulo    = leerReal(p);
+        m.velocidad = leerReal(p);
+        break;
+    case Huella:
+        m.turno  = std::uint32_t(leer(p, 4));
+        m.huella = leer(p, 8);
+        break;
+    case Reinicio:
+        m.semilla = std::uint32_t(leer(p, 4));
+        break;
+    }
+    mensaje = m;
+    return int(necesario);
+}
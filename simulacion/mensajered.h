@@ -0,0 +1,71 @@
+#ifndef MENSAJERED_H
+#define MENSAJERED_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// MensajeRed:
+//  - Lo unico que viaja en una partida en red. Las dos partes simulan la
+//    partida completa (lockstep): solo se mandan las entradas de cada
+//    disparo y, al final de cada turno, la huella del estado
+//    (MundoSimulacion::hashEstado) para notar si se separaron.
+//  - Tamaño fijo segun el tipo; todo little-endian.
+//
+//   'S' Saludo    u16 version, u32 semilla, u64 huella del nivel   15 bytes
+//   'D' Disparo   u32 turno, u8 modo, f64 angulo, f64 velocidad    22 bytes
+//   'H' Huella    u32 turno, u64 huella                            13 bytes
+//   'R' Reinicio  u32 semilla                                       5 bytes
+//
+// 'turno' es el numero de disparo desde que empezo la partida (0, 1, ...)
+// en Disparo, y cuantos disparos van resueltos en Huella.
+struct MensajeRed
+{
+    // 2: la huella cubre tambien el nivel y los parametros fisicos.
+    static constexpr std::uint16_t kVersion = 2;
+
+    // Lo que acepta la interfaz (VentanaPrincipal usa los mismos rangos);
+    // un Disparo fuera de ellos o con otro modo es un error del otro lado.
+    static constexpr double kAnguloMin = 5.0;
+    static constexpr double kAnguloMax = 85.0;
+    static constexpr double kVelocidadMin = 50.0;
+    static constexpr double kVelocidadMax = 300.0;
+    static constexpr std::uint8_t kModos = 4;   // MundoSimulacion::ModoDisparo
+
+    enum Tipo : std::uint8_t {
+        Saludo   = 'S',
+        Disparo  = 'D',
+        Huella   = 'H',
+        Reinicio = 'R'
+    };
+
+    Tipo          tipo{Disparo};
+    std::uint16_t version{kVersion};
+    std::uint32_t turno{0};
+    std::uint8_t  modo{0};
+    double        angulo{0.0};
+    double        velocidad{0.0};
+    std::uint64_t huella{0};
+    std::uint32_t semilla{0};
+
+    static MensajeRed saludo(std::uint32_t semilla, std::uint64_t huellaNivel);
+    static MensajeRed disparo(std::uint32_t turno, std::uint8_t modo,
+                              double angulo, double velocidad);
+    static MensajeRed huellaTurno(std::uint32_t turno, std::uint64_t huella);
+    static MensajeRed reinicio(std::uint32_t semilla);
+
+    // Modo conocido y angulo y velocidad finitos dentro de los rangos.
+    bool disparoValido() const;
+
+    // Agrega el mensaje al final de 'salida'.
+    void codificar(std::vector<std::uint8_t> &salida) const;
+    // Lee un mensaje del principio de 'datos' (lo recibido del flujo).
+    // Devuelve los bytes que ocupa, 0 si aun no llego entero o -1 si el
+    // tipo es desconocido (flujo corrupto: hay que cortar).
+    static int decodificar(const std::uint8_t *datos, std::size_t tamano,
+                           MensajeRed &mensaje);
+    // Bytes de un mensaje de ese tipo (0 si no existe).
+    static std::size_t tamano(std::uint8_t tipo);
+};
+
+#endif // MENSAJERED_H
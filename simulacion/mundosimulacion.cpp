@@ -0,0 +1,1591 @@
+#include "mundosimulacion.h"
+#include "balistica.h"
+#include "perfilador.h"
+#include <algorithm>    // std::min, std::max
+#include <cmath>        // std::
+#include <cstring>      // std::memcpy
+#include <functional>   // std::greater
+
+namespace {
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kTiempoVida = 8.0;   // segundos en vuelo antes de retirarlo
+constexpr double kVelocidadMinima = 10.0;   // mas lento se retira
+constexpr double kPasoDerrumbe = 1.0 / 60.0; // derrumbe tras el salto por eventos
+constexpr int    kMaxPasosDerrumbe = 6000;
+
+// FNV-1a por palabras de 64 bits (con una mezcla extra por palabra): los
+// reales entran con sus bits exactos.
+class Huella
+{
+public:
+    void palabra(std::uint64_t v)
+    {
+        m_h = (m_h ^ v) * 0x100000001B3ull;
+        m_h ^= m_h >> 29;
+    }
+    void real(double v)
+    {
+        std::uint64_t bits;
+        std::memcpy(&bits, &v, sizeof bits);
+        palabra(bits);
+    }
+    void reales(const std::vector<double> &v)
+    {
+        palabra(v.size());
+        for (double x : v) real(x);
+    }
+    std::uint64_t valor() const { return m_h; }
+
+private:
+    std::uint64_t m_h{0xCBF29CE484222325ull};
+};
+}
+
+bool circuloIntersecaRect(const Vector2D &c, double r, const RectMundo &rect)
+{
+    double qx = std::max(rect.izquierda(), std::min(rect.derecha(), c.x));
+    double qy = std::max(rect.arriba(),    std::min(rect.abajo(),   c.y));
+    Vector2D d(c.x - qx, c.y - qy);
+    return magnitud2(d) <= r*r;
+}
+
+// Normal de la cara del rectangulo mas cercana al circulo (para cuando
+// ya se solapan y no hay un instante de contacto que usar).
+static Vector2D normalCaraMasCercana(const Vector2D &c, double r,
+                                     const RectMundo &rect)
+{
+    double distIzq  = std::abs((c.x + r) - rect.izquierda());
+    double distDer  = std::abs((c.x - r) - rect.derecha());
+    double distSup  = std::abs((c.y + r) - rect.arriba());
+    double distInf  = std::abs((c.y - r) - rect.abajo());
+
+    double minDist = std::min(std::min(distIzq, distDer),
+                              std::min(distSup, distInf));
+
+    if (minDist == distIzq)       return Vector2D(-1,0);
+    else if (minDist == distDer)  return Vector2D(1,0);
+    else if (minDist == distSup)  return Vector2D(0,-1);
+    else                          return Vector2D(0,1);
+}
+
+bool barridoCirculoRect(const Vector2D &p0, const Vector2D &d, double r,
+                        const RectMundo &rect, double &t, Vector2D &normal)
+{
+    // Ya se tocan al empezar: contacto inmediato.
+    if (circuloIntersecaRect(p0, r, rect)) {
+        t = 0.0;
+        normal = normalCaraMasCercana(p0, r, rect);
+        return true;
+    }
+
+    // Rayo contra el rectangulo agrandado r por cada lado (metodo de losas).
+    const double bx0 = rect.izquierda() - r, bx1 = rect.derecha() + r;
+    const double by0 = rect.arriba() - r,    by1 = rect.abajo() + r;
+    double tEntrada = 0.0, tSalida = 1.0;
+    Vector2D nEntrada(0,0);
+
+    auto losa = [&](double origen, double despl, double lo, double hi,
+                    const Vector2D &nLo, const Vector2D &nHi){
+        if (std::abs(despl) < 1e-12)
+            return origen >= lo && origen <= hi;
+        double ta = (lo - origen) / despl;
+        double tb = (hi - origen) / despl;
+        Vector2D n = nLo;
+        if (ta > tb) { std::swap(ta, tb); n = nHi; }
+        if (ta > tEntrada) { tEntrada = ta; nEntrada = n; }
+        tSalida = std::min(tSalida, tb);
+        return tEntrada <= tSalida;
+    };
+    if (!losa(p0.x, d.x, bx0, bx1, Vector2D(-1,0), Vector2D(1,0))) return false;
+    if (!losa(p0.y, d.y, by0, by1, Vector2D(0,-1), Vector2D(0,1))) return false;
+
+    // Entra por una cara (no por la zona de una esquina).
+    Vector2D q = p0 + d * tEntrada;
+    bool enRangoX = q.x >= rect.izquierda() && q.x <= rect.derecha();
+    bool enRangoY = q.y >= rect.arriba()    && q.y <= rect.abajo();
+    if ((enRangoX || enRangoY) && magnitud2(nEntrada) > 0.0) {
+        t = tEntrada;
+        normal = nEntrada;
+        return true;
+    }
+
+    // Zona de esquina: rayo contra el circulo de radio r en esa esquina.
+    Vector2D esquina(q.x < rect.centro().x ? rect.izquierda() : rect.derecha(),
+                     q.y < rect.centro().y ? rect.arriba()    : rect.abajo());
+    Vector2D m = p0 - esquina;
+    double a = productoPunto(d, d);
+    double b = productoPunto(m, d);
+    double c = productoPunto(m, m) - r*r;
+    if (a < 1e-12) return false;
+    double disc = b*b - a*c;
+    if (disc < 0.0) return false;
+    double tc = (-b - std::sqrt(disc)) / a;
+    if (tc < 0.0 || tc > 1.0) return false;
+
+    t = tc;
+    normal = normalizar(p0 + d * tc - esquina);
+    return true;
+}
+
+MundoSimulacion::MundoSimulacion(double ancho, double alto)
+    : m_ancho(ancho),
+    m_alto(alto)
+{
+    m_escombros.fijarLimites(m_ancho, m_alto);
+}
+
+// Borra la geometria del nivel y deja la partida en su estado inicial.
+void MundoSimulacion::limpiar()
+{
+    m_rectBloques.clear();
+    m_rectInicial.clear();
+    m_vyBloque.clear();
+    m_sentidoVuelco.clear();
+    m_resistencia.clear();
+    m_resistenciaInicial.clear();
+    m_destruido.clear();
+    m_ladoBloque.clear();
+    m_marcas.clear();
+    m_rejillaSucia = true;
+    m_apoyosSucios = true;
+    m_hayTerreno = false;
+    m_colinas.clear();
+    generarTerreno();
+
+    for (int b = 0; b < 2; ++b) {
+        m_rectRival[b] = RectMundo();
+        m_rectCanion[b] = RectMundo();
+        m_rectPlataforma[b] = RectMundo();
+    }
+
+    reiniciarPartida();
+}
+
+int MundoSimulacion::agregarBloque(const RectMundo &rect, double resistencia,
+                                   Bando lado)
+{
+    m_rectBloques.push_back(rect);
+    m_rectInicial.push_back(rect);
+    m_vyBloque.push_back(0.0);
+    m_sentidoVuelco.push_back(0);
+    m_resistencia.push_back(resistencia);
+    m_resistenciaInicial.push_back(resistencia);
+    m_destruido.push_back(0);
+    m_ladoBloque.push_back(std::uint8_t(lado));
+    m_marcas.push_back(0);
+    m_rejillaSucia = true;
+    m_apoyosSucios = true;
+    return int(m_rectBloques.size()) - 1;
+}
+
+void MundoSimulacion::fijarTamano(double ancho, double alto)
+{
+    m_ancho = ancho;
+    m_alto = alto;
+    m_rejillaSucia = true;
+    m_apoyosSucios = true;
+    m_escombros.fijarLimites(m_ancho, m_alto);
+    generarTerreno();
+}
+
+void MundoSimulacion::cargarBloques(int n, const void *rects,
+                                    const void *resistencias,
+                                    const std::uint8_t *lados)
+{
+    const std::size_t cuantos = std::size_t(std::max(n, 0));
+    m_rectBloques.resize(cuantos);
+    m_resistencia.resize(cuantos);
+    if (cuantos > 0) {
+        std::memcpy(m_rectBloques.data(), rects, cuantos * sizeof(RectMundo));
+        std::memcpy(m_resistencia.data(), resistencias, cuantos * sizeof(double));
+    }
+    m_rectInicial = m_rectBloques;
+    m_vyBloque.assign(cuantos, 0.0);
+    m_sentidoVuelco.assign(cuantos, 0);
+    m_resistenciaInicial = m_resistencia;
+    m_ladoBloque.assign(lados, lados + cuantos);
+    m_destruido.assign(cuantos, 0);
+    m_marcas.assign(cuantos, 0);
+    m_sucesos.limpiar();
+    m_rejillaSucia = true;
+    m_apoyosSucios = true;
+}
+
+void MundoSimulacion::fijarRival(Bando bando, const RectMundo &rect)
+{
+    m_rectRival[bando] = rect;
+    m_apoyosSucios = true;   // los rivales sostienen bloques
+}
+
+void MundoSimulacion::fijarCanion(Bando bando, const RectMundo &rect)
+{
+    m_rectCanion[bando] = rect;
+}
+
+void MundoSimulacion::fijarPlataforma(Bando bando, const RectMundo &rect)
+{
+    m_rectPlataforma[bando] = rect;
+    m_apoyosSucios = true;
+}
+
+void MundoSimulacion::activarTerreno(bool activo)
+{
+    m_hayTerreno = activo;
+    generarTerreno();
+}
+
+void MundoSimulacion::agregarColina(const Colina &colina)
+{
+    m_colinas.push_back(colina);
+    generarTerreno();
+}
+
+// Superficie de cada columna: la linea del suelo o la colina mas alta que
+// pase por ella. Sin terreno solo libera la mascara.
+void MundoSimulacion::generarTerreno()
+{
+    m_apoyosSucios = true;
+    if (!m_hayTerreno) {
+        m_terreno.crear(0, 0);
+        return;
+    }
+
+    const int ancho = int(std::ceil(m_ancho));
+    const int alto  = int(std::ceil(m_alto));
+    const double linea = m_alto - m_altoSuelo;
+    std::vector<int> superficie(std::size_t(std::max(ancho, 0)));
+    for (int x = 0; x < ancho; ++x) {
+        double y = linea;
+        for (const Colina &c : m_colinas) {
+            const double u = (x + 0.5 - c.centro) / c.ancho;
+            if (c.ancho > 0.0 && std::abs(u) < 0.5)
+                y = std::min(y, linea - c.alto * 0.5 * (1.0 + std::cos(2.0*kPi*u)));
+        }
+        superficie[x] = int(std::lround(y));
+    }
+    m_terreno.crear(ancho, alto);
+    m_terreno.rellenarBajo(superficie);
+}
+
+// Misma geometria que montaba EscenaJuego::configurarMundo.
+void MundoSimulacion::construirNivelBase(double anchoRival, double altoRival,
+                                         double anchoCanion, double altoCanion,
+                                         double resistenciaColumna,
+                                         double resistenciaTecho)
+{
+    limpiar();
+
+    // Geometria comun de las estructuras
+    double yBase = m_alto - m_altoSuelo;
+    double anchoColumna = 60;
+    double altoColumna = 200;
+    double separacion = 110;
+    double altoTecho = 60;
+    double anchoEstructura = 2*anchoColumna + separacion;
+    double yTecho = yBase - altoColumna - altoTecho;
+
+    // Un poco mas adentro de la pared izquierda
+    double xBaseIzq = 110;
+    double xBaseDer = m_ancho - xBaseIzq - anchoEstructura;
+
+    auto agregarEstructura = [&](double xBase, Bando lado){
+        agregarBloque(RectMundo(xBase, yBase - altoColumna,
+                                anchoColumna, altoColumna), resistenciaColumna, lado);
+        agregarBloque(RectMundo(xBase + anchoColumna + separacion,
+                                yBase - altoColumna,
+                                anchoColumna, altoColumna), resistenciaColumna, lado);
+        agregarBloque(RectMundo(xBase, yTecho,
+                                anchoEstructura, altoTecho), resistenciaTecho, lado);
+    };
+    agregarEstructura(xBaseIzq, Izquierda);
+    agregarEstructura(xBaseDer, Derecha);
+
+    // Personajes centrados ENTRE las dos columnas de su estructura
+    double yPersonaje = yBase - altoRival - 10;
+    double xCentroEstrIzq = xBaseIzq + anchoEstructura / 2.0;
+    double xCentroEstrDer = xBaseDer + anchoEstructura / 2.0;
+    fijarRival(Izquierda, RectMundo(xCentroEstrIzq - anchoRival/2.0,
+                                    yPersonaje, anchoRival, altoRival));
+    fijarRival(Derecha, RectMundo(xCentroEstrDer - anchoRival/2.0,
+                                  yPersonaje, anchoRival, altoRival));
+
+    // Cañones sobre plataformas centradas en los laterales
+    double yCentro = m_alto / 2.0;
+    double anchoPlataforma = 80;
+    double altoPlataforma  = 10;
+    double xPlataformaMargen = 10;   // separacion de la pared
+
+    fijarPlataforma(Izquierda, RectMundo(xPlataformaMargen, yCentro + 10,
+                                         anchoPlataforma, altoPlataforma));
+    fijarPlataforma(Derecha, RectMundo(m_ancho - xPlataformaMargen - anchoPlataforma,
+                                       yCentro + 10,
+                                       anchoPlataforma, altoPlataforma));
+
+    double xCanonIzq = xPlataformaMargen + anchoPlataforma/2.0;
+    double xCanonDer = m_ancho - xPlataformaMargen - anchoPlataforma/2.0;
+    double yCanon    = yCentro - altoCanion/2.0;
+    fijarCanion(Izquierda, RectMundo(xCanonIzq - anchoCanion/2.0, yCanon,
+                                     anchoCanion, altoCanion));
+    fijarCanion(Derecha, RectMundo(xCanonDer - anchoCanion/2.0, yCanon,
+                                   anchoCanion, altoCanion));
+}
+
+// Vuelve al turno inicial sin tocar la geometria.
+void MundoSimulacion::reiniciarPartida()
+{
+    m_proyectiles.limpiar();
+    m_porAbrir.clear();
+    m_sucesos.limpiar();
+    std::fill(m_marcas.begin(), m_marcas.end(), std::uint8_t(0));
+    m_cayendo.clear();
+    m_escombros.limpiar();
+    m_apoyosSucios = true;
+    m_turno = Izquierda;
+    m_hayGanador = false;
+    m_ganador = Izquierda;
+}
+
+// Deja los bloques como al construir el nivel sin volver a crearlos.
+void MundoSimulacion::restaurarNivel()
+{
+    m_resistencia = m_resistenciaInicial;   // misma capacidad: sin reservar
+    m_rectBloques = m_rectInicial;
+    std::fill(m_destruido.begin(), m_destruido.end(), std::uint8_t(0));
+    std::fill(m_vyBloque.begin(), m_vyBloque.end(), 0.0);
+    std::fill(m_sentidoVuelco.begin(), m_sentidoVuelco.end(), std::int8_t(0));
+    m_rejillaSucia = true;
+    if (m_hayTerreno)
+        generarTerreno();   // sin crateres
+    reiniciarPartida();
+}
+
+void MundoSimulacion::tomarSucesos(SucesosFisica &destino)
+{
+    destino.limpiar();
+    destino.intercambiar(m_sucesos);
+    for (int b : destino.bloquesDaniados) m_marcas[b] = 0;
+    for (int b : destino.bloquesMovidos)  m_marcas[b] = 0;
+    m_terreno.limpiarCambios();
+}
+
+// Inicia un disparo desde el cañon del bando que tenga el turno.
+// Devuelve false si el turno anterior sigue en movimiento.
+bool MundoSimulacion::disparar(double anguloGrados, double velocidad,
+                               ModoDisparo modo)
+{
+    if (hayMovimiento()) return false;
+
+    const Vector2D origen = m_rectCanion[m_turno].centro();
+    const double sentido = (m_turno == Izquierda) ? 1.0 : -1.0;
+
+    auto lanzar = [&](double grados, double radio, double masa,
+                      AlmacenProyectiles::Tipo tipo){
+        double rad = grados * kPi / 180.0;
+        Vector2D vel(sentido * velocidad * std::cos(rad),
+                     -velocidad * std::sin(rad));
+        m_proyectiles.agregar(origen, vel, radio, masa, tipo);
+    };
+
+    const double radio = radioProyectil(modo);
+    const double masa = masaProyectil(modo);
+    switch (modo) {
+    case DisparoSimple:
+        lanzar(anguloGrados, radio, masa, AlmacenProyectiles::Normal);
+        break;
+    case DisparoSalva:
+        // Cinco proyectiles mas livianos separados 3 grados
+        for (int k = -2; k <= 2; ++k)
+            lanzar(anguloGrados + 3.0*k, radio, masa, AlmacenProyectiles::Normal);
+        break;
+    case DisparoRacimo:
+        lanzar(anguloGrados, radio, masa, AlmacenProyectiles::CargaRacimo);
+        break;
+    case DisparoMetralla:
+        lanzar(anguloGrados, radio, masa, AlmacenProyectiles::CargaMetralla);
+        break;
+    }
+    return true;
+}
+
+ModeloFuerzas MundoSimulacion::fuerzas() const
+{
+    ModeloFuerzas f;
+    f.gravedad = m_gravedad;
+    f.arrastre = m_arrastre;
+    f.viento = m_viento;
+    f.suelo = nivelSuelo();
+    return f;
+}
+
+// Se mide con el proyectil que mas frena el aire (un fragmento de
+// metralla: radio 2, masa 0.25).
+double MundoSimulacion::pasoRecomendado(double pasoBase, double pasoMaximo) const
+{
+    if (m_integrador == Integrador::EulerSemiImplicito)
+        return pasoBase;
+
+    const ModeloFuerzas f = fuerzas();
+    const double coef = f.coefArrastre(2.0, 0.25);
+    const double tolerancia = errorTrayectoria(Integrador::EulerSemiImplicito, f, coef, pasoBase);
+    double candidatos[4];
+    int n = 0;
+    for (double factor : {1.0, 1.5, 2.0, 3.0})
+        if (pasoBase * factor <= pasoMaximo)
+            candidatos[n++] = pasoBase * factor;
+    return elegirPaso(m_integrador, f, coef, tolerancia, candidatos, n);
+}
+
+double MundoSimulacion::radioProyectil(ModoDisparo modo)
+{
+    switch (modo) {
+    case DisparoSalva:   return 6.0;
+    case DisparoRacimo:  return 10.0;
+    default:             return 8.0;
+    }
+}
+
+double MundoSimulacion::masaProyectil(ModoDisparo modo)
+{
+    switch (modo) {
+    case DisparoSalva:   return 4.0;
+    case DisparoRacimo:  return 12.0;
+    default:             return 10.0;
+    }
+}
+
+// p(t) = p0 + v0 t + g t²/2: cada tramo entre dos muestras se barre
+// contra paredes, bloques (con la rejilla), rivales, escombros y terreno,
+// igual que en paso().
+bool MundoSimulacion::preverTrayectoria(double anguloGrados, double velocidad,
+                                        ModoDisparo modo,
+                                        std::vector<Vector2D> &puntos,
+                                        double intervalo)
+{
+    puntos.clear();
+    asegurarRejilla();
+
+    const Vector2D origen = m_rectCanion[m_turno].centro();
+    const double sentido = (m_turno == Izquierda) ? 1.0 : -1.0;
+    const double rad = anguloGrados * kPi / 180.0;
+    const Vector2D v0(sentido * velocidad * std::cos(rad), -velocidad * std::sin(rad));
+    const double r = radioProyectil(modo);
+    const double suelo = nivelSuelo();
+
+    // Con arrastre se integra.
+    const ModeloFuerzas f = fuerzas();
+    const double coef = f.coefArrastre(r, masaProyectil(modo));
+    EstadoVuelo vuelo{origen, v0};
+    auto posicion = [&](double t) {
+        if (f.soloGravedad())
+            return Vector2D(origen.x + v0.x*t, origen.y + v0.y*t + 0.5*m_gravedad*t*t);
+        vuelo = avanzarVuelo(Integrador::RK4, f, coef, vuelo, intervalo);
+        return vuelo.p;
+    };
+
+    puntos.push_back(origen);
+    const int muestras = int(kTiempoVida / intervalo);
+    Vector2D anterior = origen;
+
+    for (int i = 1; i <= muestras; ++i) {
+        const Vector2D actual = posicion(i * intervalo);
+        const Vector2D d = actual - anterior;
+        double tMin = 2.0;   // > 1: sin contacto en este tramo
+        Vector2D normal;
+
+        // Paredes y suelo (solo si el tramo las cruza hacia afuera).
+        if (actual.x < r && d.x < 0.0)           tMin = std::min(tMin, (r - anterior.x) / d.x);
+        if (actual.x > m_ancho - r && d.x > 0.0) tMin = std::min(tMin, (m_ancho - r - anterior.x) / d.x);
+        if (actual.y < r && d.y < 0.0)           tMin = std::min(tMin, (r - anterior.y) / d.y);
+        if (actual.y > suelo - r && d.y > 0.0)   tMin = std::min(tMin, (suelo - r - anterior.y) / d.y);
+
+        m_candidatos.clear();
+        m_rejilla.consultar(std::min(anterior.x, actual.x) - r,
+                            std::min(anterior.y, actual.y) - r,
+                            std::max(anterior.x, actual.x) + r,
+                            std::max(anterior.y, actual.y) + r,
+                            m_candidatos);
+        double t;
+        for (int b : m_candidatos) {
+            if (barridoCirculoRect(anterior, d, r, m_rectBloques[b], t, normal))
+                tMin = std::min(tMin, t);
+        }
+        for (int b = Izquierda; b <= Derecha; ++b) {
+            if (barridoCirculoRect(anterior, d, r, m_rectRival[b], t, normal))
+                tMin = std::min(tMin, t);
+        }
+        m_escombrosCerca.clear();
+        m_escombros.consultar(std::min(anterior.x, actual.x) - r,
+                              std::min(anterior.y, actual.y) - r,
+                              std::max(anterior.x, actual.x) + r,
+                              std::max(anterior.y, actual.y) + r,
+                              m_escombrosCerca);
+        for (int e : m_escombrosCerca) {
+            if (m_escombros.barrerCirculo(e, anterior, d, r, t, normal))
+                tMin = std::min(tMin, t);
+        }
+        if (m_terreno.barrerCirculo(anterior, d, r, t, normal))
+            tMin = std::min(tMin, t);
+
+        if (tMin <= 1.0) {
+            puntos.push_back(anterior + d * std::max(0.0, tMin));
+            return true;
+        }
+        puntos.push_back(actual);
+        anterior = actual;
+    }
+    return false;
+}
+
+// Avanza la simulacion un paso de tiempo. Los sucesos se suman a los de
+// los pasos anteriores hasta que alguien los toma.
+MundoSimulacion::ResultadoPaso MundoSimulacion::paso(double dt)
+{
+    ResultadoPaso res;
+    if (!hayMovimiento())
+        return res;
+
+    // El vuelo se integra por lotes. Los proyectiles cuyo recorrido
+    // pasa cerca de un bloque o de un rival se barren con tiempo de
+    // impacto; el resto solo puede chocar con las paredes, que se
+    // resuelven tambien por lotes.
+    {
+        MedicionFase medir(Perfilador::Integrar);
+        m_proyectiles.integrar(dt, fuerzas(), m_integrador);
+    }
+    {
+        MedicionFase medir(Perfilador::Choques);
+        resolverChoquesBarridos(dt);
+    }
+    {
+        MedicionFase medir(Perfilador::Paredes);
+        if (m_proyectiles.resolverChoquesParedes(m_ancho, nivelSuelo()))
+            m_sucesos.agregar(Suceso::Rebote, -1, 0.0, Vector2D(0, 0));
+    }
+
+    if (m_hayGanador) {
+        // La partida termino: lo que estuviera cayendo se queda donde esta.
+        m_proyectiles.limpiar();
+        m_cayendo.clear();
+        m_escombros.dormirTodos();
+        res.golpeRival = true;
+        return res;
+    }
+
+    {
+        MedicionFase medir(Perfilador::Cargas);
+        abrirCargas();
+    }
+    {
+        MedicionFase medir(Perfilador::Limpieza);
+        eliminarFueraDeJuego(dt);
+    }
+    if (!m_cayendo.empty()) {
+        MedicionFase medir(Perfilador::Derrumbe);
+        moverBloquesCayendo(dt);
+    }
+    if (m_escombros.hayDespiertos()) {
+        MedicionFase medir(Perfilador::Escombros);
+        moverEscombros(dt);
+    }
+
+    if (!hayMovimiento()) {
+        finalizarTurno();
+        res.turnoTerminado = true;
+    }
+    return res;
+}
+
+// La rejilla y el grafo de apoyos se reconstruyen solo despues de
+// cambiar el nivel (o de reiniciar la partida).
+void MundoSimulacion::asegurarRejilla()
+{
+    if (m_rejillaSucia) {
+        m_rejilla.construir(m_rectBloques, m_destruido, m_ancho, m_alto);
+        m_rejillaSucia = false;
+    }
+    if (m_apoyosSucios) {
+        const RectMundo fijos[4] = {m_rectPlataforma[Izquierda], m_rectPlataforma[Derecha],
+                                    m_rectRival[Izquierda],      m_rectRival[Derecha]};
+        m_apoyos.construir(m_rectBloques, m_destruido, fijos, 4,
+                           nivelSuelo(), m_ancho, m_rejilla,
+                           m_hayTerreno ? &m_terreno : nullptr);
+        m_apoyosSucios = false;
+    }
+}
+
+void MundoSimulacion::marcarMovido(int bloque)
+{
+    if (!(m_marcas[bloque] & kMarcaMovido)) {
+        m_marcas[bloque] |= kMarcaMovido;
+        m_sucesos.bloquesMovidos.push_back(bloque);
+    }
+}
+
+// Los bloques sin apoyo se procesan de abajo hacia arriba para que uno
+// pueda posarse sobre otro que aterrizo en el mismo paso. Un bloque que
+// aun toca algo que no lo sostiene se desliza hacia el lado de su centro
+// hasta soltarse; uno que no toca nada cae en vertical con la gravedad.
+// Al tocar una superficie (suelo, terreno, apoyo fijo o bloque quieto)
+// el golpe daña al bloque y a lo que tiene debajo segun el momento de la
+// caida y se vuelve a intentar asentarlo; si algo cede, sigue el derrumbe.
+void MundoSimulacion::moverBloquesCayendo(double dt)
+{
+    asegurarRejilla();
+
+    m_cayendoPaso.clear();
+    m_cayendoPaso.swap(m_cayendo);
+    std::sort(m_cayendoPaso.begin(), m_cayendoPaso.end(), [&](int a, int b) {
+        return m_rectBloques[a].abajo() > m_rectBloques[b].abajo();
+    });
+
+    const double suelo = nivelSuelo();
+    const Terreno *terreno = m_hayTerreno ? &m_terreno : nullptr;
+    const double kContacto = 0.5;
+    const double kVelocidadVuelco = 240.0;   // px/s al deslizarse de un apoyo
+
+    auto reubicar = [&](int i) {
+        if (!m_rejilla.insertar(i, m_rectBloques[i]))
+            m_rejilla.construir(m_rectBloques, m_destruido, m_ancho, m_alto);
+        marcarMovido(i);
+        // Lo que tenga encima o al lado deja de estar quieto.
+        const RectMundo &q = m_rectBloques[i];
+        m_escombros.despertarEn(RectMundo(q.x - 1.0, q.y - 1.0, q.ancho + 2.0, q.alto + 2.0));
+    };
+
+    for (int i : m_cayendoPaso) {
+        if (m_destruido[i]) continue;
+
+        RectMundo &r = m_rectBloques[i];
+        int vuelco = 0;
+        bool quieto = m_apoyos.asentar(i, m_rectBloques, m_destruido, m_rejilla,
+                                       vuelco, terreno);
+        // Vuelca al reves que en el paso anterior: quedo encajado entre dos
+        // apoyos (p. ej. los bordes de un crater) y se queda ahi.
+        if (!quieto && vuelco != 0 && vuelco == -m_sentidoVuelco[i])
+            quieto = m_apoyos.asentar(i, m_rectBloques, m_destruido, m_rejilla,
+                                      vuelco, terreno, true);
+        m_sentidoVuelco[i] = std::int8_t(vuelco);
+        if (quieto)
+            continue;
+        m_cayendo.push_back(i);
+
+        if (vuelco != 0) {
+            // Se desliza hasta la pared o el primer bloque quieto de ese
+            // lado; ahi se recuesta en el siguiente paso.
+            m_vyBloque[i] = 0.0;
+            double x = std::clamp(r.x + vuelco * kVelocidadVuelco * dt, 0.0, m_ancho - r.ancho);
+            auto frenar = [&](const RectMundo &q) {
+                if (std::min(r.abajo(), q.abajo()) - std::max(r.arriba(), q.arriba()) <= kContacto)
+                    return;
+                if (vuelco < 0 && q.derecha() <= r.izquierda() + kContacto)
+                    x = std::max(x, q.derecha());
+                else if (vuelco > 0 && q.izquierda() >= r.derecha() - kContacto)
+                    x = std::min(x, q.izquierda() - r.ancho);
+            };
+            for (int b = Izquierda; b <= Derecha; ++b) {
+                frenar(m_rectPlataforma[b]);
+                frenar(m_rectRival[b]);
+            }
+            m_candidatos.clear();
+            m_rejilla.consultar(std::min(x, r.x), r.arriba(),
+                                std::max(x, r.x) + r.ancho, r.abajo(), m_candidatos);
+            for (int j : m_candidatos)
+                if (j != i && !m_apoyos.cae(j))
+                    frenar(m_rectBloques[j]);
+            // El terreno de ese lado tambien (retrocede de a 1 px).
+            while (terreno && x != r.x &&
+                   terreno->hayEnRect(x, r.arriba(), x + r.ancho, r.abajo() - 1.0))
+                x = (std::abs(x - r.x) <= 1.0) ? r.x : x - vuelco;
+            r.x = x;
+            reubicar(i);
+            continue;
+        }
+
+        m_vyBloque[i] += m_gravedad * dt;
+        const double dy = m_vyBloque[i] * dt;
+        const double abajo = r.abajo();
+
+        // Superficie mas alta entre la cara inferior y donde acabara.
+        double superficie = std::max(suelo, abajo);
+        int debajo = -1;
+        auto probar = [&](const RectMundo &q, int bloque) {
+            const double solape = std::min(r.derecha(), q.derecha()) -
+                                  std::max(r.izquierda(), q.izquierda());
+            if (solape > kContacto && q.arriba() >= abajo - kContacto &&
+                q.arriba() < superficie) {
+                superficie = q.arriba();
+                debajo = bloque;
+            }
+        };
+        for (int b = Izquierda; b <= Derecha; ++b) {
+            probar(m_rectPlataforma[b], -1);
+            probar(m_rectRival[b], -1);
+        }
+        m_candidatos.clear();
+        m_rejilla.consultar(r.izquierda(), abajo - kContacto,
+                            r.derecha(), abajo + dy, m_candidatos);
+        for (int j : m_candidatos)
+            if (j != i)
+                probar(m_rectBloques[j], j);
+        if (terreno) {
+            const int fila = terreno->primeraFila(r.izquierda(), r.derecha(),
+                                                  int(std::ceil(abajo - kContacto)),
+                                                  int(std::floor(abajo + dy)));
+            if (fila >= 0 && fila < superficie) {
+                superficie = fila;
+                debajo = -1;
+            }
+        }
+
+        if (abajo + dy < superficie) {
+            r.y += dy;
+            reubicar(i);
+            continue;
+        }
+
+        // Alcanza a otro que cae (ya movido en este paso): sigue encima de
+        // el a su velocidad, sin golpe.
+        if (debajo >= 0 && m_apoyos.cae(debajo)) {
+            r.y = superficie - r.alto;
+            m_vyBloque[i] = std::min(m_vyBloque[i], m_vyBloque[debajo]);
+            reubicar(i);
+            continue;
+        }
+
+        // Aterriza: se asienta antes de repartir el daño para que, si
+        // cede lo de abajo, el derrumbe lo vuelva a soltar.
+        r.y = superficie - r.alto;
+        reubicar(i);
+        if (m_apoyos.asentar(i, m_rectBloques, m_destruido, m_rejilla, vuelco, terreno))
+            m_cayendo.pop_back();
+
+        const double danio = m_factorDanio * kDensidadBloque * r.ancho * r.alto *
+                             m_vyBloque[i];
+        m_vyBloque[i] = 0.0;
+        const Vector2D contacto(r.x + 0.5 * r.ancho, r.abajo());
+        if (debajo >= 0)
+            aplicarDanio(debajo, danio, contacto);
+        if (!m_destruido[i])
+            aplicarDanio(i, danio, contacto);
+    }
+}
+
+// Recorrido de un paso: barrido contra bloques, rivales, escombros,
+// terreno y paredes. Solo entran aqui los proyectiles cuyo segmento del
+// paso (AABB) toca algun bloque vivo, algun rival, algun escombro o baja
+// hasta la primera fila del terreno.
+void MundoSimulacion::resolverChoquesBarridos(double dt)
+{
+    asegurarRejilla();
+
+    const AlmacenProyectiles &p = m_proyectiles;
+    const double suelo = nivelSuelo();
+
+    for (int k = 0; k < p.tamano() && !m_hayGanador; ++k){
+        const double r = p.radio[k];
+
+        // AABB del segmento recorrido; si cruzo una pared se agrega
+        // tambien el punto reflejado donde acabara.
+        const Vector2D ant = p.posicionAnterior(k);
+        const Vector2D pos = p.posicion(k);
+        double xFin = pos.x, yFin = pos.y;
+        if (xFin < r)              xFin = 2*r - xFin;
+        if (xFin > m_ancho - r)    xFin = 2*(m_ancho - r) - xFin;
+        if (yFin < r)              yFin = 2*r - yFin;
+        if (yFin > suelo - r)      yFin = 2*(suelo - r) - yFin;
+
+        const double x0 = std::min({ant.x, pos.x, xFin}) - r;
+        const double x1 = std::max({ant.x, pos.x, xFin}) + r;
+        const double y0 = std::min({ant.y, pos.y, yFin}) - r;
+        const double y1 = std::max({ant.y, pos.y, yFin}) + r;
+
+        auto tocaAABB = [&](const RectMundo &q){
+            return !(x1 < q.izquierda() || x0 > q.derecha() ||
+                     y1 < q.arriba()    || y0 > q.abajo());
+        };
+
+        m_candidatos.clear();
+        m_rejilla.consultar(x0, y0, x1, y1, m_candidatos);
+        if (m_candidatos.empty() &&
+            !tocaAABB(m_rectRival[Izquierda]) && !tocaAABB(m_rectRival[Derecha]) &&
+            !(m_hayTerreno && y1 >= m_terreno.filaSuperior())) {
+            m_escombrosCerca.clear();
+            m_escombros.consultar(x0, y0, x1, y1, m_escombrosCerca);
+            if (m_escombrosCerca.empty())
+                continue;
+        }
+
+        barrerProyectil(k, dt);
+    }
+}
+
+// Avanza el proyectil k desde su posicion anterior por el segmento del
+// paso, deteniendose en cada primer contacto (tiempo de impacto), aplicando
+// la respuesta y siguiendo con el tiempo restante.
+void MundoSimulacion::barrerProyectil(int k, double dt)
+{
+    AlmacenProyectiles &p = m_proyectiles;
+    const double r = p.radio[k];
+    const double suelo = nivelSuelo();
+    const double kSeparacion = 1e-3;
+
+    Vector2D pos(p.xAnt[k], p.yAnt[k]);
+    Vector2D vel = p.velocidad(k);
+    double tiempoRestante = dt;
+
+    for (int iter = 0; iter < 8 && tiempoRestante > 0.0; ++iter) {
+        const Vector2D d = vel * tiempoRestante;
+
+        enum Objetivo { Ninguno, Pared, Bloque, Rival, Escombro, Crater };
+        Objetivo objetivo = Ninguno;
+        int indice = -1;
+        double tMin = 2.0;   // > 1: sin contacto en este tramo
+        Vector2D normal(0,0);
+
+        // Paredes: planos x = r, x = ancho - r, y = r, y = suelo - r.
+        auto probarPlano = [&](double coord, double despl, double limite,
+                               bool menor, const Vector2D &n){
+            // Solo cuenta si se mueve hacia la pared y la cruza.
+            if (menor ? (despl >= 0.0 || coord + despl >= limite)
+                      : (despl <= 0.0 || coord + despl <= limite))
+                return;
+            double t = std::max(0.0, (limite - coord) / despl);
+            if (t < tMin) {
+                tMin = t; normal = n; objetivo = Pared;
+            }
+        };
+        probarPlano(pos.x, d.x, r,             true,  Vector2D(1,0));
+        probarPlano(pos.x, d.x, m_ancho - r,   false, Vector2D(-1,0));
+        probarPlano(pos.y, d.y, r,             true,  Vector2D(0,1));
+        probarPlano(pos.y, d.y, suelo - r,     false, Vector2D(0,-1));
+
+        // Bloques cercanos al segmento.
+        m_candidatos.clear();
+        m_rejilla.consultar(std::min(pos.x, pos.x + d.x) - r,
+                            std::min(pos.y, pos.y + d.y) - r,
+                            std::max(pos.x, pos.x + d.x) + r,
+                            std::max(pos.y, pos.y + d.y) + r,
+                            m_candidatos);
+        for (int i : m_candidatos) {
+            double t;
+            Vector2D n;
+            if (barridoCirculoRect(pos, d, r, m_rectBloques[i], t, n) &&
+                t < tMin) {
+                tMin = t; normal = n; objetivo = Bloque; indice = i;
+            }
+        }
+
+        // Rivales: el primer contacto decide la partida.
+        for (int b = Izquierda; b <= Derecha; ++b) {
+            double t;
+            Vector2D n;
+            if (barridoCirculoRect(pos, d, r, m_rectRival[b], t, n) &&
+                t < tMin) {
+                tMin = t; normal = n; objetivo = Rival; indice = b;
+            }
+        }
+
+        // Escombros (girados). Uno que ya se solapa y se aleja no cuenta.
+        m_escombrosCerca.clear();
+        m_escombros.consultar(std::min(pos.x, pos.x + d.x) - r,
+                              std::min(pos.y, pos.y + d.y) - r,
+                              std::max(pos.x, pos.x + d.x) + r,
+                              std::max(pos.y, pos.y + d.y) + r,
+                              m_escombrosCerca);
+        for (int e : m_escombrosCerca) {
+            double t;
+            Vector2D n;
+            if (m_escombros.barrerCirculo(e, pos, d, r, t, n) && t < tMin) {
+                const Vector2D punto = pos + d * t - n * r;
+                if (t == 0.0 &&
+                    productoPunto(vel - m_escombros.velocidadEn(e, punto), n) >= 0.0)
+                    continue;
+                tMin = t; normal = n; objetivo = Escombro; indice = e;
+            }
+        }
+
+        // Terreno destructible.
+        {
+            double t;
+            Vector2D n;
+            if (m_terreno.barrerCirculo(pos, d, r, t, n) && t < tMin) {
+                tMin = t; normal = n; objetivo = Crater;
+            }
+        }
+
+        if (objetivo == Ninguno) {
+            pos += d;
+            break;
+        }
+
+        // Avanzar hasta el contacto.
+        pos += d * tMin;
+        tiempoRestante *= (1.0 - tMin);
+
+        if (objetivo == Rival) {
+            registrarGolpeRival(k, Bando(indice));
+            break;
+        }
+        if (objetivo == Crater) {
+            // Se hunde en el terreno y se detiene (se retira por lento); una
+            // carga se abre ahi, en el hueco del crater (abrirCargas).
+            abrirCrater(pos - normal * r, p.masa[k], vel, r);
+            vel = Vector2D(0, 0);
+            if (p.tipo[k] == AlmacenProyectiles::CargaMetralla)
+                m_porAbrir.push_back(k);
+            break;
+        }
+
+        double vN = productoPunto(vel, normal);
+        if (objetivo == Pared) {
+            // Rebote elastico: se invierte la componente normal.
+            if (vN < 0.0) vel -= normal * (2.0 * vN);
+            m_sucesos.agregar(Suceso::Rebote, -1, 0.0, pos);
+        } else if (objetivo == Escombro) {
+            // Choque entre dos cuerpos: el escombro sale empujado (y se
+            // despierta); no hay daño.
+            vel = golpearEscombro(indice, pos - normal * r, normal, vel, p.masa[k]);
+            m_sucesos.agregar(Suceso::Rebote, indice, 0.0, pos - normal * r);
+        } else {
+            // Empezo el paso ya solapado (p. ej. un fragmento nacido dentro
+            // del bloque): se le saca hasta la cara elegida.
+            const RectMundo &rect = m_rectBloques[indice];
+            if (tMin == 0.0 && circuloIntersecaRect(pos, r - kSeparacion, rect)) {
+                if (normal.x < 0.0)      pos.x = rect.izquierda() - r;
+                else if (normal.x > 0.0) pos.x = rect.derecha() + r;
+                else if (normal.y < 0.0) pos.y = rect.arriba() - r;
+                else                     pos.y = rect.abajo() + r;
+            }
+
+            // Descomposicion de la velocidad en normal y tangencial.
+            Vector2D vPerp = normal * vN;
+            Vector2D vPar  = vel - vPerp;
+
+            // Rebote inelastico (se pierde energia en la normal).
+            if (vN < 0.0)
+                vel = vPar + normal * (-m_coefRestEstructura * vN);
+
+            // Daño proporcional al momento (masa * |velocidad|)
+            double danio = m_factorDanio * p.masa[k] * magnitud(vel);
+
+            aplicarDanio(indice, danio, pos - normal * r);
+
+            if (p.tipo[k] == AlmacenProyectiles::CargaMetralla)
+                m_porAbrir.push_back(k);
+        }
+
+        // Separacion minima para no volver a detectar la misma cara.
+        pos += normal * kSeparacion;
+    }
+
+    p.x[k] = pos.x;
+    p.y[k] = pos.y;
+    p.vx[k] = vel.x;
+    p.vy[k] = vel.y;
+}
+
+// Cada vuelta del lazo toma el suceso mas proximo de todos los
+// proyectiles, los lleva a ese instante por su parabola y lo resuelve
+// con las mismas reglas que paso(): rebote elastico en paredes,
+// inelastico y con daño en bloques, apertura de cargas y retirada por
+// tiempo o por lentitud. Solo se calcula el suceso del que choco y de
+// los fragmentos nuevos; los que iban hacia un bloque roto o un terreno
+// que cambio se corrigen al salir de la cola. Los sucesos estan en una
+// ColaIndexada: tomar el proximo y corregir uno cuesta O(log n), no un
+// recorrido de todos.
+MundoSimulacion::ResultadoPaso MundoSimulacion::resolverAlInstante()
+{
+    ResultadoPaso res;
+    m_porAbrir.clear();
+    if (!hayMovimiento())
+        return res;
+    if (!fuerzas().soloGravedad())
+        return resolverAPasos();
+
+    asegurarRejilla();
+
+    AlmacenProyectiles &p = m_proyectiles;
+    const double kSeparacion = 1e-3;
+    // Velocidad normal de salida por debajo de la cual un proyectil que
+    // rebota sobre la cara superior de un bloque se da por apoyado (si no,
+    // la serie de rebotes cada vez mas cortos no terminaria nunca).
+    const double kVelocidadApoyo = 15.0;
+    const int kMaxEventos = 1000000;
+
+    // A igual instante va primero el menor indice (como el recorrido que
+    // habia antes: el mismo orden da los mismos resultados).
+    const auto antes = [this](int a, int b) {
+        return m_eventos[a].t < m_eventos[b].t ||
+               (m_eventos[a].t == m_eventos[b].t && a < b);
+    };
+    ColaIndexada &cola = m_colaEventos;
+    int crateres = 0;   // abiertos en este salto
+    auto calcular = [&](int k, double ahora) {
+        Evento ev = proximoEvento(k, ahora);
+        ev.crateres = crateres;
+        return ev;
+    };
+    m_eventos.clear();
+    for (int k = 0; k < p.tamano(); ++k)
+        m_eventos.push_back(calcular(k, 0.0));
+    cola.construir(p.tamano(), antes);
+
+    auto recalcular = [&](int k, double ahora) {
+        m_eventos[k] = calcular(k, ahora);
+        cola.actualizar(k, antes);
+    };
+    // eliminar() mueve el ultimo al hueco: los eventos y la cola lo imitan.
+    auto olvidar = [&](int k) {
+        cola.quitar(k, antes);
+        m_eventos[k] = m_eventos.back();
+        m_eventos.pop_back();
+        if (k < int(m_eventos.size()))
+            cola.actualizar(k, antes);   // mismo instante, otro indice
+    };
+    auto quitar = [&](int k) {
+        p.eliminar(k);
+        olvidar(k);
+    };
+    auto abrir = [&](int k, int cuantos, double radio, double masa,
+                     double rapidez, bool abanico, double ahora) {
+        olvidar(k);
+        fragmentar(k, cuantos, radio, masa, rapidez, abanico);
+        for (int f = int(m_eventos.size()); f < p.tamano(); ++f) {
+            m_eventos.push_back(calcular(f, ahora));
+            cola.agregar(antes);
+        }
+    };
+
+    double ahora = 0.0;
+    for (int n = 0; n < kMaxEventos && !p.vacio(); ++n) {
+        const int k = cola.primero();
+        const Evento ev = m_eventos[k];
+
+        p.avanzarParabolas(ev.t - ahora, m_gravedad);
+        ahora = ev.t;
+
+        // Invalidacion perezosa: romper un bloque o abrir un crater solo
+        // quita obstaculos, asi que los sucesos contra ellos no se buscan
+        // al cambiar; se recalculan al llegar su turno si el bloque ya no
+        // esta o si el terreno cambio desde que se calcularon.
+        if ((ev.tipo == Evento::Bloque && m_destruido[ev.objetivo]) ||
+            (ev.tipo == Evento::Crater && ev.crateres != crateres)) {
+            recalcular(k, ahora);
+            continue;
+        }
+
+        switch (ev.tipo) {
+        case Evento::Expira:
+            quitar(k);
+            break;
+
+        case Evento::Apertura:
+            abrir(k, 24, 4.0, 2.0, 60.0, true, ahora);
+            break;
+
+        case Evento::Rival:
+            registrarGolpeRival(k, Bando(ev.objetivo));
+            p.limpiar();
+            m_cayendo.clear();
+            m_escombros.dormirTodos();
+            res.golpeRival = true;
+            return res;
+
+        case Evento::Pared: {
+            Vector2D vel = p.velocidad(k);
+            const double vN = productoPunto(vel, ev.normal);
+            if (vN < 0.0) vel -= ev.normal * (2.0 * vN);
+            m_sucesos.agregar(Suceso::Rebote, -1, 0.0, p.posicion(k));
+            p.vx[k] = vel.x;
+            p.vy[k] = vel.y;
+            p.x[k] += ev.normal.x * kSeparacion;
+            p.y[k] += ev.normal.y * kSeparacion;
+            recalcular(k, ahora);
+            break;
+        }
+
+        case Evento::Escombro: {
+            // Los escombros no se mueven hasta que acaban los proyectiles:
+            // el golpe les deja la velocidad y el proyectil sale como de
+            // una superficie quieta.
+            const Vector2D punto = p.posicion(k) - ev.normal * p.radio[k];
+            Vector2D vel = golpearEscombro(ev.objetivo, punto, ev.normal,
+                                           p.velocidad(k), p.masa[k]);
+            const double vN = productoPunto(vel, ev.normal);
+            if (vN < 0.0) vel -= ev.normal * vN;
+            m_sucesos.agregar(Suceso::Rebote, ev.objetivo, 0.0, punto);
+
+            p.vx[k] = vel.x;
+            p.vy[k] = vel.y;
+            p.x[k] += ev.normal.x * kSeparacion;
+            p.y[k] += ev.normal.y * kSeparacion;
+            if (ev.normal.y < -0.5 && productoPunto(vel, ev.normal) < kVelocidadApoyo)
+                quitar(k);
+            else
+                recalcular(k, ahora);
+            break;
+        }
+
+        case Evento::Crater: {
+            // Igual que en paso(): crater, proyectil detenido y las cargas
+            // se abren en el hueco. Los que iban a tocar el terreno dentro
+            // del crater siguen (ver la invalidacion perezosa).
+            abrirCrater(p.posicion(k) - ev.normal * p.radio[k], p.masa[k],
+                        p.velocidad(k), p.radio[k]);
+            ++crateres;
+            p.vx[k] = 0.0;
+            p.vy[k] = 0.0;
+
+            if (p.tipo[k] == AlmacenProyectiles::CargaMetralla)
+                abrir(k, 400, 2.0, 0.25, 160.0, false, ahora);
+            else if (p.tipo[k] == AlmacenProyectiles::CargaRacimo)
+                abrir(k, 24, 4.0, 2.0, 60.0, true, ahora);
+            else
+                quitar(k);
+            break;
+        }
+
+        case Evento::Bloque: {
+            Vector2D vel = p.velocidad(k);
+            const double vN = productoPunto(vel, ev.normal);
+            if (vN < 0.0)
+                vel = (vel - ev.normal * vN) + ev.normal * (-m_coefRestEstructura * vN);
+
+            const double danio = m_factorDanio * p.masa[k] * magnitud(vel);
+            // Los que iban hacia el bloque, si se destruye, siguen de largo
+            // (ver la invalidacion perezosa).
+            aplicarDanio(ev.objetivo, danio, p.posicion(k) - ev.normal * p.radio[k]);
+
+            p.vx[k] = vel.x;
+            p.vy[k] = vel.y;
+            p.x[k] += ev.normal.x * kSeparacion;
+            p.y[k] += ev.normal.y * kSeparacion;
+
+            if (p.tipo[k] == AlmacenProyectiles::CargaMetralla)
+                abrir(k, 400, 2.0, 0.25, 160.0, false, ahora);
+            else if (ev.normal.y < -0.5 &&
+                     productoPunto(vel, ev.normal) < kVelocidadApoyo)
+                quitar(k);
+            else
+                recalcular(k, ahora);
+            break;
+        }
+        }
+    }
+
+    // Los bloques que se quedaron sin apoyo y los escombros caen al
+    // terminar los proyectiles (mientras tanto cuentan como quietos).
+    for (int n = 0; n < kMaxPasosDerrumbe &&
+                    (!m_cayendo.empty() || m_escombros.hayDespiertos()); ++n) {
+        if (!m_cayendo.empty())
+            moverBloquesCayendo(kPasoDerrumbe);
+        if (m_escombros.hayDespiertos())
+            moverEscombros(kPasoDerrumbe);
+    }
+    m_cayendo.clear();
+    m_escombros.dormirTodos();
+
+    finalizarTurno();
+    res.turnoTerminado = true;
+    return res;
+}
+
+// Con arrastre no hay parabola que seguir hasta el siguiente evento: el
+// turno se simula entero a pasos de kPasoDerrumbe (como el derrumbe del
+// salto), acumulando los sucesos.
+MundoSimulacion::ResultadoPaso MundoSimulacion::resolverAPasos()
+{
+    ResultadoPaso res;
+    const int kMaxPasos = int(kTiempoVida / kPasoDerrumbe) + kMaxPasosDerrumbe;
+    for (int n = 0; n < kMaxPasos && hayMovimiento(); ++n) {
+        res.golpeRival |= paso(kPasoDerrumbe).golpeRival;
+    }
+    if (hayMovimiento()) {
+        m_proyectiles.limpiar();
+        m_cayendo.clear();
+        m_escombros.dormirTodos();
+        finalizarTurno();
+    }
+    res.turnoTerminado = true;
+    return res;
+}
+
+// Suceso mas proximo del proyectil k desde 'ahora': fin de vida (por
+// tiempo o porque su rapidez baja de kVelocidadMinima), apertura de la
+// carga de racimo en el punto mas alto, o primer contacto con pared,
+// terreno, bloque, rival o escombro. Los bloques salen de la rejilla con la caja de
+// la parabola hasta el limite ya encontrado. De un escombro se usa su caja
+// alineada (contiene al cuerpo girado).
+MundoSimulacion::Evento MundoSimulacion::proximoEvento(int k, double ahora)
+{
+    const AlmacenProyectiles &p = m_proyectiles;
+    const double r  = p.radio[k];
+    const double vx = p.vx[k], vy = p.vy[k];
+    const double g  = m_gravedad;
+    const Parabola trayecto{p.posicion(k), p.velocidad(k), g};
+
+    Evento ev;
+    ev.t = std::max(0.0, kTiempoVida - p.tiempoVida[k]);
+    if (magnitud(p.velocidad(k)) < kVelocidadMinima) {
+        ev.t = 0.0;
+    } else if (std::abs(vx) < kVelocidadMinima && g > 0.0) {
+        // Subiendo, la rapidez baja de kVelocidadMinima cuando vy = -s.
+        const double s = std::sqrt(kVelocidadMinima*kVelocidadMinima - vx*vx);
+        if (vy < -s) ev.t = std::min(ev.t, (-s - vy) / g);
+    }
+
+    const double tCima = (g > 0.0 && vy < 0.0) ? -vy / g : 0.0;
+    if (p.tipo[k] == AlmacenProyectiles::CargaRacimo && g > 0.0 && tCima < ev.t) {
+        ev.t = tCima;
+        ev.tipo = Evento::Apertura;
+    }
+
+    double t;
+    Vector2D n;
+    if (impactoParabolaParedes(trayecto, r, m_ancho, nivelSuelo(),
+                               ev.t, t, n) && t < ev.t)
+        ev = {t, Evento::Pared, -1, n};
+
+    // Terreno: cuerdas cortas de la parabola (mas precisas que los pasos
+    // de paso()); las que quedan por encima del terreno se descartan sin
+    // mirar celdas.
+    if (m_hayTerreno) {
+        const double kCuerda = 1.0 / 120.0;
+        Vector2D anterior = trayecto.posicion(0.0);
+        for (double t0 = 0.0; t0 < ev.t; t0 += kCuerda) {
+            const double t1 = std::min(ev.t, t0 + kCuerda);
+            const Vector2D siguiente = trayecto.posicion(t1);
+            double u;
+            if (m_terreno.barrerCirculo(anterior, siguiente - anterior, r, u, n)) {
+                ev = {t0 + u*(t1 - t0), Evento::Crater, -1, n};
+                break;
+            }
+            anterior = siguiente;
+        }
+    }
+
+    const Vector2D a = trayecto.posicion(0.0);
+    const Vector2D b = trayecto.posicion(ev.t);
+    double yMin = std::min(a.y, b.y);
+    if (tCima > 0.0 && tCima < ev.t)
+        yMin = trayecto.posicion(tCima).y;
+
+    m_candidatos.clear();
+    m_rejilla.consultar(std::min(a.x, b.x) - r, yMin - r,
+                        std::max(a.x, b.x) + r, std::max(a.y, b.y) + r,
+                        m_candidatos);
+    for (int i : m_candidatos) {
+        if (impactoParabolaRect(trayecto, r, m_rectBloques[i], ev.t, t, n) &&
+            t < ev.t)
+            ev = {t, Evento::Bloque, i, n};
+    }
+    for (int bando = Izquierda; bando <= Derecha; ++bando) {
+        if (impactoParabolaRect(trayecto, r, m_rectRival[bando], ev.t, t, n) &&
+            t < ev.t)
+            ev = {t, Evento::Rival, bando, n};
+    }
+    m_escombrosCerca.clear();
+    m_escombros.consultar(std::min(a.x, b.x) - r, yMin - r,
+                          std::max(a.x, b.x) + r, std::max(a.y, b.y) + r,
+                          m_escombrosCerca);
+    for (int e : m_escombrosCerca) {
+        if (impactoParabolaRect(trayecto, r, m_escombros.caja(e), ev.t, t, n) &&
+            t < ev.t)
+            ev = {t, Evento::Escombro, e, n};
+    }
+
+    ev.t += ahora;
+    return ev;
+}
+
+// Aplica daño al bloque y devuelve true si se destruye con este golpe.
+// Lo que se queda sin apoyo empieza a caer. El golpe (y la destruccion)
+// quedan en los sucesos con el punto de contacto.
+bool MundoSimulacion::aplicarDanio(int bloque, double danio, const Vector2D &punto)
+{
+    if (m_destruido[bloque]) return false;
+
+    m_resistencia[bloque] -= danio;
+    m_sucesos.agregar(Suceso::Golpe, bloque, danio, punto);
+    if (!(m_marcas[bloque] & kMarcaDaniado)) {
+        m_marcas[bloque] |= kMarcaDaniado;
+        m_sucesos.bloquesDaniados.push_back(bloque);
+    }
+    if (m_resistencia[bloque] <= 0.0){
+        m_sucesos.agregar(Suceso::Destruccion, bloque, 0.0, punto);
+        m_resistencia[bloque] = 0.0;
+        m_destruido[bloque] = 1;
+        m_rejilla.quitar(bloque);
+        romperBloque(bloque);
+
+        const std::size_t antes = m_cayendo.size();
+        m_apoyos.quitar(bloque, m_rectBloques, m_cayendo);
+        for (std::size_t c = antes; c < m_cayendo.size(); ++c)
+            m_vyBloque[m_cayendo[c]] = 0.0;
+        return true;
+    }
+    return false;
+}
+
+// Parte el bloque destruido en pedazos de unos 30 px (hasta 4 x 4), un
+// poco menores que su hueco para que no nazcan tocandose, con un empujon
+// al azar. Despierta lo que estaba apoyado en el.
+void MundoSimulacion::romperBloque(int bloque)
+{
+    const RectMundo &r = m_rectBloques[bloque];
+    const double kPedazo = 30.0;
+    const double kHueco = 0.5;
+    const int nx = std::clamp(int(std::lround(r.ancho / kPedazo)), 1, 4);
+    const int ny = std::clamp(int(std::lround(r.alto / kPedazo)), 1, 4);
+    const double an = r.ancho / nx, al = r.alto / ny;
+
+    m_escombros.despertarEn(RectMundo(r.x - 1.0, r.y - 1.0, r.ancho + 2.0, r.alto + 2.0));
+    for (int f = 0; f < ny; ++f)
+        for (int c = 0; c < nx; ++c) {
+            const Vector2D centro(r.x + (c + 0.5)*an, r.y + (f + 0.5)*al);
+            const Vector2D vel((aleatorio() - 0.5) * 60.0, -aleatorio() * 40.0);
+            const double giro = (aleatorio() - 0.5) * 2.0;
+            m_escombros.agregar(centro, an/2.0 - kHueco, al/2.0 - kHueco,
+                                vel + Vector2D(0.0, m_vyBloque[bloque]), giro,
+                                kDensidadBloque);
+        }
+}
+
+// Crater donde el proyectil toca el terreno: el radio crece con la raiz
+// de la energia del golpe (entre el del proyectil y kMaxCrater). Despierta
+// los escombros de alrededor y suelta los bloques que se quedan sin suelo.
+// Devuelve el radio, o 0 si no habia nada que excavar.
+double MundoSimulacion::abrirCrater(const Vector2D &punto, double masa,
+                                    const Vector2D &vel, double radioProyectil)
+{
+    const double kExcavacion = 0.04;   // px por raiz de unidad de energia
+    const double kMaxCrater = 40.0;
+    const double radio = std::clamp(kExcavacion * std::sqrt(0.5 * masa * magnitud2(vel)),
+                                    radioProyectil, kMaxCrater);
+    if (!m_terreno.excavar(punto, radio))
+        return 0.0;
+    m_sucesos.agregar(Suceso::Crater, -1, radio, punto);
+
+    const RectMundo zona(punto.x - radio - 1.0, punto.y - radio - 1.0,
+                         2.0*radio + 2.0, 2.0*radio + 2.0);
+    m_escombros.despertarEn(zona);
+
+    asegurarRejilla();
+    m_sobreCrater.clear();
+    m_rejilla.consultar(zona.izquierda(), zona.arriba(), zona.derecha(), zona.abajo(),
+                        m_sobreCrater);
+    const std::size_t antes = m_cayendo.size();
+    m_apoyos.terrenoExcavado(m_sobreCrater, m_rectBloques, m_terreno, m_cayendo);
+    for (std::size_t c = antes; c < m_cayendo.size(); ++c)
+        m_vyBloque[m_cayendo[c]] = 0.0;
+    return radio;
+}
+
+// Un paso de los escombros contra lo que no se mueve en este paso:
+// suelo o terreno, paredes, rivales, plataformas y bloques vivos (los que
+// caen cuentan en su posicion actual). Los pedazos que tocan a un rival
+// desaparecen: si no, los que caen encima lo dejan fuera de alcance.
+void MundoSimulacion::moverEscombros(double dt)
+{
+    asegurarRejilla();
+    const RectMundo fijos[4] = {m_rectPlataforma[Izquierda], m_rectPlataforma[Derecha],
+                                m_rectRival[Izquierda],      m_rectRival[Derecha]};
+    Escombros::Entorno entorno;
+    entorno.ancho = m_ancho;
+    entorno.suelo = nivelSuelo();
+    entorno.bloques = &m_rectBloques;
+    entorno.rejilla = &m_rejilla;
+    entorno.fijos = fijos;
+    entorno.numFijos = 4;
+    entorno.numQuitan = 2;   // los rivales
+    entorno.terreno = m_hayTerreno ? &m_terreno : nullptr;
+    m_escombros.paso(dt, m_gravedad, entorno);
+}
+
+// Choque del proyectil (masa y velocidad 'vel') con el escombro en
+// 'punto'; la normal va del escombro al proyectil. Impulso con la
+// restitucion de la estructura. Devuelve la velocidad de salida.
+Vector2D MundoSimulacion::golpearEscombro(int escombro, const Vector2D &punto,
+                                          const Vector2D &normal, const Vector2D &vel,
+                                          double masa)
+{
+    Escombros &e = m_escombros;
+    const double vN = productoPunto(vel - e.velocidadEn(escombro, punto), normal);
+    if (vN >= 0.0) return vel;
+
+    const Vector2D brazo = punto - Vector2D(e.x[escombro], e.y[escombro]);
+    const double rn = brazo.x*normal.y - brazo.y*normal.x;
+    const double j = -(1.0 + m_coefRestEstructura) * vN /
+                     (1.0/masa + e.invMasa[escombro] + e.invInercia[escombro]*rn*rn);
+    e.golpear(escombro, punto, normal * -j);
+    return vel + normal * (j / masa);
+}
+
+// Abre las cargas de racimo que pasaron el punto mas alto (o se quedaron
+// clavadas en el terreno) y las de metralla que golpearon un bloque o el
+// terreno en este paso.
+void MundoSimulacion::abrirCargas()
+{
+    AlmacenProyectiles &p = m_proyectiles;
+    for (int k = 0; k < p.tamano(); ++k) {
+        if (p.tipo[k] == AlmacenProyectiles::CargaRacimo && p.vy[k] >= 0.0)
+            m_porAbrir.push_back(k);
+    }
+    if (m_porAbrir.empty()) return;
+
+    // De mayor a menor indice: eliminar() solo mueve el ultimo elemento,
+    // asi los indices pendientes siguen siendo validos. Una carga de
+    // metralla puede haber tocado dos bloques en el mismo paso.
+    std::sort(m_porAbrir.begin(), m_porAbrir.end(), std::greater<int>());
+    m_porAbrir.erase(std::unique(m_porAbrir.begin(), m_porAbrir.end()),
+                     m_porAbrir.end());
+
+    for (int k : m_porAbrir) {
+        if (p.tipo[k] == AlmacenProyectiles::CargaRacimo)
+            fragmentar(k, 24, 4.0, 2.0, 60.0, true);
+        else
+            fragmentar(k, 400, 2.0, 0.25, 160.0, false);
+    }
+    m_porAbrir.clear();
+}
+
+// Sustituye el proyectil i por 'cuantos' fragmentos que heredan su
+// velocidad mas un empuje radial (en abanico regular o al azar).
+void MundoSimulacion::fragmentar(int i, int cuantos, double radio, double masa,
+                                 double rapidez, bool abanico)
+{
+    AlmacenProyectiles &p = m_proyectiles;
+    const Vector2D pos = p.posicion(i);
+    const Vector2D vel = p.velocidad(i);
+    const double vida  = p.tiempoVida[i];
+    p.eliminar(i);
+
+    cuantos = std::min(cuantos, kMaxProyectiles - p.tamano());
+    for (int f = 0; f < cuantos; ++f) {
+        double ang = abanico ? (2.0*kPi * f) / cuantos
+                             : 2.0*kPi * aleatorio();
+        double emp = abanico ? rapidez : rapidez * (0.3 + 0.7*aleatorio());
+        Vector2D v = vel * 0.6 + Vector2D(std::cos(ang), std::sin(ang)) * emp;
+        int nuevo = p.agregar(pos, v, radio, masa);
+        p.tiempoVida[nuevo] = vida;
+    }
+}
+
+// Quita los proyectiles que salieron de la escena, se frenaron o
+// llevan demasiado tiempo en vuelo.
+void MundoSimulacion::eliminarFueraDeJuego(double dt)
+{
+    AlmacenProyectiles &p = m_proyectiles;
+    for (int k = p.tamano() - 1; k >= 0; --k) {
+        p.tiempoVida[k] += dt;
+        const double r = p.radio[k];
+        const double vel = magnitud(p.velocidad(k));
+
+        if (p.y[k] - r > m_alto + 50 ||
+            p.x[k] + r < -50 ||
+            p.x[k] - r > m_ancho + 50 ||
+            p.tiempoVida[k] > kTiempoVida || vel < kVelocidadMinima)
+        {
+            p.eliminar(k);
+        }
+    }
+}
+
+// El proyectil k toco a un rival: decide la victoria.
+void MundoSimulacion::registrarGolpeRival(int k, Bando golpeado)
+{
+    // Si ya hubo ganador, ignoramos nuevos impactos
+    if (m_hayGanador)
+        return;
+
+    // ¿Toca a los dos a la vez? Caso muy raro: damos la victoria al
+    // rival del turno.
+    const RectMundo &otro = m_rectRival[golpeado == Izquierda ? Derecha : Izquierda];
+    Vector2D pos(m_proyectiles.x[k], m_proyectiles.y[k]);
+    if (circuloIntersecaRect(pos, m_proyectiles.radio[k], otro))
+        m_ganador = (m_turno == Izquierda) ? Derecha : Izquierda;
+    else
+        // Golpear al jugador de un lado (propio o enemigo) da la
+        // victoria al del otro lado.
+        m_ganador = (golpeado == Izquierda) ? Derecha : Izquierda;
+
+    m_hayGanador = true;
+    m_sucesos.agregar(Suceso::GolpeRival, golpeado, 0.0, pos);
+}
+
+// Retira los proyectiles que queden y alterna el turno
+void MundoSimulacion::finalizarTurno()
+{
+    m_proyectiles.limpiar();
+    m_turno = (m_turno == Izquierda) ? Derecha : Izquierda;
+}
+
+// Solo lo que sigue vivo entre turnos: los proyectiles y los bloques que
+// caen ya terminaron cuando se compara.
+std::uint64_t MundoSimulacion::hashEstado() const
+{
+    Huella h;
+    const auto rect = [&h](const RectMundo &r) {
+        h.real(r.x);
+        h.real(r.y);
+        h.real(r.ancho);
+        h.real(r.alto);
+    };
+
+    h.palabra(std::uint64_t(m_turno) | std::uint64_t(m_hayGanador) << 8 |
+              std::uint64_t(m_ganador) << 16 | std::uint64_t(m_integrador) << 24 |
+              std::uint64_t(m_semilla) << 32);
+    h.real(m_arrastre);
+    h.real(m_viento.x);
+    h.real(m_viento.y);
+    h.real(m_gravedad);
+    h.real(m_coefRestEstructura);
+    h.real(m_factorDanio);
+
+    // El nivel: dos pares con otro tamaño u otros rivales tambien se
+    // separarian aunque el resto coincida.
+    h.real(m_ancho);
+    h.real(m_alto);
+    h.real(m_altoSuelo);
+    h.palabra(m_hayTerreno);
+    for (int b = 0; b < 2; ++b) {
+        rect(m_rectRival[b]);
+        rect(m_rectCanion[b]);
+        rect(m_rectPlataforma[b]);
+    }
+
+    h.palabra(m_rectBloques.size());
+    for (std::size_t i = 0; i < m_rectBloques.size(); ++i) {
+        rect(m_rectBloques[i]);
+        h.real(m_resistencia[i]);
+        h.palabra(m_destruido[i]);
+        h.palabra(m_ladoBloque[i]);
+    }
+
+    const Escombros &e = m_escombros;
+    h.reales(e.x);
+    h.reales(e.y);
+    h.reales(e.angulo);
+    h.reales(e.vx);
+    h.reales(e.vy);
+    h.reales(e.w);
+
+    if (m_terreno.activo()) {
+        const std::size_t palabras = std::size_t(m_terreno.palabrasPorFila());
+        for (int y = m_terreno.filaSuperior(); y < m_terreno.alto(); ++y) {
+            const std::uint64_t *fila = m_terreno.fila(y);
+            for (std::size_t w = 0; w < palabras; ++w)
+                h.palabra(fila[w]);
+        }
+    }
+    return h.valor();
+}
+
+// Numero pseudoaleatorio en [0, 1) (xorshift32).
+double MundoSimulacion::aleatorio()
+{
+    m_semilla ^= m_semilla << 13;
+    m_semilla ^= m_semilla >> 17;
+    m_semilla ^= m_semilla << 5;
+    return (m_semilla >> 8) * (1.0 / 16777216.0);
+}
@@ -0,0 +1,342 @@
+#ifndef MUNDOSIMULACION_H
+#define MUNDOSIMULACION_H
+
+#include <vector>
+#include <cstdint>
+#include "vector2d.h"
+#include "almacenproyectiles.h"
+#include "colaindexada.h"
+#include "integrador.h"
+#include "sucesosfisica.h"
+#include "rejillabloques.h"
+#include "grafoapoyos.h"
+#include "escombros.h"
+#include "terreno.h"
+
+// RectMundo:
+//  - Rectangulo alineado a los ejes, en coordenadas de escena.
+//  - Equivale a QRectF pero sin depender de Qt.
+struct RectMundo {
+    double x{0.0}, y{0.0}, ancho{0.0}, alto{0.0};
+    RectMundo() = default;
+    RectMundo(double x_, double y_, double ancho_, double alto_)
+        : x(x_), y(y_), ancho(ancho_), alto(alto_) {}
+
+    double izquierda() const { return x; }
+    double derecha()   const { return x + ancho; }
+    double arriba()    const { return y; }
+    double abajo()     const { return y + alto; }
+    Vector2D centro()  const { return {x + ancho/2.0, y + alto/2.0}; }
+};
+
+// Los niveles binarios guardan RectMundo tal cual esta en memoria.
+static_assert(sizeof(RectMundo) == 4*sizeof(double), "RectMundo sin relleno");
+
+// Chequeo geometrico: ¿un circulo intersecta un rectangulo?
+bool circuloIntersecaRect(const Vector2D &c, double r, const RectMundo &rect);
+
+// Barrido de un circulo de radio r que se mueve de p0 a p0 + d contra un
+// rectangulo. Si lo toca con t ∈ [0, 1] devuelve true, el instante del
+// primer contacto y la normal de la cara (o esquina) golpeada.
+bool barridoCirculoRect(const Vector2D &p0, const Vector2D &d, double r,
+                        const RectMundo &rect, double &t, Vector2D &normal);
+
+// MundoSimulacion:
+//  - Nucleo de la fisica del juego, en C++ puro (sin Qt, sin audio).
+//  - Guarda bloques, rivales y cañones en arreglos planos.
+//  - Avanza con paso(dt) sin tocar nada fuera de si mismo: lo que
+//    ocurrio (golpes, rebotes, bloques movidos...) se acumula en un
+//    buffer de sucesos que la vista (EscenaJuego) recoge una vez por
+//    frame para dibujar y reproducir sonidos.
+//  - Los bloques que se quedan sin apoyo (GrafoApoyos) se deslizan de lo
+//    que aun tocan y caen en vertical, golpean lo que tienen debajo y se
+//    asientan; el turno no termina hasta que todo queda quieto.
+//  - Los bloques destruidos se rompen en escombros (Escombros) que caen
+//    y se apilan; el proyectil rebota en ellos y los empuja.
+//  - Opcionalmente el suelo es un Terreno destructible (con colinas): el
+//    proyectil que lo toca abre un crater y se detiene, y lo que quede sin
+//    suelo debajo cae.
+class MundoSimulacion
+{
+public:
+    enum Bando { Izquierda, Derecha };
+
+    // Cuantos proyectiles salen por disparo y como se dividen.
+    enum ModoDisparo {
+        DisparoSimple,    // un solo proyectil
+        DisparoSalva,     // varios proyectiles en abanico
+        DisparoRacimo,    // se abre en submuniciones en el punto mas alto
+        DisparoMetralla   // estalla en cientos de fragmentos al primer golpe
+    };
+
+    // Limite de proyectiles simultaneos (acota el coste por paso).
+    static constexpr int kMaxProyectiles = 20000;
+
+    // Ancho o alto maximo del mundo en px (acota la mascara del terreno y
+    // la rejilla). Los archivos de nivel y de partida se rechazan por
+    // encima.
+    static constexpr double kLadoMaximo = 16384.0;
+
+    // Masa de un bloque por px² (para el daño de los que caen).
+    static constexpr double kDensidadBloque = 0.002;
+
+    // Elevacion del terreno: medio coseno de 'ancho' centrado en 'centro'
+    // que sube 'alto' sobre la linea del suelo.
+    struct Colina {
+        double centro{0.0}, ancho{0.0}, alto{0.0};
+    };
+
+    // Resumen de un paso de simulacion (lo demas queda en sucesos()).
+    struct ResultadoPaso {
+        bool golpeRival{false};      // el proyectil alcanzo a un jugador
+        bool turnoTerminado{false};  // ya no queda proyectil ni bloque en movimiento
+    };
+
+    explicit MundoSimulacion(double ancho = 1200.0, double alto = 600.0);
+
+    // --- construccion del nivel ---
+    void limpiar();
+    // Cambia el tamaño del mundo (lo fija el archivo de nivel).
+    void fijarTamano(double ancho, double alto);
+    int  agregarBloque(const RectMundo &rect, double resistencia, Bando lado);
+    // Reemplaza todos los bloques de una vez copiando arreglos con el
+    // mismo formato en memoria que los del mundo (RectMundo, double y un
+    // byte por lado), p. ej. directamente desde un nivel mapeado. Los
+    // punteros no necesitan estar alineados.
+    void cargarBloques(int n, const void *rects, const void *resistencias,
+                       const std::uint8_t *lados);
+    void fijarRival(Bando bando, const RectMundo &rect);
+    void fijarCanion(Bando bando, const RectMundo &rect);
+    void fijarPlataforma(Bando bando, const RectMundo &rect);
+
+    // Cambia el suelo plano por terreno destructible: celdas llenas desde
+    // la linea del suelo hasta el fondo del mundo, mas las colinas. El fondo
+    // queda como suelo firme (lo que atraviesa el terreno se apoya ahi).
+    void activarTerreno(bool activo);
+    void agregarColina(const Colina &colina);
+
+    // Nivel original de la practica (dos estructuras de tres bloques).
+    // Recibe el tamaño de los sprites para colocar rivales y cañones; las
+    // resistencias de columnas y techo se pueden cambiar para equilibrar
+    // el juego (herramientas/torneo).
+    void construirNivelBase(double anchoRival, double altoRival,
+                            double anchoCanion, double altoCanion,
+                            double resistenciaColumna = 200.0,
+                            double resistenciaTecho = 150.0);
+
+    // --- partida ---
+    void reiniciarPartida();
+    // Revancha: bloques con la resistencia con que se agregaron y turno inicial.
+    void restaurarNivel();
+    bool disparar(double anguloGrados, double velocidad,
+                  ModoDisparo modo = DisparoSimple);
+    ResultadoPaso paso(double dt);
+
+    // Salto al final del turno: en vez de pasos de dt, cada proyectil
+    // sigue su parabola exacta hasta el siguiente evento (choque,
+    // apertura de carga, fin de vida) y se resuelve ese evento. El coste
+    // es proporcional a los rebotes, no a los frames. Los sucesos de
+    // todo el turno quedan en sucesos(). Con arrastre el vuelo ya no es
+    // una parabola: se simula a pasos fijos sin dibujar.
+    ResultadoPaso resolverAlInstante();
+
+    // Radio y masa del proyectil principal de cada modo de disparo.
+    static double radioProyectil(ModoDisparo modo);
+    static double masaProyectil(ModoDisparo modo);
+
+    // Trayectoria prevista del disparo del bando con turno: la parabola
+    // exacta (sin integrar; con arrastre, RK4) muestreada cada 'intervalo'
+    // segundos hasta el primer contacto con pared, suelo, bloque o rival.
+    // Deja los puntos en 'puntos' (el ultimo es el del contacto) y
+    // devuelve true si choca antes de que el proyectil expire.
+    bool preverTrayectoria(double anguloGrados, double velocidad, ModoDisparo modo,
+                           std::vector<Vector2D> &puntos, double intervalo = 1.0/60.0);
+
+    // --- consultas ---
+    double ancho() const { return m_ancho; }
+    double alto() const { return m_alto; }
+    double altoSuelo() const { return m_altoSuelo; }
+    bool hayTerreno() const { return m_hayTerreno; }
+    // Celdas del terreno; cambios() dice que se excavo desde el ultimo
+    // tomarSucesos() (o desde que se genero, tras cambiar de nivel o
+    // restaurarlo).
+    const Terreno &terreno() const { return m_terreno; }
+    int numColinas() const { return int(m_colinas.size()); }
+    const Colina &colina(int i) const { return m_colinas[i]; }
+
+    Bando turno() const { return m_turno; }
+    // Cambia quien dispara (p. ej. para que un torneo alterne quien abre).
+    void fijarTurno(Bando b) { m_turno = b; }
+    bool hayGanador() const { return m_hayGanador; }
+    Bando ganador() const { return m_ganador; }
+
+    bool hayProyectilesEnVuelo() const { return !m_proyectiles.vacio(); }
+    // Proyectiles en vuelo, bloques cayendo o escombros despiertos: el
+    // turno sigue en curso.
+    bool hayMovimiento() const
+    {
+        return !m_proyectiles.vacio() || !m_cayendo.empty() || m_escombros.hayDespiertos();
+    }
+    const AlmacenProyectiles &proyectiles() const { return m_proyectiles; }
+    const Escombros &escombros() const { return m_escombros; }
+
+    // Sucesos desde la ultima llamada a tomarSucesos() (o desde que se
+    // cargo el nivel o empezo la partida).
+    const SucesosFisica &sucesos() const { return m_sucesos; }
+    // Deja los sucesos en 'destino' (lo que tuviera se descarta) y sigue
+    // llenando el buffer de 'destino': no copia ni pide memoria. Olvida
+    // tambien los cambios del terreno, que hay que leer antes.
+    void tomarSucesos(SucesosFisica &destino);
+
+    int numBloques() const { return int(m_rectBloques.size()); }
+    const RectMundo &rectBloque(int i) const { return m_rectBloques[i]; }
+    const RectMundo &rectInicialBloque(int i) const { return m_rectInicial[i]; }
+    double resistenciaBloque(int i) const { return m_resistencia[i]; }
+    double resistenciaInicialBloque(int i) const { return m_resistenciaInicial[i]; }
+    bool bloqueDestruido(int i) const { return m_destruido[i] != 0; }
+    Bando ladoBloque(int i) const { return Bando(m_ladoBloque[i]); }
+
+    const RectMundo &rectRival(Bando b) const { return m_rectRival[b]; }
+    const RectMundo &rectCanion(Bando b) const { return m_rectCanion[b]; }
+    const RectMundo &rectPlataforma(Bando b) const { return m_rectPlataforma[b]; }
+
+    // --- parametros fisicos ---
+    double gravedad() const { return m_gravedad; }
+    double coefRestEstructura() const { return m_coefRestEstructura; }
+    double factorDanio() const { return m_factorDanio; }
+    void fijarGravedad(double g) { m_gravedad = g; }
+    void fijarCoefRestEstructura(double e) { m_coefRestEstructura = e; }
+    void fijarFactorDanio(double f) { m_factorDanio = f; }
+
+    // Metodo de integracion y aire (ver ModeloFuerzas). Sin arrastre el
+    // vuelo es la parabola de siempre y el viento no cuenta.
+    Integrador integrador() const { return m_integrador; }
+    double arrastre() const { return m_arrastre; }
+    const Vector2D &viento() const { return m_viento; }
+    void fijarIntegrador(Integrador metodo) { m_integrador = metodo; }
+    void fijarAire(double arrastre, const Vector2D &viento)
+    {
+        m_arrastre = arrastre;
+        m_viento = viento;
+    }
+    ModeloFuerzas fuerzas() const;
+    // Paso mas largo (pasoBase por 1, 1.5, 2 o 3, sin pasar de pasoMaximo)
+    // con el que el integrador de la partida no se aleja del vuelo exacto
+    // mas que Euler con pasoBase (ver elegirPaso). Euler da pasoBase.
+    double pasoRecomendado(double pasoBase, double pasoMaximo) const;
+
+    // Estado del generador de la metralla (para grabar y reproducir).
+    std::uint32_t semilla() const { return m_semilla; }
+    void fijarSemilla(std::uint32_t s) { m_semilla = s ? s : 0x9E3779B9u; }
+
+    // Huella de 64 bits de lo que decide el resto de la partida: turno,
+    // generador, parametros fisicos, tamaño del mundo, rivales, cañones,
+    // plataformas, bloques, escombros y terreno. Dos mundos que empezaron
+    // igual y recibieron los mismos disparos dan la misma (la partida en
+    // red la compara en el saludo y al final de cada turno).
+    std::uint64_t hashEstado() const;
+
+private:
+    // Proximo suceso de un proyectil en el salto por eventos.
+    struct Evento {
+        enum Tipo : std::uint8_t { Expira, Pared, Bloque, Rival, Apertura, Escombro, Crater };
+        double   t{0.0};          // instante absoluto dentro del salto
+        Tipo     tipo{Expira};
+        int      objetivo{-1};    // bloque, bando o escombro golpeado
+        Vector2D normal;
+        int      crateres{0};     // crateres del salto cuando se calculo
+    };
+
+    // Donde se apoya todo: la linea del suelo, o el fondo con terreno.
+    double nivelSuelo() const { return m_hayTerreno ? m_alto : m_alto - m_altoSuelo; }
+    ResultadoPaso resolverAPasos();
+    void asegurarRejilla();
+    void generarTerreno();
+    double abrirCrater(const Vector2D &punto, double masa, const Vector2D &vel,
+                       double radioProyectil);
+    void moverBloquesCayendo(double dt);
+    void marcarMovido(int bloque);
+    void moverEscombros(double dt);
+    void romperBloque(int bloque);
+    Vector2D golpearEscombro(int escombro, const Vector2D &punto,
+                             const Vector2D &normal, const Vector2D &vel,
+                             double masa);
+    Evento proximoEvento(int k, double ahora);
+    void resolverChoquesBarridos(double dt);
+    void barrerProyectil(int k, double dt);
+    void registrarGolpeRival(int k, Bando golpeado);
+    bool aplicarDanio(int bloque, double danio, const Vector2D &punto);
+    void abrirCargas();
+    void fragmentar(int i, int cuantos, double radio, double masa,
+                    double rapidez, bool abanico);
+    void eliminarFueraDeJuego(double dt);
+    void finalizarTurno();
+    double aleatorio();
+
+    double m_ancho;
+    double m_alto;
+    double m_altoSuelo{20.0};
+
+    double m_gravedad{200.0};
+    double m_coefRestEstructura{0.5};
+    double m_factorDanio{0.02};
+    Integrador m_integrador{Integrador::EulerSemiImplicito};
+    double     m_arrastre{0.0};
+    Vector2D   m_viento;
+
+    Bando m_turno{Izquierda};
+    bool  m_hayGanador{false};
+    Bando m_ganador{Izquierda};
+
+    AlmacenProyectiles m_proyectiles;
+    std::vector<int>   m_porAbrir;     // cargas de metralla que golpearon
+
+    // Generador propio (xorshift) para que la metralla sea reproducible.
+    std::uint32_t m_semilla{0x9E3779B9u};
+
+    // Bloques: un indice comun para todos los arreglos.
+    std::vector<RectMundo>    m_rectBloques;
+    std::vector<RectMundo>    m_rectInicial;     // antes de cualquier derrumbe
+    std::vector<double>       m_resistencia;
+    std::vector<double>       m_resistenciaInicial;
+    std::vector<std::uint8_t> m_destruido;
+    std::vector<std::uint8_t> m_ladoBloque;
+
+    // Fase amplia: se reconstruye solo si cambia la geometria del nivel.
+    RejillaBloques   m_rejilla;
+    bool             m_rejillaSucia{true};
+    std::vector<int> m_candidatos;
+
+    // Derrumbes: quien sostiene a quien y los bloques que estan cayendo
+    // (siguen en la rejilla, que se actualiza al moverlos).
+    GrafoApoyos      m_apoyos;
+    bool             m_apoyosSucios{true};
+    std::vector<int> m_cayendo;
+    std::vector<int> m_cayendoPaso;
+    std::vector<double> m_vyBloque;
+    std::vector<std::int8_t> m_sentidoVuelco;   // ultimo deslizamiento (0: ninguno)
+
+    // Pedazos de los bloques destruidos.
+    Escombros        m_escombros;
+    std::vector<int> m_escombrosCerca;
+
+    // Suelo destructible (vacio si !m_hayTerreno).
+    bool                m_hayTerreno{false};
+    std::vector<Colina> m_colinas;
+    Terreno             m_terreno;
+    std::vector<int>    m_sobreCrater;
+
+    RectMundo m_rectRival[2];
+    RectMundo m_rectCanion[2];
+    RectMundo m_rectPlataforma[2];
+
+    // Lo que ve la vista; m_marcas evita repetir un bloque en sus listas.
+    static constexpr std::uint8_t kMarcaDaniado = 1;
+    static constexpr std::uint8_t kMarcaMovido  = 2;
+    SucesosFisica             m_sucesos;
+    std::vector<std::uint8_t> m_marcas;   // kMarcaDaniado | kMarcaMovido
+    std::vector<Evento>  m_eventos;    // paralelo al almacen (resolverAlInstante)
+    ColaIndexada         m_colaEventos;   // indices de m_eventos por instante
+};
+
+#endif // MUNDOSIMULACION_H
@@ -0,0 +1,384 @@
+#include "nivel.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+namespace {
+
+const char kMagia[4] = {'P', '5', 'N', 'V'};
+
+// Cabecera fija: magia, version, nBloques, tamaño del mundo y los 6
+// rectangulos de los bandos. Multiplo de 8 para que los arreglos que
+// siguen queden alineados.
+constexpr std::size_t kBytesCabecera = 16 + 2*8 + 6*sizeof(RectMundo);
+constexpr std::size_t kBytesPorBloque = sizeof(RectMundo) + sizeof(double) + 1;
+constexpr std::size_t kBytesPorColina = sizeof(MundoSimulacion::Colina);
+static_assert(kBytesCabecera % 8 == 0, "cabecera alineada");
+static_assert(kBytesPorColina == 3*sizeof(double), "colina sin relleno");
+
+constexpr std::uint16_t kBanderaTerreno = 1;
+
+// El binario guarda los arreglos con el orden de bytes de la memoria;
+// solo coincide con el del formato en maquinas little-endian.
+bool maquinaLittleEndian()
+{
+    const std::uint16_t uno = 1;
+    std::uint8_t primero;
+    std::memcpy(&primero, &uno, 1);
+    return primero == 1;
+}
+
+std::uint32_t leerU32(const std::uint8_t *p)
+{
+    return std::uint32_t(p[0]) | std::uint32_t(p[1]) << 8 |
+           std::uint32_t(p[2]) << 16 | std::uint32_t(p[3]) << 24;
+}
+
+void escribirU32(std::uint8_t *p, std::uint32_t v)
+{
+    for (int i = 0; i < 4; ++i)
+        p[i] = std::uint8_t(v >> (8*i));
+}
+
+// Los niveles se intercambian como archivos: nada de NaN, infinitos ni
+// coordenadas desmedidas, que la rejilla y el terreno pasan a enteros.
+constexpr double kCoordenadaMaxima = 4.0 * MundoSimulacion::kLadoMaximo;
+
+bool acotado(double v) { return std::isfinite(v) && std::abs(v) <= kCoordenadaMaxima; }
+
+bool tamanoValido(double ancho, double alto)
+{
+    return ancho > 0.0 && ancho <= MundoSimulacion::kLadoMaximo &&
+           alto > 0.0 && alto <= MundoSimulacion::kLadoMaximo;
+}
+
+bool rectValido(const RectMundo &r)
+{
+    return acotado(r.x) && acotado(r.y) && acotado(r.ancho) && acotado(r.alto) &&
+           r.ancho >= 0.0 && r.alto >= 0.0;
+}
+
+bool colinaValida(const MundoSimulacion::Colina &c)
+{
+    return acotado(c.centro) && acotado(c.ancho) && acotado(c.alto) &&
+           c.ancho > 0.0 && c.alto >= 0.0;
+}
+
+const std::string kErrorTamano = "el mundo debe medir mas de 0 y hasta " +
+                                 std::to_string(int(MundoSimulacion::kLadoMaximo)) +
+                                 " px de ancho y de alto";
+
+const char *nombreLado(int lado) { return lado == 0 ? "izquierda" : "derecha"; }
+
+bool leerLado(const std::string &palabra, int &lado)
+{
+    if (palabra == "izquierda") { lado = 0; return true; }
+    if (palabra == "derecha")   { lado = 1; return true; }
+    return false;
+}
+
+} // namespace
+
+bool Nivel::fallar(const std::string &motivo)
+{
+    m_error = motivo;
+    return false;
+}
+
+bool Nivel::abrir(const std::string &ruta)
+{
+    ArchivoMapeado archivo;
+    if (!archivo.abrir(ruta))
+        return fallar("no se pudo abrir " + ruta);
+
+    if (!desdeMemoria(archivo.datos(), archivo.tamano()))
+        return false;
+
+    // Un binario sigue apuntando al mapeo; hay que conservarlo.
+    m_archivo = std::move(archivo);
+    return true;
+}
+
+bool Nivel::desdeMemoria(const std::uint8_t *datos, std::size_t tamano)
+{
+    if (tamano >= 4 && std::memcmp(datos, kMagia, 4) == 0)
+        return desdeBinario(datos, tamano);
+    return desdeTexto(std::string(reinterpret_cast<const char *>(datos), tamano));
+}
+
+// Se validan los tamaños, los lados y que todos los numeros sean finitos
+// y acotados; despues los bloques se copian tal cual.
+bool Nivel::desdeBinario(const std::uint8_t *datos, std::size_t tamano)
+{
+    if (!maquinaLittleEndian())
+        return fallar("los niveles binarios necesitan una maquina little-endian");
+    if (tamano < kBytesCabecera)
+        return fallar("nivel binario truncado");
+
+    const std::uint16_t version = std::uint16_t(datos[4] | datos[5] << 8);
+    if (version != 1 && version != kVersion)
+        return fallar("version de nivel no soportada");
+
+    // La version 1 tiene ceros donde la 2 guarda banderas y colinas.
+    const std::uint16_t banderas = version >= 2 ? std::uint16_t(datos[6] | datos[7] << 8) : 0;
+    const std::uint32_t nColinas = version >= 2 ? leerU32(datos + 12) : 0;
+    if ((tamano - kBytesCabecera) / kBytesPorColina < nColinas)
+        return fallar("nivel binario truncado");
+    const std::size_t bytesColinas = std::size_t(nColinas) * kBytesPorColina;
+
+    const std::uint32_t n = leerU32(datos + 8);
+    if (n > std::uint32_t(std::numeric_limits<int>::max()) ||
+        (tamano - kBytesCabecera - bytesColinas) / kBytesPorBloque < n)
+        return fallar("nivel binario truncado");
+
+    const std::uint8_t *bloques = datos + kBytesCabecera + bytesColinas;
+    const std::uint8_t *lados = bloques + n*(sizeof(RectMundo) + sizeof(double));
+    if (std::any_of(lados, lados + n, [](std::uint8_t l) { return l > 1; }))
+        return fallar("lado de bloque invalido");
+
+    const std::uint8_t *p = datos + 16;
+    double ancho, alto;
+    std::memcpy(&ancho, p, 8);
+    std::memcpy(&alto,  p + 8, 8);
+    if (!tamanoValido(ancho, alto))
+        return fallar(kErrorTamano);
+    p += 16;
+    RectMundo fijos[6];
+    std::memcpy(fijos, p, sizeof fijos);
+    p += sizeof fijos;
+    if (!std::all_of(fijos, fijos + 6, rectValido))
+        return fallar("rival, cañon o plataforma con medidas invalidas");
+
+    std::vector<MundoSimulacion::Colina> colinas(nColinas);
+    if (nColinas > 0)
+        std::memcpy(colinas.data(), p, bytesColinas);
+    if (!std::all_of(colinas.begin(), colinas.end(), colinaValida))
+        return fallar("colina con medidas invalidas");
+
+    for (std::uint32_t i = 0; i < n; ++i) {
+        RectMundo r;
+        double resistencia;
+        std::memcpy(&r, bloques + i*sizeof(RectMundo), sizeof r);
+        std::memcpy(&resistencia, bloques + n*sizeof(RectMundo) + i*sizeof(double),
+                    sizeof resistencia);
+        if (!rectValido(r) || !acotado(resistencia))
+            return fallar("bloque " + std::to_string(i) + " con medidas o resistencia invalidas");
+    }
+
+    m_ancho = ancho;
+    m_alto  = alto;
+    for (int b = 0; b < 2; ++b) {
+        m_rectRival[b]      = fijos[3*b];
+        m_rectCanion[b]     = fijos[3*b + 1];
+        m_rectPlataforma[b] = fijos[3*b + 2];
+    }
+    m_terreno = (banderas & kBanderaTerreno) != 0 || nColinas > 0;
+    m_colinas = std::move(colinas);
+
+    m_numBloques   = int(n);
+    m_rects        = bloques;
+    m_resistencias = bloques + n*sizeof(RectMundo);
+    m_lados        = lados;
+
+    m_rectsTexto.clear();
+    m_resistenciasTexto.clear();
+    m_ladosTexto.clear();
+    m_archivo.cerrar();
+    m_error.clear();
+    return true;
+}
+
+bool Nivel::desdeTexto(const std::string &texto)
+{
+    std::vector<RectMundo>    rects;
+    std::vector<double>       resistencias;
+    std::vector<std::uint8_t> lados;
+    double ancho = 0.0, alto = 0.0;
+    RectMundo rival[2], canion[2], plataforma[2];
+    bool terreno = false;
+    std::vector<MundoSimulacion::Colina> colinas;
+
+    std::istringstream entrada(texto);
+    std::string linea;
+    for (int numLinea = 1; std::getline(entrada, linea); ++numLinea) {
+        const std::size_t comentario = linea.find('#');
+        if (comentario != std::string::npos)
+            linea.erase(comentario);
+
+        std::istringstream campos(linea);
+        std::string clave;
+        if (!(campos >> clave))
+            continue;
+
+        auto errorLinea = [&](const std::string &motivo) {
+            return fallar("linea " + std::to_string(numLinea) + ": " + motivo);
+        };
+
+        if (clave == "mundo") {
+            if (!(campos >> ancho >> alto))
+                return errorLinea("se esperaba 'mundo <ancho> <alto>'");
+            if (!tamanoValido(ancho, alto))
+                return errorLinea(kErrorTamano);
+        } else if (clave == "bloque") {
+            RectMundo r;
+            double resistencia;
+            std::string palabra;
+            int lado;
+            if (!(campos >> r.x >> r.y >> r.ancho >> r.alto >> resistencia >> palabra) ||
+                !leerLado(palabra, lado))
+                return errorLinea("se esperaba 'bloque <x> <y> <ancho> <alto> "
+                                  "<resistencia> <izquierda|derecha>'");
+            if (!rectValido(r) || !acotado(resistencia))
+                return errorLinea("bloque con medidas o resistencia invalidas");
+            rects.push_back(r);
+            resistencias.push_back(resistencia);
+            lados.push_back(std::uint8_t(lado));
+        } else if (clave == "rival" || clave == "canion" || clave == "plataforma") {
+            RectMundo r;
+            std::string palabra;
+            int lado;
+            if (!(campos >> palabra) || !leerLado(palabra, lado) ||
+                !(campos >> r.x >> r.y >> r.ancho >> r.alto))
+                return errorLinea("se esperaba '" + clave +
+                                  " <izquierda|derecha> <x> <y> <ancho> <alto>'");
+            if (!rectValido(r))
+                return errorLinea(clave + " con medidas invalidas");
+            RectMundo *destino = clave == "rival"  ? rival
+                               : clave == "canion" ? canion
+                                                   : plataforma;
+            destino[lado] = r;
+        } else if (clave == "terreno") {
+            terreno = true;
+        } else if (clave == "colina") {
+            MundoSimulacion::Colina c;
+            if (!(campos >> c.centro >> c.ancho >> c.alto) || !colinaValida(c))
+                return errorLinea("se esperaba 'colina <centro> <ancho> <alto>'");
+            colinas.push_back(c);
+            terreno = true;
+        } else {
+            return errorLinea("entrada desconocida '" + clave + "'");
+        }
+
+        std::string sobra;
+        if (campos >> sobra)
+            return errorLinea("sobra '" + sobra + "'");
+    }
+
+    if (ancho <= 0.0)
+        return fallar("falta la linea 'mundo <ancho> <alto>'");
+
+    m_ancho = ancho;
+    m_alto  = alto;
+    for (int b = 0; b < 2; ++b) {
+        m_rectRival[b]      = rival[b];
+        m_rectCanion[b]     = canion[b];
+        m_rectPlataforma[b] = plataforma[b];
+    }
+    m_terreno           = terreno;
+    m_colinas           = std::move(colinas);
+    m_rectsTexto        = std::move(rects);
+    m_resistenciasTexto = std::move(resistencias);
+    m_ladosTexto        = std::move(lados);
+
+    m_numBloques   = int(m_rectsTexto.size());
+    m_rects        = m_rectsTexto.data();
+    m_resistencias = m_resistenciasTexto.data();
+    m_lados        = m_ladosTexto.data();
+    m_archivo.cerrar();
+    m_error.clear();
+    return true;
+}
+
+void Nivel::aplicar(MundoSimulacion &mundo) const
+{
+    mundo.limpiar();
+    mundo.fijarTamano(m_ancho, m_alto);
+    if (m_terreno) {
+        mundo.activarTerreno(true);
+        for (const MundoSimulacion::Colina &c : m_colinas)
+            mundo.agregarColina(c);
+    }
+    mundo.cargarBloques(m_numBloques, m_rects, m_resistencias, m_lados);
+    for (int b = 0; b < 2; ++b) {
+        const MundoSimulacion::Bando bando = MundoSimulacion::Bando(b);
+        mundo.fijarRival(bando, m_rectRival[b]);
+        mundo.fijarCanion(bando, m_rectCanion[b]);
+        mundo.fijarPlataforma(bando, m_rectPlataforma[b]);
+    }
+}
+
+std::vector<std::uint8_t> Nivel::serializar(const MundoSimulacion &mundo)
+{
+    const std::size_t n = std::size_t(mundo.numBloques());
+    const std::size_t nColinas = std::size_t(mundo.numColinas());
+    std::vector<std::uint8_t> datos(kBytesCabecera + nColinas*kBytesPorColina +
+                                    n*kBytesPorBloque, 0);
+    std::uint8_t *p = datos.data();
+
+    std::memcpy(p, kMagia, 4);
+    p[4] = std::uint8_t(kVersion);
+    p[5] = std::uint8_t(kVersion >> 8);
+    p[6] = mundo.hayTerreno() ? std::uint8_t(kBanderaTerreno) : 0;
+    escribirU32(p + 8, std::uint32_t(n));
+    escribirU32(p + 12, std::uint32_t(nColinas));
+
+    const double ancho = mundo.ancho(), alto = mundo.alto();
+    std::memcpy(p + 16, &ancho, 8);
+    std::memcpy(p + 24, &alto, 8);
+    p += 32;
+    for (int b = 0; b < 2; ++b) {
+        const MundoSimulacion::Bando bando = MundoSimulacion::Bando(b);
+        std::memcpy(p, &mundo.rectRival(bando),      sizeof(RectMundo)); p += sizeof(RectMundo);
+        std::memcpy(p, &mundo.rectCanion(bando),     sizeof(RectMundo)); p += sizeof(RectMundo);
+        std::memcpy(p, &mundo.rectPlataforma(bando), sizeof(RectMundo)); p += sizeof(RectMundo);
+    }
+    for (std::size_t c = 0; c < nColinas; ++c, p += kBytesPorColina)
+        std::memcpy(p, &mundo.colina(int(c)), kBytesPorColina);
+
+    std::uint8_t *rects = p;
+    std::uint8_t *resistencias = rects + n*sizeof(RectMundo);
+    std::uint8_t *lados = resistencias + n*sizeof(double);
+    for (std::size_t i = 0; i < n; ++i) {
+        const double resistencia = mundo.resistenciaInicialBloque(int(i));
+        std::memcpy(rects + i*sizeof(RectMundo), &mundo.rectInicialBloque(int(i)), sizeof(RectMundo));
+        std::memcpy(resistencias + i*sizeof(double), &resistencia, sizeof(double));
+        lados[i] = std::uint8_t(mundo.ladoBloque(int(i)));
+    }
+    return datos;
+}
+
+std::string Nivel::aTexto(const MundoSimulacion &mundo)
+{
+    std::ostringstream s;
+    s << std::setprecision(std::numeric_limits<double>::max_digits10);
+
+    auto rect = [&](const RectMundo &r) {
+        s << r.x << ' ' << r.y << ' ' << r.ancho << ' ' << r.alto;
+    };
+
+    s << "mundo " << mundo.ancho() << ' ' << mundo.alto() << "\n\n";
+    for (int b = 0; b < 2; ++b) {
+        const MundoSimulacion::Bando bando = MundoSimulacion::Bando(b);
+        s << "rival "      << nombreLado(b) << ' '; rect(mundo.rectRival(bando));      s << '\n';
+        s << "canion "     << nombreLado(b) << ' '; rect(mundo.rectCanion(bando));     s << '\n';
+        s << "plataforma " << nombreLado(b) << ' '; rect(mundo.rectPlataforma(bando)); s << '\n';
+    }
+    if (mundo.hayTerreno()) {
+        s << "\nterreno\n";
+        for (int c = 0; c < mundo.numColinas(); ++c) {
+            const MundoSimulacion::Colina &colina = mundo.colina(c);
+            s << "colina " << colina.centro << ' ' << colina.ancho << ' ' << colina.alto << '\n';
+        }
+    }
+    s << "\n# x y ancho alto resistencia lado\n";
+    for (int i = 0; i < mundo.numBloques(); ++i) {
+        s << "bloque ";
+        rect(mundo.rectInicialBloque(i));
+        s << ' ' << mundo.resistenciaInicialBloque(i)
+          << ' ' << nombreLado(mundo.ladoBloque(i)) << '\n';
+    }
+    return s.str();
+}
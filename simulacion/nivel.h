@@ -0,0 +1,101 @@
+#ifndef NIVEL_H
+#define NIVEL_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "archivomapeado.h"
+#include "mundosimulacion.h"
+
+// Nivel:
+//  - Descripcion de un nivel fuera del codigo: tamaño del mundo, bloques
+//    y donde van rivales, cañones y plataformas de cada bando.
+//  - Dos formas: texto (la fuente, editable a mano) y binario (lo que se
+//    distribuye). herramientas/niveles convierte de una a otra.
+//  - El binario se lee mapeado en memoria: los bloques estan guardados
+//    como los arreglos de MundoSimulacion, asi que aplicar() los copia en
+//    bloque sin interpretar campo a campo. El coste de cargar crece solo
+//    con el tamaño del archivo.
+//  - Los dos lectores rechazan (con error()) numeros no finitos,
+//    coordenadas desmedidas y mundos sin tamaño o de mas de
+//    MundoSimulacion::kLadoMaximo: los niveles se intercambian.
+//
+// Formato binario (little-endian, version 2; todas las secciones quedan
+// alineadas a 8 bytes):
+//   "P5NV" u16 version, u16 banderas (bit 0: terreno), u32 nBloques,
+//   u32 nColinas
+//   f64 ancho, f64 alto
+//   6 x (f64 x, y, ancho, alto)          rival, cañon y plataforma por bando
+//   nColinas x (f64 centro, ancho, alto)
+//   nBloques x (f64 x, y, ancho, alto)
+//   nBloques x f64 resistencia
+//   nBloques x u8 lado (0 izquierda, 1 derecha)
+// La version 1 (sin terreno) se sigue leyendo: banderas y nColinas a 0.
+//
+// Formato de texto (una entrada por linea, '#' comenta hasta el final):
+//   mundo <ancho> <alto>
+//   rival|canion|plataforma <izquierda|derecha> <x> <y> <ancho> <alto>
+//   bloque <x> <y> <ancho> <alto> <resistencia> <izquierda|derecha>
+//   terreno                                  suelo destructible
+//   colina <centro> <ancho> <alto>           (implica terreno)
+class Nivel
+{
+public:
+    static constexpr std::uint16_t kVersion = 2;
+
+    Nivel() = default;
+    Nivel(const Nivel &) = delete;
+    Nivel &operator=(const Nivel &) = delete;
+
+    // Binario (se mapea) o texto (se interpreta), segun la cabecera.
+    bool abrir(const std::string &ruta);
+    // Igual que abrir() pero sobre datos ya en memoria (p. ej. un recurso
+    // compilado en el ejecutable). Un binario no se copia: 'datos' debe
+    // seguir vivo mientras se use el nivel.
+    bool desdeMemoria(const std::uint8_t *datos, std::size_t tamano);
+    bool desdeTexto(const std::string &texto);
+
+    // Motivo del ultimo fallo (con numero de linea en los de texto).
+    const std::string &error() const { return m_error; }
+
+    double ancho() const { return m_ancho; }
+    double alto() const { return m_alto; }
+    int numBloques() const { return m_numBloques; }
+
+    // Deja el mundo con este nivel (limpia lo que hubiera antes).
+    void aplicar(MundoSimulacion &mundo) const;
+
+    // Nivel actual del mundo (con la posicion y la resistencia con que
+    // se agregaron los bloques), en cualquiera de los dos formatos.
+    static std::vector<std::uint8_t> serializar(const MundoSimulacion &mundo);
+    static std::string aTexto(const MundoSimulacion &mundo);
+
+private:
+    bool desdeBinario(const std::uint8_t *datos, std::size_t tamano);
+    bool fallar(const std::string &motivo);
+
+    ArchivoMapeado m_archivo;
+    std::string m_error;
+
+    double m_ancho{0.0};
+    double m_alto{0.0};
+    bool   m_terreno{false};
+    std::vector<MundoSimulacion::Colina> m_colinas;
+    RectMundo m_rectRival[2];
+    RectMundo m_rectCanion[2];
+    RectMundo m_rectPlataforma[2];
+
+    // Vistas sobre los arreglos de bloques: apuntan al archivo mapeado
+    // (o a la memoria de desdeMemoria) o a los vectores de abajo si el
+    // nivel vino en texto.
+    int m_numBloques{0};
+    const void         *m_rects{nullptr};
+    const void         *m_resistencias{nullptr};
+    const std::uint8_t *m_lados{nullptr};
+
+    std::vector<RectMundo>    m_rectsTexto;
+    std::vector<double>       m_resistenciasTexto;
+    std::vector<std::uint8_t> m_ladosTexto;
+};
+
+#endif // NIVEL_H
@@ -0,0 +1,114 @@
+#include "particulas.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr float kPi = 3.14159265f;
+
+struct Comportamiento {
+    float gravedad;
+    float frenado;
+    float duracionMin;
+    float duracionMax;
+};
+
+// Por Tipo. La gravedad del polvo es casi nula: flota y se frena.
+constexpr Comportamiento kComportamiento[Particulas::NumTipos] = {
+    { 30.0f, 3.0f, 0.60f, 1.20f},   // Polvo
+    {400.0f, 0.5f, 0.25f, 0.50f},   // Chispa
+    {600.0f, 0.2f, 0.80f, 1.40f},   // Pedazo
+};
+
+// El lazo de avanzar(), con los arreglos como parametros restrict: con
+// los punteros sacados de los miembros GCC no lo vectoriza. Devuelve
+// cuantas siguen vivas.
+int avanzarLote(int n, float dt, float *__restrict px, float *__restrict py,
+                float *__restrict pvx, float *__restrict pvy, float *__restrict pv,
+                const float *__restrict pg, const float *__restrict pf)
+{
+    int vivas = 0;
+    for (int i = 0; i < n; ++i) {
+        float f = 1.0f - pf[i] * dt;
+        f = f > 0.0f ? f : 0.0f;
+        pvx[i] *= f;
+        pvy[i] = pvy[i] * f + pg[i] * dt;
+        px[i] += pvx[i] * dt;
+        py[i] += pvy[i] * dt;
+        pv[i] -= dt;
+        vivas += pv[i] > 0.0f ? 1 : 0;
+    }
+    return vivas;
+}
+
+} // namespace
+
+Particulas::Particulas(int capacidad)
+{
+    const std::size_t n = std::size_t(std::max(capacidad, 1));
+    x.assign(n, 0.0f);
+    y.assign(n, 0.0f);
+    vx.assign(n, 0.0f);
+    vy.assign(n, 0.0f);
+    gravedad.assign(n, 0.0f);
+    frenado.assign(n, 0.0f);
+    vida.assign(n, 0.0f);
+    duracion.assign(n, 1.0f);
+    tipo.assign(n, Polvo);
+}
+
+void Particulas::limpiar()
+{
+    std::fill(vida.begin(), vida.begin() + m_ocupadas, 0.0f);
+    m_siguiente = 0;
+    m_ocupadas = 0;
+    m_vivas = 0;
+}
+
+float Particulas::azar()
+{
+    m_estado ^= m_estado << 13;
+    m_estado ^= m_estado >> 17;
+    m_estado ^= m_estado << 5;
+    return float(m_estado >> 8) * (1.0f / 16777216.0f);
+}
+
+void Particulas::emitir(Tipo t, const Vector2D &punto, int cuantas, double rapidez)
+{
+    const Comportamiento &c = kComportamiento[t];
+    cuantas = std::min(cuantas, capacidad());
+    for (int k = 0; k < cuantas; ++k) {
+        const int i = m_siguiente;
+        if (++m_siguiente == capacidad())
+            m_siguiente = 0;
+        if (i >= m_ocupadas)
+            m_ocupadas = i + 1;
+
+        // En pantalla y crece hacia abajo: hacia arriba es seno negativo.
+        const float angulo = t == Polvo ? 2.0f * kPi * azar()
+                                        : -kPi * (0.15f + 0.7f * azar());
+        const float v = float(rapidez) * (0.3f + 0.7f * azar());
+        x[i] = float(punto.x);
+        y[i] = float(punto.y);
+        vx[i] = v * std::cos(angulo);
+        vy[i] = v * std::sin(angulo);
+        gravedad[i] = c.gravedad;
+        frenado[i] = c.frenado;
+        duracion[i] = c.duracionMin + (c.duracionMax - c.duracionMin) * azar();
+        vida[i] = duracion[i];
+        tipo[i] = t;
+    }
+    m_vivas = std::min(m_vivas + cuantas, m_ocupadas);
+}
+
+void Particulas::avanzar(double dt)
+{
+    const int vivas = avanzarLote(m_ocupadas, float(dt), x.data(), y.data(),
+                                  vx.data(), vy.data(), vida.data(),
+                                  gravedad.data(), frenado.data());
+    m_vivas = vivas;
+    if (vivas == 0) {   // todo apagado: el anillo vuelve a empezar
+        m_siguiente = 0;
+        m_ocupadas = 0;
+    }
+}
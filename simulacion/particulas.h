@@ -0,0 +1,64 @@
+#ifndef PARTICULAS_H
+#define PARTICULAS_H
+
+#include <cstdint>
+#include <vector>
+#include "vector2d.h"
+
+// Particulas:
+//  - Polvo, chispas y pedazos que saltan con los golpes a los bloques, al
+//    romperse y al abrir un crater. Solo se ven: no son parte del mundo,
+//    no entran en hashEstado ni en los registros y tienen su propio azar.
+//  - Anillo de capacidad fija, un arreglo por campo (SoA) en float.
+//    emitir() nunca pide memoria: con el anillo lleno pisa las mas
+//    viejas, que son las primeras que se apagan.
+//  - avanzar() recorre todas las ranuras ocupadas sin ramas (las muertas
+//    tambien, con vida <= 0) para que el compilador lo vectorice; la
+//    vista (CapaParticulas) se salta las muertas al dibujar.
+class Particulas
+{
+public:
+    enum Tipo : std::uint8_t {
+        Polvo,     // lento, casi sin gravedad y muy frenado
+        Chispa,    // rapida y corta
+        Pedazo,    // cae como un escombro pequeño
+        NumTipos
+    };
+
+    static constexpr int kCapacidad = 1 << 15;
+
+    std::vector<float> x, y;
+    std::vector<float> vx, vy;
+    std::vector<float> gravedad;   // px/s^2 (segun el tipo)
+    std::vector<float> frenado;    // 1/s: perdida de velocidad por segundo
+    std::vector<float> vida;       // segundos que le quedan; <= 0: apagada
+    std::vector<float> duracion;   // vida al nacer (para el desvanecido)
+    std::vector<std::uint8_t> tipo;
+
+    explicit Particulas(int capacidad = kCapacidad);
+
+    int  capacidad() const { return int(x.size()); }
+    // Ranuras [0, ocupadas()) que alguna vez tuvieron una particula.
+    int  ocupadas() const { return m_ocupadas; }
+    // Cota superior de las vivas (exacta despues de avanzar()).
+    int  vivas() const { return m_vivas; }
+    bool vacio() const { return m_vivas == 0; }
+
+    void limpiar();
+
+    // 'cuantas' particulas en 'punto' con rapidez al azar hasta 'rapidez'.
+    // Polvo sale en cualquier direccion; chispas y pedazos hacia arriba.
+    void emitir(Tipo tipo, const Vector2D &punto, int cuantas, double rapidez);
+
+    void avanzar(double dt);
+
+private:
+    float azar();   // en [0, 1)
+
+    int m_siguiente{0};   // ranura que toca llenar
+    int m_ocupadas{0};
+    int m_vivas{0};
+    std::uint32_t m_estado{2463534242u};
+};
+
+#endif // PARTICULAS_H
@@ -0,0 +1,143 @@
+#include "perfilador.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+thread_local Perfilador *t_actual = nullptr;
+}
+
+const char *Perfilador::nombreFase(Fase fase)
+{
+    static const char *const nombres[NumFases] = {
+        "Frame", "Despacho", "Actualizar", "Integrar", "Choques", "Paredes",
+        "Cargas", "Limpieza", "Derrumbe", "Escombros", "Danio", "Sonido", "Pintado"
+    };
+    return (fase >= 0 && fase < NumFases) ? nombres[fase] : "?";
+}
+
+std::int64_t Perfilador::ahoraNs()
+{
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+Perfilador *Perfilador::actual()
+{
+    return t_actual;
+}
+
+Perfilador::Activo::Activo(Perfilador *perfilador)
+    : m_anterior(t_actual)
+{
+    t_actual = perfilador;
+}
+
+Perfilador::Activo::~Activo()
+{
+    t_actual = m_anterior;
+}
+
+Perfilador::Perfilador() = default;
+
+void Perfilador::iniciarFrame(std::int64_t intervaloNs)
+{
+    m_inicioFrame = ahoraNs();
+
+    if (m_inicioFrameAnterior >= 0) {
+        const std::int64_t periodo = m_inicioFrame - m_inicioFrameAnterior;
+        sumar(Frame, m_inicioFrameAnterior, periodo);
+
+        const std::int64_t retraso = periodo - intervaloNs;
+        if (retraso > 0)
+            sumar(Despacho, m_inicioFrame - retraso, retraso);
+    }
+    m_inicioFrameAnterior = m_inicioFrame;
+}
+
+void Perfilador::terminarFrame()
+{
+    if (m_inicioFrame < 0) return;
+
+    for (int f = 0; f < NumFases; ++f) {
+        m_historiaMs[f][m_posicion] = float(m_frameActual[f] * 1e-6);
+        m_frameActual[f] = 0;
+    }
+    m_posicion = (m_posicion + 1) % kFramesHistoria;
+    m_frames = std::min(m_frames + 1, kFramesHistoria);
+    m_inicioFrame = -1;
+}
+
+// Lo que se mide fuera de un frame (p. ej. el pintado que sigue a
+// actualizarSimulacion) cuenta para el frame siguiente.
+void Perfilador::sumar(Fase fase, std::int64_t inicioNs, std::int64_t duracionNs)
+{
+    m_frameActual[fase] += duracionNs;
+    if (m_grabando)
+        registrarEvento(fase, inicioNs, duracionNs);
+}
+
+void Perfilador::registrarEvento(Fase fase, std::int64_t inicioNs,
+                                 std::int64_t duracionNs)
+{
+    // Buffer reservado al empezar a grabar: lleno = se descarta.
+    if (m_eventos.size() >= kMaxEventosTraza) {
+        ++m_descartados;
+        return;
+    }
+    m_eventos.push_back({inicioNs, duracionNs, std::uint8_t(fase)});
+}
+
+Perfilador::Resumen Perfilador::resumen(Fase fase) const
+{
+    Resumen r;
+    if (m_frames == 0) return r;
+
+    std::array<float, kFramesHistoria> copia;
+    std::copy_n(m_historiaMs[fase].begin(), m_frames, copia.begin());
+    auto fin = copia.begin() + m_frames;
+
+    auto percentil = [&](double p) {
+        auto it = copia.begin() + std::min<int>(m_frames - 1, int(p * m_frames));
+        std::nth_element(copia.begin(), it, fin);
+        return double(*it);
+    };
+    r.p50Ms = percentil(0.50);
+    r.p99Ms = percentil(0.99);
+    return r;
+}
+
+void Perfilador::grabarTraza(bool grabar)
+{
+    if (grabar && !m_grabando) {
+        m_eventos.clear();
+        m_eventos.reserve(kMaxEventosTraza);
+        m_descartados = 0;
+    }
+    m_grabando = grabar;
+}
+
+// Formato "JSON Object" de trace_event: eventos completos (ph = "X")
+// con tiempos en microsegundos, todos en el hilo de la interfaz.
+bool Perfilador::exportarTraza(const std::string &ruta) const
+{
+    std::FILE *f = std::fopen(ruta.c_str(), "w");
+    if (!f) return false;
+
+    std::int64_t origen = m_eventos.empty() ? 0 : m_eventos.front().inicioNs;
+    for (const Evento &e : m_eventos)
+        origen = std::min(origen, e.inicioNs);
+
+    std::fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", f);
+    std::fputs("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,"
+               "\"args\":{\"name\":\"interfaz\"}}", f);
+    for (const Evento &e : m_eventos) {
+        std::fprintf(f, ",\n{\"name\":\"%s\",\"cat\":\"frame\",\"ph\":\"X\","
+                        "\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":1}",
+                     nombreFase(Fase(e.fase)),
+                     (e.inicioNs - origen) * 1e-3, e.duracionNs * 1e-3);
+    }
+    std::fprintf(f, "\n],\"otherData\":{\"eventosDescartados\":%zu}}\n",
+                 m_descartados);
+
+    return std::fclose(f) == 0;
+}
@@ -0,0 +1,129 @@
+#ifndef PERFILADOR_H
+#define PERFILADOR_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Perfilador:
+//  - Mide cuanto tarda cada fase de un frame (paso de fisica, choques,
+//    daño, sonido, pintado...) con temporizadores de ambito.
+//  - Guarda los ultimos kFramesHistoria frames para sacar p50/p99.
+//  - Opcionalmente graba cada medicion y la exporta en formato
+//    trace_event de Chrome (chrome://tracing, Perfetto).
+//  - Sin Qt y sin reservar memoria en el camino caliente. Solo mide el
+//    hilo donde esta activo (ver Perfilador::Activo): las copias del
+//    mundo que usa la CPU en otros hilos no cuentan.
+class Perfilador
+{
+public:
+    enum Fase {
+        Frame,          // de un frame al siguiente
+        Despacho,       // retraso del temporizador respecto a su intervalo
+        Actualizar,     // todo actualizarSimulacion
+        Integrar,
+        Choques,        // barrido contra bloques y rivales
+        Paredes,
+        Cargas,         // racimo / metralla
+        Limpieza,       // fuera de juego
+        Derrumbe,       // bloques sin apoyo cayendo
+        Escombros,      // pedazos de bloques destruidos
+        Danio,          // reflejar el daño en la capa de estructura
+        Sonido,
+        Pintado,        // pintado de la vista
+        NumFases
+    };
+
+    static constexpr int kFramesHistoria = 256;
+    static constexpr std::size_t kMaxEventosTraza = 1u << 18;
+
+    struct Resumen {
+        double p50Ms{0.0};
+        double p99Ms{0.0};
+    };
+
+    static const char *nombreFase(Fase fase);
+    static std::int64_t ahoraNs();
+
+    // Perfilador del hilo actual (nullptr si no se esta midiendo).
+    static Perfilador *actual();
+
+    // Activa el perfilador en el hilo actual mientras exista.
+    class Activo {
+    public:
+        explicit Activo(Perfilador *perfilador);
+        ~Activo();
+        Activo(const Activo &) = delete;
+        Activo &operator=(const Activo &) = delete;
+    private:
+        Perfilador *m_anterior;
+    };
+
+    Perfilador();
+
+    // Marca el inicio de un frame; 'intervaloNs' es el periodo esperado
+    // del temporizador. Las mediciones se acumulan hasta terminarFrame().
+    void iniciarFrame(std::int64_t intervaloNs);
+    void terminarFrame();
+    // Tras una pausa (sin frames) el siguiente no cuenta como frame largo.
+    void olvidarUltimoFrame() { m_inicioFrameAnterior = -1; }
+
+    void sumar(Fase fase, std::int64_t inicioNs, std::int64_t duracionNs);
+
+    Resumen resumen(Fase fase) const;
+    int framesMedidos() const { return m_frames; }
+
+    void grabarTraza(bool grabar);
+    bool grabandoTraza() const { return m_grabando; }
+    std::size_t eventosTraza() const { return m_eventos.size(); }
+    bool exportarTraza(const std::string &ruta) const;
+
+private:
+    struct Evento {
+        std::int64_t inicioNs;
+        std::int64_t duracionNs;
+        std::uint8_t fase;
+    };
+
+    void registrarEvento(Fase fase, std::int64_t inicioNs, std::int64_t duracionNs);
+
+    std::array<std::int64_t, NumFases> m_frameActual{};
+    std::array<std::array<float, kFramesHistoria>, NumFases> m_historiaMs{};
+    int m_frames{0};
+    int m_posicion{0};
+
+    std::int64_t m_inicioFrame{-1};
+    std::int64_t m_inicioFrameAnterior{-1};
+
+    bool m_grabando{false};
+    std::vector<Evento> m_eventos;
+    std::size_t m_descartados{0};
+};
+
+// Temporizador de ambito: suma su duracion a la fase al salir del bloque.
+// Si no hay perfilador activo en el hilo solo cuesta una comprobacion.
+class MedicionFase
+{
+public:
+    explicit MedicionFase(Perfilador::Fase fase)
+        : m_perfilador(Perfilador::actual()), m_fase(fase)
+    {
+        if (m_perfilador) m_inicio = Perfilador::ahoraNs();
+    }
+    ~MedicionFase()
+    {
+        if (m_perfilador)
+            m_perfilador->sumar(m_fase, m_inicio, Perfilador::ahoraNs() - m_inicio);
+    }
+    MedicionFase(const MedicionFase &) = delete;
+    MedicionFase &operator=(const MedicionFase &) = delete;
+
+private:
+    Perfilador *m_perfilador;
+    Perfilador::Fase m_fase;
+    std::int64_t m_inicio{0};
+};
+
+#endif // PERFILADOR_H
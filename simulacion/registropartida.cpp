@@ -0,0 +1,399 @@
+#include "registropartida.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+const char kMagia[4] = {'P', '5', 'R', 'P'};
+
+// Escritura y lectura little-endian independientes de la plataforma.
+class Escritor
+{
+public:
+    explicit Escritor(std::vector<std::uint8_t> &salida) : m_salida(salida) {}
+
+    void u8(std::uint8_t v) { m_salida.push_back(v); }
+    void u16(std::uint16_t v) { entero(v, 2); }
+    void u32(std::uint32_t v) { entero(v, 4); }
+    void f64(double v)
+    {
+        std::uint64_t bits;
+        std::memcpy(&bits, &v, sizeof bits);
+        entero(bits, 8);
+    }
+    void rect(const RectMundo &r) { f64(r.x); f64(r.y); f64(r.ancho); f64(r.alto); }
+
+private:
+    void entero(std::uint64_t v, int bytes)
+    {
+        for (int i = 0; i < bytes; ++i)
+            m_salida.push_back(std::uint8_t(v >> (8*i)));
+    }
+
+    std::vector<std::uint8_t> &m_salida;
+};
+
+class Lector
+{
+public:
+    Lector(const std::uint8_t *datos, std::size_t tamano)
+        : m_datos(datos), m_tamano(tamano) {}
+
+    bool ok() const { return m_ok; }
+    // Quedan al menos 'n' bytes (para validar contadores antes de reservar).
+    bool quedan(std::size_t n) const { return m_ok && m_tamano - m_pos >= n; }
+
+    std::uint8_t  u8()  { return std::uint8_t(entero(1)); }
+    std::uint16_t u16() { return std::uint16_t(entero(2)); }
+    std::uint32_t u32() { return std::uint32_t(entero(4)); }
+    double f64()
+    {
+        std::uint64_t bits = entero(8);
+        double v;
+        std::memcpy(&v, &bits, sizeof v);
+        return v;
+    }
+    RectMundo rect()
+    {
+        RectMundo r;
+        r.x = f64(); r.y = f64(); r.ancho = f64(); r.alto = f64();
+        return r;
+    }
+    bool bytes(void *destino, std::size_t n)
+    {
+        if (!quedan(n)) { m_ok = false; return false; }
+        std::memcpy(destino, m_datos + m_pos, n);
+        m_pos += n;
+        return true;
+    }
+
+private:
+    std::uint64_t entero(int n)
+    {
+        if (!quedan(std::size_t(n))) { m_ok = false; return 0; }
+        std::uint64_t v = 0;
+        for (int i = 0; i < n; ++i)
+            v |= std::uint64_t(m_datos[m_pos + i]) << (8*i);
+        m_pos += std::size_t(n);
+        return v;
+    }
+
+    const std::uint8_t *m_datos;
+    std::size_t m_tamano;
+    std::size_t m_pos{0};
+    bool m_ok{true};
+};
+
+} // namespace
+
+// ------------------------- grabacion -------------------------
+
+void RegistroPartida::iniciar(const MundoSimulacion &mundo, double dt)
+{
+    m_semilla     = mundo.semilla();
+    m_dt          = dt;
+    m_gravedad    = mundo.gravedad();
+    m_coefRest    = mundo.coefRestEstructura();
+    m_factorDanio = mundo.factorDanio();
+    m_ancho       = mundo.ancho();
+    m_alto        = mundo.alto();
+    m_integrador  = mundo.integrador();
+    m_arrastre    = mundo.arrastre();
+    m_viento      = mundo.viento();
+
+    for (int b = 0; b < 2; ++b) {
+        MundoSimulacion::Bando bando = MundoSimulacion::Bando(b);
+        m_rectRival[b]      = mundo.rectRival(bando);
+        m_rectCanion[b]     = mundo.rectCanion(bando);
+        m_rectPlataforma[b] = mundo.rectPlataforma(bando);
+    }
+
+    // El terreno se regenera con las colinas: se supone que aun no tiene crateres.
+    m_terreno = mundo.hayTerreno();
+    m_colinas.clear();
+    for (int c = 0; c < mundo.numColinas(); ++c)
+        m_colinas.push_back(mundo.colina(c));
+
+    m_bloques.clear();
+    m_bloques.reserve(mundo.numBloques());
+    for (int i = 0; i < mundo.numBloques(); ++i)
+        m_bloques.push_back({mundo.rectBloque(i), mundo.resistenciaBloque(i),
+                             std::uint8_t(mundo.ladoBloque(i))});
+
+    m_disparos.clear();
+    m_ganador = kSinGanador;
+    m_resistenciaFinal.clear();
+}
+
+void RegistroPartida::agregarDisparo(MundoSimulacion::Bando turno,
+                                     MundoSimulacion::ModoDisparo modo,
+                                     double angulo, double velocidad)
+{
+    m_disparos.push_back({std::uint8_t(turno), std::uint8_t(modo), angulo, velocidad,
+                          kSinSalto});
+}
+
+void RegistroPartida::marcarSalto(std::uint32_t pasos)
+{
+    if (!m_disparos.empty())
+        m_disparos.back().pasosHastaSalto = pasos;
+}
+
+void RegistroPartida::cerrar(const MundoSimulacion &mundo)
+{
+    m_ganador = mundo.hayGanador() ? std::uint8_t(mundo.ganador()) : kSinGanador;
+    m_resistenciaFinal.resize(mundo.numBloques());
+    for (int i = 0; i < mundo.numBloques(); ++i)
+        m_resistenciaFinal[i] = mundo.resistenciaBloque(i);
+}
+
+// ------------------------- reproduccion -------------------------
+
+MundoSimulacion RegistroPartida::crearMundo() const
+{
+    MundoSimulacion mundo(m_ancho, m_alto);
+    mundo.limpiar();
+    if (m_terreno) {
+        mundo.activarTerreno(true);
+        for (const MundoSimulacion::Colina &c : m_colinas)
+            mundo.agregarColina(c);
+    }
+    for (const Bloque &b : m_bloques)
+        mundo.agregarBloque(b.rect, b.resistencia, MundoSimulacion::Bando(b.lado));
+    for (int b = 0; b < 2; ++b) {
+        MundoSimulacion::Bando bando = MundoSimulacion::Bando(b);
+        mundo.fijarRival(bando, m_rectRival[b]);
+        mundo.fijarCanion(bando, m_rectCanion[b]);
+        mundo.fijarPlataforma(bando, m_rectPlataforma[b]);
+    }
+    mundo.fijarGravedad(m_gravedad);
+    mundo.fijarCoefRestEstructura(m_coefRest);
+    mundo.fijarFactorDanio(m_factorDanio);
+    mundo.fijarIntegrador(m_integrador);
+    mundo.fijarAire(m_arrastre, m_viento);
+    mundo.fijarSemilla(m_semilla);
+    return mundo;
+}
+
+// Cada disparo se simula hasta que termina el turno, con el mismo paso
+// fijo que la partida original (y el mismo salto por eventos si lo
+// hubo). Se exige igualdad exacta: mismo binario y mismas entradas dan
+// el mismo resultado bit a bit. Un disparo que no termina en
+// kMaxPasosDisparo pasos corta la reproduccion y cuenta como distinta.
+RegistroPartida::Verificacion RegistroPartida::reproducir() const
+{
+    Verificacion v;
+    MundoSimulacion mundo = crearMundo();
+
+    for (std::size_t k = 0; k < m_disparos.size(); ++k) {
+        const Disparo &d = m_disparos[k];
+        if (mundo.hayGanador() || mundo.turno() != MundoSimulacion::Bando(d.turno)) {
+            v.disparoFueraDeTurno = int(k);
+            break;
+        }
+
+        mundo.disparar(d.angulo, d.velocidad, MundoSimulacion::ModoDisparo(d.modo));
+        ++v.disparosSimulados;
+        std::uint32_t n = 0;
+        for (; mundo.hayMovimiento() && n < kMaxPasosDisparo; ++n) {
+            if (n == d.pasosHastaSalto) {
+                mundo.resolverAlInstante();
+                break;
+            }
+            mundo.paso(m_dt);
+            ++v.pasosSimulados;
+        }
+        if (mundo.hayMovimiento()) {
+            v.disparoSinTerminar = int(k);
+            break;
+        }
+    }
+
+    v.ganador = mundo.hayGanador() ? std::uint8_t(mundo.ganador()) : kSinGanador;
+
+    const int n = std::min<int>(mundo.numBloques(), int(m_resistenciaFinal.size()));
+    for (int i = 0; i < n; ++i) {
+        if (mundo.resistenciaBloque(i) != m_resistenciaFinal[i]) {
+            v.primerBloqueDistinto = i;
+            break;
+        }
+    }
+    if (v.primerBloqueDistinto < 0 && mundo.numBloques() != int(m_resistenciaFinal.size()))
+        v.primerBloqueDistinto = n;
+
+    v.coincide = v.disparoFueraDeTurno < 0 && v.disparoSinTerminar < 0
+                 && v.primerBloqueDistinto < 0 && v.ganador == m_ganador;
+    return v;
+}
+
+// ------------------------- formato binario -------------------------
+
+std::vector<std::uint8_t> RegistroPartida::serializar() const
+{
+    std::vector<std::uint8_t> datos;
+    datos.reserve(96 + 25 + 6*32 + 5 + m_colinas.size()*24 + m_bloques.size()*49 + m_disparos.size()*22
+                  + m_resistenciaFinal.size()*8);
+    Escritor e(datos);
+
+    for (char c : kMagia)
+        e.u8(std::uint8_t(c));
+    e.u16(kVersion);
+
+    e.u32(m_semilla);
+    e.f64(m_dt);
+    e.f64(m_gravedad);
+    e.f64(m_coefRest);
+    e.f64(m_factorDanio);
+    e.f64(m_ancho);
+    e.f64(m_alto);
+    e.u8(std::uint8_t(m_integrador));
+    e.f64(m_arrastre);
+    e.f64(m_viento.x);
+    e.f64(m_viento.y);
+
+    for (int b = 0; b < 2; ++b) {
+        e.rect(m_rectRival[b]);
+        e.rect(m_rectCanion[b]);
+        e.rect(m_rectPlataforma[b]);
+    }
+
+    e.u8(m_terreno ? 1 : 0);
+    e.u32(std::uint32_t(m_colinas.size()));
+    for (const MundoSimulacion::Colina &c : m_colinas) {
+        e.f64(c.centro);
+        e.f64(c.ancho);
+        e.f64(c.alto);
+    }
+
+    e.u32(std::uint32_t(m_bloques.size()));
+    for (const Bloque &b : m_bloques) {
+        e.rect(b.rect);
+        e.f64(b.resistencia);
+        e.u8(b.lado);
+    }
+
+    e.u32(std::uint32_t(m_disparos.size()));
+    for (const Disparo &d : m_disparos) {
+        e.u8(d.turno);
+        e.u8(d.modo);
+        e.f64(d.angulo);
+        e.f64(d.velocidad);
+        e.u32(d.pasosHastaSalto);
+    }
+
+    // Sin cerrar: el resultado se guarda vacio (y no se podra verificar).
+    e.u8(m_ganador);
+    for (std::size_t i = 0; i < m_bloques.size(); ++i)
+        e.f64(i < m_resistenciaFinal.size() ? m_resistenciaFinal[i] : m_bloques[i].resistencia);
+
+    return datos;
+}
+
+bool RegistroPartida::deserializar(const std::uint8_t *datos, std::size_t tamano)
+{
+    Lector l(datos, tamano);
+
+    char magia[4];
+    if (!l.bytes(magia, 4) || std::memcmp(magia, kMagia, 4) != 0) return false;
+    const std::uint16_t version = l.u16();
+    if (version < 1 || version > kVersion) return false;
+
+    RegistroPartida r;
+    r.m_semilla     = l.u32();
+    r.m_dt          = l.f64();
+    r.m_gravedad    = l.f64();
+    r.m_coefRest    = l.f64();
+    r.m_factorDanio = l.f64();
+    r.m_ancho       = l.f64();
+    r.m_alto        = l.f64();
+    // Un dt nulo o NaN no terminaria nunca de reproducir; un mundo
+    // enorme o sin tamaño no se puede crear.
+    if (!(r.m_dt > 0.0 && r.m_dt <= kPasoMaximo)) return false;
+    if (!(r.m_ancho > 0.0 && r.m_ancho <= MundoSimulacion::kLadoMaximo) ||
+        !(r.m_alto > 0.0 && r.m_alto <= MundoSimulacion::kLadoMaximo))
+        return false;
+    if (version >= 4) {
+        const std::uint8_t integrador = l.u8();
+        if (integrador > std::uint8_t(Integrador::RK4)) return false;
+        r.m_integrador = Integrador(integrador);
+        r.m_arrastre   = l.f64();
+        r.m_viento.x   = l.f64();
+        r.m_viento.y   = l.f64();
+    }
+
+    for (int b = 0; b < 2; ++b) {
+        r.m_rectRival[b]      = l.rect();
+        r.m_rectCanion[b]     = l.rect();
+        r.m_rectPlataforma[b] = l.rect();
+    }
+
+    if (version >= 3) {
+        r.m_terreno = l.u8() != 0;
+        const std::uint32_t nColinas = l.u32();
+        if (!l.quedan(std::size_t(nColinas) * 24)) return false;
+        r.m_colinas.resize(nColinas);
+        for (MundoSimulacion::Colina &c : r.m_colinas) {
+            c.centro = l.f64();
+            c.ancho = l.f64();
+            c.alto = l.f64();
+        }
+    }
+
+    const std::uint32_t nBloques = l.u32();
+    if (!l.quedan(std::size_t(nBloques) * 41)) return false;
+    r.m_bloques.resize(nBloques);
+    for (Bloque &b : r.m_bloques) {
+        b.rect = l.rect();
+        b.resistencia = l.f64();
+        b.lado = l.u8();
+        if (b.lado > MundoSimulacion::Derecha) return false;
+    }
+
+    const std::uint32_t nDisparos = l.u32();
+    const std::size_t bytesDisparo = version >= 2 ? 22 : 18;
+    if (!l.quedan(std::size_t(nDisparos) * bytesDisparo)) return false;
+    r.m_disparos.resize(nDisparos);
+    for (Disparo &d : r.m_disparos) {
+        d.turno = l.u8();
+        d.modo = l.u8();
+        d.angulo = l.f64();
+        d.velocidad = l.f64();
+        d.pasosHastaSalto = version >= 2 ? l.u32() : kSinSalto;
+        if (d.turno > MundoSimulacion::Derecha || d.modo > MundoSimulacion::DisparoMetralla)
+            return false;
+    }
+
+    r.m_ganador = l.u8();
+    r.m_resistenciaFinal.resize(nBloques);
+    for (double &v : r.m_resistenciaFinal)
+        v = l.f64();
+
+    if (!l.ok()) return false;
+    *this = std::move(r);
+    return true;
+}
+
+bool RegistroPartida::guardar(const std::string &ruta) const
+{
+    const std::vector<std::uint8_t> datos = serializar();
+    std::FILE *f = std::fopen(ruta.c_str(), "wb");
+    if (!f) return false;
+    const bool escrito = std::fwrite(datos.data(), 1, datos.size(), f) == datos.size();
+    return (std::fclose(f) == 0) && escrito;
+}
+
+bool RegistroPartida::cargar(const std::string &ruta)
+{
+    std::FILE *f = std::fopen(ruta.c_str(), "rb");
+    if (!f) return false;
+
+    std::vector<std::uint8_t> datos;
+    std::uint8_t bloque[4096];
+    std::size_t n;
+    while ((n = std::fread(bloque, 1, sizeof bloque, f)) > 0)
+        datos.insert(datos.end(), bloque, bloque + n);
+    std::fclose(f);
+
+    return deserializar(datos.data(), datos.size());
+}
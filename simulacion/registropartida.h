@@ -0,0 +1,117 @@
+#ifndef REGISTROPARTIDA_H
+#define REGISTROPARTIDA_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "mundosimulacion.h"
+
+// RegistroPartida:
+//  - Grabacion compacta de una partida: solo las entradas (turno, modo,
+//    angulo y velocidad de cada disparo), la semilla, los parametros
+//    fisicos y el nivel tal como estaba al empezar.
+//  - Al cerrarse guarda ademas el resultado (vida de cada bloque y
+//    ganador) para comprobar que una reproduccion llega a lo mismo.
+//  - reproducir() vuelve a simular la partida sin temporizador, tan
+//    rapido como da la CPU.
+//
+// Formato binario (little-endian, version 4; se siguen leyendo de la 1 a la 3):
+//   "P5RP" u16 version
+//   u32 semilla, f64 dt, f64 gravedad, f64 coefRest, f64 factorDanio
+//   f64 ancho, f64 alto
+//   u8 integrador, f64 arrastre, f64 vientoX, f64 vientoY   solo en v4
+//   6 x (f64 x, y, ancho, alto)          rival, cañon y plataforma por bando
+//   u8 terreno, u32 nColinas, nColinas x (f64 centro, ancho, alto)   solo en v3
+//   u32 nBloques, nBloques x (f64 x, y, ancho, alto, resistencia, u8 lado)
+//   u32 nDisparos, nDisparos x (u8 turno, u8 modo, f64 angulo, f64 velocidad,
+//                               u32 pasos hasta el salto; solo en v2)
+//   u8 ganador (0 izq., 1 der., 2 ninguno), nBloques x f64 resistencia final
+class RegistroPartida
+{
+public:
+    static constexpr std::uint16_t kVersion = 4;
+    static constexpr std::uint8_t  kSinGanador = 2;
+    static constexpr std::uint32_t kSinSalto = 0xFFFFFFFFu;
+    // Paso mas largo que usa una partida (EscenaJuego::kPasoMaximo); un
+    // registro con dt fuera de (0, kPasoMaximo] no se carga.
+    static constexpr double kPasoMaximo = 0.048;
+    // Ningun disparo dura mas pasos que estos (vuelo y derrumbe caben de
+    // sobra): si no termina antes, la reproduccion se da por distinta.
+    static constexpr std::uint32_t kMaxPasosDisparo = 1u << 20;
+
+    struct Disparo {
+        std::uint8_t turno{0};
+        std::uint8_t modo{0};
+        double angulo{0.0};
+        double velocidad{0.0};
+        // Pasos simulados antes de saltar al final del turno
+        // (MundoSimulacion::resolverAlInstante); kSinSalto si no se salto.
+        std::uint32_t pasosHastaSalto{kSinSalto};
+    };
+
+    struct Bloque {
+        RectMundo    rect;
+        double       resistencia{0.0};
+        std::uint8_t lado{0};
+    };
+
+    // Resultado de volver a simular un registro.
+    struct Verificacion {
+        bool coincide{false};
+        int  disparosSimulados{0};
+        int  pasosSimulados{0};
+        int  primerBloqueDistinto{-1};   // -1 = todos iguales
+        int  disparoFueraDeTurno{-1};    // -1 = turnos coherentes
+        int  disparoSinTerminar{-1};     // -1 = todos terminaron antes de kMaxPasosDisparo
+        std::uint8_t ganador{kSinGanador};
+    };
+
+    // Copia el nivel y los parametros del mundo al empezar la partida.
+    void iniciar(const MundoSimulacion &mundo, double dt);
+    void agregarDisparo(MundoSimulacion::Bando turno,
+                        MundoSimulacion::ModoDisparo modo,
+                        double angulo, double velocidad);
+    // El ultimo disparo se resolvio de golpe tras 'pasos' pasos.
+    void marcarSalto(std::uint32_t pasos);
+    // Guarda el resultado final (vida de los bloques y ganador).
+    void cerrar(const MundoSimulacion &mundo);
+
+    bool vacio() const { return m_disparos.empty(); }
+    const std::vector<Disparo> &disparos() const { return m_disparos; }
+    std::uint32_t semilla() const { return m_semilla; }
+
+    // Mundo en el estado inicial del registro (nivel, parametros, semilla).
+    MundoSimulacion crearMundo() const;
+    Verificacion reproducir() const;
+
+    std::vector<std::uint8_t> serializar() const;
+    bool deserializar(const std::uint8_t *datos, std::size_t tamano);
+    bool guardar(const std::string &ruta) const;
+    bool cargar(const std::string &ruta);
+
+private:
+    std::uint32_t m_semilla{0};
+    double m_dt{0.016};
+    double m_gravedad{0.0};
+    double m_coefRest{0.0};
+    double m_factorDanio{0.0};
+    double m_ancho{0.0};
+    double m_alto{0.0};
+    Integrador m_integrador{Integrador::EulerSemiImplicito};
+    double m_arrastre{0.0};
+    Vector2D m_viento;
+
+    RectMundo m_rectRival[2];
+    RectMundo m_rectCanion[2];
+    RectMundo m_rectPlataforma[2];
+    bool m_terreno{false};
+    std::vector<MundoSimulacion::Colina> m_colinas;
+    std::vector<Bloque> m_bloques;
+
+    std::vector<Disparo> m_disparos;
+
+    std::uint8_t m_ganador{kSinGanador};
+    std::vector<double> m_resistenciaFinal;
+};
+
+#endif // REGISTROPARTIDA_H
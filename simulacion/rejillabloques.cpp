@@ -0,0 +1,164 @@
+#include "rejillabloques.h"
+#include "mundosimulacion.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// Huecos de reserva por celda para insertar() sin reconstruir.
+constexpr int kHolgura = 2;
+}
+
+void RejillaBloques::construir(const std::vector<RectMundo> &rects,
+                               const std::vector<std::uint8_t> &destruido,
+                               double ancho, double alto, double tamCelda)
+{
+    m_tamCelda = tamCelda;
+    m_columnas = std::max(1, int(std::ceil(ancho / tamCelda)));
+    m_filas    = std::max(1, int(std::ceil(alto / tamCelda)));
+
+    const int nCeldas = m_columnas * m_filas;
+    const int nBloques = int(rects.size());
+
+    m_rangoBloque.assign(nBloques, RangoCeldas{0, 0, -1, -1});
+    m_marca.assign(nBloques, 0);
+    m_consulta = 0;
+
+    // Primera pasada: cuantos bloques caen en cada celda.
+    m_cuenta.assign(nCeldas, 0);
+    for (int i = 0; i < nBloques; ++i) {
+        if (destruido[i]) continue;
+        const RectMundo &r = rects[i];
+        RangoCeldas rango;
+        if (!rangoDe(r.izquierda(), r.arriba(), r.derecha(), r.abajo(), rango))
+            continue;
+        m_rangoBloque[i] = rango;
+        for (int f = rango.f0; f <= rango.f1; ++f)
+            for (int c = rango.c0; c <= rango.c1; ++c)
+                ++m_cuenta[f*m_columnas + c];
+    }
+
+    // Inicios por suma acumulada (con los huecos de reserva).
+    m_inicio.assign(nCeldas + 1, 0);
+    for (int k = 0; k < nCeldas; ++k)
+        m_inicio[k+1] = m_inicio[k] + m_cuenta[k] + kHolgura;
+
+    // Segunda pasada: rellenar las listas (en orden creciente de bloque).
+    m_bloques.assign(m_inicio[nCeldas], -1);
+    std::fill(m_cuenta.begin(), m_cuenta.end(), 0);
+    for (int i = 0; i < nBloques; ++i) {
+        const RangoCeldas &rango = m_rangoBloque[i];
+        for (int f = rango.f0; f <= rango.f1; ++f)
+            for (int c = rango.c0; c <= rango.c1; ++c) {
+                int k = f*m_columnas + c;
+                m_bloques[m_inicio[k] + m_cuenta[k]++] = i;
+            }
+    }
+}
+
+// Saca el bloque de todas sus celdas (cuando se destruye o empieza a caer).
+void RejillaBloques::quitar(int bloque)
+{
+    if (bloque < 0 || bloque >= int(m_rangoBloque.size())) return;
+
+    RangoCeldas &rango = m_rangoBloque[bloque];
+    for (int f = rango.f0; f <= rango.f1; ++f)
+        for (int c = rango.c0; c <= rango.c1; ++c) {
+            int k = f*m_columnas + c;
+            int *lista = m_bloques.data() + m_inicio[k];
+            int *fin = lista + m_cuenta[k];
+            int *it = std::find(lista, fin, bloque);
+            if (it == fin) continue;
+
+            // Se conserva el orden para que las colisiones se resuelvan
+            // siempre en el mismo orden que sin rejilla.
+            std::copy(it + 1, fin, it);
+            --m_cuenta[k];
+        }
+    rango = RangoCeldas{0, 0, -1, -1};
+}
+
+bool RejillaBloques::insertar(int bloque, const RectMundo &rect)
+{
+    if (bloque < 0 || bloque >= int(m_rangoBloque.size())) return false;
+
+    RangoCeldas rango;
+    const bool dentro = rangoDe(rect.izquierda(), rect.arriba(),
+                                rect.derecha(), rect.abajo(), rango);
+    const RangoCeldas &antes = m_rangoBloque[bloque];
+    if (dentro && rango.c0 == antes.c0 && rango.c1 == antes.c1 &&
+        rango.f0 == antes.f0 && rango.f1 == antes.f1)
+        return true;   // sigue en las mismas celdas
+
+    quitar(bloque);
+    if (!dentro)
+        return true;   // fuera de la rejilla: nada que insertar
+
+    for (int f = rango.f0; f <= rango.f1; ++f)
+        for (int c = rango.c0; c <= rango.c1; ++c) {
+            const int k = f*m_columnas + c;
+            if (m_cuenta[k] >= m_inicio[k+1] - m_inicio[k])
+                return false;
+        }
+
+    // En su lugar segun el indice, como al construir.
+    for (int f = rango.f0; f <= rango.f1; ++f)
+        for (int c = rango.c0; c <= rango.c1; ++c) {
+            const int k = f*m_columnas + c;
+            int *lista = m_bloques.data() + m_inicio[k];
+            int *fin = lista + m_cuenta[k];
+            int *it = std::lower_bound(lista, fin, bloque);
+            std::copy_backward(it, fin, fin + 1);
+            *it = bloque;
+            ++m_cuenta[k];
+        }
+    m_rangoBloque[bloque] = rango;
+    return true;
+}
+
+void RejillaBloques::consultar(double x0, double y0, double x1, double y1,
+                               std::vector<int> &salida)
+{
+    RangoCeldas rango;
+    if (!rangoDe(x0, y0, x1, y1, rango)) return;
+
+    const std::size_t primero = salida.size();
+    if (++m_consulta == 0) {
+        std::fill(m_marca.begin(), m_marca.end(), 0);
+        m_consulta = 1;
+    }
+
+    for (int f = rango.f0; f <= rango.f1; ++f)
+        for (int c = rango.c0; c <= rango.c1; ++c) {
+            int k = f*m_columnas + c;
+            const int *lista = m_bloques.data() + m_inicio[k];
+            for (int j = 0; j < m_cuenta[k]; ++j) {
+                int b = lista[j];
+                if (m_marca[b] == m_consulta) continue;
+                m_marca[b] = m_consulta;
+                salida.push_back(b);
+            }
+        }
+
+    // Si el rectangulo toco varias celdas, los bloques llegan desordenados.
+    if (rango.c0 != rango.c1 || rango.f0 != rango.f1)
+        std::sort(salida.begin() + primero, salida.end());
+}
+
+// Celdas que toca un rectangulo, recortadas a la rejilla.
+// Devuelve false si el rectangulo queda completamente fuera.
+bool RejillaBloques::rangoDe(double x0, double y0, double x1, double y1,
+                             RangoCeldas &rango) const
+{
+    if (m_columnas == 0) return false;
+
+    const double anchoRejilla = m_columnas * m_tamCelda;
+    const double altoRejilla  = m_filas * m_tamCelda;
+    if (x1 < 0.0 || y1 < 0.0 || x0 > anchoRejilla || y0 > altoRejilla)
+        return false;
+
+    rango.c0 = std::clamp(int(x0 / m_tamCelda), 0, m_columnas - 1);
+    rango.c1 = std::clamp(int(x1 / m_tamCelda), 0, m_columnas - 1);
+    rango.f0 = std::clamp(int(y0 / m_tamCelda), 0, m_filas - 1);
+    rango.f1 = std::clamp(int(y1 / m_tamCelda), 0, m_filas - 1);
+    return true;
+}
@@ -0,0 +1,57 @@
+#ifndef REJILLABLOQUES_H
+#define REJILLABLOQUES_H
+
+#include <vector>
+#include <cstdint>
+
+struct RectMundo;
+
+// RejillaBloques:
+//  - Fase amplia de colisiones: una rejilla uniforme sobre el mundo donde
+//    cada celda lista los bloques cuyo AABB la toca.
+//  - Se construye una vez por nivel y solo se modifica cuando un bloque
+//    se destruye (quitar()) o se mueve al caer (insertar()).
+//  - Las listas de todas las celdas viven en un unico arreglo contiguo
+//    (cada celda tiene un inicio fijo, una cuenta de bloques vivos y
+//    unos huecos de reserva para los bloques que caen).
+class RejillaBloques
+{
+public:
+    void construir(const std::vector<RectMundo> &rects,
+                   const std::vector<std::uint8_t> &destruido,
+                   double ancho, double alto, double tamCelda = 64.0);
+    void quitar(int bloque);
+    // Pone el bloque con su nuevo rectangulo (no hace nada si sigue en las
+    // mismas celdas). Devuelve false si alguna celda no tiene hueco: el
+    // bloque queda fuera y hay que reconstruir la rejilla.
+    bool insertar(int bloque, const RectMundo &rect);
+
+    // Agrega a 'salida' (sin repetir y en orden creciente) los bloques
+    // vivos de las celdas que toca el rectangulo [x0,x1] x [y0,y1].
+    void consultar(double x0, double y0, double x1, double y1,
+                   std::vector<int> &salida);
+
+    bool vacia() const { return m_columnas == 0; }
+
+private:
+    struct RangoCeldas { int c0, f0, c1, f1; };
+    bool rangoDe(double x0, double y0, double x1, double y1,
+                 RangoCeldas &rango) const;
+
+    double m_tamCelda{64.0};
+    int m_columnas{0};
+    int m_filas{0};
+
+    std::vector<int> m_inicio;   // primer hueco de cada celda en m_bloques
+    std::vector<int> m_cuenta;   // bloques vivos en cada celda
+    std::vector<int> m_bloques;  // listas de todas las celdas, seguidas
+
+    // Rango de celdas de cada bloque (para quitarlo sin recalcular).
+    std::vector<RangoCeldas> m_rangoBloque;
+
+    // Marca de la ultima consulta que vio cada bloque (evita repetidos).
+    std::vector<std::uint32_t> m_marca;
+    std::uint32_t m_consulta{0};
+};
+
+#endif // REJILLABLOQUES_H
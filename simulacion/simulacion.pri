@@ -0,0 +1,63 @@
+# Nucleo de simulacion sin Qt (fisica, reglas de la partida).
+# Lo incluyen la aplicacion y las herramientas sin ventana.
+
+INCLUDEPATH += $$PWD
+DEPENDPATH  += $$PWD
+
+# SolucionadorPunteria reparte las pruebas, Torneo las partidas y
+# Escombros las islas entre hilos (std::thread).
+CONFIG += thread
+
+SOURCES += \
+    $$PWD/almacenproyectiles.cpp \
+    $$PWD/archivomapeado.cpp \
+    $$PWD/balistica.cpp \
+    $$PWD/escombros.cpp \
+    $$PWD/grafoapoyos.cpp \
+    $$PWD/integrador.cpp \
+    $$PWD/mensajered.cpp \
+    $$PWD/mundosimulacion.cpp \
+    $$PWD/nivel.cpp \
+    $$PWD/particulas.cpp \
+    $$PWD/perfilador.cpp \
+    $$PWD/registropartida.cpp \
+    $$PWD/rejillabloques.cpp \
+    $$PWD/solucionadorpunteria.cpp \
+    $$PWD/terreno.cpp \
+    $$PWD/torneo.cpp
+
+HEADERS += \
+    $$PWD/almacenproyectiles.h \
+    $$PWD/archivomapeado.h \
+    $$PWD/balistica.h \
+    $$PWD/colaindexada.h \
+    $$PWD/escombros.h \
+    $$PWD/fijo.h \
+    $$PWD/grafoapoyos.h \
+    $$PWD/integrador.h \
+    $$PWD/mensajered.h \
+    $$PWD/mundosimulacion.h \
+    $$PWD/nivel.h \
+    $$PWD/particulas.h \
+    $$PWD/perfilador.h \
+    $$PWD/registropartida.h \
+    $$PWD/rejillabloques.h \
+    $$PWD/solucionadorpunteria.h \
+    $$PWD/sucesosfisica.h \
+    $$PWD/terreno.h \
+    $$PWD/torneo.h \
+    $$PWD/vector2d.h
+
+# Los lazos por lotes (AlmacenProyectiles, Particulas) dependen de la vectorizacion.
+!msvc: QMAKE_CXXFLAGS_RELEASE += -O3
+
+# Proyectiles del mundo en float en vez de double (qmake CONFIG+=proyectiles_float):
+# la mitad de memoria por proyectil. Los registros de partida y la partida
+# en red solo valen entre compilaciones con la misma eleccion.
+proyectiles_float: DEFINES += SIMULACION_PROYECTILES_FLOAT
+
+# La partida en red y el registro de partidas exigen los mismos bits en
+# cualquier compilacion: nada de fusionar multiplicacion y suma (FMA)
+# segun el procesador ni de reordenar operaciones en coma flotante.
+!msvc: QMAKE_CXXFLAGS += -ffp-contract=off -fno-fast-math
+msvc:  QMAKE_CXXFLAGS += /fp:precise
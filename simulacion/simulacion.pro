@@ -0,0 +1,9 @@
+# Biblioteca estatica con el nucleo de simulacion.
+# No depende de Qt: se puede compilar y ejecutar sin pantalla ni audio.
+
+TEMPLATE = lib
+CONFIG  += staticlib c++17
+CONFIG  -= qt
+TARGET   = simulacion
+
+include(simulacion.pri)
@@ -0,0 +1,164 @@
+#include "solucionadorpunteria.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Reloj = std::chrono::steady_clock;
+
+struct Candidato {
+    double angulo;
+    double velocidad;
+    double distancia;
+};
+
+// Distancia del borde de un circulo a un rectangulo (0 si se tocan).
+double distanciaCirculoRect(const Vector2D &c, double r, const RectMundo &rect)
+{
+    double qx = std::max(rect.izquierda(), std::min(rect.derecha(), c.x));
+    double qy = std::max(rect.arriba(),    std::min(rect.abajo(),   c.y));
+    return std::max(0.0, magnitud(Vector2D(c.x - qx, c.y - qy)) - r);
+}
+
+// Malla de na x nv disparos centrada en (angulo, velocidad), recortada
+// a los rangos permitidos.
+void agregarMalla(std::vector<Candidato> &salida,
+                  const SolucionadorPunteria::Opciones &op,
+                  double angulo, double velocidad,
+                  double semiAngulo, double semiVelocidad, int na, int nv)
+{
+    for (int i = 0; i < na; ++i) {
+        double a = (na == 1) ? angulo
+                             : angulo - semiAngulo + 2.0*semiAngulo * i / (na - 1);
+        a = limitar(a, op.anguloMin, op.anguloMax);
+        for (int j = 0; j < nv; ++j) {
+            double v = (nv == 1) ? velocidad
+                                 : velocidad - semiVelocidad + 2.0*semiVelocidad * j / (nv - 1);
+            v = limitar(v, op.velocidadMin, op.velocidadMax);
+            salida.push_back({a, v, std::numeric_limits<double>::infinity()});
+        }
+    }
+}
+
+} // namespace
+
+double SolucionadorPunteria::evaluar(const MundoSimulacion &base,
+                                     MundoSimulacion &trabajo,
+                                     double angulo, double velocidad, double dt)
+{
+    trabajo = base;   // reutiliza la memoria de la prueba anterior
+    const MundoSimulacion::Bando tirador = trabajo.turno();
+    const MundoSimulacion::Bando enemigo =
+        (tirador == MundoSimulacion::Izquierda) ? MundoSimulacion::Derecha
+                                                : MundoSimulacion::Izquierda;
+    const RectMundo objetivo = trabajo.rectRival(enemigo);
+
+    if (!trabajo.disparar(angulo, velocidad))
+        return std::numeric_limits<double>::infinity();
+
+    double mejor = std::numeric_limits<double>::infinity();
+    while (trabajo.hayProyectilesEnVuelo()) {
+        trabajo.paso(dt);
+
+        const AlmacenProyectiles &p = trabajo.proyectiles();
+        for (int k = 0; k < p.tamano(); ++k)
+            mejor = std::min(mejor, distanciaCirculoRect(p.posicion(k), p.radio[k],
+                                                         objetivo));
+    }
+
+    if (trabajo.hayGanador())
+        return (trabajo.ganador() == tirador) ? 0.0 : 1e9;
+    return mejor;
+}
+
+SolucionadorPunteria::Resultado
+SolucionadorPunteria::resolver(const MundoSimulacion &mundo, const Opciones &op)
+{
+    const Reloj::time_point limite = Reloj::now() +
+        std::chrono::microseconds(static_cast<long long>(op.presupuestoMs * 1000.0));
+
+    int hilos = op.hilos > 0 ? op.hilos : int(std::thread::hardware_concurrency());
+    hilos = std::max(1, hilos);
+
+    // La copia de partida: sin proyectiles en vuelo y con el turno actual.
+    MundoSimulacion base = mundo;
+
+    Resultado res;
+    res.distancia = std::numeric_limits<double>::infinity();
+    std::atomic<int>  totalPruebas{0};
+    std::atomic<bool> hayAcierto{false};
+
+    // Ronda 0: malla gruesa sobre todo el rango.
+    double semiA = (op.anguloMax - op.anguloMin) / 2.0;
+    double semiV = (op.velocidadMax - op.velocidadMin) / 2.0;
+    std::vector<Candidato> ronda;
+    agregarMalla(ronda, op, op.anguloMin + semiA, op.velocidadMin + semiV,
+                 semiA, semiV, 24, 16);
+    semiA /= 23.0;
+    semiV /= 15.0;
+
+    while (!ronda.empty()) {
+        std::atomic<int> siguiente{0};
+        auto trabajar = [&](){
+            MundoSimulacion trabajo = base;
+            for (;;) {
+                if (hayAcierto.load(std::memory_order_relaxed) ||
+                    Reloj::now() >= limite)
+                    return;
+                int i = siguiente.fetch_add(1);
+                if (i >= int(ronda.size())) return;
+
+                Candidato &c = ronda[i];
+                c.distancia = evaluar(base, trabajo, c.angulo, c.velocidad, op.dt);
+                totalPruebas.fetch_add(1, std::memory_order_relaxed);
+                if (c.distancia == 0.0)
+                    hayAcierto.store(true, std::memory_order_relaxed);
+            }
+        };
+
+        std::vector<std::thread> trabajadores;
+        for (int h = 1; h < hilos; ++h)
+            trabajadores.emplace_back(trabajar);
+        trabajar();
+        for (std::thread &t : trabajadores)
+            t.join();
+
+        // Los candidatos sin evaluar quedan con distancia infinita.
+        std::sort(ronda.begin(), ronda.end(),
+                  [](const Candidato &a, const Candidato &b){
+                      return a.distancia < b.distancia;
+                  });
+        if (ronda.front().distancia < res.distancia) {
+            res.angulo    = ronda.front().angulo;
+            res.velocidad = ronda.front().velocidad;
+            res.distancia = ronda.front().distancia;
+        }
+
+        if (hayAcierto || Reloj::now() >= limite)
+            break;
+        ++res.rondas;
+
+        // Refinar: malla 5 x 5 alrededor de los cuatro mejores, con la
+        // mitad del paso de la ronda anterior.
+        std::vector<Candidato> mejores(ronda.begin(),
+                                       ronda.begin() + std::min<std::size_t>(4, ronda.size()));
+        ronda.clear();
+        for (const Candidato &c : mejores)
+            agregarMalla(ronda, op, c.angulo, c.velocidad, semiA, semiV, 5, 5);
+        semiA /= 2.0;
+        semiV /= 2.0;
+
+        // Sin resolucion util que ganar: se detiene.
+        if (semiA < 1e-3 && semiV < 1e-3)
+            break;
+    }
+
+    res.acierta = (res.distancia == 0.0);
+    res.pruebas = totalPruebas.load();
+    return res;
+}
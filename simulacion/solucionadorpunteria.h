@@ -0,0 +1,49 @@
+#ifndef SOLUCIONADORPUNTERIA_H
+#define SOLUCIONADORPUNTERIA_H
+
+#include "mundosimulacion.h"
+
+// SolucionadorPunteria:
+//  - Punteria automatica para la CPU.
+//  - Prueba miles de disparos (angulo, velocidad) sobre copias del mundo
+//    actual (con el daño que tengan los bloques) repartidos entre todos
+//    los nucleos, primero en una malla gruesa y luego refinando alrededor
+//    de los mejores.
+//  - Respeta un presupuesto de tiempo: devuelve lo mejor que encontro
+//    aunque no haya terminado.
+class SolucionadorPunteria
+{
+public:
+    struct Opciones {
+        // Mismos rangos que los controles de VentanaPrincipal.
+        double anguloMin{5.0};
+        double anguloMax{85.0};
+        double velocidadMin{50.0};
+        double velocidadMax{300.0};
+
+        double presupuestoMs{50.0};  // tiempo maximo de respuesta
+        int    hilos{0};             // 0 = todos los nucleos
+        double dt{0.016};            // mismo paso que la partida
+    };
+
+    struct Resultado {
+        double angulo{45.0};
+        double velocidad{150.0};
+        bool   acierta{false};     // el disparo gana la partida
+        double distancia{0.0};     // menor distancia al rival enemigo
+        int    pruebas{0};         // trayectorias simuladas
+        int    rondas{0};          // rondas de refinamiento completas
+    };
+
+    // Mejor disparo para el bando que tiene el turno en 'mundo'.
+    static Resultado resolver(const MundoSimulacion &mundo,
+                              const Opciones &opciones);
+
+    // Simula un disparo sobre 'trabajo' (copia de 'base') y devuelve la
+    // menor distancia al rival enemigo; 0 si lo alcanza y un valor muy
+    // grande si el disparo se vuelve contra el propio jugador.
+    static double evaluar(const MundoSimulacion &base, MundoSimulacion &trabajo,
+                          double angulo, double velocidad, double dt);
+};
+
+#endif // SOLUCIONADORPUNTERIA_H
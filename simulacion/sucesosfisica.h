@@ -0,0 +1,101 @@
+#ifndef SUCESOSFISICA_H
+#define SUCESOSFISICA_H
+
+#include <array>
+#include <cstdint>
+#include <vector>
+#include "vector2d.h"
+
+// Algo que paso en la fisica y que le interesa a quien mira la partida
+// (sonido, dibujo, estadisticas), no a la fisica misma.
+struct Suceso {
+    enum Tipo : std::uint8_t {
+        Golpe,         // un proyectil o un bloque que cae daña un bloque
+        Destruccion,   // ... y lo rompe (viene despues de su Golpe)
+        Rebote,        // contra pared, suelo o escombro, sin daño
+        Crater,        // el proyectil abre un crater en el terreno
+        GolpeRival,    // alcanzo a un jugador
+        NumTipos
+    };
+
+    Tipo     tipo{Golpe};
+    int      objetivo{-1};   // bloque, escombro o bando; -1: pared o suelo
+    double   valor{0.0};     // Golpe: daño; Crater: radio
+    // Donde ocurrio. Los rebotes contra las paredes de paso(), que se
+    // resuelven por lotes, van juntos en uno solo y sin punto (0, 0).
+    Vector2D punto;
+};
+
+// SucesosFisica:
+//  - Lo que paso en el mundo desde que alguien recogio los sucesos por
+//    ultima vez (MundoSimulacion::tomarSucesos), normalmente un frame de
+//    uno o varios pasos: la lista de sucesos en orden y los bloques cuya
+//    resistencia o posicion cambio, cada uno una sola vez.
+//  - El espacio de la lista se reserva al crearlo: agregar() nunca pide
+//    memoria. Lo que no cabe solo se cuenta (cuantos() es exacto aunque
+//    la lista se llene), p. ej. en las copias del mundo que nadie lee.
+//  - Se intercambia entero con otro (intercambiar) en vez de copiarse,
+//    asi quien lo consume puede hacerlo en otro hilo mientras el mundo
+//    sigue llenando el otro.
+class SucesosFisica
+{
+public:
+    static constexpr int kCapacidad = 4096;
+
+    std::vector<int> bloquesDaniados;   // sin repetir, en el orden del primer golpe
+    std::vector<int> bloquesMovidos;    // caidos o asentados, sin repetir
+
+    SucesosFisica() { m_lista.reserve(kCapacidad); }
+    SucesosFisica(const SucesosFisica &o)
+        : bloquesDaniados(o.bloquesDaniados), bloquesMovidos(o.bloquesMovidos),
+          m_cuantos(o.m_cuantos)
+    {
+        m_lista.reserve(kCapacidad);
+        m_lista = o.m_lista;
+    }
+    SucesosFisica &operator=(const SucesosFisica &) = default;   // conserva la reserva
+
+    void agregar(Suceso::Tipo tipo, int objetivo, double valor, const Vector2D &punto)
+    {
+        ++m_cuantos[tipo];
+        if (int(m_lista.size()) < kCapacidad)
+            m_lista.push_back({tipo, objetivo, valor, punto});
+    }
+
+    void limpiar()
+    {
+        m_lista.clear();
+        bloquesDaniados.clear();
+        bloquesMovidos.clear();
+        m_cuantos.fill(0);
+    }
+
+    void intercambiar(SucesosFisica &otro)
+    {
+        m_lista.swap(otro.m_lista);
+        bloquesDaniados.swap(otro.bloquesDaniados);
+        bloquesMovidos.swap(otro.bloquesMovidos);
+        m_cuantos.swap(otro.m_cuantos);
+    }
+
+    const std::vector<Suceso> &lista() const { return m_lista; }
+    int  cuantos(Suceso::Tipo tipo) const { return m_cuantos[tipo]; }
+    bool hay(Suceso::Tipo tipo) const { return m_cuantos[tipo] > 0; }
+    bool vacio() const
+    {
+        return m_lista.empty() && bloquesDaniados.empty() && bloquesMovidos.empty();
+    }
+    // Hubo mas sucesos que kCapacidad: la lista no los tiene todos.
+    bool desbordado() const
+    {
+        int total = 0;
+        for (int n : m_cuantos) total += n;
+        return total > int(m_lista.size());
+    }
+
+private:
+    std::vector<Suceso> m_lista;
+    std::array<int, Suceso::NumTipos> m_cuantos{};
+};
+
+#endif // SUCESOSFISICA_H
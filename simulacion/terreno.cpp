@@ -0,0 +1,257 @@
+#include "terreno.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr std::uint64_t kUnos = ~std::uint64_t(0);
+
+// Bits de las columnas c0 .. 63 y 0 .. c1 de una palabra.
+inline std::uint64_t desde(int c0) { return kUnos << (c0 & 63); }
+inline std::uint64_t hasta(int c1) { return kUnos >> (63 - (c1 & 63)); }
+
+} // namespace
+
+void Terreno::Zona::unir(const Zona &z)
+{
+    if (z.vacia()) return;
+    if (vacia()) { *this = z; return; }
+    x0 = std::min(x0, z.x0);
+    y0 = std::min(y0, z.y0);
+    x1 = std::max(x1, z.x1);
+    y1 = std::max(y1, z.y1);
+}
+
+void Terreno::crear(int ancho, int alto)
+{
+    if (ancho <= 0 || alto <= 0) {
+        m_ancho = m_alto = m_palabras = 0;
+        std::vector<std::uint64_t>().swap(m_bits);
+        m_filaSuperior = 0;
+        m_cambios = Zona();
+        return;
+    }
+    m_ancho = ancho;
+    m_alto = alto;
+    m_palabras = (ancho + 63) / 64;
+    m_bits.assign(std::size_t(alto) * m_palabras, 0);
+    m_filaSuperior = alto;
+    m_cambios = {0, 0, ancho, alto};
+}
+
+// Las filas por debajo de la superficie mas baja se llenan por palabras;
+// solo las de en medio se recorren celda a celda.
+void Terreno::rellenarBajo(const std::vector<int> &superficie)
+{
+    if (!activo()) return;
+    int arriba = m_alto, abajo = 0;
+    for (int x = 0; x < m_ancho; ++x) {
+        const int s = x < int(superficie.size()) ? std::clamp(superficie[x], 0, m_alto) : m_alto;
+        arriba = std::min(arriba, s);
+        abajo = std::max(abajo, s);
+    }
+
+    for (int y = arriba; y < abajo; ++y) {
+        std::uint64_t *p = m_bits.data() + std::size_t(y) * m_palabras;
+        for (int x = 0; x < m_ancho; ++x)
+            if (x < int(superficie.size()) && superficie[x] <= y)
+                p[x >> 6] |= std::uint64_t(1) << (x & 63);
+    }
+    for (int y = abajo; y < m_alto; ++y) {
+        std::uint64_t *p = m_bits.data() + std::size_t(y) * m_palabras;
+        std::fill(p, p + m_palabras - 1, kUnos);
+        p[m_palabras - 1] |= hasta(m_ancho - 1);
+    }
+
+    m_filaSuperior = std::min(m_filaSuperior, arriba);
+    m_cambios.unir({0, arriba, m_ancho, m_alto});
+}
+
+bool Terreno::solido(int x, int y) const
+{
+    if (x < 0 || y < 0 || x >= m_ancho || y >= m_alto) return false;
+    return (fila(y)[x >> 6] >> (x & 63)) & 1u;
+}
+
+bool Terreno::columnas(double x0, double x1, int &c0, int &c1) const
+{
+    c0 = int(std::ceil(std::clamp(x0 - 0.5, -1.0, double(m_ancho))));
+    c1 = int(std::floor(std::clamp(x1 - 0.5, -1.0, double(m_ancho)))) + 1;
+    c0 = std::max(c0, 0);
+    c1 = std::min(c1, m_ancho);
+    return c0 < c1;
+}
+
+bool Terreno::hayEnTramo(int y, int c0, int c1) const
+{
+    const std::uint64_t *p = fila(y);
+    const int w0 = c0 >> 6, w1 = (c1 - 1) >> 6;
+    if (w0 == w1)
+        return (p[w0] & desde(c0) & hasta(c1 - 1)) != 0;
+    std::uint64_t o = (p[w0] & desde(c0)) | (p[w1] & hasta(c1 - 1));
+    for (int w = w0 + 1; w < w1; ++w)
+        o |= p[w];
+    return o != 0;
+}
+
+bool Terreno::limpiarTramo(int y, int c0, int c1)
+{
+    std::uint64_t *p = m_bits.data() + std::size_t(y) * m_palabras;
+    const int w0 = c0 >> 6, w1 = (c1 - 1) >> 6;
+    if (w0 == w1) {
+        const std::uint64_t m = desde(c0) & hasta(c1 - 1);
+        const bool habia = (p[w0] & m) != 0;
+        p[w0] &= ~m;
+        return habia;
+    }
+    std::uint64_t o = (p[w0] & desde(c0)) | (p[w1] & hasta(c1 - 1));
+    p[w0] &= ~desde(c0);
+    p[w1] &= ~hasta(c1 - 1);
+    for (int w = w0 + 1; w < w1; ++w)
+        o |= p[w];
+    std::fill(p + w0 + 1, p + w1, std::uint64_t(0));
+    return o != 0;
+}
+
+bool Terreno::tramoCirculo(int y, const Vector2D &c, double r, int &c0, int &c1) const
+{
+    const double dy = (y + 0.5) - c.y;
+    const double h2 = r*r - dy*dy;
+    if (h2 < 0.0) return false;
+    const double h = std::sqrt(h2);
+    return columnas(c.x - h, c.x + h, c0, c1);
+}
+
+bool Terreno::hayEnFila(int y, double x0, double x1) const
+{
+    int c0, c1;
+    return y >= 0 && y < m_alto && columnas(x0, x1, c0, c1) && hayEnTramo(y, c0, c1);
+}
+
+int Terreno::primeraFila(double x0, double x1, int f0, int f1) const
+{
+    int c0, c1;
+    if (!columnas(x0, x1, c0, c1)) return -1;
+    f0 = std::max({f0, m_filaSuperior, 0});
+    f1 = std::min(f1, m_alto - 1);
+    for (int y = f0; y <= f1; ++y)
+        if (hayEnTramo(y, c0, c1)) return y;
+    return -1;
+}
+
+bool Terreno::hayEnRect(double x0, double y0, double x1, double y1) const
+{
+    if (!activo()) return false;
+    const int f0 = int(std::ceil(std::clamp(y0 - 0.5, -1.0, double(m_alto))));
+    const int f1 = int(std::floor(std::clamp(y1 - 0.5, -1.0, double(m_alto))));
+    return primeraFila(x0, x1, f0, f1) >= 0;
+}
+
+bool Terreno::tramoEnFila(int y, double x0, double x1, double &izquierda, double &derecha) const
+{
+    int c0, c1;
+    if (y < 0 || y >= m_alto || !columnas(x0, x1, c0, c1)) return false;
+    const std::uint64_t *p = fila(y);
+    int primera = -1, ultima = -1;
+    for (int c = c0; c < c1; ++c) {
+        if ((c & 63) == 0 && c + 64 <= c1 && p[c >> 6] == 0) {
+            c += 63;            // palabra vacia entera
+            continue;
+        }
+        if ((p[c >> 6] >> (c & 63)) & 1u) {
+            if (primera < 0) primera = c;
+            ultima = c;
+        }
+    }
+    if (primera < 0) return false;
+    izquierda = primera;
+    derecha = ultima + 1;
+    return true;
+}
+
+bool Terreno::tocaCirculo(const Vector2D &c, double r) const
+{
+    const int f0 = std::max({int(std::ceil(c.y - r - 0.5)), m_filaSuperior, 0});
+    const int f1 = std::min(int(std::floor(c.y + r - 0.5)), m_alto - 1);
+    int c0, c1;
+    for (int y = f0; y <= f1; ++y)
+        if (tramoCirculo(y, c, r, c0, c1) && hayEnTramo(y, c0, c1))
+            return true;
+    return false;
+}
+
+Vector2D Terreno::normalEn(const Vector2D &c, double r) const
+{
+    const int f0 = std::max({int(std::ceil(c.y - r - 0.5)), m_filaSuperior, 0});
+    const int f1 = std::min(int(std::floor(c.y + r - 0.5)), m_alto - 1);
+    Vector2D suma;
+    int c0, c1;
+    for (int y = f0; y <= f1; ++y) {
+        if (!tramoCirculo(y, c, r, c0, c1)) continue;
+        const std::uint64_t *p = fila(y);
+        for (int x = c0; x < c1; ++x)
+            if ((p[x >> 6] >> (x & 63)) & 1u)
+                suma += Vector2D(x + 0.5 - c.x, y + 0.5 - c.y);
+    }
+    return normalizar(suma * -1.0);
+}
+
+bool Terreno::barrerCirculo(const Vector2D &p0, const Vector2D &d, double r,
+                            double &t, Vector2D &normal) const
+{
+    if (!activo() || r <= 0.0) return false;
+    // Todo el barrido por encima del terreno o fuera del mundo.
+    if (std::max(p0.y, p0.y + d.y) + r < m_filaSuperior ||
+        std::min(p0.y, p0.y + d.y) - r > m_alto ||
+        std::max(p0.x, p0.x + d.x) + r < 0.0 ||
+        std::min(p0.x, p0.x + d.x) - r > m_ancho)
+        return false;
+
+    auto normalDe = [&](const Vector2D &c) {
+        const Vector2D n = normalEn(c, r + 1.0);
+        return magnitud2(n) > 0.0 ? n : normalizar(d * -1.0);
+    };
+
+    if (tocaCirculo(p0, r)) {
+        t = 0.0;
+        normal = normalDe(p0);
+        return true;
+    }
+
+    const int pasos = std::max(1, int(std::ceil(magnitud(d) / std::max(0.5, 0.5*r))));
+    double libre = 0.0;
+    for (int i = 1; i <= pasos; ++i) {
+        const double u = double(i) / pasos;
+        if (!tocaCirculo(p0 + d*u, r)) {
+            libre = u;
+            continue;
+        }
+        double choca = u;
+        for (int k = 0; k < 10; ++k) {
+            const double medio = 0.5 * (libre + choca);
+            if (tocaCirculo(p0 + d*medio, r)) choca = medio;
+            else                               libre = medio;
+        }
+        t = libre;
+        normal = normalDe(p0 + d*choca);
+        return true;
+    }
+    return false;
+}
+
+bool Terreno::excavar(const Vector2D &centro, double radio)
+{
+    if (!activo() || radio <= 0.0) return false;
+    const int f0 = std::max({int(std::ceil(centro.y - radio - 0.5)), m_filaSuperior, 0});
+    const int f1 = std::min(int(std::floor(centro.y + radio - 0.5)), m_alto - 1);
+
+    Zona zona;
+    int c0, c1;
+    for (int y = f0; y <= f1; ++y) {
+        if (!tramoCirculo(y, centro, radio, c0, c1) || !limpiarTramo(y, c0, c1))
+            continue;
+        zona.unir({c0, y, c1, y + 1});
+    }
+    m_cambios.unir(zona);
+    return !zona.vacia();
+}
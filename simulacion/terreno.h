@@ -0,0 +1,97 @@
+#ifndef TERRENO_H
+#define TERRENO_H
+
+#include <cstdint>
+#include <vector>
+#include "vector2d.h"
+
+// Terreno:
+//  - Suelo destructible: una mascara de ocupacion con un bit por celda de
+//    1 x 1 px. Cada fila son palabras de 64 bits; la columna x es el bit
+//    (x % 64) de la palabra x / 64. Un mundo de 1200 x 600 ocupa 90 KB y
+//    uno de 4800 x 600, 360 KB.
+//  - Una celda cuenta como tocada por una figura si su centro queda dentro.
+//  - Excavar un crater limpia en cada fila un tramo de bits con mascaras:
+//    las palabras de los extremos con un AND y las de en medio enteras, 64
+//    celdas por operacion. Las consultas (¿hay algo en este tramo?) tambien
+//    son por palabras.
+//  - Guarda la zona que cambio desde limpiarCambios() para que la vista
+//    vuelva a dibujar solo eso.
+//  - Las filas estan en memoria en el orden de una imagen de 1 bit por
+//    pixel con el bit menos significativo primero (en maquinas
+//    little-endian): la vista la puede leer sin copiarla.
+class Terreno
+{
+public:
+    // Celdas [x0, x1) x [y0, y1).
+    struct Zona {
+        int x0{0}, y0{0}, x1{0}, y1{0};
+        bool vacia() const { return x1 <= x0 || y1 <= y0; }
+        void unir(const Zona &z);
+    };
+
+    // Terreno vacio de ancho x alto celdas (0 x 0: sin terreno).
+    void crear(int ancho, int alto);
+    bool activo() const { return m_ancho > 0; }
+    int  ancho() const { return m_ancho; }
+    int  alto() const { return m_alto; }
+
+    // Llena cada columna x desde la fila superficie[x] hasta abajo.
+    void rellenarBajo(const std::vector<int> &superficie);
+
+    // --- consultas ---
+    bool solido(int x, int y) const;
+    bool solido(const Vector2D &p) const
+    {
+        return p.x >= 0.0 && p.y >= 0.0 && p.x < m_ancho && p.y < m_alto &&
+               solido(int(p.x), int(p.y));
+    }
+    // Primera fila que puede tener algo (lo que esta por encima es aire).
+    int  filaSuperior() const { return m_filaSuperior; }
+    // ¿Alguna celda llena en la fila y con el centro entre x0 y x1?
+    bool hayEnFila(int y, double x0, double x1) const;
+    // Primera fila entre f0 y f1 (incluidas) con algo entre x0 y x1; -1 si no hay.
+    int  primeraFila(double x0, double x1, int f0, int f1) const;
+    // ¿Algo dentro del rectangulo [x0, x1] x [y0, y1]?
+    bool hayEnRect(double x0, double y0, double x1, double y1) const;
+    // Primera y ultima celda llena de la fila y entre x0 y x1 (tramo que
+    // sostiene a un bloque). false si no hay ninguna.
+    bool tramoEnFila(int y, double x0, double x1, double &izquierda, double &derecha) const;
+
+    bool tocaCirculo(const Vector2D &c, double r) const;
+    // Hacia donde queda el aire alrededor de c: suma de las direcciones de
+    // las celdas llenas a menos de r, invertida. (0, 0) si no hay ninguna.
+    Vector2D normalEn(const Vector2D &c, double r) const;
+    // Barrido de un circulo de p0 a p0 + d: pasos de a lo sumo medio radio
+    // y biseccion del primero que toca. Deja el instante del ultimo punto
+    // libre y la normal del terreno ahi.
+    bool barrerCirculo(const Vector2D &p0, const Vector2D &d, double r,
+                       double &t, Vector2D &normal) const;
+
+    // --- cambios ---
+    // Vacia las celdas dentro del circulo. Devuelve false si no habia nada.
+    bool excavar(const Vector2D &centro, double radio);
+    const Zona &cambios() const { return m_cambios; }
+    void limpiarCambios() { m_cambios = Zona(); }
+
+    // --- para la vista ---
+    int palabrasPorFila() const { return m_palabras; }
+    const std::uint64_t *fila(int y) const { return m_bits.data() + std::size_t(y) * m_palabras; }
+
+private:
+    // Rango de columnas [c0, c1) cuyo centro esta entre x0 y x1.
+    bool columnas(double x0, double x1, int &c0, int &c1) const;
+    bool hayEnTramo(int y, int c0, int c1) const;
+    bool limpiarTramo(int y, int c0, int c1);
+    // Columnas de la fila y cuyo centro esta dentro del circulo.
+    bool tramoCirculo(int y, const Vector2D &c, double r, int &c0, int &c1) const;
+
+    int m_ancho{0};
+    int m_alto{0};
+    int m_palabras{0};
+    int m_filaSuperior{0};
+    std::vector<std::uint64_t> m_bits;
+    Zona m_cambios;
+};
+
+#endif // TERRENO_H
@@ -0,0 +1,329 @@
+#include "torneo.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr int    kLote = 8;     // partidas que toma un hilo de su tramo cada vez
+
+// Generador de la CPU (splitmix64): rapido, sin estado compartido y con la
+// misma secuencia en cualquier biblioteca estandar.
+class Generador
+{
+public:
+    explicit Generador(std::uint64_t semilla) : m_estado(semilla) {}
+
+    std::uint64_t siguiente()
+    {
+        std::uint64_t z = (m_estado += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+    // En [0, 1).
+    double uniforme() { return double(siguiente() >> 11) * (1.0 / 9007199254740992.0); }
+    // Normal de media 0 y desvio 1 (Box-Muller).
+    double normal()
+    {
+        const double u = 1.0 - uniforme();   // (0, 1]: el logaritmo es finito
+        const double v = uniforme();
+        return std::sqrt(-2.0 * std::log(u)) * std::cos(2.0 * kPi * v);
+    }
+
+private:
+    std::uint64_t m_estado;
+};
+
+// Partidas [0, total) repartidas en un tramo contiguo por hilo. Cada hilo
+// consume su tramo desde el principio; el que se queda sin nada roba la
+// mitad final del tramo con mas partidas pendientes. Nunca se tienen dos
+// cerrojos a la vez.
+class RepartoConRobo
+{
+public:
+    RepartoConRobo(int total, int hilos) : m_tramos(hilos)
+    {
+        for (int h = 0; h < hilos; ++h) {
+            m_tramos[h].inicio = int(std::int64_t(total) * h / hilos);
+            m_tramos[h].fin    = int(std::int64_t(total) * (h + 1) / hilos);
+        }
+    }
+
+    // Siguiente lote [inicio, fin) para el hilo; false si no queda nada.
+    bool tomar(int hilo, int &inicio, int &fin)
+    {
+        Tramo &propio = m_tramos[hilo];
+        for (;;) {
+            {
+                std::lock_guard<std::mutex> l(propio.m);
+                if (propio.inicio < propio.fin) {
+                    inicio = propio.inicio;
+                    fin = std::min(propio.fin, inicio + kLote);
+                    propio.inicio = fin;
+                    return true;
+                }
+            }
+
+            int victima = -1, mayor = 0;
+            for (int h = 0; h < int(m_tramos.size()); ++h) {
+                if (h == hilo) continue;
+                std::lock_guard<std::mutex> l(m_tramos[h].m);
+                if (m_tramos[h].fin - m_tramos[h].inicio > mayor) {
+                    mayor = m_tramos[h].fin - m_tramos[h].inicio;
+                    victima = h;
+                }
+            }
+            if (victima < 0)
+                return false;
+
+            int a, b;
+            {
+                Tramo &otro = m_tramos[victima];
+                std::lock_guard<std::mutex> l(otro.m);
+                const int quedan = otro.fin - otro.inicio;
+                if (quedan <= 0) continue;   // se adelanto otro ladron
+                b = otro.fin;
+                a = b - (quedan + 1) / 2;
+                otro.fin = a;
+            }
+            m_robos.fetch_add(1, std::memory_order_relaxed);
+            std::lock_guard<std::mutex> l(propio.m);
+            propio.inicio = a;
+            propio.fin = b;
+        }
+    }
+
+    long long robos() const { return m_robos.load(); }
+
+private:
+    struct alignas(64) Tramo {
+        std::mutex m;
+        int inicio{0};
+        int fin{0};
+    };
+    std::vector<Tramo>     m_tramos;
+    std::atomic<long long> m_robos{0};
+};
+
+// Semilla de la partida 'numero': independiente del hilo que la juegue.
+std::uint64_t semillaPartida(std::uint32_t semillaTorneo, int numero)
+{
+    Generador g((std::uint64_t(semillaTorneo) << 32) ^ std::uint64_t(std::uint32_t(numero)));
+    return g.siguiente();
+}
+
+} // namespace
+
+std::vector<Torneo::Disparo> Torneo::repertorio(const MundoSimulacion &nivel,
+                                                MundoSimulacion::Bando bando,
+                                                const Opciones &op)
+{
+    MundoSimulacion vacio = nivel;
+    vacio.cargarBloques(0, nullptr, nullptr, nullptr);
+    vacio.fijarTurno(bando);
+    MundoSimulacion trabajo = vacio;
+
+    std::vector<Disparo> aciertos, otros;
+    for (double a = op.anguloMin; a <= op.anguloMax + 1e-9; a += op.pasoAngulo) {
+        for (double v = op.velocidadMin; v <= op.velocidadMax + 1e-9; v += op.pasoVelocidad) {
+            trabajo = vacio;
+            if (!trabajo.disparar(a, v, op.modo)) continue;
+            trabajo.resolverAlInstante();
+            if (!trabajo.hayGanador())
+                otros.push_back({a, v});
+            else if (trabajo.ganador() == bando)
+                aciertos.push_back({a, v});
+        }
+    }
+    return aciertos.empty() ? otros : aciertos;
+}
+
+Torneo::Partida Torneo::jugarPartida(const MundoSimulacion &nivel, MundoSimulacion &trabajo,
+                                     SucesosFisica &sucesos,
+                                     const std::vector<Disparo> repertorios[2],
+                                     std::uint64_t semilla, bool abreDerecha,
+                                     const Opciones &op)
+{
+    trabajo = nivel;   // reutiliza la memoria de la partida anterior
+    if (abreDerecha)
+        trabajo.fijarTurno(MundoSimulacion::Derecha);
+    Generador azar(semilla);
+    trabajo.fijarSemilla(std::uint32_t(azar.siguiente() >> 32));
+
+    Partida r;
+    while (!trabajo.hayGanador() && r.turnos < op.maxTurnos) {
+        const std::vector<Disparo> &opciones = repertorios[trabajo.turno()];
+        if (opciones.empty())
+            break;
+        const Disparo &elegido = opciones[std::size_t(azar.uniforme() * double(opciones.size()))];
+        const double angulo = limitar(elegido.angulo + op.errorAngulo * azar.normal(),
+                                      op.anguloMin, op.anguloMax);
+        const double velocidad = limitar(elegido.velocidad + op.errorVelocidad * azar.normal(),
+                                         op.velocidadMin, op.velocidadMax);
+
+        // resolverAlInstante deja el mundo quieto: siempre se puede disparar.
+        if (!trabajo.disparar(angulo, velocidad, op.modo))
+            break;
+        trabajo.resolverAlInstante();
+        ++r.turnos;
+
+        trabajo.tomarSucesos(sucesos);
+        r.golpes += sucesos.cuantos(Suceso::Golpe);
+        r.destrucciones += sucesos.cuantos(Suceso::Destruccion);
+        for (const Suceso &s : sucesos.lista()) {
+            if (s.tipo != Suceso::Golpe) continue;
+            ++r.golpesMedidos;
+            r.danio += s.valor;
+        }
+    }
+    if (trabajo.hayGanador())
+        r.ganador = trabajo.ganador();
+    return r;
+}
+
+Torneo::Estadisticas Torneo::jugar(const MundoSimulacion &nivel, const Opciones &op)
+{
+    const auto inicio = std::chrono::steady_clock::now();
+
+    int hilos = op.hilos > 0 ? op.hilos : int(std::thread::hardware_concurrency());
+    hilos = std::clamp(hilos, 1, std::max(1, op.partidas));
+
+    const std::vector<Disparo> repertorios[2] = {
+        repertorio(nivel, MundoSimulacion::Izquierda, op),
+        repertorio(nivel, MundoSimulacion::Derecha, op)
+    };
+
+    const int bloques = nivel.numBloques();
+    RepartoConRobo reparto(op.partidas, hilos);
+
+    // Cada hilo acumula lo suyo y se suma al final: nada compartido
+    // mientras se juega.
+    std::vector<Estadisticas> parciales(hilos);
+    auto trabajar = [&](int hilo) {
+        Estadisticas &e = parciales[hilo];
+        e.turnosHasta.assign(op.maxTurnos + 1, 0);
+        e.bloqueEnPie.assign(bloques, 0);
+        e.resistenciaFinal.assign(bloques, 0.0);
+        MundoSimulacion trabajo = nivel;
+        SucesosFisica sucesos;
+
+        int desde, hasta;
+        while (reparto.tomar(hilo, desde, hasta)) {
+            for (int n = desde; n < hasta; ++n) {
+                const Partida p = jugarPartida(nivel, trabajo, sucesos, repertorios,
+                                               semillaPartida(op.semilla, n),
+                                               op.alternarInicio && n % 2 == 1, op);
+                ++e.partidas;
+                e.golpes += p.golpes;
+                e.destrucciones += p.destrucciones;
+                e.golpesMedidos += p.golpesMedidos;
+                e.danio += p.danio;
+                if (p.ganador < 0) {
+                    ++e.empates;
+                } else {
+                    ++e.victorias[p.ganador];
+                    ++e.turnosHasta[p.turnos];
+                }
+                for (int b = 0; b < bloques; ++b) {
+                    if (!trabajo.bloqueDestruido(b))
+                        ++e.bloqueEnPie[b];
+                    e.resistenciaFinal[b] += trabajo.resistenciaBloque(b);
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> trabajadores;
+    for (int h = 1; h < hilos; ++h)
+        trabajadores.emplace_back(trabajar, h);
+    trabajar(0);
+    for (std::thread &t : trabajadores)
+        t.join();
+
+    Estadisticas total = std::move(parciales[0]);
+    for (int h = 1; h < hilos; ++h) {
+        const Estadisticas &e = parciales[h];
+        total.partidas += e.partidas;
+        total.victorias[0] += e.victorias[0];
+        total.victorias[1] += e.victorias[1];
+        total.empates += e.empates;
+        total.golpes += e.golpes;
+        total.destrucciones += e.destrucciones;
+        total.golpesMedidos += e.golpesMedidos;
+        total.danio += e.danio;
+        for (std::size_t t = 0; t < total.turnosHasta.size(); ++t)
+            total.turnosHasta[t] += e.turnosHasta[t];
+        for (int b = 0; b < bloques; ++b) {
+            total.bloqueEnPie[b] += e.bloqueEnPie[b];
+            total.resistenciaFinal[b] += e.resistenciaFinal[b];
+        }
+    }
+    total.robos = reparto.robos();
+    total.segundos = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - inicio).count();
+    return total;
+}
+
+double Torneo::Estadisticas::tasaVictoria(MundoSimulacion::Bando b) const
+{
+    return partidas > 0 ? double(victorias[b]) / partidas : 0.0;
+}
+
+double Torneo::Estadisticas::turnosMedios() const
+{
+    long long suma = 0, cuantas = 0;
+    for (std::size_t t = 0; t < turnosHasta.size(); ++t) {
+        suma += (long long)t * turnosHasta[t];
+        cuantas += turnosHasta[t];
+    }
+    return cuantas > 0 ? double(suma) / double(cuantas) : 0.0;
+}
+
+// El menor numero de turnos con el que termina al menos la fraccion 'p'
+// de las partidas con ganador (0 si no hubo ninguna).
+int Torneo::Estadisticas::percentilTurnos(double p) const
+{
+    const long long cuantas = victorias[0] + victorias[1];
+    if (cuantas == 0) return 0;
+    const long long necesarias = std::max<long long>(1, (long long)std::ceil(p * double(cuantas)));
+    long long acumuladas = 0;
+    for (std::size_t t = 0; t < turnosHasta.size(); ++t) {
+        acumuladas += turnosHasta[t];
+        if (acumuladas >= necesarias)
+            return int(t);
+    }
+    return int(turnosHasta.size()) - 1;
+}
+
+double Torneo::Estadisticas::supervivencia(int bloque) const
+{
+    return partidas > 0 ? double(bloqueEnPie[bloque]) / partidas : 0.0;
+}
+
+double Torneo::Estadisticas::supervivenciaMedia() const
+{
+    if (bloqueEnPie.empty() || partidas == 0) return 0.0;
+    long long enPie = 0;
+    for (int n : bloqueEnPie) enPie += n;
+    return double(enPie) / (double(partidas) * double(bloqueEnPie.size()));
+}
+
+double Torneo::Estadisticas::golpesPorPartida() const
+{
+    return partidas > 0 ? double(golpes) / partidas : 0.0;
+}
+
+double Torneo::Estadisticas::danioMedioGolpe() const
+{
+    return golpesMedidos > 0 ? danio / double(golpesMedidos) : 0.0;
+}
+
+double Torneo::Estadisticas::partidasPorMinuto() const
+{
+    return segundos > 0.0 ? partidas * 60.0 / segundos : 0.0;
+}
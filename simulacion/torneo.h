@@ -0,0 +1,119 @@
+#ifndef TORNEO_H
+#define TORNEO_H
+
+#include <cstdint>
+#include <vector>
+#include "mundosimulacion.h"
+
+// Torneo:
+//  - Muchas partidas completas CPU contra CPU sin ventana, con las reglas
+//    de MundoSimulacion: turnos alternos, daño a los bloques y victoria al
+//    alcanzar a un rival. Sirve para equilibrar resistencias y factor de
+//    daño (herramientas/torneo).
+//  - La CPU del torneo no busca entre miles de disparos en cada turno
+//    como SolucionadorPunteria (demasiado lento para cientos de miles de
+//    partidas). Antes de empezar se prueba una malla de disparos con el
+//    nivel sin bloques y se guardan los que alcanzan al rival enemigo (con
+//    la velocidad de los controles casi siempre rebotando en paredes y
+//    suelo); en cada turno la CPU toma uno al azar y falla con un desvio,
+//    como un jugador que sabe donde apuntar pero no es perfecto. Los
+//    bloques que se interponen son los que hay que romper.
+//  - Cada partida juega sobre su propia copia del nivel y sale de una
+//    semilla propia (la del torneo y su numero), asi que los resultados
+//    no dependen del numero de hilos ni del orden en que se jueguen (salvo
+//    el redondeo de la resistencia final sumada).
+//  - Las partidas se reparten entre hilos con robo de trabajo: cada hilo
+//    empieza con un tramo de partidas y, cuando acaba el suyo, roba la
+//    mitad del tramo que mas partidas tenga pendientes (las partidas
+//    duran muy distinto segun cuanto tarde alguien en acertar).
+class Torneo
+{
+public:
+    struct Opciones {
+        int partidas{1000};
+        int hilos{0};                 // 0 = todos los nucleos
+        int maxTurnos{200};           // sin ganador antes: empate
+        std::uint32_t semilla{1};
+        MundoSimulacion::ModoDisparo modo{MundoSimulacion::DisparoSimple};
+        bool alternarInicio{false};   // las partidas impares abre la derecha
+
+        // Mismos rangos que los controles de VentanaPrincipal.
+        double anguloMin{5.0};
+        double anguloMax{85.0};
+        double velocidadMin{50.0};
+        double velocidadMax{300.0};
+
+        // Malla del repertorio de la CPU.
+        double pasoAngulo{1.0};
+        double pasoVelocidad{5.0};
+
+        // Desvio tipico del disparo de la CPU respecto al elegido.
+        double errorAngulo{1.0};      // grados
+        double errorVelocidad{3.0};   // px/s
+    };
+
+    struct Disparo {
+        double angulo{45.0};
+        double velocidad{150.0};
+    };
+
+    struct Partida {
+        int ganador{-1};              // Bando, o -1 si acabo en empate
+        int turnos{0};                // disparos de los dos bandos
+        // De los sucesos de cada turno: golpes a bloques, bloques rotos y
+        // daño de los golpes que cupieron en la lista (golpesMedidos).
+        int    golpes{0};
+        int    destrucciones{0};
+        int    golpesMedidos{0};
+        double danio{0.0};
+    };
+
+    struct Estadisticas {
+        int partidas{0};
+        int victorias[2]{0, 0};       // por Bando
+        int empates{0};
+        // turnosHasta[t]: partidas con ganador que terminaron en el turno t.
+        std::vector<int> turnosHasta;
+        // Por bloque: partidas que termino en pie y resistencia final sumada.
+        std::vector<int>    bloqueEnPie;
+        std::vector<double> resistenciaFinal;
+        long long golpes{0};
+        long long destrucciones{0};
+        long long golpesMedidos{0};
+        double    danio{0.0};
+        double segundos{0.0};
+        long long robos{0};           // tramos robados entre hilos
+
+        double tasaVictoria(MundoSimulacion::Bando b) const;
+        double turnosMedios() const;  // de las partidas con ganador
+        int    percentilTurnos(double p) const;
+        double supervivencia(int bloque) const;
+        double supervivenciaMedia() const;
+        double golpesPorPartida() const;
+        double danioMedioGolpe() const;
+        double partidasPorMinuto() const;
+    };
+
+    // Juega op.partidas partidas sobre copias de 'nivel' (que debe estar
+    // sin proyectiles en vuelo) y resume los resultados.
+    static Estadisticas jugar(const MundoSimulacion &nivel, const Opciones &op);
+
+    // Disparos de la malla de 'op' que, desde el cañon de 'bando' y con el
+    // nivel sin bloques, alcanzan al rival enemigo. Si ninguno llega,
+    // todos los que no alcanzan al propio.
+    static std::vector<Disparo> repertorio(const MundoSimulacion &nivel,
+                                           MundoSimulacion::Bando bando,
+                                           const Opciones &op);
+
+    // Una partida sobre 'trabajo' (copia de 'nivel', reutiliza su
+    // memoria) con el repertorio de cada bando. Al volver 'trabajo' queda
+    // como termino la partida. 'sucesos' recoge los de cada turno (se
+    // reutiliza entre partidas).
+    static Partida jugarPartida(const MundoSimulacion &nivel, MundoSimulacion &trabajo,
+                                SucesosFisica &sucesos,
+                                const std::vector<Disparo> repertorios[2],
+                                std::uint64_t semilla, bool abreDerecha,
+                                const Opciones &op);
+};
+
+#endif // TORNEO_H
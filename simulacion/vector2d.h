@@ -0,0 +1,123 @@
+#ifndef VECTOR2D_H
+#define VECTOR2D_H
+
+#include <cmath>
+#include <array>
+
+// Vector2DT:
+//  - Vector de dos componentes sobre cualquier escalar con + - * / y sqrt:
+//    double (el mundo), float (la mitad de bytes por proyectil) o Fijo
+//    (coma fija, mismos bits en cualquier maquina).
+//  - Vector2D es el de double, el que usa toda la simulacion.
+template <typename T>
+struct Vector2DT {
+    T x{0}, y{0};
+    Vector2DT() = default;
+    Vector2DT(T x_, T y_) : x(x_), y(y_) {}
+
+    Vector2DT operator+(const Vector2DT& o) const { return {x+o.x, y+o.y}; }
+    Vector2DT operator-(const Vector2DT& o) const { return {x-o.x, y-o.y}; }
+    Vector2DT operator*(T k)                const { return {x*k, y*k}; }
+    Vector2DT operator/(T k)                const { return {x/k, y/k}; }
+
+    Vector2DT& operator+=(const Vector2DT& o){ x+=o.x; y+=o.y; return *this; }
+    Vector2DT& operator-=(const Vector2DT& o){ x-=o.x; y-=o.y; return *this; }
+    Vector2DT& operator*=(T k){ x*=k; y*=k; return *this; }
+};
+
+using Vector2D  = Vector2DT<double>;
+using Vector2Df = Vector2DT<float>;
+
+template <typename T>
+inline T productoPunto(const Vector2DT<T>& a, const Vector2DT<T>& b){
+    return a.x*b.x + a.y*b.y;
+}
+template <typename T>
+inline T magnitud2(const Vector2DT<T>& a){
+    return productoPunto(a,a);
+}
+template <typename T>
+inline T magnitud(const Vector2DT<T>& a){
+    using std::sqrt;
+    return sqrt(magnitud2(a));
+}
+template <typename T>
+inline Vector2DT<T> normalizar(const Vector2DT<T>& a){
+    T m = magnitud(a);
+    return (m>T(0)) ? a/m : Vector2DT<T>();
+}
+inline double limitar(double v, double minimo, double maximo){
+    if (v < minimo) return minimo;
+    if (v > maximo) return maximo;
+    return v;
+}
+
+// Carriles que llenan un registro de 256 bits: 4 double u 8 float.
+template <typename T>
+constexpr int kCarrilesLote = sizeof(T) >= 8 ? 4 : 8;
+
+// Vector2DLote:
+//  - N vectores a la vez, guardados como en un AlmacenProyectiles: las N
+//    x juntas y las N y juntas.
+//  - Cada operador es un lazo de N sin saltos con los mismos calculos que
+//    Vector2DT; con -O3 el compilador lo hace con instrucciones SIMD y da
+//    los mismos resultados que carril por carril.
+//  - cargar()/guardar() leen y escriben N elementos seguidos de los
+//    arreglos de un almacen SoA.
+template <typename T, int N = kCarrilesLote<T>>
+struct Vector2DLote {
+    static constexpr int kCarriles = N;
+
+    alignas(sizeof(T) * N) T x[N];
+    alignas(sizeof(T) * N) T y[N];
+
+    static Vector2DLote cargar(const T *xs, const T *ys)
+    {
+        Vector2DLote l;
+        for (int c = 0; c < N; ++c) { l.x[c] = xs[c]; l.y[c] = ys[c]; }
+        return l;
+    }
+    void guardar(T *xs, T *ys) const
+    {
+        for (int c = 0; c < N; ++c) { xs[c] = x[c]; ys[c] = y[c]; }
+    }
+
+    Vector2DLote& operator+=(const Vector2DLote& o){
+        for (int c = 0; c < N; ++c) { x[c]+=o.x[c]; y[c]+=o.y[c]; }
+        return *this;
+    }
+    Vector2DLote& operator-=(const Vector2DLote& o){
+        for (int c = 0; c < N; ++c) { x[c]-=o.x[c]; y[c]-=o.y[c]; }
+        return *this;
+    }
+    // El mismo vector en todos los carriles.
+    Vector2DLote& operator+=(const Vector2DT<T>& v){
+        for (int c = 0; c < N; ++c) { x[c]+=v.x; y[c]+=v.y; }
+        return *this;
+    }
+    Vector2DLote& operator*=(T k){
+        for (int c = 0; c < N; ++c) { x[c]*=k; y[c]*=k; }
+        return *this;
+    }
+
+    Vector2DLote operator+(const Vector2DLote& o) const { Vector2DLote r = *this; return r += o; }
+    Vector2DLote operator-(const Vector2DLote& o) const { Vector2DLote r = *this; return r -= o; }
+    Vector2DLote operator+(const Vector2DT<T>& v) const { Vector2DLote r = *this; return r += v; }
+    Vector2DLote operator*(T k)                   const { Vector2DLote r = *this; return r *= k; }
+
+    Vector2DT<T> carril(int c) const { return {x[c], y[c]}; }
+};
+
+template <typename T, int N>
+inline std::array<T, N> productoPunto(const Vector2DLote<T, N>& a, const Vector2DLote<T, N>& b){
+    std::array<T, N> r;
+    for (int c = 0; c < N; ++c)
+        r[c] = a.x[c]*b.x[c] + a.y[c]*b.y[c];
+    return r;
+}
+template <typename T, int N>
+inline std::array<T, N> magnitud2(const Vector2DLote<T, N>& a){
+    return productoPunto(a,a);
+}
+
+#endif // VECTOR2D_H
@@ -3,6 +3,13 @@
 #include <QHBoxLayout>
 #include <QWidget>
 #include <QKeyEvent>
+#include <QtConcurrent/QtConcurrentRun>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QSignalBlocker>
+#include <QStatusBar>
 VentanaPrincipal::VentanaPrincipal(QWidget *parent)
     : QMainWindow(parent)
 {
@@ -18,21 +25,68 @@ VentanaPrincipal::VentanaPrincipal(QWidget *parent)
     auto *layoutControles = new QHBoxLayout;
 
     m_spinAngulo = new QDoubleSpinBox;
-    m_spinAngulo->setRange(5, 85);
+    m_spinAngulo->setRange(MensajeRed::kAnguloMin, MensajeRed::kAnguloMax);
     m_spinAngulo->setValue(45);
 
     m_spinVelocidad = new QDoubleSpinBox;
-    m_spinVelocidad->setRange(50, 300);
+    m_spinVelocidad->setRange(MensajeRed::kVelocidadMin, MensajeRed::kVelocidadMax);
     m_spinVelocidad->setValue(150);
 
+    // Tipo de disparo (el dato es el MundoSimulacion::ModoDisparo)
+    m_comboModo = new QComboBox;
+    m_comboModo->addItem(tr("Simple"),   MundoSimulacion::DisparoSimple);
+    m_comboModo->addItem(tr("Salva"),    MundoSimulacion::DisparoSalva);
+    m_comboModo->addItem(tr("Racimo"),   MundoSimulacion::DisparoRacimo);
+    m_comboModo->addItem(tr("Metralla"), MundoSimulacion::DisparoMetralla);
+
+    // Niveles incluidos en el ejecutable; empieza en el base.
+    m_comboNivel = new QComboBox;
+    const QStringList incluidos = QDir(QStringLiteral(":/niveles")).entryList({"*.p5n"});
+    for (const QString &nombre : incluidos)
+        m_comboNivel->addItem(QFileInfo(nombre).completeBaseName(),
+                              QStringLiteral(":/niveles/") + nombre);
+    m_indiceNivel = qMax(0, m_comboNivel->findData(EscenaJuego::kNivelBase));
+    m_comboNivel->setCurrentIndex(m_indiceNivel);
+
+    // Fisica de la partida: cambiarla empieza una partida nueva.
+    m_comboIntegrador = new QComboBox;
+    m_comboIntegrador->addItem(tr("Euler"),  int(Integrador::EulerSemiImplicito));
+    m_comboIntegrador->addItem(tr("Verlet"), int(Integrador::Verlet));
+    m_comboIntegrador->addItem(tr("RK4"),    int(Integrador::RK4));
+    m_comboAire = new QComboBox;
+    m_comboAire->addItem(tr("Sin aire"),          EscenaJuego::SinAire);
+    m_comboAire->addItem(tr("Arrastre"),          EscenaJuego::ConArrastre);
+    m_comboAire->addItem(tr("Arrastre y viento"), EscenaJuego::ConViento);
+
+    // Jugadores controlados por la CPU y su tiempo para pensar
+    m_cpuIzquierda = new QCheckBox(tr("CPU izq."));
+    m_cpuDerecha   = new QCheckBox(tr("CPU der."));
+    m_spinPresupuestoCpu = new QSpinBox;
+    m_spinPresupuestoCpu->setRange(5, 1000);
+    m_spinPresupuestoCpu->setValue(50);
+    m_spinPresupuestoCpu->setSuffix(tr(" ms"));
+
     m_botonDisparar = new QPushButton(tr("Disparar"));
+    // Sin animacion: resuelve el disparo en vuelo hasta el final (tecla S)
+    m_botonSaltar = new QPushButton(tr("Saltar"));
     m_etiquetaTurno = new QLabel(tr("Turno: jugador izquierda"));
 
     layoutControles->addWidget(new QLabel(tr("Ángulo (°):")));
     layoutControles->addWidget(m_spinAngulo);
     layoutControles->addWidget(new QLabel(tr("Velocidad:")));
     layoutControles->addWidget(m_spinVelocidad);
+    layoutControles->addWidget(new QLabel(tr("Modo:")));
+    layoutControles->addWidget(m_comboModo);
     layoutControles->addWidget(m_botonDisparar);
+    layoutControles->addWidget(m_botonSaltar);
+    layoutControles->addWidget(new QLabel(tr("Nivel:")));
+    layoutControles->addWidget(m_comboNivel);
+    layoutControles->addWidget(new QLabel(tr("Física:")));
+    layoutControles->addWidget(m_comboIntegrador);
+    layoutControles->addWidget(m_comboAire);
+    layoutControles->addWidget(m_cpuIzquierda);
+    layoutControles->addWidget(m_cpuDerecha);
+    layoutControles->addWidget(m_spinPresupuestoCpu);
     layoutControles->addWidget(m_etiquetaTurno);
 
     layoutVertical->addLayout(layoutControles);
@@ -42,25 +96,112 @@ VentanaPrincipal::VentanaPrincipal(QWidget *parent)
 
     connect(m_botonDisparar, &QPushButton::clicked,
             this, &VentanaPrincipal::botonDisparar);
+    connect(m_botonSaltar, &QPushButton::clicked,
+            m_escena, &EscenaJuego::resolverAlInstante);
     connect(m_escena, &EscenaJuego::turnoCambiado,
             this, &VentanaPrincipal::actualizarEtiquetaTurno);
+    connect(m_comboNivel, &QComboBox::currentIndexChanged,
+            this, &VentanaPrincipal::cambiarNivel);
+    connect(m_comboIntegrador, &QComboBox::currentIndexChanged,
+            this, &VentanaPrincipal::cambiarFisica);
+    connect(m_comboAire, &QComboBox::currentIndexChanged,
+            this, &VentanaPrincipal::cambiarFisica);
     connect(m_escena, &EscenaJuego::partidaTerminada,
             this, &VentanaPrincipal::mostrarGanador);
+
+    // La CPU juega cuando le toca (también CPU contra CPU).
+    connect(m_escena, &EscenaJuego::turnoCambiado,
+            this, &VentanaPrincipal::jugarTurnoCpu);
+    connect(m_cpuIzquierda, &QCheckBox::toggled,
+            this, &VentanaPrincipal::jugarTurnoCpu);
+    connect(m_cpuDerecha, &QCheckBox::toggled,
+            this, &VentanaPrincipal::jugarTurnoCpu);
+    connect(&m_vigilanteCpu, &QFutureWatcherBase::finished,
+            this, &VentanaPrincipal::disparoCpuListo);
+
+    // Guia del disparo mientras se apunta
+    connect(m_spinAngulo, &QDoubleSpinBox::valueChanged,
+            this, &VentanaPrincipal::actualizarPrevision);
+    connect(m_spinVelocidad, &QDoubleSpinBox::valueChanged,
+            this, &VentanaPrincipal::actualizarPrevision);
+    connect(m_comboModo, &QComboBox::currentIndexChanged,
+            this, &VentanaPrincipal::actualizarPrevision);
+    actualizarPrevision();
 }
 
 void VentanaPrincipal::botonDisparar()
 {
+    if (m_red && !m_red->turnoLocal()) {
+        statusBar()->showMessage(tr("Es el turno del otro jugador"), 3000);
+        return;
+    }
     m_escena->dispararProyectil(
         m_spinAngulo->value(),
-        m_spinVelocidad->value());
+        m_spinVelocidad->value(),
+        MundoSimulacion::ModoDisparo(m_comboModo->currentData().toInt()));
+}
+
+void VentanaPrincipal::actualizarPrevision()
+{
+    m_escena->preverDisparo(
+        m_spinAngulo->value(),
+        m_spinVelocidad->value(),
+        MundoSimulacion::ModoDisparo(m_comboModo->currentData().toInt()));
+}
+
+void VentanaPrincipal::agregarNiveles(const QString &ruta)
+{
+    if (ruta.isEmpty()) return;
+
+    const QFileInfo info(ruta);
+    if (info.isDir()) {
+        const QDir carpeta(ruta);
+        const QFileInfoList archivos =
+            carpeta.entryInfoList({"*.p5n", "*.txt"}, QDir::Files, QDir::Name);
+        for (const QFileInfo &archivo : archivos)
+            m_comboNivel->addItem(archivo.fileName(), archivo.absoluteFilePath());
+        return;
+    }
+
+    m_comboNivel->addItem(info.fileName(), info.absoluteFilePath());
+    m_comboNivel->setCurrentIndex(m_comboNivel->count() - 1);
+}
+
+// Cambiar de nivel empieza una partida nueva; si el archivo no se puede
+// leer se sigue en el nivel anterior.
+void VentanaPrincipal::cambiarNivel(int indice)
+{
+    const QString ruta = m_comboNivel->itemData(indice).toString();
+    if (m_escena->cargarNivel(ruta)) {
+        m_indiceNivel = indice;
+        statusBar()->clearMessage();
+        return;
+    }
+
+    const QString motivo = tr("No se pudo cargar %1: %2").arg(ruta, m_escena->errorNivel());
+    qWarning("%s", qPrintable(motivo));
+    statusBar()->showMessage(motivo, 8000);
+
+    const QSignalBlocker bloqueo(m_comboNivel);
+    m_comboNivel->setCurrentIndex(m_indiceNivel);
 }
 
+void VentanaPrincipal::cambiarFisica()
+{
+    m_escena->fijarFisica(Integrador(m_comboIntegrador->currentData().toInt()),
+                          EscenaJuego::Aire(m_comboAire->currentData().toInt()));
+    m_escena->reiniciarJuego();
+}
+
+// El viento (positivo: hacia la derecha) cambia en cada partida.
 void VentanaPrincipal::actualizarEtiquetaTurno(EscenaJuego::Bando bando)
 {
-    if (bando == EscenaJuego::Izquierda)
-        m_etiquetaTurno->setText(tr("Turno: jugador izquierda"));
-    else
-        m_etiquetaTurno->setText(tr("Turno: jugador derecha"));
+    QString texto = (bando == EscenaJuego::Izquierda) ? tr("Turno: jugador izquierda")
+                                                      : tr("Turno: jugador derecha");
+    const MundoSimulacion &mundo = m_escena->mundo();
+    if (mundo.arrastre() > 0.0 && mundo.viento().x != 0.0)
+        texto += tr(" · viento %1").arg(mundo.viento().x, 0, 'f', 0);
+    m_etiquetaTurno->setText(texto);
 }
 
 void VentanaPrincipal::mostrarGanador(EscenaJuego::Bando ganador)
@@ -69,10 +210,163 @@ void VentanaPrincipal::mostrarGanador(EscenaJuego::Bando ganador)
     Q_UNUSED(ganador);
 }
 
+// Si el turno es de la CPU, busca el disparo en otro hilo sobre una
+// copia del mundo; la interfaz sigue respondiendo mientras tanto.
+void VentanaPrincipal::jugarTurnoCpu()
+{
+    if (m_vigilanteCpu.isRunning()) return;
+
+    const MundoSimulacion &mundo = m_escena->mundo();
+    if (mundo.hayGanador() || mundo.hayMovimiento()) return;
+
+    EscenaJuego::Bando turno = m_escena->turnoActual();
+    if (m_red && !m_red->turnoLocal()) return;   // juega el otro proceso
+    QCheckBox *cpu = (turno == EscenaJuego::Izquierda) ? m_cpuIzquierda
+                                                       : m_cpuDerecha;
+    if (!cpu->isChecked()) return;
+
+    SolucionadorPunteria::Opciones opciones;
+    opciones.anguloMin     = m_spinAngulo->minimum();
+    opciones.anguloMax     = m_spinAngulo->maximum();
+    opciones.velocidadMin  = m_spinVelocidad->minimum();
+    opciones.velocidadMax  = m_spinVelocidad->maximum();
+    opciones.presupuestoMs = m_spinPresupuestoCpu->value();
+    opciones.dt            = m_escena->pasoFisica();
+
+    m_turnoCpu = turno;
+    m_vigilanteCpu.setFuture(QtConcurrent::run(
+        [copia = mundo, opciones]() {
+            return SolucionadorPunteria::resolver(copia, opciones);
+        }));
+}
+
+void VentanaPrincipal::disparoCpuListo()
+{
+    const MundoSimulacion &mundo = m_escena->mundo();
+
+    // La partida pudo cambiar mientras pensaba (reinicio, victoria...).
+    if (mundo.hayGanador() || m_escena->turnoActual() != m_turnoCpu ||
+        (m_red && !m_red->turnoLocal())) {
+        jugarTurnoCpu();
+        return;
+    }
+
+    SolucionadorPunteria::Resultado r = m_vigilanteCpu.result();
+    m_spinAngulo->setValue(r.angulo);
+    m_spinVelocidad->setValue(r.velocidad);
+    m_escena->dispararProyectil(r.angulo, r.velocidad,
+                                MundoSimulacion::DisparoSimple);
+}
+
+void VentanaPrincipal::configurarPerfil(bool mostrarHud, const QString &rutaTraza)
+{
+    m_escena->mostrarPerfil(mostrarHud);
+
+    m_rutaTraza = rutaTraza;
+    if (!m_rutaTraza.isEmpty()) {
+        m_escena->grabarTraza(true);
+        connect(qApp, &QCoreApplication::aboutToQuit, this, [this]() {
+            if (m_escena->grabandoTraza())
+                alternarTraza();
+        });
+    }
+}
+
+// F4: empieza a grabar o detiene la grabacion y guarda el JSON.
+void VentanaPrincipal::alternarTraza()
+{
+    if (!m_escena->grabandoTraza()) {
+        m_escena->grabarTraza(true);
+        qInfo("Perfil: grabando traza");
+        return;
+    }
+
+    m_escena->grabarTraza(false);
+    QString ruta = m_rutaTraza;
+    if (ruta.isEmpty())
+        ruta = QStringLiteral("traza_%1.json")
+                   .arg(QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss"));
+
+    if (m_escena->exportarTraza(ruta))
+        qInfo("Perfil: traza guardada en %s", qPrintable(ruta));
+    else
+        qWarning("Perfil: no se pudo escribir %s", qPrintable(ruta));
+}
+
+// ------------------------- Partida en red -------------------------
+
+// Solo se juega por la red desde el bando local: la CPU puede llevarlo,
+// pero el del otro lado lo maneja el otro proceso.
+PartidaRed *VentanaPrincipal::crearPartidaRed()
+{
+    m_red = new PartidaRed(m_escena, this);
+    connect(m_red, &PartidaRed::estadoCambiado, this, [this](const QString &texto) {
+        statusBar()->showMessage(texto);
+    });
+    connect(m_red, &PartidaRed::terminada, this, &VentanaPrincipal::redTerminada);
+
+    m_comboNivel->setEnabled(false);
+    m_comboIntegrador->setEnabled(false);
+    m_comboAire->setEnabled(false);
+    m_botonSaltar->setEnabled(false);
+    QCheckBox *cpuRemota = m_red->bandoLocal() == EscenaJuego::Izquierda ? m_cpuDerecha
+                                                                         : m_cpuIzquierda;
+    cpuRemota->setChecked(false);
+    cpuRemota->setEnabled(false);
+    return m_red;
+}
+
+void VentanaPrincipal::servirPartida(quint16 puerto)
+{
+    if (m_red) return;
+    crearPartidaRed()->servir(puerto);
+}
+
+void VentanaPrincipal::unirsePartida(const QString &host, quint16 puerto)
+{
+    if (m_red) return;
+    crearPartidaRed()->conectar(host, puerto);
+}
+
+// Sin conexion se sigue jugando en local, con todo habilitado.
+void VentanaPrincipal::redTerminada()
+{
+    m_red->deleteLater();
+    m_red = nullptr;
+    m_comboNivel->setEnabled(true);
+    m_comboIntegrador->setEnabled(true);
+    m_comboAire->setEnabled(true);
+    m_botonSaltar->setEnabled(true);
+    m_cpuIzquierda->setEnabled(true);
+    m_cpuDerecha->setEnabled(true);
+}
+
 void VentanaPrincipal::keyPressEvent(QKeyEvent *event)
 {
+    // F3: HUD del perfilador; F4: grabar / guardar traza
+    if (event->key() == Qt::Key_F3) {
+        m_escena->mostrarPerfil(!m_escena->perfilVisible());
+        event->accept();
+        return;
+    }
+    if (event->key() == Qt::Key_F4) {
+        alternarTraza();
+        event->accept();
+        return;
+    }
+
+    if (event->key() == Qt::Key_S) {
+        if (!m_red)
+            m_escena->resolverAlInstante();
+        event->accept();
+        return;
+    }
+
     if (event->key() == Qt::Key_R) {
-        if (m_escena) {
+        if (m_red) {
+            if (!m_red->revancha())
+                statusBar()->showMessage(tr("La revancha la decide quien sirve la partida"), 3000);
+        } else if (m_escena) {
             m_escena->reiniciarJuego();
         }
         event->accept();
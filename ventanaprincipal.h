@@ -4,9 +4,15 @@
 #include <QMainWindow>
 #include <QGraphicsView>
 #include <QDoubleSpinBox>
+#include <QComboBox>
 #include <QPushButton>
 #include <QLabel>
+#include <QCheckBox>
+#include <QSpinBox>
+#include <QFutureWatcher>
 #include "escenajuego.h"
+#include "solucionadorpunteria.h"
+#include "partidared.h"
 
 class VentanaPrincipal : public QMainWindow
 {
@@ -14,10 +20,38 @@ class VentanaPrincipal : public QMainWindow
 public:
     explicit VentanaPrincipal(QWidget *parent = nullptr);
 
+    // Perfilado: HUD con p50/p99 por fase y traza para chrome://tracing.
+    // Con 'rutaTraza' se graba desde el arranque y se guarda al salir.
+    void configurarPerfil(bool mostrarHud, const QString &rutaTraza);
+    // Carpeta donde se archiva cada partida terminada (.p5r).
+    void fijarCarpetaRegistros(const QString &carpeta) { m_escena->fijarCarpetaRegistros(carpeta); }
+    // Agrega al selector un nivel (.p5n o de texto) o todos los de una
+    // carpeta. Si es un archivo suelto, ademas lo carga.
+    void agregarNiveles(const QString &ruta);
+
+    // Partida en red contra otro proceso (ver PartidaRed): quien sirve
+    // juega a la izquierda. El nivel y la fisica quedan fijos (los que
+    // esten elegidos) y no se puede saltar al final del turno.
+    void servirPartida(quint16 puerto);
+    void unirsePartida(const QString &host, quint16 puerto);
+
 private slots:
     void botonDisparar();
     void actualizarEtiquetaTurno(EscenaJuego::Bando bando);
     void mostrarGanador(EscenaJuego::Bando ganador);
+    void actualizarPrevision();
+    void cambiarNivel(int indice);
+    void cambiarFisica();
+
+    // --- jugador CPU ---
+    void jugarTurnoCpu();
+    void disparoCpuListo();
+
+    // --- perfilado ---
+    void alternarTraza();
+
+    // --- partida en red ---
+    void redTerminada();
 
 protected:
     // ---  para capturar la tecla R ---
@@ -27,8 +61,28 @@ private:
     QGraphicsView  *m_vista;
     QDoubleSpinBox *m_spinAngulo;
     QDoubleSpinBox *m_spinVelocidad;
+    QComboBox      *m_comboModo;
+    QComboBox      *m_comboNivel;     // dato: ruta del nivel
+    QComboBox      *m_comboIntegrador; // dato: Integrador
+    QComboBox      *m_comboAire;       // dato: EscenaJuego::Aire
+    int             m_indiceNivel{0}; // el cargado (para volver si falla)
     QPushButton    *m_botonDisparar;
+    QPushButton    *m_botonSaltar;
     QLabel         *m_etiquetaTurno;
+
+    // --- jugador CPU ---
+    QCheckBox *m_cpuIzquierda;
+    QCheckBox *m_cpuDerecha;
+    QSpinBox  *m_spinPresupuestoCpu;   // ms para buscar el disparo
+    QFutureWatcher<SolucionadorPunteria::Resultado> m_vigilanteCpu;
+    EscenaJuego::Bando m_turnoCpu{EscenaJuego::Izquierda};
+
+    // --- perfilado ---
+    QString m_rutaTraza;
+
+    // --- partida en red ---
+    PartidaRed *crearPartidaRed();
+    PartidaRed *m_red{nullptr};
 };
 
 #endif // VENTANAPRINCIPAL_H